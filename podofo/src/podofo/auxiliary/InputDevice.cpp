@@ -25,6 +25,18 @@ bool InputStreamDevice::Peek(char& ch) const
     return peek(ch);
 }
 
+bool InputStreamDevice::TryPeekBuffer(bufferview& buffer) const
+{
+    EnsureAccess(DeviceAccess::Read);
+    return tryPeekBuffer(buffer);
+}
+
+bool InputStreamDevice::tryPeekBuffer(bufferview& buffer) const
+{
+    buffer = { };
+    return false;
+}
+
 void InputStreamDevice::checkRead() const
 {
     EnsureAccess(DeviceAccess::Read);
@@ -10,6 +10,7 @@
 #include <istream>
 #include <fstream>
 
+#include "basetypes.h"
 #include "StreamDeviceBase.h"
 #include "InputStream.h"
 
@@ -31,12 +32,26 @@ public:
      */
     bool Peek(char& ch) const;
 
+    /** Try to peek a contiguous window of the data following the
+     * current position, without consuming it. The window is valid
+     * until the next operation on the device
+     * /returns true if success, false if EOF or the device
+     * doesn't support peeking windows
+     */
+    bool TryPeekBuffer(bufferview& buffer) const;
+
 protected:
     /** Peek at next char in stream.
      *  /returns true if success, false if EOF
      */
     virtual bool peek(char& ch) const = 0;
 
+    /** Peek a window of the data following the current position.
+     * The default implementation doesn't support it
+     *  /returns true if success, false if EOF or unsupported
+     */
+    virtual bool tryPeekBuffer(bufferview& buffer) const;
+
     void checkRead() const override;
 };
 
@@ -11,9 +11,22 @@
 
 #include <podofo/private/FileSystem.h>
 
+#ifdef _WIN32
+#include <podofo/private/WindowsLeanMean.h>
+#include <podofo/private/utfcpp_extensions.h>
+#else
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif
+
 using namespace std;
 using namespace PoDoFo;
 
+static const char* mapFile(const string_view& filepath, size_t& length);
+static void unmapFile(const char* buffer, size_t length);
+
 template <typename TStream>
 size_t getPosition(TStream& stream)
 {
@@ -611,7 +624,218 @@ bool SpanStreamDevice::peek(char& ch) const
     return true;
 }
 
+bool SpanStreamDevice::tryPeekBuffer(bufferview& buffer) const
+{
+    if (m_Position == m_Length)
+    {
+        buffer = { };
+        return false;
+    }
+
+    buffer = bufferview(m_buffer + m_Position, m_Length - m_Position);
+    return true;
+}
+
 void SpanStreamDevice::seek(ssize_t offset, SeekDirection direction)
 {
     m_Position = SeekPosition(m_Position, m_Length, offset, direction);
 }
+
+MmapStreamDevice::MmapStreamDevice(const string_view& filepath) :
+    StreamDevice(DeviceAccess::Read),
+    m_Filepath(filepath),
+    m_buffer(nullptr),
+    m_Length(0),
+    m_Position(0)
+{
+    m_buffer = mapFile(filepath, m_Length);
+}
+
+MmapStreamDevice::~MmapStreamDevice()
+{
+    unmapFile(m_buffer, m_Length);
+}
+
+size_t MmapStreamDevice::GetLength() const
+{
+    return m_Length;
+}
+
+size_t MmapStreamDevice::GetPosition() const
+{
+    return m_Position;
+}
+
+bool MmapStreamDevice::Eof() const
+{
+    return m_Position == m_Length;
+}
+
+bool MmapStreamDevice::CanSeek() const
+{
+    return true;
+}
+
+bufferview MmapStreamDevice::GetView(size_t offset, size_t size) const
+{
+    if (offset > m_Length || size > m_Length - offset)
+        PODOFO_RAISE_ERROR_INFO(PdfErrorCode::ValueOutOfRange, "Attempt to view out of mapping bounds");
+
+    return bufferview(m_buffer + offset, size);
+}
+
+void MmapStreamDevice::writeBuffer(const char* buffer, size_t size)
+{
+    (void)buffer;
+    (void)size;
+    PODOFO_RAISE_ERROR_INFO(PdfErrorCode::InvalidDeviceOperation, "A mapped file device is read-only");
+}
+
+size_t MmapStreamDevice::readBuffer(char* buffer, size_t size, bool& eof)
+{
+    size_t readCount = std::min(size, m_Length - m_Position);
+    std::memcpy(buffer, m_buffer + m_Position, readCount);
+    m_Position += readCount;
+    eof = m_Position == m_Length;
+    return readCount;
+}
+
+bool MmapStreamDevice::readChar(char& ch)
+{
+    if (m_Position == m_Length)
+    {
+        ch = '\0';
+        return false;
+    }
+
+    ch = m_buffer[m_Position];
+    m_Position++;
+    return true;
+}
+
+bool MmapStreamDevice::peek(char& ch) const
+{
+    if (m_Position == m_Length)
+    {
+        ch = '\0';
+        return false;
+    }
+
+    ch = m_buffer[m_Position];
+    return true;
+}
+
+bool MmapStreamDevice::tryPeekBuffer(bufferview& buffer) const
+{
+    if (m_Position == m_Length)
+    {
+        buffer = { };
+        return false;
+    }
+
+    buffer = bufferview(m_buffer + m_Position, m_Length - m_Position);
+    return true;
+}
+
+void MmapStreamDevice::seek(ssize_t offset, SeekDirection direction)
+{
+    m_Position = SeekPosition(m_Position, m_Length, offset, direction);
+}
+
+void MmapStreamDevice::close()
+{
+    unmapFile(m_buffer, m_Length);
+    m_buffer = nullptr;
+    m_Length = 0;
+    m_Position = 0;
+}
+
+#ifdef _WIN32
+
+const char* mapFile(const string_view& filepath, size_t& length)
+{
+    auto filepath16 = utf8::utf8to16((string)filepath);
+    // Don't lock the file while it's mapped: like on POSIX,
+    // other processes can still write, rename or delete it
+    HANDLE file = CreateFileW((wchar_t*)filepath16.c_str(), GENERIC_READ,
+        FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE,
+        nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (file == INVALID_HANDLE_VALUE)
+        PODOFO_RAISE_ERROR_INFO(PdfErrorCode::InvalidDeviceOperation, "Error accessing file {}", filepath);
+
+    LARGE_INTEGER size;
+    if (!GetFileSizeEx(file, &size))
+    {
+        CloseHandle(file);
+        PODOFO_RAISE_ERROR_INFO(PdfErrorCode::InvalidDeviceOperation, "Error retrieving size of file {}", filepath);
+    }
+
+    length = (size_t)size.QuadPart;
+    if (length == 0)
+    {
+        // Empty files can't be mapped
+        CloseHandle(file);
+        return nullptr;
+    }
+
+    // NOTE: The view keeps a reference to the mapping, which in
+    // turn references the file, so both handles can be closed
+    HANDLE mapping = CreateFileMappingW(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    CloseHandle(file);
+    if (mapping == nullptr)
+        PODOFO_RAISE_ERROR_INFO(PdfErrorCode::InvalidDeviceOperation, "Error mapping file {}", filepath);
+
+    auto ret = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+    CloseHandle(mapping);
+    if (ret == nullptr)
+        PODOFO_RAISE_ERROR_INFO(PdfErrorCode::InvalidDeviceOperation, "Error mapping file {}", filepath);
+
+    return (const char*)ret;
+}
+
+void unmapFile(const char* buffer, size_t length)
+{
+    (void)length;
+    if (buffer != nullptr)
+        UnmapViewOfFile(buffer);
+}
+
+#else // _WIN32
+
+const char* mapFile(const string_view& filepath, size_t& length)
+{
+    int fd = ::open(((string)filepath).c_str(), O_RDONLY);
+    if (fd == -1)
+        PODOFO_RAISE_ERROR_INFO(PdfErrorCode::InvalidDeviceOperation, "Error accessing file {}", filepath);
+
+    struct stat st;
+    if (fstat(fd, &st) == -1 || !S_ISREG(st.st_mode))
+    {
+        ::close(fd);
+        PODOFO_RAISE_ERROR_INFO(PdfErrorCode::InvalidDeviceOperation, "Error accessing regular file {}", filepath);
+    }
+
+    length = (size_t)st.st_size;
+    if (length == 0)
+    {
+        // Empty files can't be mapped
+        ::close(fd);
+        return nullptr;
+    }
+
+    // NOTE: The mapping stays valid after closing the descriptor
+    void* ret = mmap(nullptr, length, PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd);
+    if (ret == MAP_FAILED)
+        PODOFO_RAISE_ERROR_INFO(PdfErrorCode::InvalidDeviceOperation, "Error mapping file {}", filepath);
+
+    return (const char*)ret;
+}
+
+void unmapFile(const char* buffer, size_t length)
+{
+    if (buffer != nullptr)
+        munmap(const_cast<char*>(buffer), length);
+}
+
+#endif // _WIN32
@@ -194,6 +194,18 @@ protected:
         return true;
     }
 
+    bool tryPeekBuffer(bufferview& buffer) const override
+    {
+        if (m_Position == m_container->size())
+        {
+            buffer = { };
+            return false;
+        }
+
+        buffer = bufferview(m_container->data() + m_Position, m_container->size() - m_Position);
+        return true;
+    }
+
     void seek(ssize_t offset, SeekDirection direction) override
     {
         m_Position = SeekPosition(m_Position, m_container->size(), offset, direction);
@@ -231,11 +243,16 @@ public:
 
     bool CanSeek() const override;
 
+    /** Get a view of the whole span
+     */
+    bufferview GetView() const { return bufferview(m_buffer, m_Length); }
+
 protected:
     void writeBuffer(const char* buffer, size_t size) override;
     size_t readBuffer(char* buffer, size_t size, bool& eof) override;
     bool readChar(char& ch) override;
     bool peek(char& ch) const override;
+    bool tryPeekBuffer(bufferview& buffer) const override;
     void seek(ssize_t offset, SeekDirection direction) override;
 
 private:
@@ -247,6 +264,61 @@ private:
     size_t m_Position;
 };
 
+/** A read-only StreamDevice that maps a whole file in memory
+ *
+ *  Reads are served directly from the mapping and the mapped
+ *  bytes can be accessed without copies with GetView(). Views
+ *  into the mapping are valid as long as the device is alive
+ *  and not closed
+ */
+class PODOFO_API MmapStreamDevice final : public StreamDevice
+{
+public:
+    /** Map for reading the supplied filepath
+     */
+    MmapStreamDevice(const std::string_view& filepath);
+
+    ~MmapStreamDevice();
+
+public:
+    size_t GetLength() const override;
+
+    size_t GetPosition() const override;
+
+    bool Eof() const override;
+
+    bool CanSeek() const override;
+
+    const std::string& GetFilepath() const { return m_Filepath; }
+
+    /** Get a view of the whole mapped file
+     */
+    bufferview GetView() const { return bufferview(m_buffer, m_Length); }
+
+    /** Get a view of the given range of the mapped file
+     */
+    bufferview GetView(size_t offset, size_t size) const;
+
+protected:
+    void writeBuffer(const char* buffer, size_t size) override;
+    size_t readBuffer(char* buffer, size_t size, bool& eof) override;
+    bool readChar(char& ch) override;
+    bool peek(char& ch) const override;
+    bool tryPeekBuffer(bufferview& buffer) const override;
+    void seek(ssize_t offset, SeekDirection direction) override;
+    void close() override;
+
+private:
+    MmapStreamDevice(const MmapStreamDevice&) = delete;
+    MmapStreamDevice& operator=(const MmapStreamDevice&) = delete;
+
+private:
+    std::string m_Filepath;
+    const char* m_buffer;
+    size_t m_Length;
+    size_t m_Position;
+};
+
 /**
  * An StreamDevice device that does nothing
  */
@@ -0,0 +1,34 @@
+/**
+ * SPDX-FileCopyrightText: (C) 2024 Francesco Pretto <ceztko@gmail.com>
+ * SPDX-License-Identifier: LGPL-2.0-or-later
+ * SPDX-License-Identifier: MPL-2.0
+ */
+
+#include <podofo/private/PdfDeclarationsPrivate.h>
+#include "PdfArenaAllocator.h"
+#include <podofo/private/PdfArena.h>
+
+using namespace std;
+using namespace PoDoFo;
+
+PdfArena* PdfArenaAllocatorBase::getCurrentArena()
+{
+    static_assert(ArenaAlignment == PdfArena::BlockAlignment, "The arena alignment must match");
+    return PdfArena::GetCurrent();
+}
+
+void* PdfArenaAllocatorBase::allocate(PdfArena* arena, size_t size)
+{
+    if (arena == nullptr)
+        return ::operator new(size);
+    else
+        return arena->Allocate(size);
+}
+
+void PdfArenaAllocatorBase::deallocate(PdfArena* arena, void* ptr) noexcept
+{
+    if (arena == nullptr)
+        ::operator delete(ptr);
+    else
+        PdfArena::Deallocate(ptr);
+}
@@ -0,0 +1,101 @@
+/**
+ * SPDX-FileCopyrightText: (C) 2024 Francesco Pretto <ceztko@gmail.com>
+ * SPDX-License-Identifier: LGPL-2.0-or-later
+ * SPDX-License-Identifier: MPL-2.0
+ */
+
+#ifndef PDF_ARENA_ALLOCATOR_H
+#define PDF_ARENA_ALLOCATOR_H
+
+#include "PdfDeclarations.h"
+
+namespace PoDoFo {
+
+class PdfArena;
+
+class PODOFO_API PdfArenaAllocatorBase
+{
+protected:
+    // Alignment of the memory handed out by the arenas
+    static constexpr size_t ArenaAlignment = alignof(void*) > alignof(double) ? alignof(void*) : alignof(double);
+
+    static PdfArena* getCurrentArena();
+    static void* allocate(PdfArena* arena, size_t size);
+    static void deallocate(PdfArena* arena, void* ptr) noexcept;
+};
+
+/** Standard allocator taking memory from the arena of the
+ * document being loaded, if any, otherwise from the heap.
+ * The arena is recorded in the allocator, and moved along
+ * with the memory by the containers
+ * \remarks Used for the storage of the parsed objects
+ * \see PdfLoadOptions::ArenaAllocation
+ */
+template <typename T>
+class PdfArenaAllocator : private PdfArenaAllocatorBase
+{
+    template <typename U>
+    friend class PdfArenaAllocator;
+
+public:
+    using value_type = T;
+    using propagate_on_container_move_assignment = std::true_type;
+    using propagate_on_container_swap = std::true_type;
+    using is_always_equal = std::false_type;
+
+    /** Create an allocator on the heap
+     */
+    PdfArenaAllocator() noexcept
+        : m_arena(nullptr) { }
+
+    template <typename U>
+    PdfArenaAllocator(const PdfArenaAllocator<U>& rhs) noexcept
+        : m_arena(rhs.m_arena) { }
+
+    /** Create an allocator on the current arena of the calling thread, if any
+     */
+    static PdfArenaAllocator GetCurrent() noexcept
+    {
+        return PdfArenaAllocator(getCurrentArena());
+    }
+
+    T* allocate(size_t n)
+    {
+        static_assert(alignof(T) <= ArenaAlignment, "The type is overaligned for the arena");
+        return static_cast<T*>(PdfArenaAllocatorBase::allocate(m_arena, n * sizeof(T)));
+    }
+
+    void deallocate(T* ptr, size_t) noexcept
+    {
+        PdfArenaAllocatorBase::deallocate(m_arena, ptr);
+    }
+
+    // Copied containers don't share the arena of the source
+    PdfArenaAllocator select_on_container_copy_construction() const noexcept
+    {
+        return PdfArenaAllocator();
+    }
+
+    template <typename U>
+    bool operator==(const PdfArenaAllocator<U>& rhs) const noexcept
+    {
+        return m_arena == rhs.m_arena;
+    }
+
+    template <typename U>
+    bool operator!=(const PdfArenaAllocator<U>& rhs) const noexcept
+    {
+        return m_arena != rhs.m_arena;
+    }
+
+private:
+    explicit PdfArenaAllocator(PdfArena* arena) noexcept
+        : m_arena(arena) { }
+
+private:
+    PdfArena* m_arena;
+};
+
+}
+
+#endif // PDF_ARENA_ALLOCATOR_H
@@ -12,10 +12,11 @@
 using namespace std;
 using namespace PoDoFo;
 
-PdfArray::PdfArray() { }
+PdfArray::PdfArray()
+    : m_Objects(PdfArenaAllocator<PdfObject>::GetCurrent()) { }
 
 PdfArray::PdfArray(const PdfArray& rhs)
-    : m_Objects(rhs.m_Objects)
+    : m_Objects(rhs.m_Objects, PdfArenaAllocator<PdfObject>::GetCurrent())
 {
     setChildrenParent();
 }
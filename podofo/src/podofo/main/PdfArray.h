@@ -9,11 +9,12 @@
 
 #include "PdfDeclarations.h"
 #include "PdfDataContainer.h"
+#include "PdfArenaAllocator.h"
 
 namespace PoDoFo {
 
 class PdfArray;
-using PdfArrayList = std::vector<PdfObject>;
+using PdfArrayList = std::vector<PdfObject, PdfArenaAllocator<PdfObject>>;
 
 /**
  * Helper class to iterate through array indirect objects
@@ -14,9 +14,10 @@ using namespace std;
 using namespace PoDoFo;
 
 PdfCharCodeMap::PdfCharCodeMap()
-    : m_MapDirty(false), m_codePointMapHead(nullptr), m_depth(0) { }
+    : m_MapDirty(false), m_codePointMapHead(nullptr), m_depth(0), m_compiledMap(nullptr) { }
 
 PdfCharCodeMap::PdfCharCodeMap(PdfCharCodeMap&& map) noexcept
+    : m_compiledMap(nullptr)
 {
     move(map);
 }
@@ -24,6 +25,7 @@ PdfCharCodeMap::PdfCharCodeMap(PdfCharCodeMap&& map) noexcept
 PdfCharCodeMap::~PdfCharCodeMap()
 {
     deleteNode(m_codePointMapHead);
+    resetCompiledMap();
 }
 
 PdfCharCodeMap& PdfCharCodeMap::operator=(PdfCharCodeMap&& map) noexcept
@@ -49,6 +51,8 @@ void PdfCharCodeMap::move(PdfCharCodeMap& map) noexcept
     utls::move(map.m_MapDirty, m_MapDirty);
     utls::move(map.m_codePointMapHead, m_codePointMapHead);
     utls::move(map.m_depth, m_depth);
+    resetCompiledMap();
+    m_compiledMap.store(map.m_compiledMap.exchange(nullptr));
 }
 
 void PdfCharCodeMap::PushMapping(const PdfCharCode& codeUnit, const codepointview& codePoints)
@@ -68,14 +72,63 @@ void PdfCharCodeMap::PushMapping(const PdfCharCode& codeUnit, codepoint codePoin
 
 bool PdfCharCodeMap::TryGetCodePoints(const PdfCharCode& codeUnit, vector<codepoint>& codePoints) const
 {
-    auto found = m_CodeUnitMap.find(codeUnit);
-    if (found == m_CodeUnitMap.end())
+    codepointview view;
+    if (!TryGetCodePoints(codeUnit, view))
     {
         codePoints.clear();
         return false;
     }
 
-    codePoints = found->second;
+    codePoints.assign(view.begin(), view.end());
+    return true;
+}
+
+bool PdfCharCodeMap::TryGetCodePoints(const PdfCharCode& codeUnit, codepointview& codePoints) const
+{
+    auto& compiled = getCompiledMap();
+    auto entry = compiled.Find(codeUnit.Code);
+    if (entry == nullptr)
+    {
+        codePoints = { };
+        return false;
+    }
+
+    codePoints = compiled.GetCodePoints(*entry);
+    return true;
+}
+
+bool PdfCharCodeMap::TryAppendCodePoints(string_view::iterator& it, const string_view::iterator& end,
+    const PdfEncodingLimits& limits, vector<codepoint>& codePoints) const
+{
+    auto& compiled = getCompiledMap();
+    while (it != end)
+    {
+        // Match the code sizes from the shortest, as
+        // in PdfEncodingMap::tryGetNextCodePoints()
+        string_view::iterator curr = it;
+        const CompiledMap::Entry* entry = nullptr;
+        unsigned code = 0;
+        for (unsigned char i = 1; i <= limits.MaxCodeSize && curr != end; i++)
+        {
+            code <<= 8;
+            code |= (uint8_t)*curr;
+            curr++;
+            if (i < limits.MinCodeSize)
+                continue;
+
+            entry = compiled.Find(code);
+            if (entry != nullptr)
+                break;
+        }
+
+        if (entry == nullptr)
+            return false;
+
+        auto view = compiled.GetCodePoints(*entry);
+        codePoints.insert(codePoints.end(), view.begin(), view.end());
+        it = curr;
+    }
+
     return true;
 }
 
@@ -144,6 +197,7 @@ void PdfCharCodeMap::pushMapping(const PdfCharCode& codeUnit, vector<codepoint>&
         PODOFO_RAISE_ERROR_INFO(PdfErrorCode::InvalidHandle, "Code unit must be valid");
 
     m_CodeUnitMap[codeUnit] = std::move(codePoints);
+    resetCompiledMap();
 
     // Update limits
     if (codeUnit.CodeSpaceSize < m_Limits.MinCodeSize)
@@ -292,3 +346,127 @@ void PdfCharCodeMap::deleteNode(CPMapNode* node)
     deleteNode(node->Right);
     delete node;
 }
+
+const PdfCharCodeMap::CompiledMap& PdfCharCodeMap::getCompiledMap() const
+{
+    auto compiled = m_compiledMap.load(memory_order_acquire);
+    if (compiled != nullptr)
+        return *compiled;
+
+    // The map may be looked up by multiple threads, so it's
+    // compiled only once. Modifications are not thread safe
+    unique_lock<mutex> lock(m_compileMutex);
+    compiled = m_compiledMap.load(memory_order_relaxed);
+    if (compiled != nullptr)
+        return *compiled;
+
+    unique_ptr<CompiledMap> newMap(new CompiledMap());
+    newMap->TwoBytesFirstCode = 0;
+
+    // Codes up to 0xFFFF are stored in dense tables, unless
+    // the table would be too sparse. The other codes are
+    // binary searched
+    bool hasOneByteCodes = false;
+    unsigned twoBytesCount = 0;
+    unsigned twoBytesFirstCode = numeric_limits<unsigned>::max();
+    unsigned twoBytesLastCode = 0;
+    for (auto& pair : m_CodeUnitMap)
+    {
+        unsigned code = pair.first.Code;
+        if (code < 0x100)
+        {
+            hasOneByteCodes = true;
+        }
+        else if (code <= 0xFFFF)
+        {
+            twoBytesCount++;
+            twoBytesFirstCode = std::min(twoBytesFirstCode, code);
+            twoBytesLastCode = std::max(twoBytesLastCode, code);
+        }
+    }
+
+    if (hasOneByteCodes)
+        newMap->OneByteCodes.resize(0x100);
+
+    if (twoBytesCount != 0
+        && twoBytesLastCode - twoBytesFirstCode < std::max(0x100u, twoBytesCount * 8))
+    {
+        newMap->TwoBytesFirstCode = twoBytesFirstCode;
+        newMap->TwoBytesCodes.resize(twoBytesLastCode - twoBytesFirstCode + 1);
+    }
+
+    for (auto& pair : m_CodeUnitMap)
+    {
+        auto& codePoints = pair.second;
+        CompiledMap::Entry entry;
+        entry.Length = (uint32_t)codePoints.size();
+        if (codePoints.size() == 1)
+        {
+            entry.Value = codePoints[0];
+        }
+        else
+        {
+            entry.Value = (codepoint)newMap->Pool.size();
+            newMap->Pool.insert(newMap->Pool.end(), codePoints.begin(), codePoints.end());
+        }
+
+        unsigned code = pair.first.Code;
+        if (code < 0x100)
+            newMap->OneByteCodes[code] = entry;
+        else if (code <= 0xFFFF && newMap->TwoBytesCodes.size() != 0)
+            newMap->TwoBytesCodes[code - newMap->TwoBytesFirstCode] = entry;
+        else
+            newMap->OtherCodes.push_back({ code, entry }); // NOTE: The map is sorted by code
+    }
+
+    newMap->OtherCodes.shrink_to_fit();
+    newMap->Pool.shrink_to_fit();
+    compiled = newMap.release();
+    m_compiledMap.store(compiled, memory_order_release);
+    return *compiled;
+}
+
+void PdfCharCodeMap::resetCompiledMap()
+{
+    delete m_compiledMap.exchange(nullptr);
+}
+
+const PdfCharCodeMap::CompiledMap::Entry* PdfCharCodeMap::CompiledMap::Find(unsigned code) const
+{
+    const Entry* entry;
+    if (code < 0x100)
+    {
+        if (OneByteCodes.size() == 0)
+            return nullptr;
+
+        entry = &OneByteCodes[code];
+    }
+    else if (code <= 0xFFFF && TwoBytesCodes.size() != 0)
+    {
+        if (code < TwoBytesFirstCode || code - TwoBytesFirstCode >= TwoBytesCodes.size())
+            return nullptr;
+
+        entry = &TwoBytesCodes[code - TwoBytesFirstCode];
+    }
+    else
+    {
+        auto found = std::lower_bound(OtherCodes.begin(), OtherCodes.end(), code,
+            [](const pair<unsigned, Entry>& pair, unsigned code) {
+                return pair.first < code;
+            });
+        if (found == OtherCodes.end() || found->first != code)
+            return nullptr;
+
+        entry = &found->second;
+    }
+
+    return entry->Length == 0 ? nullptr : entry;
+}
+
+codepointview PdfCharCodeMap::CompiledMap::GetCodePoints(const Entry& entry) const
+{
+    if (entry.Length == 1)
+        return codepointview(&entry.Value, 1);
+    else
+        return codepointview(Pool.data() + entry.Value, entry.Length);
+}
@@ -7,6 +7,9 @@
 #ifndef PDF_CHAR_CODE_MAP_H
 #define PDF_CHAR_CODE_MAP_H
 
+#include <atomic>
+#include <mutex>
+
 #include "PdfDeclarations.h"
 #include "PdfEncodingCommon.h"
 
@@ -51,6 +54,22 @@ namespace PoDoFo
          */
         bool TryGetCodePoints(const PdfCharCode& codeUnit, std::vector<codepoint>& codePoints) const;
 
+        /** Try get a view of the code points mapped by the code unit, without copying them
+         * \remarks The view is valid until the map is modified
+         */
+        bool TryGetCodePoints(const PdfCharCode& codeUnit, codepointview& codePoints) const;
+
+        /** Decode an encoded string range, appending the code points of
+         * all its code units. For every code unit the sizes in the limits
+         * are tried from the shortest one, see ISO 32000-1:2008 "9.7.6.2 CMap Mapping"
+         * \param limits the limits of the code sizes to try
+         * \returns true if the whole range was decoded, false if the
+         * decoding stopped at a code unit that is not mapped. The
+         * iterator is left at the start of that code unit
+         */
+        bool TryAppendCodePoints(std::string_view::iterator& it, const std::string_view::iterator& end,
+            const PdfEncodingLimits& limits, std::vector<codepoint>& codePoints) const;
+
         /** Try get char code from utf8 encoded range
          * \remarks It assumes it != and it will consumes the interator
          * also when returning false
@@ -77,6 +96,30 @@ namespace PoDoFo
         void move(PdfCharCodeMap& map) noexcept;
         void pushMapping(const PdfCharCode& codeUnit, std::vector<codepoint>&& codePoints);
 
+        // Immutable lookup tables of code units -> code point(s),
+        // compiled on first lookup after the map is modified.
+        // NOTE: As in the map, codes are matched regardless of their size
+        struct CompiledMap
+        {
+            struct Entry
+            {
+                codepoint Value;        ///< The code point, or the offset in the pool for ligatures
+                uint32_t Length;        ///< Count of the code points, 0 if the code is not mapped
+            };
+
+            const Entry* Find(unsigned code) const;
+            codepointview GetCodePoints(const Entry& entry) const;
+
+            std::vector<Entry> OneByteCodes;        ///< Indexed by the codes below 0x100, or empty
+            unsigned TwoBytesFirstCode;
+            std::vector<Entry> TwoBytesCodes;       ///< Indexed by the codes up to 0xFFFF minus TwoBytesFirstCode, or empty
+            std::vector<std::pair<unsigned, Entry>> OtherCodes; ///< Sorted codes not in the dense tables
+            std::vector<codepoint> Pool;            ///< Packed code points of the ligatures
+        };
+
+        const CompiledMap& getCompiledMap() const;
+        void resetCompiledMap();
+
         // Map code point(s) -> code units
         struct CPMapNode
         {
@@ -115,6 +158,8 @@ namespace PoDoFo
         bool m_MapDirty;
         CPMapNode* m_codePointMapHead;           // Head of a BST to lookup code points
         int m_depth;
+        mutable std::atomic<CompiledMap*> m_compiledMap;
+        mutable std::mutex m_compileMutex;
     };
 }
 
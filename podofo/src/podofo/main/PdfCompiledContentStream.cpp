@@ -0,0 +1,263 @@
+/**
+ * SPDX-FileCopyrightText: (C) 2024 Francesco Pretto <ceztko@gmail.com>
+ * SPDX-License-Identifier: LGPL-2.0-or-later
+ * SPDX-License-Identifier: MPL-2.0
+ */
+
+#include <podofo/private/PdfDeclarationsPrivate.h>
+#include "PdfCompiledContentStream.h"
+
+#include "PdfCanvasInputDevice.h"
+#include "PdfArray.h"
+
+using namespace std;
+using namespace PoDoFo;
+
+PdfCompiledContentStream::PdfCompiledContentStream(const PdfCanvas& canvas)
+{
+    PdfCanvasInputDevice device(canvas);
+    compile(device);
+}
+
+PdfCompiledContentStream::PdfCompiledContentStream(InputStreamDevice& device)
+{
+    compile(device);
+}
+
+unsigned PdfCompiledContentStream::GetCount() const
+{
+    return (unsigned)m_instructions.size();
+}
+
+void PdfCompiledContentStream::compile(InputStreamDevice& device)
+{
+    // Read the stream with a reader that doesn't follow XObject forms,
+    // so the replayed contents are exactly the same as the read ones
+    PdfContentStreamReader reader(shared_ptr<InputStreamDevice>(&device, [](InputStreamDevice*) { }));
+    PdfContent content;
+    while (reader.TryReadNext(content))
+    {
+        Instruction instruction{ };
+        instruction.Type = content.Type;
+        instruction.Operator = content.Operator;
+        instruction.Warnings = content.Warnings;
+        instruction.OperandIndex = (uint32_t)m_operands.size();
+        instruction.OperandCount = content.Stack.GetSize();
+        // NOTE: The stack is stored bottom to top
+        for (auto it = content.Stack.rbegin(); it != content.Stack.rend(); it++)
+            pushOperand(*it);
+
+        switch (content.Type)
+        {
+            case PdfContentType::ImageDictionary:
+            {
+                // The dictionary follows the stack operands
+                pushOperand(PdfVariant(content.InlineImageDictionary));
+                break;
+            }
+            case PdfContentType::ImageData:
+            {
+                instruction.DataOffset = pushData(content.InlineImageData);
+                instruction.DataLength = (uint32_t)content.InlineImageData.size();
+                break;
+            }
+            case PdfContentType::UnexpectedKeyword:
+            {
+                instruction.DataOffset = pushData(content.Keyword);
+                instruction.DataLength = (uint32_t)content.Keyword.size();
+                break;
+            }
+            default:
+            {
+                // Nothing to store
+                break;
+            }
+        }
+
+        m_instructions.push_back(instruction);
+    }
+
+    m_instructions.shrink_to_fit();
+    m_operands.shrink_to_fit();
+    m_data.shrink_to_fit();
+}
+
+void PdfCompiledContentStream::pushOperand(const PdfVariant& variant)
+{
+    Operand operand{ };
+    switch (variant.GetDataType())
+    {
+        case PdfDataType::Bool:
+        {
+            operand.Type = OperandType::Bool;
+            operand.Bool = variant.GetBool();
+            m_operands.push_back(operand);
+            break;
+        }
+        case PdfDataType::Number:
+        {
+            operand.Type = OperandType::Number;
+            operand.Number = variant.GetNumber();
+            m_operands.push_back(operand);
+            break;
+        }
+        case PdfDataType::Real:
+        {
+            operand.Type = OperandType::Real;
+            operand.Real = variant.GetRealStrict();
+            m_operands.push_back(operand);
+            break;
+        }
+        case PdfDataType::String:
+        {
+            auto& str = variant.GetString();
+            auto& raw = str.GetRawData();
+            operand.Type = str.IsHex() ? OperandType::HexString : OperandType::String;
+            operand.Offset = pushData(raw);
+            operand.Length = (uint32_t)raw.size();
+            m_operands.push_back(operand);
+            break;
+        }
+        case PdfDataType::Name:
+        {
+            auto& raw = variant.GetName().GetRawData();
+            operand.Type = OperandType::Name;
+            operand.Offset = pushData(raw);
+            operand.Length = (uint32_t)raw.size();
+            m_operands.push_back(operand);
+            break;
+        }
+        case PdfDataType::Array:
+        {
+            auto& arr = variant.GetArray();
+            operand.Type = OperandType::Array;
+            operand.Length = arr.GetSize();
+            m_operands.push_back(operand);
+            for (auto& obj : arr)
+                pushOperand(obj.GetVariant());
+
+            break;
+        }
+        case PdfDataType::Dictionary:
+        {
+            auto& dict = variant.GetDictionary();
+            operand.Type = OperandType::Dictionary;
+            operand.Length = dict.GetSize();
+            m_operands.push_back(operand);
+            for (auto& pair : dict)
+            {
+                pushOperand(pair.first);
+                pushOperand(pair.second.GetVariant());
+            }
+
+            break;
+        }
+        case PdfDataType::Null:
+        {
+            operand.Type = OperandType::Null;
+            m_operands.push_back(operand);
+            break;
+        }
+        default:
+        {
+            PODOFO_RAISE_ERROR_INFO(PdfErrorCode::InvalidDataType, "Unsupported operand type {}", variant.GetDataTypeString());
+        }
+    }
+}
+
+uint32_t PdfCompiledContentStream::pushData(const bufferview& data)
+{
+    if (m_data.size() + data.size() > numeric_limits<uint32_t>::max())
+        PODOFO_RAISE_ERROR_INFO(PdfErrorCode::ValueOutOfRange, "Content stream too big to be compiled");
+
+    uint32_t offset = (uint32_t)m_data.size();
+    m_data.append(data.data(), data.size());
+    return offset;
+}
+
+PdfVariant PdfCompiledContentStream::getOperand(unsigned& index) const
+{
+    auto& operand = m_operands[index];
+    index++;
+    switch (operand.Type)
+    {
+        case OperandType::Bool:
+            return PdfVariant(operand.Bool);
+        case OperandType::Number:
+            return PdfVariant(operand.Number);
+        case OperandType::Real:
+            return PdfVariant(operand.Real);
+        case OperandType::String:
+        case OperandType::HexString:
+            return PdfVariant(PdfString::FromRaw(getData(operand.Offset, operand.Length),
+                operand.Type == OperandType::HexString));
+        case OperandType::Name:
+            return PdfVariant(PdfName::FromRaw(getData(operand.Offset, operand.Length)));
+        case OperandType::Array:
+        {
+            PdfArray arr;
+            arr.Reserve(operand.Length);
+            for (unsigned i = 0; i < operand.Length; i++)
+                arr.Add(getOperand(index));
+
+            return PdfVariant(std::move(arr));
+        }
+        case OperandType::Dictionary:
+        {
+            PdfDictionary dict;
+            for (unsigned i = 0; i < operand.Length; i++)
+            {
+                auto key = getOperand(index);
+                dict.AddKey(key.GetName(), getOperand(index));
+            }
+
+            return PdfVariant(std::move(dict));
+        }
+        case OperandType::Null:
+            return PdfVariant();
+        default:
+            PODOFO_RAISE_ERROR(PdfErrorCode::InvalidEnumValue);
+    }
+}
+
+string_view PdfCompiledContentStream::getData(uint32_t offset, uint32_t length) const
+{
+    return string_view(m_data.data() + offset, length);
+}
+
+PdfContentStreamCache::PdfContentStreamCache() { }
+
+shared_ptr<const PdfCompiledContentStream> PdfContentStreamCache::GetOrCompile(const PdfCanvas& canvas)
+{
+    auto key = &canvas.GetElement().GetObject();
+    {
+        unique_lock<mutex> lock(m_mutex);
+        auto found = m_streams.find(key);
+        if (found != m_streams.end())
+            return found->second;
+    }
+
+    // Compile without holding the lock. If another thread compiled
+    // the same canvas in the meantime, its stream is kept instead
+    auto compiled = std::make_shared<const PdfCompiledContentStream>(canvas);
+    unique_lock<mutex> lock(m_mutex);
+    return m_streams.emplace(key, std::move(compiled)).first->second;
+}
+
+void PdfContentStreamCache::Remove(const PdfCanvas& canvas)
+{
+    unique_lock<mutex> lock(m_mutex);
+    m_streams.erase(&canvas.GetElement().GetObject());
+}
+
+void PdfContentStreamCache::Clear()
+{
+    unique_lock<mutex> lock(m_mutex);
+    m_streams.clear();
+}
+
+unsigned PdfContentStreamCache::GetCount() const
+{
+    unique_lock<mutex> lock(m_mutex);
+    return (unsigned)m_streams.size();
+}
@@ -0,0 +1,140 @@
+/**
+ * SPDX-FileCopyrightText: (C) 2024 Francesco Pretto <ceztko@gmail.com>
+ * SPDX-License-Identifier: LGPL-2.0-or-later
+ * SPDX-License-Identifier: MPL-2.0
+ */
+
+#ifndef PDF_COMPILED_CONTENT_STREAM_H
+#define PDF_COMPILED_CONTENT_STREAM_H
+
+#include <mutex>
+#include <unordered_map>
+
+#include "PdfContentStreamReader.h"
+
+namespace PoDoFo {
+
+/** A content stream that has been tokenized once and stored
+ * in a compact form, so it can be replayed by PdfContentStreamReader
+ * without parsing it again
+ *
+ * The contents are stored as a flat array of instructions, with the
+ * operands packed in a separate array: numbers are stored inline
+ * while strings, names, keywords and inline image data are stored
+ * as offsets in a single buffer
+ * \remarks XObject forms are not followed while compiling, the reader
+ * follows them while replaying
+ */
+class PODOFO_API PdfCompiledContentStream final
+{
+    friend class PdfContentStreamReader;
+
+public:
+    /** Compile the content stream of the given canvas
+     */
+    PdfCompiledContentStream(const PdfCanvas& canvas);
+
+    /** Compile the content stream read from the given device
+     */
+    PdfCompiledContentStream(InputStreamDevice& device);
+
+public:
+    /** Get the count of contents (operators, inline image
+     * dictionaries and data, unexpected keywords) in the stream
+     */
+    unsigned GetCount() const;
+
+private:
+    PdfCompiledContentStream(const PdfCompiledContentStream&) = delete;
+    PdfCompiledContentStream& operator=(const PdfCompiledContentStream&) = delete;
+
+private:
+    enum class OperandType : uint8_t
+    {
+        Null,
+        Bool,
+        Number,
+        Real,
+        String,
+        HexString,
+        Name,
+        Array,      ///< Followed by Length elements
+        Dictionary, ///< Followed by Length key/value pairs
+    };
+
+    struct Operand
+    {
+        OperandType Type;
+        uint32_t Length;        ///< Length of the data, or count of the children
+        union
+        {
+            bool Bool;
+            int64_t Number;
+            double Real;
+            uint32_t Offset;    ///< Offset of the data
+        };
+    };
+
+    struct Instruction
+    {
+        PdfContentType Type;
+        PdfOperator Operator;
+        PdfContentWarnings Warnings;
+        uint32_t OperandIndex;  ///< Index of the first operand
+        uint32_t OperandCount;  ///< Count of the operands in the stack
+        uint32_t DataOffset;    ///< Unexpected keyword or inline image data
+        uint32_t DataLength;
+    };
+
+private:
+    void compile(InputStreamDevice& device);
+    void pushOperand(const PdfVariant& variant);
+    uint32_t pushData(const bufferview& data);
+    PdfVariant getOperand(unsigned& index) const;
+    std::string_view getData(uint32_t offset, uint32_t length) const;
+
+private:
+    std::vector<Instruction> m_instructions;
+    std::vector<Operand> m_operands;
+    charbuff m_data;
+};
+
+/** A thread safe cache of compiled content streams, keyed
+ * by the address of the canvas object, eg. an XObject form
+ * \remarks The cache is not invalidated automatically: remove
+ * a canvas after modifying its content stream. Since the keys
+ * are const PdfObject pointers, the cache must not outlive the
+ * document of the cached canvases, nor be used after they are
+ * removed from it
+ */
+class PODOFO_API PdfContentStreamCache final
+{
+public:
+    PdfContentStreamCache();
+
+public:
+    /** Get the compiled content stream of the canvas, compiling
+     * it if it's not cached yet
+     */
+    std::shared_ptr<const PdfCompiledContentStream> GetOrCompile(const PdfCanvas& canvas);
+
+    /** Remove the compiled content stream of the canvas, if any
+     */
+    void Remove(const PdfCanvas& canvas);
+
+    void Clear();
+
+    unsigned GetCount() const;
+
+private:
+    PdfContentStreamCache(const PdfContentStreamCache&) = delete;
+    PdfContentStreamCache& operator=(const PdfContentStreamCache&) = delete;
+
+private:
+    mutable std::mutex m_mutex;
+    std::unordered_map<const PdfObject*, std::shared_ptr<const PdfCompiledContentStream>> m_streams;
+};
+
+}
+
+#endif // PDF_COMPILED_CONTENT_STREAM_H
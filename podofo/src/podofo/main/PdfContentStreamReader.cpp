@@ -8,6 +8,7 @@
 #include "PdfContentStreamReader.h"
 
 #include "PdfXObjectForm.h"
+#include "PdfCompiledContentStream.h"
 #include "PdfOperatorUtils.h"
 #include "PdfCanvasInputDevice.h"
 #include "PdfData.h"
@@ -18,25 +19,41 @@ using namespace PoDoFo;
 
 PdfContentStreamReader::PdfContentStreamReader(const PdfCanvas& canvas,
         nullable<const PdfContentReaderArgs&> args) :
-    PdfContentStreamReader(std::make_shared<PdfCanvasInputDevice>(canvas),
-        &canvas, args) { }
+    PdfContentStreamReader(args)
+{
+    // NOTE: The canvas is read directly also when the cache is
+    // set, since it's usually read once, eg. a page, while the
+    // forms it draws may be shared with other canvases
+    m_inputs.push_back({ nullptr, std::make_shared<PdfCanvasInputDevice>(canvas), nullptr, 0, &canvas });
+}
 
 PdfContentStreamReader::PdfContentStreamReader(const shared_ptr<InputStreamDevice>& device,
         nullable<const PdfContentReaderArgs&> args) :
-    PdfContentStreamReader(device, nullptr, args) { }
+    PdfContentStreamReader(args)
+{
+    if (device == nullptr)
+        PODOFO_RAISE_ERROR_INFO(PdfErrorCode::InvalidHandle, "Device must be non null");
 
-PdfContentStreamReader::PdfContentStreamReader(const shared_ptr<InputStreamDevice>& device,
-    const PdfCanvas* canvas, nullable<const PdfContentReaderArgs&> args) :
+    m_inputs.push_back({ nullptr, device, nullptr, 0, nullptr });
+}
+
+PdfContentStreamReader::PdfContentStreamReader(const shared_ptr<const PdfCompiledContentStream>& compiled,
+        nullable<const PdfContentReaderArgs&> args) :
+    PdfContentStreamReader(args)
+{
+    if (compiled == nullptr)
+        PODOFO_RAISE_ERROR_INFO(PdfErrorCode::InvalidHandle, "Compiled stream must be non null");
+
+    m_inputs.push_back({ nullptr, nullptr, compiled, 0, nullptr });
+}
+
+PdfContentStreamReader::PdfContentStreamReader(nullable<const PdfContentReaderArgs&> args) :
     m_args(args.has_value() ? *args : PdfContentReaderArgs()),
     m_buffer(std::make_shared<charbuff>(PdfTokenizer::BufferSize)),
     m_tokenizer(m_buffer),
     m_readingInlineImgData(false),
     m_temp{ }
 {
-    if (device == nullptr)
-        PODOFO_RAISE_ERROR_INFO(PdfErrorCode::InvalidHandle, "Device must be non null");
-
-    m_inputs.push_back({ nullptr, device, canvas });
 }
 
 bool PdfContentStreamReader::TryReadNext(PdfContent& content)
@@ -48,6 +65,14 @@ bool PdfContentStreamReader::TryReadNext(PdfContent& content)
         if (m_inputs.size() == 0)
             goto Eof;
 
+        if (m_inputs.back().Compiled != nullptr)
+        {
+            if (!tryReplayNextContent(content))
+                goto PopDevice;
+
+            goto HandleContent;
+        }
+
         if (m_readingInlineImgData)
         {
             if (m_args.InlineImageHandler == nullptr)
@@ -167,6 +192,68 @@ bool PdfContentStreamReader::tryReadNextContent(PdfContent& content)
     }
 }
 
+// Returns false in case of EOF
+bool PdfContentStreamReader::tryReplayNextContent(PdfContent& content)
+{
+    auto& input = m_inputs.back();
+    auto& compiled = *input.Compiled;
+    if (input.Position == compiled.m_instructions.size())
+    {
+        content.Type = PdfContentType::Unknown;
+        return false;
+    }
+
+    auto& instruction = compiled.m_instructions[input.Position];
+    input.Position++;
+    content.Type = instruction.Type;
+    content.Warnings = instruction.Warnings;
+    content.Operator = instruction.Operator;
+    unsigned index = instruction.OperandIndex;
+    content.Stack.m_variants.reserve(instruction.OperandCount);
+    for (unsigned i = 0; i < instruction.OperandCount; i++)
+        content.Stack.m_variants.push_back(compiled.getOperand(index));
+
+    switch (instruction.Type)
+    {
+        case PdfContentType::Operator:
+        {
+            content.Keyword = PoDoFo::GetPdfOperatorName(instruction.Operator);
+            // Inline images are already split in dictionary and data,
+            // so the only operator to handle is Do
+            if (content.Operator == PdfOperator::Do && input.Canvas != nullptr)
+                tryFollowXObject(content);
+
+            break;
+        }
+        case PdfContentType::ImageDictionary:
+        {
+            content.InlineImageDictionary = std::move(compiled.getOperand(index).GetDictionary());
+            break;
+        }
+        case PdfContentType::ImageData:
+        {
+            content.InlineImageData = compiled.getData(instruction.DataOffset, instruction.DataLength);
+            break;
+        }
+        case PdfContentType::UnexpectedKeyword:
+        {
+            content.Keyword = compiled.getData(instruction.DataOffset, instruction.DataLength);
+            break;
+        }
+        default:
+        {
+            PODOFO_RAISE_ERROR_INFO(PdfErrorCode::InternalLogic, "Unsupported flow");
+        }
+    }
+
+    return true;
+}
+
+bool PdfContentStreamReader::isCacheEnabled() const
+{
+    return m_args.Cache != nullptr && m_args.InlineImageHandler == nullptr;
+}
+
 void PdfContentStreamReader::beforeReadReset(PdfContent& content)
 {
     content.Stack.Clear();
@@ -344,10 +431,17 @@ void PdfContentStreamReader::tryFollowXObject(PdfContent& content)
     if (content.XObject->GetType() == PdfXObjectType::Form
         && (m_args.Flags & PdfContentReaderFlags::DontFollowXObjectForms) == PdfContentReaderFlags::None)
     {
-        m_inputs.push_back({
-            content.XObject,
-            std::make_shared<PdfCanvasInputDevice>(static_cast<const PdfXObjectForm&>(*content.XObject)),
-            dynamic_cast<const PdfCanvas*>(content.XObject.get()) });
+        auto& form = static_cast<const PdfXObjectForm&>(*content.XObject);
+        if (isCacheEnabled())
+        {
+            m_inputs.push_back({ content.XObject, nullptr, m_args.Cache->GetOrCompile(form),
+                0, dynamic_cast<const PdfCanvas*>(content.XObject.get()) });
+        }
+        else
+        {
+            m_inputs.push_back({ content.XObject, std::make_shared<PdfCanvasInputDevice>(form),
+                nullptr, 0, dynamic_cast<const PdfCanvas*>(content.XObject.get()) });
+        }
     }
 }
 
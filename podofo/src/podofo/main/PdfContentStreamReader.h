@@ -16,6 +16,9 @@
 
 namespace PoDoFo {
 
+class PdfCompiledContentStream;
+class PdfContentStreamCache;
+
 /** Type of the content read from a content stream
  */
 enum class PdfContentType
@@ -72,6 +75,13 @@ struct PdfContentReaderArgs
 {
     PdfContentReaderFlags Flags = PdfContentReaderFlags::None;
     PdfInlineImageHandler InlineImageHandler;
+    /** Cache of compiled content streams. When set, the content
+     * streams of the XObject forms followed by the reader are
+     * tokenized only once and then replayed. The canvas the reader
+     * is created on is always read directly. It's not used if
+     * InlineImageHandler is set
+     */
+    std::shared_ptr<PdfContentStreamCache> Cache;
 };
 
 /** Reader class to read content streams
@@ -83,9 +93,13 @@ public:
 
     PdfContentStreamReader(const std::shared_ptr<InputStreamDevice>& device, nullable<const PdfContentReaderArgs&> args = { });
 
+    /** Replay a compiled content stream. XObject forms are not followed
+     */
+    PdfContentStreamReader(const std::shared_ptr<const PdfCompiledContentStream>& compiled,
+        nullable<const PdfContentReaderArgs&> args = { });
+
 private:
-    PdfContentStreamReader(const std::shared_ptr<InputStreamDevice>& device, const PdfCanvas* canvas,
-        nullable<const PdfContentReaderArgs&> args);
+    PdfContentStreamReader(nullable<const PdfContentReaderArgs&> args);
 
 public:
     bool TryReadNext(PdfContent& data);
@@ -97,6 +111,10 @@ private:
 
     bool tryReadNextContent(PdfContent& content);
 
+    bool tryReplayNextContent(PdfContent& content);
+
+    bool isCacheEnabled() const;
+
     bool tryHandleOperator(PdfContent& content);
 
     bool tryReadInlineImgDict(PdfContent& content);
@@ -122,6 +140,8 @@ private:
     {
         std::shared_ptr<const PdfXObject> Form;
         std::shared_ptr<InputStreamDevice> Device;
+        std::shared_ptr<const PdfCompiledContentStream> Compiled; // Replayed instead of Device, if set
+        unsigned Position;          // Position of the next replayed content
         const PdfCanvas* Canvas;
     };
 
@@ -126,6 +126,8 @@ enum class PdfWriteFlags
     Clean = 1,             ///< Create a PDF that is readable in a text editor, i.e. insert spaces and linebreaks between tokens
     NoInlineLiteral = 2,   ///< Don't write spaces before literal types (numerical, references, null)
     NoFlateCompress = 4,
+    FlateCompressFast = 8,  ///< Flate compress streams favoring speed over size
+    FlateCompressBest = 16, ///< Flate compress streams favoring size over speed
 
     // NOTE: The following flags are actually never set but
     // they are kept for documenting some PDF peculiarities
@@ -441,6 +443,23 @@ enum class PdfSaveOptions
      */
     NoMetadataUpdate = 16,
     Clean = 32,
+    /**
+     * Flate compress streams with the fastest compression level,
+     * trading output size for speed
+     */
+    FlateCompressFast = 64,
+    /**
+     * Flate compress streams with the best compression level,
+     * trading speed for output size
+     */
+    FlateCompressBest = 128,
+    /**
+     * Pack the objects that are not streams in compressed object
+     * streams, see ISO 32000-1:2008 7.5.7 "Object Streams". This
+     * implies writing a cross-reference stream and requires PDF 1.5.
+     * It's ignored when saving an incremental update
+     */
+    ObjectStreams = 256,
 
     /**
       * \deprecated Use NoMetadataUpdate instead
@@ -448,6 +467,45 @@ enum class PdfSaveOptions
     NoModifyDateUpdate = NoMetadataUpdate
 };
 
+/**
+ * Options to control how a document is loaded
+ */
+enum class PdfLoadOptions
+{
+    None = 0,
+    /**
+     * Allocate the objects built by the parser from a per-document
+     * arena, released wholesale when the document is cleared or
+     * destroyed. This makes teardown of large documents cheap and
+     * avoids heap fragmentation in long running processes, at the
+     * cost of not reusing the memory of objects removed while the
+     * document is alive. Objects returned by RemoveObject() are
+     * copied to the heap
+     */
+    ArenaAllocation = 1,
+    /**
+     * Make delayed loading of objects and streams safe when the
+     * document is read by multiple threads. Every object is loaded
+     * exactly once, objects of memory backed sources (buffers and
+     * mapped files) are read through private cursors so different
+     * objects can be loaded in parallel, and access to already
+     * loaded objects stays lock free. The document must still not
+     * be modified while it's being read concurrently
+     */
+    ConcurrentRead = 2,
+    /**
+     * Read only the cross-reference sections and the trailers when
+     * loading. The objects, including the catalog and the page tree,
+     * are created from their cross-reference entries the first time
+     * they are looked up, so reading few values of a big document, like
+     * the page count or the document information, doesn't create all
+     * the objects. Enumerating the objects, creating or removing them,
+     * or saving the document first creates all the remaining objects.
+     * It can't be combined with ConcurrentRead
+     */
+    Peek = 4,
+};
+
 /**
  * Enum holding the supported page sizes by PoDoFo.
  * Can be used to construct a Rect structure with
@@ -771,6 +829,7 @@ enum class PdfBlendMode
 };
 
 ENABLE_BITMASK_OPERATORS(PoDoFo::PdfSaveOptions);
+ENABLE_BITMASK_OPERATORS(PoDoFo::PdfLoadOptions);
 ENABLE_BITMASK_OPERATORS(PoDoFo::PdfWriteFlags);
 ENABLE_BITMASK_OPERATORS(PoDoFo::PdfInfoInitial);
 ENABLE_BITMASK_OPERATORS(PoDoFo::PdfFontStyle);
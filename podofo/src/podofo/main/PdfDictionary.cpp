@@ -7,11 +7,262 @@
 #include <podofo/private/PdfDeclarationsPrivate.h>
 #include "PdfDictionary.h"
 
+#include <algorithm>
+
 #include <podofo/auxiliary/OutputDevice.h>
+#include <podofo/private/PdfArena.h>
 
 using namespace std;
 using namespace PoDoFo;
 
+// A block of entries, followed by the sorted index of all
+// entries of the map. Only the index of the newest block is used
+struct PdfDictionaryMap::Block
+{
+    Block* Next;
+    unsigned Capacity;
+    unsigned Used;
+    bool InArena;
+
+    static constexpr size_t EntriesOffset = (sizeof(Block*) + 2 * sizeof(unsigned) + sizeof(bool)
+        + alignof(value_type) - 1) / alignof(value_type) * alignof(value_type);
+
+    value_type* GetEntries()
+    {
+        return reinterpret_cast<value_type*>(reinterpret_cast<char*>(this) + EntriesOffset);
+    }
+
+    value_type** GetIndex()
+    {
+        return reinterpret_cast<value_type**>(GetEntries() + Capacity);
+    }
+};
+
+static_assert(alignof(PdfDictionaryMap::value_type) >= alignof(void*), "The index must be aligned after the entries");
+
+// Initial capacity of a map, which grows doubling it
+static constexpr unsigned MapInitialCapacity = 4;
+
+PdfDictionaryMap::PdfDictionaryMap()
+    : m_blocks(nullptr), m_index(nullptr), m_size(0), m_capacity(0), m_freeEntries(nullptr) { }
+
+PdfDictionaryMap::PdfDictionaryMap(const PdfDictionaryMap& rhs)
+    : PdfDictionaryMap()
+{
+    if (rhs.m_size == 0)
+        return;
+
+    // Copies are allocated exactly in a single block
+    grow(rhs.m_size);
+    auto entries = m_blocks->GetEntries();
+    try
+    {
+        for (auto& pair : rhs)
+        {
+            m_index[m_size] = new(entries + m_blocks->Used) value_type(pair);
+            m_blocks->Used++;
+            m_size++;
+        }
+    }
+    catch (...)
+    {
+        clear();
+        throw;
+    }
+}
+
+PdfDictionaryMap::PdfDictionaryMap(PdfDictionaryMap&& rhs) noexcept
+{
+    moveFrom(rhs);
+}
+
+PdfDictionaryMap::~PdfDictionaryMap()
+{
+    clear();
+}
+
+PdfDictionaryMap& PdfDictionaryMap::operator=(const PdfDictionaryMap& rhs)
+{
+    if (this == &rhs)
+        return *this;
+
+    PdfDictionaryMap copy(rhs);
+    clear();
+    moveFrom(copy);
+    return *this;
+}
+
+PdfDictionaryMap& PdfDictionaryMap::operator=(PdfDictionaryMap&& rhs) noexcept
+{
+    if (this == &rhs)
+        return *this;
+
+    clear();
+    moveFrom(rhs);
+    return *this;
+}
+
+bool PdfDictionaryMap::operator==(const PdfDictionaryMap& rhs) const
+{
+    if (m_size != rhs.m_size)
+        return false;
+
+    for (unsigned i = 0; i < m_size; i++)
+    {
+        if (!(m_index[i]->first == rhs.m_index[i]->first
+            && m_index[i]->second == rhs.m_index[i]->second))
+        {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+bool PdfDictionaryMap::operator!=(const PdfDictionaryMap& rhs) const
+{
+    return !operator==(rhs);
+}
+
+pair<PdfDictionaryMap::iterator, bool> PdfDictionaryMap::try_emplace(const PdfName& key, PdfObject&& obj)
+{
+    auto pos = lowerBound(key);
+    if (pos != m_index + m_size && (*pos)->first == key)
+        return { iterator(pos), false };
+
+    // NOTE: Allocating the entry may move the index
+    size_t posIndex = pos - m_index;
+    void* storage = allocateEntry();
+    value_type* entry;
+    try
+    {
+        entry = new(storage) value_type(key, std::move(obj));
+    }
+    catch (...)
+    {
+        *reinterpret_cast<void**>(storage) = m_freeEntries;
+        m_freeEntries = storage;
+        throw;
+    }
+
+    pos = m_index + posIndex;
+    std::memmove(pos + 1, pos, (m_size - posIndex) * sizeof(value_type*));
+    *pos = entry;
+    m_size++;
+    return { iterator(pos), true };
+}
+
+PdfDictionaryMap::iterator PdfDictionaryMap::find(const string_view& key)
+{
+    auto pos = lowerBound(key);
+    if (pos == m_index + m_size || (string_view)(*pos)->first != key)
+        return end();
+
+    return iterator(pos);
+}
+
+PdfDictionaryMap::const_iterator PdfDictionaryMap::find(const string_view& key) const
+{
+    return const_cast<PdfDictionaryMap&>(*this).find(key);
+}
+
+void PdfDictionaryMap::erase(const const_iterator& it)
+{
+    auto pos = const_cast<value_type**>(it.m_entry);
+    auto entry = *pos;
+    entry->~value_type();
+
+    // Keep the storage of the entry for reuse
+    *reinterpret_cast<void**>(entry) = m_freeEntries;
+    m_freeEntries = entry;
+
+    std::memmove(pos, pos + 1, (m_index + m_size - pos - 1) * sizeof(value_type*));
+    m_size--;
+}
+
+void PdfDictionaryMap::clear()
+{
+    for (unsigned i = 0; i < m_size; i++)
+        m_index[i]->~value_type();
+
+    auto block = m_blocks;
+    while (block != nullptr)
+    {
+        auto next = block->Next;
+        if (block->InArena)
+            PdfArena::Deallocate(block);
+        else
+            ::operator delete(block);
+        block = next;
+    }
+
+    m_blocks = nullptr;
+    m_index = nullptr;
+    m_size = 0;
+    m_capacity = 0;
+    m_freeEntries = nullptr;
+}
+
+PdfDictionaryMap::value_type** PdfDictionaryMap::lowerBound(const string_view& key) const
+{
+    return std::lower_bound(m_index, m_index + m_size, key, [](const value_type* entry, const string_view& key) {
+        return (string_view)entry->first < key;
+    });
+}
+
+void* PdfDictionaryMap::allocateEntry()
+{
+    if (m_freeEntries != nullptr)
+    {
+        void* ret = m_freeEntries;
+        m_freeEntries = *reinterpret_cast<void**>(ret);
+        return ret;
+    }
+
+    if (m_blocks == nullptr || m_blocks->Used == m_blocks->Capacity)
+        grow(m_capacity == 0 ? MapInitialCapacity : m_capacity);
+
+    void* ret = m_blocks->GetEntries() + m_blocks->Used;
+    m_blocks->Used++;
+    return ret;
+}
+
+void PdfDictionaryMap::grow(unsigned capacity)
+{
+    // Maps built while loading a document with
+    // PdfLoadOptions::ArenaAllocation grow in its arena
+    unsigned newCapacity = m_capacity + capacity;
+    size_t size = Block::EntriesOffset
+        + capacity * sizeof(value_type) + newCapacity * sizeof(value_type*);
+    auto arena = PdfArena::GetCurrent();
+    auto block = static_cast<Block*>(arena == nullptr ? ::operator new(size) : arena->Allocate(size));
+    block->Next = m_blocks;
+    block->Capacity = capacity;
+    block->Used = 0;
+    block->InArena = arena != nullptr;
+    auto index = block->GetIndex();
+    if (m_size != 0)
+        std::memcpy(index, m_index, m_size * sizeof(value_type*));
+
+    m_blocks = block;
+    m_index = index;
+    m_capacity = newCapacity;
+}
+
+void PdfDictionaryMap::moveFrom(PdfDictionaryMap& rhs)
+{
+    m_blocks = rhs.m_blocks;
+    m_index = rhs.m_index;
+    m_size = rhs.m_size;
+    m_capacity = rhs.m_capacity;
+    m_freeEntries = rhs.m_freeEntries;
+    rhs.m_blocks = nullptr;
+    rhs.m_index = nullptr;
+    rhs.m_size = 0;
+    rhs.m_capacity = 0;
+    rhs.m_freeEntries = nullptr;
+}
+
 PdfDictionary::PdfDictionary() { }
 
 PdfDictionary::PdfDictionary(const PdfDictionary& rhs)
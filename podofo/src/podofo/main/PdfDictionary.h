@@ -14,27 +14,134 @@ namespace PoDoFo {
 
 class PdfDictionary;
 
-// Compartor to enable heterogeneous lookup in
-// PdfDictionary with both PdfName and string_view
-// See https://stackoverflow.com/a/31924435/213871
-struct PdfDictionaryComparator final
+/**
+ * Flat storage for the entries of a PdfDictionary
+ *
+ * Entries are allocated in few blocks of doubling size and never move,
+ * so references to them stay valid until they are removed. Lookup and
+ * iteration go through a contiguous array of entry pointers sorted by
+ * key, so the iteration order is the same of a std::map
+ */
+class PODOFO_API PdfDictionaryMap final
 {
-    using is_transparent = std::true_type;
-    bool operator()(const PdfName& lhs, const PdfName& rhs) const
-    {
-        return lhs < rhs;
-    }
-    bool operator()(const PdfName& lhs, const std::string_view& rhs) const
-    {
-        return lhs.GetRawData() < rhs;
-    }
-    bool operator()(const std::string_view& lhs, const PdfName& rhs) const
+public:
+    using key_type = PdfName;
+    using mapped_type = PdfObject;
+    using value_type = std::pair<const PdfName, PdfObject>;
+    using size_type = size_t;
+
+    template <typename TValue>
+    class Iterator final
     {
-        return lhs < rhs.GetRawData();
-    }
-};
+        friend class PdfDictionaryMap;
+    public:
+        using difference_type = std::ptrdiff_t;
+        using value_type = TValue;
+        using pointer = TValue*;
+        using reference = TValue&;
+        using iterator_category = std::bidirectional_iterator_tag;
+    public:
+        Iterator() : m_entry(nullptr) { }
+        template <typename TOtherValue, typename = std::enable_if_t<std::is_const_v<TValue> && !std::is_const_v<TOtherValue>>>
+        Iterator(const Iterator<TOtherValue>& rhs) : m_entry(rhs.m_entry) { }
+    private:
+        Iterator(PdfDictionaryMap::value_type* const* entry) : m_entry(entry) { }
+    public:
+        Iterator(const Iterator&) = default;
+        Iterator& operator=(const Iterator&) = default;
+        bool operator==(const Iterator& rhs) const
+        {
+            return m_entry == rhs.m_entry;
+        }
+        bool operator!=(const Iterator& rhs) const
+        {
+            return m_entry != rhs.m_entry;
+        }
+        Iterator& operator++()
+        {
+            m_entry++;
+            return *this;
+        }
+        Iterator operator++(int)
+        {
+            auto copy = *this;
+            m_entry++;
+            return copy;
+        }
+        Iterator& operator--()
+        {
+            m_entry--;
+            return *this;
+        }
+        Iterator operator--(int)
+        {
+            auto copy = *this;
+            m_entry--;
+            return copy;
+        }
+        reference operator*() const
+        {
+            return **m_entry;
+        }
+        pointer operator->() const
+        {
+            return *m_entry;
+        }
+    private:
+        template <typename> friend class Iterator;
+        PdfDictionaryMap::value_type* const* m_entry;
+    };
+
+    using iterator = Iterator<value_type>;
+    using const_iterator = Iterator<const value_type>;
 
-using PdfDictionaryMap = std::map<PdfName, PdfObject, PdfDictionaryComparator>;
+public:
+    PdfDictionaryMap();
+    PdfDictionaryMap(const PdfDictionaryMap& rhs);
+    PdfDictionaryMap(PdfDictionaryMap&& rhs) noexcept;
+    ~PdfDictionaryMap();
+
+    PdfDictionaryMap& operator=(const PdfDictionaryMap& rhs);
+    PdfDictionaryMap& operator=(PdfDictionaryMap&& rhs) noexcept;
+
+    bool operator==(const PdfDictionaryMap& rhs) const;
+    bool operator!=(const PdfDictionaryMap& rhs) const;
+
+    /** Insert the entry if the key is not present, otherwise
+     * the object is not moved and the existing entry is returned
+     */
+    std::pair<iterator, bool> try_emplace(const PdfName& key, PdfObject&& obj);
+
+    iterator find(const std::string_view& key);
+    const_iterator find(const std::string_view& key) const;
+
+    void erase(const const_iterator& it);
+
+    void clear();
+
+    iterator begin() { return iterator(m_index); }
+    iterator end() { return iterator(m_index + m_size); }
+    const_iterator begin() const { return const_iterator(m_index); }
+    const_iterator end() const { return const_iterator(m_index + m_size); }
+
+    size_t size() const { return m_size; }
+    bool empty() const { return m_size == 0; }
+
+private:
+    struct Block;
+
+    value_type** lowerBound(const std::string_view& key) const;
+    void* allocateEntry();
+    void grow(unsigned capacity);
+    void moveFrom(PdfDictionaryMap& rhs);
+
+private:
+    Block* m_blocks;        // Newest block first
+    value_type** m_index;   // Entries sorted by key, stored in the newest block
+    unsigned m_size;
+    unsigned m_capacity;    // Total entries capacity of all blocks
+    void* m_freeEntries;    // List of storage of removed entries
+};
 
 /**
  * Helper class to iterate through indirect objects
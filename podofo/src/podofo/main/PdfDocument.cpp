@@ -24,6 +24,7 @@
 #include "PdfNameTree.h"
 #include "PdfOutlines.h"
 #include "PdfPage.h"
+#include "PdfObjectImporter.h"
 #include "PdfPageCollection.h"
 #include "PdfXObjectForm.h"
 #include "PdfImage.h"
@@ -111,90 +112,9 @@ void PdfDocument::Init()
 
 void PdfDocument::AppendDocumentPages(const PdfDocument& doc)
 {
-    append(doc, true);
-}
-
-void PdfDocument::append(const PdfDocument& doc, bool appendAll)
-{
-    unsigned difference = static_cast<unsigned>(m_Objects.GetSize() + m_Objects.GetFreeObjects().size());
-
-    // Because GetNextObject uses m_ObjectCount instead 
-    // of m_Objects.GetSize() + m_Objects.GetFreeObjects().size() + 1
-    // make sure the free objects are already present before appending to
-    // prevent overlapping obj-numbers
-
-    // create all free objects again, to have a clean free object list
-    for (auto& ref : doc.GetObjects().GetFreeObjects())
-        m_Objects.AddFreeObject(PdfReference(ref.ObjectNumber() + difference, ref.GenerationNumber()));
-
-    // append all objects first and fix their references
-    for (auto& obj : doc.GetObjects())
-    {
-        PdfReference ref(static_cast<uint32_t>(obj->GetIndirectReference().ObjectNumber() + difference), obj->GetIndirectReference().GenerationNumber());
-        auto newObj = new PdfObject(PdfDictionary());
-        newObj->setDirty();
-        newObj->SetIndirectReference(ref);
-        m_Objects.PushObject(newObj);
-        *newObj = *obj;
-
-        PoDoFo::LogMessage(PdfLogSeverity::Information, "Fixing references in {} {} R by {}",
-            newObj->GetIndirectReference().ObjectNumber(), newObj->GetIndirectReference().GenerationNumber(), difference);
-        fixObjectReferences(*newObj, difference);
-    }
-
-    if (appendAll)
-    {
-        const PdfName inheritableAttributes[] = {
-            PdfName("Resources"),
-            PdfName("MediaBox"),
-            PdfName("CropBox"),
-            PdfName("Rotate"),
-            PdfName::KeyNull
-        };
-
-        // append all pages now to our page tree
-        for (unsigned i = 0; i < doc.GetPages().GetCount(); i++)
-        {
-            auto& page = doc.GetPages().GetPageAt(i);
-            auto& obj = m_Objects.MustGetObject(PdfReference(page.GetObject().GetIndirectReference().ObjectNumber()
-                + difference, page.GetObject().GetIndirectReference().GenerationNumber()));
-            if (obj.IsDictionary() && obj.GetDictionary().HasKey("Parent"))
-                obj.GetDictionary().RemoveKey("Parent");
-
-            // Deal with inherited attributes
-            auto inherited = inheritableAttributes;
-            while (!inherited->IsNull())
-            {
-                auto attribute = page.GetDictionary().FindKeyParent(*inherited);
-                if (attribute != nullptr)
-                {
-                    PdfObject attributeCopy(*attribute);
-                    fixObjectReferences(attributeCopy, difference);
-                    obj.GetDictionary().AddKey(*inherited, attributeCopy);
-                }
-
-                inherited++;
-            }
-
-            m_Pages->InsertPageAt(m_Pages->GetCount(), *new PdfPage(obj));
-        }
-
-        // Append all outlines
-        const PdfOutlineItem* appendRoot = doc.GetOutlines();
-        if (appendRoot != nullptr && (appendRoot = appendRoot->First()) != nullptr)
-        {
-            // Get or create outlines
-            PdfOutlineItem* root = &this->GetOrCreateOutlines();
-
-            // Find actual item where to append
-            while (root->Next() != nullptr)
-                root = root->Next();
-
-            PdfReference ref(appendRoot->GetObject().GetIndirectReference().ObjectNumber()
-                + difference, appendRoot->GetObject().GetIndirectReference().GenerationNumber());
-            root->InsertChild(new PdfOutlines(m_Objects.MustGetObject(ref)));
-        }
-    }
+    PdfObjectImporter importer(*this, doc);
+    appendDocumentPages(importer, 0, doc.GetPages().GetCount());
+    importOutlines(importer);
 
     // TODO: merge name trees
     // ToDictionary -> then iteratate over all keys and add them to the new one
@@ -202,130 +122,53 @@ void PdfDocument::append(const PdfDocument& doc, bool appendAll)
 
 void PdfDocument::InsertDocumentPageAt(unsigned atIndex, const PdfDocument& doc, unsigned pageIndex)
 {
-    // copy of PdfDocument::Append, only restricts which page to add
-    unsigned difference = static_cast<unsigned>(m_Objects.GetSize() + m_Objects.GetFreeObjects().size());
-
-
-    // Because GetNextObject uses m_ObjectCount instead 
-    // of m_Objects.GetSize() + m_Objects.GetFreeObjects().size() + 1
-    // make sure the free objects are already present before appending to
-    // prevent overlapping obj-numbers
-
-    // create all free objects again, to have a clean free object list
-    for (auto& freeObj : GetObjects().GetFreeObjects())
-    {
-        m_Objects.AddFreeObject(PdfReference(freeObj.ObjectNumber() + difference, freeObj.GenerationNumber()));
-    }
-
-    // append all objects first and fix their references
-    for (auto& obj : doc.GetObjects())
-    {
-        PdfReference ref(static_cast<uint32_t>(obj->GetIndirectReference().ObjectNumber() + difference), obj->GetIndirectReference().GenerationNumber());
-        auto newObj = new PdfObject(PdfDictionary());
-        newObj->setDirty();
-        newObj->SetIndirectReference(ref);
-        m_Objects.PushObject(newObj);
-        *newObj = *obj;
-
-        PoDoFo::LogMessage(PdfLogSeverity::Information, "Fixing references in {} {} R by {}",
-            newObj->GetIndirectReference().ObjectNumber(), newObj->GetIndirectReference().GenerationNumber(), difference);
-        fixObjectReferences(*newObj, difference);
-    }
-
-    const PdfName inheritableAttributes[] = {
-        PdfName("Resources"),
-        PdfName("MediaBox"),
-        PdfName("CropBox"),
-        PdfName("Rotate"),
-        PdfName::KeyNull
-    };
-
-    // append all pages now to our page tree
-    for (unsigned i = 0; i < doc.GetPages().GetCount(); i++)
-    {
-        if (i != pageIndex)
-            continue;
-
-        auto& page = doc.GetPages().GetPageAt(i);
-        auto& obj = m_Objects.MustGetObject(PdfReference(page.GetObject().GetIndirectReference().ObjectNumber()
-            + difference, page.GetObject().GetIndirectReference().GenerationNumber()));
-        if (obj.IsDictionary() && obj.GetDictionary().HasKey("Parent"))
-            obj.GetDictionary().RemoveKey("Parent");
-
-        // Deal with inherited attributes
-        const PdfName* inherited = inheritableAttributes;
-        while (!inherited->IsNull())
-        {
-            auto attribute = page.GetDictionary().FindKeyParent(*inherited);
-            if (attribute != nullptr)
-            {
-                PdfObject attributeCopy(*attribute);
-                fixObjectReferences(attributeCopy, difference);
-                obj.GetDictionary().AddKey(*inherited, attributeCopy);
-            }
-
-            inherited++;
-        }
-
-        m_Pages->InsertPageAt(atIndex, *new PdfPage(obj));
-    }
+    PdfObjectImporter importer(*this, doc);
+    auto& obj = importer.ImportPage(doc.GetPages().GetPageAt(pageIndex));
+    m_Pages->InsertPageAt(atIndex, *new PdfPage(obj));
+    importOutlines(importer);
+}
 
-    // append all outlines
-    PdfOutlineItem* root = this->GetOutlines();
-    PdfOutlines* appendRoot = const_cast<PdfDocument&>(doc).GetOutlines();
-    if (appendRoot != nullptr && appendRoot->First())
-    {
-        // only append outlines if appended document has outlines
-        while (root != nullptr && root->Next())
-            root = root->Next();
+void PdfDocument::AppendDocumentPages(const PdfDocument& doc, unsigned pageIndex, unsigned pageCount)
+{
+    PdfObjectImporter importer(*this, doc);
+    appendDocumentPages(importer, pageIndex, pageCount);
+    importOutlines(importer);
+}
 
-        PdfReference ref(appendRoot->First()->GetObject().GetIndirectReference().ObjectNumber()
-            + difference, appendRoot->First()->GetObject().GetIndirectReference().GenerationNumber());
-        root->InsertChild(new PdfOutlines(m_Objects.MustGetObject(ref)));
-    }
+void PdfDocument::AppendDocumentPages(PdfObjectImporter& importer, unsigned pageIndex, unsigned pageCount)
+{
+    if (&importer.GetDestination() != this)
+        PODOFO_RAISE_ERROR_INFO(PdfErrorCode::InvalidHandle, "The importer destination must be this document");
 
-    // TODO: merge name trees
-    // ToDictionary -> then iteratate over all keys and add them to the new one
+    appendDocumentPages(importer, pageIndex, pageCount);
 }
 
-void PdfDocument::AppendDocumentPages(const PdfDocument& doc, unsigned pageIndex, unsigned pageCount)
+void PdfDocument::appendDocumentPages(PdfObjectImporter& importer, unsigned pageIndex, unsigned pageCount)
 {
-    /*
-      This function works a bit different than one might expect.
-      Rather than copying one page at a time - we copy the ENTIRE document
-      and then delete the pages we aren't interested in.
-
-      We do this because
-      1) SIGNIFICANTLY simplifies the process
-      2) Guarantees that shared objects aren't copied multiple times
-      3) offers MUCH faster performance for the common cases
+    // Only the objects reachable from the pages are copied
+    auto objs = importer.ImportPages(pageIndex, pageCount);
+    vector<PdfPage*> pages(objs.size());
+    for (unsigned i = 0; i < objs.size(); i++)
+        pages[i] = new PdfPage(*objs[i]);
 
-      HOWEVER: because PoDoFo doesn't currently do any sort of "object garbage collection" during
-      a Write() - we will end up with larger documents, since the data from unused pages
-      will also be in there.
-    */
+    m_Pages->InsertPagesAt(m_Pages->GetCount(), pages);
+}
 
-    // calculate preliminary "left" and "right" page ranges to delete
-    // then offset them based on where the pages were inserted
-    // NOTE: some of this will change if/when we support insertion at locations
-    //       OTHER than the end of the document!
-    unsigned leftStartPage = 0;
-    unsigned leftCount = pageIndex;
-    unsigned rightStartPage = pageIndex + pageCount;
-    unsigned rightCount = doc.GetPages().GetCount() - rightStartPage;
-    unsigned pageOffset = this->GetPages().GetCount();
+void PdfDocument::importOutlines(PdfObjectImporter& importer)
+{
+    const PdfOutlineItem* appendRoot = importer.GetSource().GetOutlines();
+    if (appendRoot == nullptr || (appendRoot = appendRoot->First()) == nullptr)
+        return;
 
-    leftStartPage += pageOffset;
-    rightStartPage += pageOffset;
+    // Get or create outlines
+    PdfOutlineItem* root = &this->GetOrCreateOutlines();
 
-    // append in the whole document
-    this->AppendDocumentPages(doc);
+    // Find actual item where to append
+    while (root->Next() != nullptr)
+        root = root->Next();
 
-    // delete
-    if (rightCount > 0)
-        this->deletePages(rightStartPage, rightCount);
-    if (leftCount > 0)
-        this->deletePages(leftStartPage, leftCount);
+    // NOTE: Destinations to pages that were not imported become null
+    root->InsertChild(new PdfOutlines(importer.ImportObject(appendRoot->GetObject())));
 }
 
 void PdfDocument::deletePages(unsigned atIndex, unsigned pageCount)
@@ -348,18 +191,18 @@ PdfInfo& PdfDocument::GetOrCreateInfo()
 
 Rect PdfDocument::FillXObjectFromPage(PdfXObjectForm& xobj, const PdfPage& page, bool useTrimBox)
 {
-    unsigned difference = 0;
+    PdfObject* pageObj;
     auto& sourceDoc = page.GetDocument();
-    if (this != &sourceDoc)
+    if (this == &sourceDoc)
     {
-        difference = static_cast<unsigned>(m_Objects.GetSize() + m_Objects.GetFreeObjects().size());
-        append(sourceDoc, false);
+        pageObj = &m_Objects.MustGetObject(page.GetObject().GetIndirectReference());
+    }
+    else
+    {
+        // TODO: remove unused objects: page, ...
+        PdfObjectImporter importer(*this, sourceDoc);
+        pageObj = &importer.ImportPage(page);
     }
-
-    // TODO: remove unused objects: page, ...
-
-    auto& pageObj = m_Objects.MustGetObject(PdfReference(page.GetObject().GetIndirectReference().ObjectNumber()
-        + difference, page.GetObject().GetIndirectReference().GenerationNumber()));
     Rect box = page.GetMediaBox();
 
     // intersect with crop-box
@@ -370,14 +213,14 @@ Rect PdfDocument::FillXObjectFromPage(PdfXObjectForm& xobj, const PdfPage& page,
         box.Intersect(page.GetTrimBox());
 
     // link resources from external doc to x-object
-    if (pageObj.IsDictionary() && pageObj.GetDictionary().HasKey("Resources"))
-        xobj.GetObject().GetDictionary().AddKey("Resources", *pageObj.GetDictionary().GetKey("Resources"));
+    if (pageObj->IsDictionary() && pageObj->GetDictionary().HasKey("Resources"))
+        xobj.GetObject().GetDictionary().AddKey("Resources", *pageObj->GetDictionary().GetKey("Resources"));
 
     // copy top-level content from external doc to x-object
-    if (pageObj.IsDictionary() && pageObj.GetDictionary().HasKey("Contents"))
+    if (pageObj->IsDictionary() && pageObj->GetDictionary().HasKey("Contents"))
     {
         // get direct pointer to contents
-        auto& contents = pageObj.GetDictionary().MustFindKey("Contents");
+        auto& contents = pageObj->GetDictionary().MustFindKey("Contents");
         if (contents.IsArray())
         {
             // copy array as one stream to xobject
@@ -443,46 +286,6 @@ Rect PdfDocument::FillXObjectFromPage(PdfXObjectForm& xobj, const PdfPage& page,
     return box;
 }
 
-void PdfDocument::fixObjectReferences(PdfObject& obj, int difference)
-{
-    if (obj.IsDictionary())
-    {
-        for (auto& pair : obj.GetDictionary())
-        {
-            if (pair.second.IsReference())
-            {
-                pair.second = PdfObject(PdfReference(pair.second.GetReference().ObjectNumber() + difference,
-                    pair.second.GetReference().GenerationNumber()));
-            }
-            else if (pair.second.IsDictionary() ||
-                pair.second.IsArray())
-            {
-                fixObjectReferences(pair.second, difference);
-            }
-        }
-    }
-    else if (obj.IsArray())
-    {
-        for (auto& child : obj.GetArray())
-        {
-            if (child.IsReference())
-            {
-                child = PdfObject(PdfReference(child.GetReference().ObjectNumber() + difference,
-                    child.GetReference().GenerationNumber()));
-            }
-            else if (child.IsDictionary() || child.IsArray())
-            {
-                fixObjectReferences(child, difference);
-            }
-        }
-    }
-    else if (obj.IsReference())
-    {
-        obj = PdfObject(PdfReference(obj.GetReference().ObjectNumber() + difference,
-            obj.GetReference().GenerationNumber()));
-    }
-}
-
 void PdfDocument::CollectGarbage()
 {
     m_Objects.CollectGarbage();
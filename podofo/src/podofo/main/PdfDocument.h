@@ -25,6 +25,7 @@ class PdfFileSpec;
 class PdfInfo;
 class PdfOutlines;
 class PdfEncrypt;
+class PdfObjectImporter;
 
 /** PdfDocument is the core interface for working with PDF documents.
  *
@@ -307,20 +308,14 @@ private:
     void AppendDocumentPages(const PdfDocument& doc);
     void InsertDocumentPageAt(unsigned atIndex, const PdfDocument& doc, unsigned pageIndex);
     void AppendDocumentPages(const PdfDocument& doc, unsigned pageIndex, unsigned pageCount);
+    void AppendDocumentPages(PdfObjectImporter& importer, unsigned pageIndex, unsigned pageCount);
 
     // Called by PdfXObjectForm
     Rect FillXObjectFromPage(PdfXObjectForm& xobj, const PdfPage& page, bool useTrimBox);
 
 private:
-    void append(const PdfDocument& doc, bool appendAll);
-    /** Recursively changes every PdfReference in the PdfObject and in any child
-     *  that is either an PdfArray or a direct object.
-     *  The reference is changed so that difference is added to the object number
-     *  of the reference.
-     *  \param obj object to change
-     *  \param difference add this value to every reference that is encountered
-     */
-    void fixObjectReferences(PdfObject& obj, int difference);
+    void appendDocumentPages(PdfObjectImporter& importer, unsigned pageIndex, unsigned pageCount);
+    void importOutlines(PdfObjectImporter& importer);
 
     void deletePages(unsigned atIndex, unsigned pageCount);
 
@@ -193,23 +193,23 @@ bool PdfEncoding::tryConvertEncodedToUtf8(const string_view& encoded, string& st
     auto it = encoded.begin();
     auto end = encoded.end();
     vector<char32_t> codePoints;
-    while (it != end)
+    codePoints.reserve(encoded.size());
+
+    // Decode the whole string at once, falling back
+    // to the raw code for the code units not found
+    while (!map.tryAppendCodePoints(it, end, codePoints))
     {
-        if (!map.TryGetNextCodePoints(it, end, codePoints))
-        {
-            success = false;
-            codePoints.clear();
-            codePoints.push_back((char32_t)fetchFallbackCharCode(it, end, limits).Code);
-        }
+        success = false;
+        codePoints.push_back((char32_t)fetchFallbackCharCode(it, end, limits).Code);
+    }
 
-        for (size_t i = 0; i < codePoints.size(); i++)
+    for (size_t i = 0; i < codePoints.size(); i++)
+    {
+        char32_t codePoint = codePoints[i];
+        if (codePoint != U'\0' && utf8::internal::is_code_point_valid(codePoint))
         {
-            char32_t codePoint = codePoints[i];
-            if (codePoint != U'\0' && utf8::internal::is_code_point_valid(codePoint))
-            {
-                // Validate codepoints to insert
-                utf8::unchecked::append((uint32_t)codePoints[i], std::back_inserter(str));
-            }
+            // Validate codepoints to insert
+            utf8::unchecked::append((uint32_t)codePoints[i], std::back_inserter(str));
         }
     }
 
@@ -237,6 +237,23 @@ bool PdfEncodingMap::tryGetNextCodePoints(string_view::iterator& it, const strin
     return false;
 }
 
+bool PdfEncodingMap::tryAppendCodePoints(string_view::iterator& it, const string_view::iterator& end,
+    vector<char32_t>& codePoints) const
+{
+    PdfCharCode codeUnit;
+    vector<char32_t> temp;
+    while (it != end)
+    {
+        temp.clear();
+        if (!tryGetNextCodePoints(it, end, codeUnit, temp))
+            return false;
+
+        codePoints.insert(codePoints.end(), temp.begin(), temp.end());
+    }
+
+    return true;
+}
+
 void PdfEncodingMap::AppendUTF16CodeTo(OutputStream& stream, char32_t codePoint, u16string& u16tmp)
 {
     return AppendUTF16CodeTo(stream, unicodeview(&codePoint, 1), u16tmp);
@@ -396,6 +413,12 @@ bool PdfEncodingMapBase::tryGetCodePoints(const PdfCharCode& code, vector<char32
     return m_charMap->TryGetCodePoints(code, codePoints);
 }
 
+bool PdfEncodingMapBase::tryAppendCodePoints(string_view::iterator& it, const string_view::iterator& end,
+    vector<char32_t>& codePoints) const
+{
+    return m_charMap->TryAppendCodePoints(it, end, GetLimits(), codePoints);
+}
+
 const PdfEncodingLimits& PdfEncodingMapBase::GetLimits() const
 {
     return m_charMap->GetLimits();
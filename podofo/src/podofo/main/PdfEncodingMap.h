@@ -135,6 +135,14 @@ protected:
      */
     virtual bool tryGetCodePoints(const PdfCharCode& codeUnit, std::vector<char32_t>& codePoints) const = 0;
 
+    /** Decode an encoded string range, appending the code points of all its code units
+     * \returns true if the whole range was decoded, false if the decoding
+     * stopped at a code unit that could not be found
+     * \remarks The default implementation looks up every code unit with tryGetCodePoints
+     */
+    virtual bool tryAppendCodePoints(std::string_view::iterator& it,
+        const std::string_view::iterator& end, std::vector<char32_t>& codePoints) const;
+
     /** Get an export object that will be used during font init
      *
      * \remarks Default implementation just throws
@@ -198,6 +206,9 @@ protected:
 
     bool tryGetCodePoints(const PdfCharCode& codeUnit, std::vector<char32_t>& codePoints) const override;
 
+    bool tryAppendCodePoints(std::string_view::iterator& it,
+        const std::string_view::iterator& end, std::vector<char32_t>& codePoints) const override;
+
     void AppendCodeSpaceRange(OutputStream& stream, charbuff& temp) const override;
 
     void AppendToUnicodeEntries(OutputStream& stream, charbuff& temp) const override;
@@ -122,54 +122,19 @@ private:
 namespace PoDoFo
 {
 
-// A class that holds the AES Crypto object
-class AESCryptoEngine
+// Cipher contexts are fully reinitialized for every operation, so
+// instead of sharing one per encrypt object, which would serialize
+// the decryption, every thread uses its own context
+static EVP_CIPHER_CTX* getThreadCipherContext()
 {
-public:
-    AESCryptoEngine()
-    {
-        aes = EVP_CIPHER_CTX_new();
-    }
-    
-    EVP_CIPHER_CTX* getEngine()
-    {
-        return aes;
-    }
-    
-    ~AESCryptoEngine()
-    {
-        EVP_CIPHER_CTX_free(aes);
-    }
-
-private:
-    EVP_CIPHER_CTX *aes;
-};
-
-// A class that holds the RC4 Crypto object
-// Either CCCrpytor or EVP_CIPHER_CTX
-class RC4CryptoEngine
-{
-public:
+    thread_local unique_ptr<EVP_CIPHER_CTX, decltype(&EVP_CIPHER_CTX_free)> ctx(
+        EVP_CIPHER_CTX_new(), EVP_CIPHER_CTX_free);
+    if (ctx == nullptr)
+        PODOFO_RAISE_ERROR(PdfErrorCode::OutOfMemory);
 
-    RC4CryptoEngine()
-    {
-        rc4 = EVP_CIPHER_CTX_new();
-    }
-
-    EVP_CIPHER_CTX* getEngine()
-    {
-        return rc4;
-    }
-
-    ~RC4CryptoEngine()
-    {
-        EVP_CIPHER_CTX_free(rc4);
-    }
+    return ctx.get();
+}
 
-private:
-    EVP_CIPHER_CTX* rc4;
-};
-    
 /** A class that can encrypt/decrpyt streamed data block wise
  *  This is used in the input and output stream encryption implementation.
  *  Only the RC4 encryption algorithm is supported
@@ -177,15 +142,20 @@ private:
 class PdfRC4Stream
 {
 public:
-    PdfRC4Stream(unsigned char rc4key[256], unsigned char rc4last[256],
-        unsigned char* key, unsigned keylen) :
+    PdfRC4Stream(const unsigned char* key, unsigned keylen) :
         m_a(0), m_b(0)
     {
         size_t i;
         size_t j;
         size_t t;
 
-        if (std::memcmp(key, rc4key, keylen) != 0)
+        // The key schedule of the last key is kept per thread, as
+        // the streams of the same object are often read repeatedly
+        thread_local unsigned char rc4key[16];
+        thread_local unsigned rc4keylen = 0;
+        thread_local unsigned char rc4last[256];
+
+        if (keylen != rc4keylen || std::memcmp(key, rc4key, keylen) != 0)
         {
             for (i = 0; i < 256; i++)
                 m_rc4[i] = static_cast<unsigned char>(i);
@@ -200,6 +170,7 @@ public:
             }
 
             std::memcpy(rc4key, key, keylen);
+            rc4keylen = keylen;
             std::memcpy(rc4last, m_rc4, 256);
         }
         else
@@ -256,9 +227,8 @@ private:
 class PdfRC4OutputStream : public OutputStream
 {
 public:
-    PdfRC4OutputStream(OutputStream& outputStream, unsigned char rc4key[256],
-        unsigned char rc4last[256], unsigned char* key, unsigned keylen) :
-        m_OutputStream(&outputStream), m_stream(rc4key, rc4last, key, keylen)
+    PdfRC4OutputStream(OutputStream& outputStream, const unsigned char* key, unsigned keylen) :
+        m_OutputStream(&outputStream), m_stream(key, keylen)
     {
     }
 
@@ -282,11 +252,10 @@ private:
 class PdfRC4InputStream : public InputStream
 {
 public:
-    PdfRC4InputStream(InputStream& inputStream, size_t inputLen, unsigned char rc4key[256], unsigned char rc4last[256],
-        unsigned char* key, unsigned keylen) :
+    PdfRC4InputStream(InputStream& inputStream, size_t inputLen, const unsigned char* key, unsigned keylen) :
         m_InputStream(&inputStream),
         m_inputLen(inputLen),
-        m_stream(rc4key, rc4last, key, keylen) { }
+        m_stream(key, keylen) { }
 
 protected:
     size_t readBuffer(char* buffer, size_t size, bool& eof) override
@@ -655,10 +624,7 @@ bool PdfEncrypt::CheckKey(unsigned char key1[32], unsigned char key2[32])
     return success;
 }
 
-PdfEncryptMD5Base::PdfEncryptMD5Base()
-    : m_rc4key{ }, m_rc4last{ }
-{
-}
+PdfEncryptMD5Base::PdfEncryptMD5Base() { }
 
 PdfEncryptMD5Base::PdfEncryptMD5Base(const PdfEncrypt& rhs) : PdfEncrypt(rhs)
 {
@@ -669,8 +635,6 @@ PdfEncryptMD5Base::PdfEncryptMD5Base(const PdfEncrypt& rhs) : PdfEncrypt(rhs)
 
     std::memcpy(m_encryptionKey, rhs.GetEncryptionKey(), sizeof(unsigned char) * 16);
 
-    std::memcpy(m_rc4key, static_cast<const PdfEncryptMD5Base*>(ptr)->m_rc4key, sizeof(unsigned char) * 16);
-    std::memcpy(m_rc4last, static_cast<const PdfEncryptMD5Base*>(ptr)->m_rc4last, sizeof(unsigned char) * 256);
     m_EncryptMetadata = static_cast<const PdfEncryptMD5Base*>(ptr)->m_EncryptMetadata;
 }
 
@@ -838,6 +802,7 @@ void PdfEncryptMD5Base::ComputeEncryptionKey(const string_view& documentId,
     }
 
     std::memcpy(m_encryptionKey, digest, m_keyLength);
+    clearObjKeys();
 
     // Setup user key
     if (revision == 3 || revision == 4)
@@ -883,6 +848,19 @@ void PdfEncryptMD5Base::ComputeEncryptionKey(const string_view& documentId,
 
 void PdfEncryptMD5Base::CreateObjKey(unsigned char objkey[16], unsigned& pnKeyLen, const PdfReference& objref) const
 {
+    // The key of an object is needed for every string and
+    // stream of it, so it's computed only the first time
+    {
+        shared_lock<shared_mutex> lock(m_objKeysMutex);
+        auto found = m_objKeys.find(objref);
+        if (found != m_objKeys.end())
+        {
+            std::memcpy(objkey, found->second.Key, 16);
+            pnKeyLen = found->second.Length;
+            return;
+        }
+    }
+
     const unsigned n = static_cast<unsigned>(objref.ObjectNumber());
     const unsigned g = static_cast<unsigned>(objref.GenerationNumber());
 
@@ -909,17 +887,20 @@ void PdfEncryptMD5Base::CreateObjKey(unsigned char objkey[16], unsigned& pnKeyLe
 
     GetMD5Binary(nkey, nkeylen, objkey);
     pnKeyLen = (m_keyLength <= 11) ? m_keyLength + 5 : 16;
-}
 
-PdfEncryptRC4Base::PdfEncryptRC4Base()
-{
-    m_rc4 = new RC4CryptoEngine();
+    unique_lock<shared_mutex> lock(m_objKeysMutex);
+    auto& cached = m_objKeys[objref];
+    std::memcpy(cached.Key, objkey, 16);
+    cached.Length = pnKeyLen;
 }
 
-PdfEncryptRC4Base::~PdfEncryptRC4Base()
+void PdfEncryptMD5Base::clearObjKeys()
 {
-    delete m_rc4;
+    unique_lock<shared_mutex> lock(m_objKeysMutex);
+    m_objKeys.clear();
 }
+
+PdfEncryptRC4Base::PdfEncryptRC4Base() { }
     
 /**
  * RC4 is the standard encryption algorithm used in PDF format
@@ -929,7 +910,7 @@ void PdfEncryptRC4Base::RC4(const unsigned char* key, unsigned keylen,
     const unsigned char* textin, size_t textlen,
     unsigned char* textout, size_t textoutlen) const
 {
-    EVP_CIPHER_CTX* rc4 = m_rc4->getEngine();
+    EVP_CIPHER_CTX* rc4 = getThreadCipherContext();
 
     if (textlen != textoutlen)
         PODOFO_RAISE_ERROR_INFO(PdfErrorCode::InternalLogic, "Error initializing RC4 encryption engine");
@@ -1119,7 +1100,7 @@ unique_ptr<InputStream> PdfEncryptRC4::CreateEncryptionInputStream(InputStream&
     unsigned char objkey[MD5_DIGEST_LENGTH];
     unsigned keylen;
     this->CreateObjKey(objkey, keylen, objref);
-    return unique_ptr<InputStream>(new PdfRC4InputStream(inputStream, inputLen, m_rc4key, m_rc4last, objkey, keylen));
+    return unique_ptr<InputStream>(new PdfRC4InputStream(inputStream, inputLen, objkey, keylen));
 }
 
 PdfEncryptRC4::PdfEncryptRC4(PdfString oValue, PdfString uValue, PdfPermissions pValue, int rValue,
@@ -1144,8 +1125,6 @@ PdfEncryptRC4::PdfEncryptRC4(PdfString oValue, PdfString uValue, PdfPermissions
     std::memcpy(m_uValue, uValueData.data(), 32);
 
     // Init buffers
-    std::memset(m_rc4key, 0, 16);
-    std::memset(m_rc4last, 0, 256);
     std::memset(m_encryptionKey, 0, 32);
 }
 
@@ -1187,10 +1166,8 @@ PdfEncryptRC4::PdfEncryptRC4(const string_view& userPassword, const string_view&
     }
 
     // Init buffers
-    std::memset(m_rc4key, 0, 16);
     std::memset(m_oValue, 0, 48);
     std::memset(m_uValue, 0, 48);
-    std::memset(m_rc4last, 0, 256);
     std::memset(m_encryptionKey, 0, 32);
 
     // Compute P value
@@ -1205,18 +1182,10 @@ unique_ptr<OutputStream> PdfEncryptRC4::CreateEncryptionOutputStream(OutputStrea
     unsigned char objkey[MD5_DIGEST_LENGTH];
     unsigned keylen;
     this->CreateObjKey(objkey, keylen, objref);
-    return unique_ptr<OutputStream>(new PdfRC4OutputStream(outputStream, m_rc4key, m_rc4last, objkey, keylen));
+    return unique_ptr<OutputStream>(new PdfRC4OutputStream(outputStream, objkey, keylen));
 }
     
-PdfEncryptAESBase::PdfEncryptAESBase()
-{
-    m_aes = new AESCryptoEngine();
-}
-
-PdfEncryptAESBase::~PdfEncryptAESBase()
-{
-    delete m_aes;
-}
+PdfEncryptAESBase::PdfEncryptAESBase() { }
 
 void PdfEncryptAESBase::BaseDecrypt(const unsigned char* key, unsigned keyLen, const unsigned char* iv,
     const unsigned char* textin, size_t textlen,
@@ -1225,7 +1194,7 @@ void PdfEncryptAESBase::BaseDecrypt(const unsigned char* key, unsigned keyLen, c
     if ((textlen % 16) != 0)
         PODOFO_RAISE_ERROR_INFO(PdfErrorCode::InternalLogic, "Error AES-decryption data length not a multiple of 16");
 
-    EVP_CIPHER_CTX* aes = m_aes->getEngine();
+    EVP_CIPHER_CTX* aes = getThreadCipherContext();
 
     int rc;
     if (keyLen == (int)PdfKeyLength::L128 / 8)
@@ -1257,7 +1226,7 @@ void PdfEncryptAESBase::BaseEncrypt(const unsigned char* key, unsigned keyLen, c
     unsigned char* textout, size_t textoutlen) const
 {
     (void)textoutlen;
-    EVP_CIPHER_CTX* aes = m_aes->getEngine();
+    EVP_CIPHER_CTX* aes = getThreadCipherContext();
 
     int rc;
     if (keyLen == (int)PdfKeyLength::L128 / 8)
@@ -1380,8 +1349,6 @@ PdfEncryptAESV2::PdfEncryptAESV2(const string_view& userPassword, const string_v
     m_keyLength = (int)PdfKeyLength::L128 / 8;
 
     // Init buffers
-    std::memset(m_rc4key, 0, 16);
-    std::memset(m_rc4last, 0, 256);
     std::memset(m_oValue, 0, 48);
     std::memset(m_uValue, 0, 48);
     std::memset(m_encryptionKey, 0, 32);
@@ -1415,8 +1382,6 @@ PdfEncryptAESV2::PdfEncryptAESV2(PdfString oValue, PdfString uValue, PdfPermissi
     std::memcpy(m_uValue, uValueData.data(), 32);
 
     // Init buffers
-    std::memset(m_rc4key, 0, 16);
-    std::memset(m_rc4last, 0, 256);
     std::memset(m_encryptionKey, 0, 32);
 }
 
@@ -1832,7 +1797,7 @@ bool PdfEncryptAESV3::Authenticate(const string_view& password, const string_vie
             // ISO 32000: "The 32-byte result is the key used to decrypt the 32-byte OE string using
             // AES-256 in CBC mode with no padding and an initialization vector of zero.
             // The 32-byte result is the file encryption key"
-            EVP_CIPHER_CTX* aes = m_aes->getEngine();
+            EVP_CIPHER_CTX* aes = getThreadCipherContext();
             EVP_DecryptInit_ex(aes, s_SSL.Aes256, nullptr, hashValue, 0); // iv zero
             EVP_CIPHER_CTX_set_padding(aes, 0); // no padding
             int lOutLen;
@@ -1849,7 +1814,7 @@ bool PdfEncryptAESV3::Authenticate(const string_view& password, const string_vie
         // ISO 32000: "The 32-byte result is the key used to decrypt the 32-byte UE string using
         // AES-256 in CBC mode with no padding and an initialization vector of zero.
         // The 32-byte result is the file encryption key"
-        EVP_CIPHER_CTX* aes = m_aes->getEngine();
+        EVP_CIPHER_CTX* aes = getThreadCipherContext();
         EVP_DecryptInit_ex(aes, s_SSL.Aes256, nullptr, hashValue, 0); // iv zero
         EVP_CIPHER_CTX_set_padding(aes, 0); // no padding
         int lOutLen;
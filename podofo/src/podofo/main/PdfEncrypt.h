@@ -8,6 +8,11 @@
 #define PDF_ENCRYPT_H
 
 #include "PdfDeclarations.h"
+
+#include <mutex>
+#include <shared_mutex>
+#include <unordered_map>
+
 #include "PdfString.h"
 #include "PdfReference.h"
 
@@ -18,8 +23,6 @@ class PdfDictionary;
 class InputStream;
 class PdfObject;
 class OutputStream;
-class AESCryptoEngine;
-class RC4CryptoEngine;
 
 /* Class representing PDF encryption methods. (For internal use only)
  * Based on code from Ulrich Telle: http://wxcode.sourceforge.net/components/wxpdfdoc/
@@ -483,9 +486,6 @@ protected:
  */
 class PdfEncryptAESBase
 {
-public:
-    ~PdfEncryptAESBase();
-
 protected:
     PdfEncryptAESBase();
 
@@ -495,8 +495,6 @@ protected:
     void BaseEncrypt(const unsigned char* key, unsigned keylen, const unsigned char* iv,
         const unsigned char* textin, size_t textlen,
         unsigned char* textout, size_t textoutlen) const;
-
-    AESCryptoEngine* m_aes;                // AES encryptor
 };
 
 /** A pure virtual class that is used to encrypt a PDF file (RC4-40..128)
@@ -508,9 +506,6 @@ protected:
  */
 class PdfEncryptRC4Base
 {
-public:
-    ~PdfEncryptRC4Base();
-
 protected:
     PdfEncryptRC4Base();
 
@@ -518,8 +513,6 @@ protected:
     void RC4(const unsigned char* key, unsigned keylen,
         const unsigned char* textin, size_t textlen,
         unsigned char* textout, size_t textoutlen) const;
-
-    RC4CryptoEngine* m_rc4;                // AES encryptor
 };
 
 class PdfEncryptMD5Base : public PdfEncrypt, public PdfEncryptRC4Base
@@ -575,9 +568,20 @@ protected:
      */
     void CreateObjKey(unsigned char objkey[16], unsigned& pnKeyLen, const PdfReference& objref) const;
 
-    unsigned char m_rc4key[16];         // last RC4 key
-    unsigned char m_rc4last[256];       // last RC4 state table
+private:
+    void clearObjKeys();
+
+private:
+    struct ObjKey
+    {
+        unsigned char Key[16];
+        unsigned Length;
+    };
 
+private:
+    // Keys of the objects, computed on first use
+    mutable std::unordered_map<PdfReference, ObjKey> m_objKeys;
+    mutable std::shared_mutex m_objKeysMutex;
 };
 
 /** A class that is used to encrypt a PDF file (AES-128)
@@ -294,9 +294,11 @@ bool PdfFont::TryGetStringLength(const string_view& str, const PdfTextState& sta
 {
     vector<unsigned> gids;
     bool success = tryConvertToGIDs(str, PdfGlyphAccess::Width, gids);
+    vector<double> widths;
+    m_Metrics->GetGlyphWidths(gids, widths);
     length = 0;
-    for (unsigned i = 0; i < gids.size(); i++)
-        length += getGlyphLength(m_Metrics->GetGlyphWidth(gids[i]), state, false);
+    for (unsigned i = 0; i < widths.size(); i++)
+        length += getGlyphLength(widths[i], state, false);
 
     return success;
 }
@@ -35,6 +35,13 @@ double PdfFontMetrics::GetGlyphWidth(unsigned gid) const
     return width;
 }
 
+void PdfFontMetrics::GetGlyphWidths(const cspan<unsigned>& gids, vector<double>& widths) const
+{
+    widths.resize(gids.size());
+    for (size_t i = 0; i < gids.size(); i++)
+        widths[i] = GetGlyphWidth(gids[i]);
+}
+
 void PdfFontMetrics::SubstituteGIDs(vector<unsigned>& gids, vector<unsigned char>& backwardMap) const
 {
     // By default do nothing and return a map to
@@ -55,6 +55,14 @@ public:
     double GetGlyphWidth(unsigned gid) const;
     virtual bool TryGetGlyphWidth(unsigned gid, double& width) const = 0;
 
+    /** Get the widths of multiple glyph ids
+     *
+     *  \param gids ids of the glyphs
+     *  \param widths the widths of the glyphs, the default
+     *      width is used for glyphs with no width
+     */
+    virtual void GetGlyphWidths(const cspan<unsigned>& gids, std::vector<double>& widths) const;
+
     /**
      * Some fonts provides a glyph subsitution list, eg. for ligatures.
      * OpenType fonts for example provides GSUB "Glyph Substitution Table"
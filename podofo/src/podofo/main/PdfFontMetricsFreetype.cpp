@@ -10,6 +10,9 @@
 #include <podofo/private/FreetypePrivate.h>
 #include FT_TRUETYPE_TABLES_H
 #include FT_TYPE1_TABLES_H
+#include FT_ADVANCES_H
+
+#include <mutex>
 
 #include "PdfArray.h"
 #include "PdfDictionary.h"
@@ -22,6 +25,17 @@ using namespace PoDoFo;
 
 static int determineType1FontWeight(const string_view& weight);
 
+struct PdfFontMetricsFreetype::GlyphWidthCache
+{
+    std::once_flag InitFlag;
+    // True if the widths were all read from the horizontal
+    // metrics, otherwise they are loaded per glyph when needed
+    bool Complete = false;
+    std::mutex Mutex;
+    // Widths in em units, NaN if not loaded yet or -1 if missing
+    std::vector<double> Widths;
+};
+
 PdfFontMetricsFreetype::PdfFontMetricsFreetype(const FreeTypeFacePtr& face, const datahandle& data,
         const PdfFontMetrics* refMetrics) :
     m_Face(face),
@@ -34,6 +48,12 @@ PdfFontMetricsFreetype::PdfFontMetricsFreetype(const FreeTypeFacePtr& face, cons
     if (face == nullptr)
         PODOFO_RAISE_ERROR_INFO(PdfErrorCode::InvalidHandle, "The buffer can't be null");
 
+    auto refFreetype = dynamic_cast<const PdfFontMetricsFreetype*>(refMetrics);
+    if (refFreetype != nullptr && refFreetype->m_Face == face)
+        m_GlyphWidths = refFreetype->m_GlyphWidths;
+    else
+        m_GlyphWidths = std::make_shared<GlyphWidthCache>();
+
     initFromFace(refMetrics);
 }
 
@@ -342,15 +362,79 @@ unsigned PdfFontMetricsFreetype::GetGlyphCount() const
 
 bool PdfFontMetricsFreetype::TryGetGlyphWidth(unsigned gid, double& width) const
 {
-    if (FT_Load_Glyph(m_Face.get(), gid, FT_LOAD_NO_SCALE | FT_LOAD_NO_BITMAP) != 0)
+    auto& cache = getGlyphWidths();
+    if (cache.Complete)
+        return tryGetGlyphWidth(cache, gid, width);
+
+    std::lock_guard<std::mutex> lock(cache.Mutex);
+    return tryGetGlyphWidth(cache, gid, width);
+}
+
+void PdfFontMetricsFreetype::GetGlyphWidths(const cspan<unsigned>& gids, vector<double>& widths) const
+{
+    widths.resize(gids.size());
+    auto& cache = getGlyphWidths();
+    unique_lock<std::mutex> lock(cache.Mutex, std::defer_lock);
+    if (!cache.Complete)
+        lock.lock();
+
+    for (size_t i = 0; i < gids.size(); i++)
+    {
+        if (!tryGetGlyphWidth(cache, gids[i], widths[i]))
+            widths[i] = GetDefaultWidth();
+    }
+}
+
+PdfFontMetricsFreetype::GlyphWidthCache& PdfFontMetricsFreetype::getGlyphWidths() const
+{
+    auto& cache = *m_GlyphWidths;
+    std::call_once(cache.InitFlag, [&]() {
+        auto face = m_Face.get();
+        cache.Widths.resize((size_t)face->num_glyphs, numeric_limits<double>::quiet_NaN());
+
+        // The fast path reads the advances straight from the horizontal
+        // metrics table, without loading the glyph outlines
+        vector<FT_Fixed> advances((size_t)face->num_glyphs);
+        if (advances.size() == 0 || FT_Get_Advances(face, 0, (FT_UInt)advances.size(),
+            FT_LOAD_NO_SCALE | FT_LOAD_NO_BITMAP | FT_ADVANCE_FLAG_FAST_ONLY, advances.data()) != 0)
+        {
+            return;
+        }
+
+        for (size_t i = 0; i < advances.size(); i++)
+            cache.Widths[i] = advances[i] / (double)face->units_per_EM;
+
+        cache.Complete = true;
+    });
+
+    return cache;
+}
+
+bool PdfFontMetricsFreetype::tryGetGlyphWidth(GlyphWidthCache& cache, unsigned gid, double& width) const
+{
+    if (gid >= cache.Widths.size())
     {
         width = -1;
         return false;
     }
 
-    // zero return code is success!
-    width = m_Face.get()->glyph->metrics.horiAdvance / (double)m_Face.get()->units_per_EM;
-    return true;
+    width = cache.Widths[gid];
+    if (std::isnan(width))
+    {
+        if (FT_Load_Glyph(m_Face.get(), gid, FT_LOAD_NO_SCALE | FT_LOAD_NO_BITMAP) == 0)
+        {
+            // zero return code is success!
+            width = m_Face.get()->glyph->metrics.horiAdvance / (double)m_Face.get()->units_per_EM;
+        }
+        else
+        {
+            width = -1;
+        }
+
+        cache.Widths[gid] = width;
+    }
+
+    return width >= 0;
 }
 
 bool PdfFontMetricsFreetype::HasUnicodeMapping() const
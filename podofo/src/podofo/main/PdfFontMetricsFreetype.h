@@ -24,6 +24,8 @@ class PODOFO_API PdfFontMetricsFreetype final : public PdfFontMetrics
 {
     friend class PdfFontManager;
 
+    struct GlyphWidthCache;
+
 public:
     static std::unique_ptr<PdfFontMetricsFreetype> FromMetrics(const PdfFontMetrics& metrics);
 
@@ -41,6 +43,8 @@ public:
 
     bool TryGetGlyphWidth(unsigned gid, double& width) const override;
 
+    void GetGlyphWidths(const cspan<unsigned>& gids, std::vector<double>& widths) const override;
+
     bool HasUnicodeMapping() const override;
 
     bool TryGetGID(char32_t codePoint, unsigned& gid) const override;
@@ -124,11 +128,20 @@ private:
 
     void initType1Lengths(const bufferview& view);
 
+    /** Get the width table, reading all the advances from
+     * the horizontal metrics table when first called
+     */
+    GlyphWidthCache& getGlyphWidths() const;
+
+    bool tryGetGlyphWidth(GlyphWidthCache& cache, unsigned gid, double& width) const;
+
 private:
     FreeTypeFacePtr m_Face;
     datahandle m_Data;
     PdfCIDToGIDMapConstPtr m_CIDToGIDMap;
     PdfFontFileType m_FontFileType;
+    // Shared by the metrics using the same face
+    std::shared_ptr<GlyphWidthCache> m_GlyphWidths;
 
     bool m_HasUnicodeMapping;
     bool m_HasSymbolCharset;
@@ -62,14 +62,13 @@ void PdfImage::DecodeTo(const bufferspan& buffer, PdfPixelFormat format, int row
     DecodeTo(stream, format, rowSize);
 }
 
-// TODO: Improve performance and format support
+// TODO: Improve format support
 void PdfImage::DecodeTo(OutputStream& stream, PdfPixelFormat format, int rowSize) const
 {
+    // NOTE: The image stream is decoded while reading it, one scan
+    // line at time, so the whole encoded data is never materialized
     auto istream = GetObject().MustGetStream().GetInputStream();
     auto& mediaFilters = istream.GetMediaFilters();
-    charbuff imageData;
-    ContainerStreamDevice device(imageData);
-    istream.CopyTo(device);
 
     charbuff smaskData;
     charbuff scanLine = initScanLine(format, rowSize, smaskData);
@@ -79,10 +78,10 @@ void PdfImage::DecodeTo(OutputStream& stream, PdfPixelFormat format, int rowSize
         switch (GetColorSpace())
         {
             case PdfColorSpace::DeviceRGB:
-                utls::FetchImageRGB(stream, m_Width, m_Height, format, (const unsigned char*)imageData.data(), smaskData, scanLine);
+                utls::FetchImageRGB(stream, m_Width, m_Height, format, istream, smaskData, scanLine);
                 break;
             case PdfColorSpace::DeviceGray:
-                utls::FetchImageGrayScale(stream, m_Width, m_Height, format, (const unsigned char*)imageData.data(), smaskData, scanLine);
+                utls::FetchImageGrayScale(stream, m_Width, m_Height, format, istream, smaskData, scanLine);
                 break;
             default:
                 PODOFO_RAISE_ERROR(PdfErrorCode::UnsupportedImageFormat);
@@ -102,7 +101,7 @@ void PdfImage::DecodeTo(OutputStream& stream, PdfPixelFormat format, int rowSize
                 {
                     InitJpegDecompressContext(ctx, jerr);
 
-                    PoDoFo::jpeg_memory_src(&ctx, reinterpret_cast<JOCTET*>(imageData.data()), imageData.size());
+                    PoDoFo::jpeg_stream_src(&ctx, istream);
 
                     if (jpeg_read_header(&ctx, TRUE) <= 0)
                         PODOFO_RAISE_ERROR(PdfErrorCode::UnexpectedEOF);
@@ -151,6 +150,13 @@ void PdfImage::DecodeTo(OutputStream& stream, PdfPixelFormat format, int rowSize
                     columns = (int)decodeParms->FindKeyAs<int64_t>("Columns", 1728);
                     rows = (int)decodeParms->FindKeyAs<int64_t>("Rows");
                 }
+
+                // NOTE: The fax decoder needs the whole encoded data,
+                // which is much smaller than the decoded image. The
+                // image is still decoded one scan line at time
+                charbuff imageData;
+                ContainerStreamDevice device(imageData);
+                istream.CopyTo(device);
                 auto decoder = fxcodec::FaxModule::CreateDecoder(
                     pdfium::span<const uint8_t>((const uint8_t *)imageData.data(), imageData.size()),
                     (int)m_Width, (int)m_Height, k, endOfLine, encodedByteAlign, blackIs1, columns, rows);
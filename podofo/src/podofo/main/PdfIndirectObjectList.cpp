@@ -8,6 +8,7 @@
 #include "PdfIndirectObjectList.h"
 
 #include <algorithm>
+#include <thread>
 
 #include "PdfArray.h"
 #include "PdfDictionary.h"
@@ -16,11 +17,20 @@
 #include "PdfReference.h"
 #include "PdfObjectStream.h"
 #include "PdfDocument.h"
+#include <podofo/private/PdfArena.h>
+#include <podofo/private/PdfConcurrentLoader.h>
+#include "PdfParser.h"
 
 using namespace std;
 using namespace PoDoFo;
 
 static constexpr size_t MaxReserveSize = 8388607; // cf. Table C.1 in section C.2 of PDF32000_2008.pdf
+// The table of objects grows to hold an object number up to
+// this many times the objects in it, or this minimum size
+static constexpr size_t MaxTableSparsity = 4;
+static constexpr size_t MinTableSize = 1024;
+// Index of the end iterator, past any object number
+static constexpr size_t EndIndex = numeric_limits<size_t>::max();
 static constexpr unsigned MaxXRefGenerationNum = 65535;
 
 struct ObjectComparatorPredicate
@@ -65,35 +75,61 @@ private:
 PdfIndirectObjectList::PdfIndirectObjectList() :
     m_Document(nullptr),
     m_CanReuseObjectNumbers(true),
+    m_ObjectListSize(0),
     m_ObjectCount(0),
-    m_StreamFactory(nullptr)
+    m_StreamFactory(nullptr),
+    m_arena(nullptr),
+    m_loader(nullptr),
+    m_peekParser(nullptr)
 {
 }
 
 PdfIndirectObjectList::PdfIndirectObjectList(PdfDocument& document) :
     m_Document(&document),
     m_CanReuseObjectNumbers(true),
+    m_ObjectListSize(0),
     m_ObjectCount(1),
-    m_StreamFactory(nullptr)
+    m_StreamFactory(nullptr),
+    m_arena(nullptr),
+    m_loader(nullptr),
+    m_peekParser(nullptr)
 {
 }
 
 PdfIndirectObjectList::PdfIndirectObjectList(PdfDocument& document, const PdfIndirectObjectList& rhs)  :
     m_Document(&document),
     m_CanReuseObjectNumbers(rhs.m_CanReuseObjectNumbers),
-    m_ObjectCount(rhs.m_ObjectCount),
-    m_FreeObjects(rhs.m_FreeObjects),
-    m_unavailableObjects(rhs.m_unavailableObjects),
-    m_StreamFactory(nullptr)
-{
+    m_StreamFactory(nullptr),
+    m_arena(nullptr),
+    m_loader(nullptr),
+    m_peekParser(nullptr)
+{
+    // The source must be complete before copying its state
+    rhs.readRemainingObjects();
+    m_Objects.resize(rhs.m_Objects.size());
+    m_ObjectListSize = rhs.m_ObjectListSize;
+    m_ObjectCount = rhs.m_ObjectCount;
+    m_FreeObjects = rhs.m_FreeObjects;
+    m_unavailableObjects = rhs.m_unavailableObjects;
+
     // Copy all objects from source, resetting parent and indirect reference
-    for (auto obj : rhs.m_Objects)
-    {
-        auto newObj = new PdfObject(*obj);
-        newObj->SetIndirectReference(obj->GetIndirectReference());
+    auto copyObject = [&document](const PdfObject& obj) {
+        auto newObj = new PdfObject(obj);
+        newObj->SetIndirectReference(obj.GetIndirectReference());
         newObj->SetDocument(&document);
-        m_Objects.insert(newObj);
+        return newObj;
+    };
+    for (size_t i = 0; i < rhs.m_Objects.size(); i++)
+    {
+        auto obj = rhs.m_Objects[i];
+        if (obj == nullptr)
+            continue;
+
+        m_Objects[i] = copyObject(*obj);
     }
+
+    for (auto& pair : rhs.m_sparseObjects)
+        m_sparseObjects[pair.first] = copyObject(*pair.second);
 }
 
 PdfIndirectObjectList::~PdfIndirectObjectList()
@@ -103,12 +139,111 @@ PdfIndirectObjectList::~PdfIndirectObjectList()
 
 void PdfIndirectObjectList::Clear()
 {
+    releasePeekParser();
     for (auto obj : m_Objects)
-        delete obj;
+        deleteObject(obj);
+
+    for (auto& pair : m_sparseObjects)
+        deleteObject(pair.second);
 
     m_Objects.clear();
+    m_sparseObjects.clear();
+    m_ObjectListSize = 0;
     m_ObjectCount = 1;
     m_StreamFactory = nullptr;
+    delete m_loader;
+    m_loader = nullptr;
+    releaseArena();
+}
+
+void PdfIndirectObjectList::enableArena()
+{
+    if (m_arena == nullptr)
+        m_arena = PdfArena::Create();
+}
+
+void* PdfIndirectObjectList::allocateObject(size_t size)
+{
+    if (m_arena == nullptr)
+        return ::operator new(size);
+
+    return m_arena->Allocate(size);
+}
+
+void PdfIndirectObjectList::deallocateObject(void* block) noexcept
+{
+    if (m_arena == nullptr)
+        ::operator delete(block);
+    else
+        PdfArena::Deallocate(block);
+}
+
+void PdfIndirectObjectList::deleteObject(PdfObject* obj) noexcept
+{
+    if (obj == nullptr)
+        return;
+
+    PdfArena::Delete(obj, obj->m_IsInArena);
+}
+
+unique_ptr<PdfObject> PdfIndirectObjectList::detachObject(PdfObject* obj)
+{
+    if (!obj->m_IsInArena)
+        return unique_ptr<PdfObject>(obj);
+
+    // Objects in the arena can't be deleted by the caller: hand
+    // out a copy on the heap, that also loads a delayed object
+    unique_ptr<PdfObject> ret;
+    {
+        PdfArena::Scope scope(nullptr);
+        ret.reset(new PdfObject(*obj));
+    }
+    ret->SetIndirectReference(obj->GetIndirectReference());
+    ret->SetDocument(m_Document);
+    deleteObject(obj);
+    return ret;
+}
+
+void PdfIndirectObjectList::enableConcurrentRead(InputStreamDevice& device)
+{
+    if (m_loader == nullptr)
+        m_loader = new PdfConcurrentLoader(device);
+}
+
+void PdfIndirectObjectList::readRemainingObjects() const
+{
+    if (m_peekParser == nullptr)
+        return;
+
+    m_peekParser->readRemainingObjects();
+    const_cast<PdfIndirectObjectList&>(*this).releasePeekParser();
+}
+
+unsigned PdfIndirectObjectList::getSizeBound() const
+{
+    // The objects of peeked documents are at most
+    // as many as the cross-reference entries
+    if (m_peekParser != nullptr)
+        return std::max(m_ObjectListSize, (unsigned)m_peekParser->m_peekPending.size());
+
+    return m_ObjectListSize;
+}
+
+void PdfIndirectObjectList::releasePeekParser()
+{
+    delete m_peekParser;
+    m_peekParser = nullptr;
+}
+
+void PdfIndirectObjectList::releaseArena()
+{
+    if (m_arena == nullptr)
+        return;
+
+    // Objects still alive outside of the list, e.g. the ones
+    // returned by RemoveObject(), keep the arena memory alive
+    m_arena->Release();
+    m_arena = nullptr;
 }
 
 PdfObject& PdfIndirectObjectList::MustGetObject(const PdfReference& ref) const
@@ -122,11 +257,96 @@ PdfObject& PdfIndirectObjectList::MustGetObject(const PdfReference& ref) const
 
 PdfObject* PdfIndirectObjectList::GetObject(const PdfReference& ref) const
 {
-    auto it = m_Objects.lower_bound(ref);
-    if (it == m_Objects.end() || (*it)->GetIndirectReference() != ref)
+    // Objects of peeked documents are read on first lookup
+    if (m_peekParser != nullptr)
+        m_peekParser->readPeekedObject(ref.ObjectNumber());
+
+    PdfObject* obj;
+    if (ref.ObjectNumber() < m_Objects.size())
+    {
+        obj = m_Objects[ref.ObjectNumber()];
+    }
+    else
+    {
+        auto found = m_sparseObjects.find(ref.ObjectNumber());
+        if (found == m_sparseObjects.end())
+            return nullptr;
+
+        obj = found->second;
+    }
+
+    if (obj == nullptr || obj->GetIndirectReference().GenerationNumber() != ref.GenerationNumber())
         return nullptr;
 
-    return *it;
+    return obj;
+}
+
+void PdfIndirectObjectList::LoadAllObjects(unsigned threadCount) const
+{
+    readRemainingObjects();
+    vector<PdfObject*> objects;
+    objects.reserve(m_ObjectListSize);
+    for (auto obj : *this)
+    {
+        if ((!obj->IsDelayedLoadDone() || !obj->m_IsDelayedLoadStreamDone.load(memory_order_acquire)))
+            objects.push_back(obj);
+    }
+
+    // Without concurrent read support delayed
+    // loading must happen on a single thread
+    if (m_loader == nullptr)
+        threadCount = 1;
+    else if (threadCount == 0)
+        threadCount = std::max(1u, std::thread::hardware_concurrency());
+    threadCount = (unsigned)std::min<size_t>(threadCount, objects.size());
+
+    atomic<size_t> nextObject(0);
+    exception_ptr error;
+    mutex errorMutex;
+    auto worker = [&]() {
+        while (true)
+        {
+            size_t i = nextObject.fetch_add(1, memory_order_relaxed);
+            if (i >= objects.size())
+                return;
+
+            try
+            {
+                // NOTE: This loads the object first
+                objects[i]->DelayedLoadStream();
+            }
+            catch (...)
+            {
+                unique_lock<mutex> lock(errorMutex);
+                if (error == nullptr)
+                    error = std::current_exception();
+
+                // Stop the other workers from taking further objects
+                nextObject.store(objects.size(), memory_order_relaxed);
+                return;
+            }
+        }
+    };
+
+    if (threadCount <= 1)
+    {
+        worker();
+    }
+    else
+    {
+        // The calling thread acts as one of the workers
+        vector<thread> threads;
+        threads.reserve(threadCount - 1);
+        for (unsigned i = 1; i < threadCount; i++)
+            threads.emplace_back(worker);
+
+        worker();
+        for (auto& thread : threads)
+            thread.join();
+    }
+
+    if (error != nullptr)
+        std::rethrow_exception(error);
 }
 
 unique_ptr<PdfObject> PdfIndirectObjectList::RemoveObject(const PdfReference& ref)
@@ -136,16 +356,15 @@ unique_ptr<PdfObject> PdfIndirectObjectList::RemoveObject(const PdfReference& re
 
 unique_ptr<PdfObject> PdfIndirectObjectList::RemoveObject(const PdfReference& ref, bool markAsFree)
 {
-    auto it = m_Objects.lower_bound(ref);
-    if (it == m_Objects.end() || (*it)->GetIndirectReference() != ref)
+    if (GetObject(ref) == nullptr)
         return nullptr;
 
-    return removeObject(it, markAsFree);
+    return removeObject(ref.ObjectNumber(), markAsFree);
 }
 
 unique_ptr<PdfObject> PdfIndirectObjectList::RemoveObject(const iterator& it)
 {
-    return removeObject(it, true);
+    return removeObject((uint32_t)it.m_index, true);
 }
 
 unique_ptr<PdfObject> PdfIndirectObjectList::ReplaceObject(const PdfReference& ref, PdfObject* obj)
@@ -153,35 +372,34 @@ unique_ptr<PdfObject> PdfIndirectObjectList::ReplaceObject(const PdfReference& r
     if (obj == nullptr)
         PODOFO_RAISE_ERROR_INFO(PdfErrorCode::InvalidHandle, "Object must be non null");
 
-    auto it = m_Objects.lower_bound(ref);
-    if (it == m_Objects.end())
+    if (GetObject(ref) == nullptr)
         PODOFO_RAISE_ERROR_INFO(PdfErrorCode::InvalidHandle, "Unable to find object with reference {}", ref.ToString());
 
-    auto hintpos = it;
-    hintpos++;
-    auto node = m_Objects.extract(it);
-    unique_ptr<PdfObject> ret(node.value());
-    node.value() = obj;
+    auto& slot = getObjectSlot(ref.ObjectNumber());
+    auto ret = detachObject(slot);
+    slot = obj;
     obj->SetIndirectReference(ref);
-    pushObject(hintpos, node, obj);
     return ret;
 }
 
-unique_ptr<PdfObject> PdfIndirectObjectList::removeObject(const iterator& it, bool markAsFree)
+unique_ptr<PdfObject> PdfIndirectObjectList::removeObject(uint32_t objectNum, bool markAsFree)
 {
-    auto obj = *it;
-    if (m_objectStreams.find(obj->GetIndirectReference().ObjectNumber()) != m_objectStreams.end())
+    readRemainingObjects();
+    if (m_objectStreams.find(objectNum) != m_objectStreams.end())
         PODOFO_RAISE_ERROR_INFO(PdfErrorCode::InternalLogic, "Can't remove a compressed object stream");
 
+    auto ret = detachObject(getObjectSlot(objectNum));
     if (markAsFree)
-        SafeAddFreeObject(obj->GetIndirectReference());
+        SafeAddFreeObject(ret->GetIndirectReference());
 
-    m_Objects.erase(it);
-    return unique_ptr<PdfObject>(obj);
+    resetObjectSlot(objectNum);
+    m_ObjectListSize--;
+    return ret;
 }
 
 PdfReference PdfIndirectObjectList::getNextFreeObject()
 {
+    readRemainingObjects();
     // Try to first use list of free objects
     if (m_CanReuseObjectNumbers && !m_FreeObjects.empty())
     {
@@ -191,6 +409,12 @@ PdfReference PdfIndirectObjectList::getNextFreeObject()
     }
 
     // If no free objects are available, create a new object with generation 0
+    return getNextNewObject();
+}
+
+PdfReference PdfIndirectObjectList::getNextNewObject()
+{
+    readRemainingObjects();
     uint32_t nextObjectNum = static_cast<uint32_t>(m_ObjectCount);
     while (true)
     {
@@ -312,33 +536,128 @@ void PdfIndirectObjectList::addNewObject(PdfObject* obj)
     PushObject(obj);
 }
 
+PdfObject& PdfIndirectObjectList::createNewDictionaryObject(const string_view& type)
+{
+    PdfDictionary dict;
+    dict.AddKey(PdfName::KeyType, PdfName(type));
+    auto ret = new PdfObject(std::move(dict));
+    ret->setDirty();
+    ret->SetIndirectReference(getNextNewObject());
+    PushObject(ret);
+    return *ret;
+}
+
+void PdfIndirectObjectList::removeNewObjects(const vector<PdfReference>& refs)
+{
+    if (refs.size() == 0)
+        return;
+
+    for (auto& ref : refs)
+        (void)removeObject(ref.ObjectNumber(), false);
+
+    // The objects got never used object numbers, starting from the
+    // object count at the time the first one was created: lower it
+    // back, so repeated creations don't grow the object count
+    PODOFO_ASSERT(refs.front().ObjectNumber() < m_ObjectCount);
+    m_ObjectCount = refs.front().ObjectNumber();
+}
+
 void PdfIndirectObjectList::PushObject(PdfObject* obj)
 {
     obj->SetDocument(m_Document);
 
-    ObjectList::node_type node;
-    auto it = m_Objects.find(obj);
-    auto hintpos = it;
-    if (it != m_Objects.end())
+    auto& slot = getObjectSlot(obj->GetIndirectReference().ObjectNumber());
+    if (slot == nullptr)
+    {
+        m_ObjectListSize++;
+    }
+    else
+    {
+        // Delete existing object with the same object number
+        // and replace it. Only one generation of an object
+        // can be alive at the same time
+        deleteObject(slot);
+    }
+
+    slot = obj;
+    TryIncrementObjectCount(obj->GetIndirectReference());
+}
+
+PdfObject*& PdfIndirectObjectList::getObjectSlot(uint32_t objectNum)
+{
+    if (objectNum < m_Objects.size())
+        return m_Objects[objectNum];
+
+    if ((size_t)objectNum >= MaxReserveSize)
+        PODOFO_RAISE_ERROR_INFO(PdfErrorCode::ValueOutOfRange, "Object number {} exceeds the maximum number of indirect objects", objectNum);
+
+    // Bound the growth of the table to the objects it holds, so
+    // a single huge object number can't allocate a huge table
+    if ((size_t)objectNum >= std::max(MinTableSize, ((size_t)m_ObjectListSize + 1) * MaxTableSparsity))
+        return m_sparseObjects[objectNum];
+
+    m_Objects.resize((size_t)objectNum + 1);
+
+    // Move the objects that now fit in the table
+    auto it = m_sparseObjects.begin();
+    while (it != m_sparseObjects.end() && it->first < m_Objects.size())
     {
-        // Delete existing object and replace
-        // the pointer on its node
-        hintpos++;
-        node = m_Objects.extract(it);
-        delete node.value();
-        node.value() = obj;
+        m_Objects[it->first] = it->second;
+        it = m_sparseObjects.erase(it);
     }
 
-    pushObject(hintpos, node, obj);
+    return m_Objects[objectNum];
 }
 
-void PdfIndirectObjectList::pushObject(const ObjectList::const_iterator& hintpos, ObjectList::node_type& node, PdfObject* obj)
+void PdfIndirectObjectList::resetObjectSlot(uint32_t objectNum)
 {
-    if (node.empty())
-        m_Objects.insert(hintpos, obj);
+    if (objectNum < m_Objects.size())
+        m_Objects[objectNum] = nullptr;
     else
-        m_Objects.insert(hintpos, std::move(node));
-    TryIncrementObjectCount(obj->GetIndirectReference());
+        m_sparseObjects.erase(objectNum);
+}
+
+size_t PdfIndirectObjectList::findNextIndex(size_t index) const
+{
+    for (; index < m_Objects.size(); index++)
+    {
+        if (m_Objects[index] != nullptr)
+            return index;
+    }
+
+    // The sparse objects all follow the ones in the table
+    auto found = m_sparseObjects.lower_bound((uint32_t)std::min(index, MaxReserveSize));
+    return found == m_sparseObjects.end() ? EndIndex : found->first;
+}
+
+size_t PdfIndirectObjectList::findPreviousIndex(size_t index) const
+{
+    if (index > m_Objects.size())
+    {
+        auto found = index == EndIndex ? m_sparseObjects.end()
+            : m_sparseObjects.lower_bound((uint32_t)std::min(index, MaxReserveSize));
+        if (found != m_sparseObjects.begin())
+            return std::prev(found)->first;
+
+        index = m_Objects.size();
+    }
+
+    while (index != 0)
+    {
+        index--;
+        if (m_Objects[index] != nullptr)
+            return index;
+    }
+
+    return 0;
+}
+
+PdfObject* const& PdfIndirectObjectList::getObjectAt(size_t index) const
+{
+    if (index < m_Objects.size())
+        return m_Objects[index];
+
+    return m_sparseObjects.find((uint32_t)index)->second;
 }
 
 void PdfIndirectObjectList::CollectGarbage()
@@ -346,28 +665,28 @@ void PdfIndirectObjectList::CollectGarbage()
     if (m_Document == nullptr)
         return;
 
+    readRemainingObjects();
     unordered_set<PdfReference> referencedOjects;
     visitObject(m_Document->GetTrailer().GetObject(), referencedOjects);
-    vector<PdfObject*> objectsToDelete;
-    ObjectList newlist;
-    for (PdfObject* obj : m_Objects)
+    vector<uint32_t> unreferencedObjects;
+    for (auto obj : *this)
     {
         auto& ref = obj->GetIndirectReference();
         if (referencedOjects.find(ref) == referencedOjects.end()
             && m_objectStreams.find(ref.ObjectNumber()) == m_objectStreams.end())
         {
-            SafeAddFreeObject(ref);
-            objectsToDelete.push_back(obj);
-            continue;
+            unreferencedObjects.push_back(ref.ObjectNumber());
         }
-
-        newlist.insert(obj);
     }
 
-    for (auto obj : objectsToDelete)
-        delete obj;
-
-    m_Objects.swap(newlist);
+    for (uint32_t objectNum : unreferencedObjects)
+    {
+        auto& obj = getObjectSlot(objectNum);
+        SafeAddFreeObject(obj->GetIndirectReference());
+        deleteObject(obj);
+        resetObjectSlot(objectNum);
+        m_ObjectListSize--;
+    }
 }
 
 void PdfIndirectObjectList::visitObject(const PdfObject& obj, unordered_set<PdfReference>& referencedObjects)
@@ -475,6 +794,7 @@ void PdfIndirectObjectList::EndAppendStream(PdfObjectStream& stream)
 
 void PdfIndirectObjectList::SetCanReuseObjectNumbers(bool canReuseObjectNumbers)
 {
+    readRemainingObjects();
     m_CanReuseObjectNumbers = canReuseObjectNumbers;
 
     if (!m_CanReuseObjectNumbers)
@@ -483,7 +803,20 @@ void PdfIndirectObjectList::SetCanReuseObjectNumbers(bool canReuseObjectNumbers)
 
 unsigned PdfIndirectObjectList::GetSize() const
 {
-    return (unsigned)m_Objects.size();
+    readRemainingObjects();
+    return m_ObjectListSize;
+}
+
+unsigned PdfIndirectObjectList::GetObjectCount() const
+{
+    readRemainingObjects();
+    return m_ObjectCount;
+}
+
+const ReferenceList& PdfIndirectObjectList::GetFreeObjects() const
+{
+    readRemainingObjects();
+    return m_FreeObjects;
 }
 
 void PdfIndirectObjectList::Attach(Observer& observer)
@@ -509,25 +842,28 @@ void PdfIndirectObjectList::TryIncrementObjectCount(const PdfReference& ref)
 
 PdfIndirectObjectList::iterator PdfIndirectObjectList::begin() const
 {
-    return m_Objects.begin();
+    readRemainingObjects();
+    return iterator(*this, findNextIndex(0));
 }
 
 PdfIndirectObjectList::iterator PdfIndirectObjectList::end() const
 {
-    return m_Objects.end();
+    readRemainingObjects();
+    return iterator(*this, EndIndex);
 }
 
 PdfIndirectObjectList::reverse_iterator PdfIndirectObjectList::rbegin() const
 {
-    return m_Objects.rbegin();
+    return reverse_iterator(end());
 }
 
 PdfIndirectObjectList::reverse_iterator PdfIndirectObjectList::rend() const
 {
-    return m_Objects.rend();
+    return reverse_iterator(begin());
 }
 
 size_t PdfIndirectObjectList::size() const
 {
-    return m_Objects.size();
+    readRemainingObjects();
+    return m_ObjectListSize;
 }
@@ -8,12 +8,17 @@
 #define PDF_INDIRECT_OBJECT_LIST_H
 
 #include <list>
+#include <map>
 
 #include "PdfObject.h"
 
 namespace PoDoFo {
 
 class PdfObjectStreamProvider;
+class PdfArena;
+class PdfConcurrentLoader;
+class PdfParser;
+class InputStreamDevice;
 using ReferenceList = std::deque<PdfReference>;
 
 /** A list of PdfObjects that constitutes the indirect object list
@@ -35,36 +40,86 @@ class PODOFO_API PdfIndirectObjectList final
     friend class PdfParser;
     friend class PdfObjectStreamParser;
     friend class PdfImmediateWriter;
+    friend class PdfMemDocument;
+    friend class PdfObject;
+    friend class PdfParserObject;
+    friend class PdfPageCollection;
 
 private:
-    // Comparator to enable heterogeneous lookup with
-    // both objects and references
-    // See https://stackoverflow.com/a/31924435/213871
-    struct ObjectListComparator final
+    // Table of objects indexed by object number. Object numbers
+    // are dense, so empty slots are the exception. Objects numbered
+    // far beyond the ones in the table, as found in malformed files,
+    // are kept in a sparse map instead, so they don't grow the table
+    using ObjectList = std::vector<PdfObject*>;
+    using SparseObjectList = std::map<uint32_t, PdfObject*>;
+
+public:
+    /** Iterator over the objects in the list, ordered by
+     * object number. Empty slots in the table are skipped
+     */
+    class Iterator final
     {
-        using is_transparent = std::true_type;
-        bool operator()(const PdfObject* lhs, const PdfObject* rhs) const
+        friend class PdfIndirectObjectList;
+    public:
+        using difference_type = std::ptrdiff_t;
+        using value_type = PdfObject*;
+        using pointer = PdfObject* const*;
+        using reference = PdfObject* const&;
+        using iterator_category = std::bidirectional_iterator_tag;
+    public:
+        Iterator() : m_objects(nullptr), m_index(0) { }
+    private:
+        Iterator(const PdfIndirectObjectList& objects, size_t index) : m_objects(&objects), m_index(index) { }
+    public:
+        Iterator(const Iterator&) = default;
+        Iterator& operator=(const Iterator&) = default;
+        bool operator==(const Iterator& rhs) const
+        {
+            return m_index == rhs.m_index;
+        }
+        bool operator!=(const Iterator& rhs) const
+        {
+            return m_index != rhs.m_index;
+        }
+        Iterator& operator++()
+        {
+            m_index = m_objects->findNextIndex(m_index + 1);
+            return *this;
+        }
+        Iterator operator++(int)
+        {
+            auto copy = *this;
+            ++(*this);
+            return copy;
+        }
+        Iterator& operator--()
         {
-            return lhs->GetIndirectReference() < rhs->GetIndirectReference();
+            m_index = m_objects->findPreviousIndex(m_index);
+            return *this;
         }
-        bool operator()(const PdfObject* lhs, const PdfReference& rhs) const
+        Iterator operator--(int)
         {
-            return lhs->GetIndirectReference() < rhs;
+            auto copy = *this;
+            --(*this);
+            return copy;
         }
-        bool operator()(const PdfReference& lhs, const PdfObject* rhs) const
+        reference operator*() const
         {
-            return lhs < rhs->GetIndirectReference();
+            return m_objects->getObjectAt(m_index);
         }
+        pointer operator->() const
+        {
+            return &m_objects->getObjectAt(m_index);
+        }
+    private:
+        // NOTE: Keep the object number and not a vector iterator,
+        // so growing the table while iterating is safe
+        const PdfIndirectObjectList* m_objects;
+        size_t m_index;
     };
 
-    using ObjectList = std::set<PdfObject*, ObjectListComparator>;
-
-public:
-    // An incomplete set of container typedefs, just enough to handle
-    // the begin() and end() methods we wrap from the internal vector.
-    // TODO: proper wrapper iterator class.
-    using iterator = ObjectList::const_iterator;
-    using reverse_iterator = ObjectList::const_reverse_iterator;
+    using iterator = Iterator;
+    using reverse_iterator = std::reverse_iterator<Iterator>;
 
     /** Every observer of PdfIndirectObjectList has to implement this interface.
      */
@@ -131,14 +186,14 @@ public:
     void Clear();
 
     /**
-     *  \returns the size of the internal vector
+     *  \returns the number of objects in the list
      */
     unsigned GetSize() const;
 
     /**
      *  \returns the highest object number in the vector
      */
-    unsigned GetObjectCount() const { return m_ObjectCount; }
+    unsigned GetObjectCount() const;
 
     /** Finds the object with the given reference
      *  and returns a pointer to it if it is found. Throws a PdfError
@@ -156,6 +211,16 @@ public:
      */
     PdfObject* GetObject(const PdfReference& ref) const;
 
+    /** Complete the delayed loading of all the objects and of their
+     *  streams, decrypting strings and stream data of encrypted documents.
+     *  The objects are loaded by a pool of worker threads if the document
+     *  was loaded with PdfLoadOptions::ConcurrentRead, otherwise they are
+     *  loaded on the calling thread
+     *  \param threadCount the number of workers, or 0 to use the
+     *      hardware concurrency
+     */
+    void LoadAllObjects(unsigned threadCount = 0) const;
+
     /** Remove the object with the given object and generation number from the list
      *  of objects.
      *  The object is returned if it was found. Otherwise nullptr is returned.
@@ -330,21 +395,99 @@ private:
     void CollectGarbage();
 
 private:
-    void pushObject(const ObjectList::const_iterator& hintpos, ObjectList::node_type& node, PdfObject* obj);
+    /** Get the slot of the given object number, creating it if needed
+     */
+    PdfObject*& getObjectSlot(uint32_t objectNum);
 
-    std::unique_ptr<PdfObject> removeObject(const iterator& it, bool markAsFree);
+    /** Empty the slot of the given object number
+     */
+    void resetObjectSlot(uint32_t objectNum);
+
+    /** \returns the first object number from the given one
+     * with an object, or the end iterator index if none
+     */
+    size_t findNextIndex(size_t index) const;
+
+    /** \returns the last object number before the given
+     * one with an object, or 0 if none
+     */
+    size_t findPreviousIndex(size_t index) const;
+
+    PdfObject* const& getObjectAt(size_t index) const;
+
+    std::unique_ptr<PdfObject> removeObject(uint32_t objectNum, bool markAsFree);
 
     void addNewObject(PdfObject* obj);
 
+    /** Create a dictionary object with a never used object number,
+     * so its generation number is always 0
+     */
+    PdfObject& createNewDictionaryObject(const std::string_view& type);
+
+    /** Remove temporary objects created with createNewDictionaryObject(),
+     * giving back their object numbers as never used
+     * \param refs the references of the objects, in creation order
+     */
+    void removeNewObjects(const std::vector<PdfReference>& refs);
+
     /**
      * \returns the next free object reference
      */
     PdfReference getNextFreeObject();
 
+    /**
+     * \returns the next never used object reference
+     */
+    PdfReference getNextNewObject();
+
     int32_t tryAddFreeObject(uint32_t objnum, uint32_t gennum);
 
     void visitObject(const PdfObject& obj, std::unordered_set<PdfReference>& referencedObj);
 
+    /** Allocate objects parsed into this list from a dedicated
+     * arena, released wholesale when the list is cleared
+     */
+    void enableArena();
+
+    void releaseArena();
+
+    /** Create an object owned by this list, in the arena if enabled
+     * \remarks Delete it with deleteObject()
+     */
+    template <typename TObject, typename... TArgs>
+    TObject* newObject(TArgs&&... args);
+
+    void* allocateObject(size_t size);
+
+    void deallocateObject(void* block) noexcept;
+
+    /** Delete an object owned by this list
+     */
+    void deleteObject(PdfObject* obj) noexcept;
+
+    /** Convert an object owned by this list to an object
+     * on the heap, that can be handed out to the caller
+     */
+    std::unique_ptr<PdfObject> detachObject(PdfObject* obj);
+
+    /** Make delayed loading of the objects of this list safe
+     * for concurrent readers
+     * \param device the device the objects are parsed from
+     */
+    void enableConcurrentRead(InputStreamDevice& device);
+
+    /** Read all the objects of a document loaded with
+     * PdfLoadOptions::Peek that were not looked up yet
+     */
+    void readRemainingObjects() const;
+
+    void releasePeekParser();
+
+    /** \returns an upper bound of the number of objects in the list,
+     * which doesn't require reading the objects of peeked documents
+     */
+    unsigned getSizeBound() const;
+
 public:
     /** Iterator pointing at the beginning of the vector
      *  \returns beginning iterator
@@ -376,12 +519,14 @@ public:
 
     /** \returns a list of free references in this vector
      */
-    inline const ReferenceList& GetFreeObjects() const { return m_FreeObjects; }
+    const ReferenceList& GetFreeObjects() const;
 
 private:
     PdfDocument* m_Document;
     bool m_CanReuseObjectNumbers;
     ObjectList m_Objects;
+    SparseObjectList m_sparseObjects;
+    unsigned m_ObjectListSize;
     unsigned m_ObjectCount;
     ReferenceList m_FreeObjects;
     ObjectNumSet m_unavailableObjects;
@@ -389,8 +534,30 @@ private:
 
     ObserverList m_observers;
     StreamFactory* m_StreamFactory;
+    PdfArena* m_arena;
+    PdfConcurrentLoader* m_loader;
+    PdfParser* m_peekParser;
 };
 
+template <typename TObject, typename... TArgs>
+TObject* PdfIndirectObjectList::newObject(TArgs&&... args)
+{
+    auto block = allocateObject(sizeof(TObject));
+    TObject* ret;
+    try
+    {
+        ret = new(block) TObject(std::forward<TArgs>(args)...);
+    }
+    catch (...)
+    {
+        deallocateObject(block);
+        throw;
+    }
+
+    static_cast<PdfObject*>(ret)->m_IsInArena = m_arena != nullptr;
+    return ret;
+}
+
 };
 
 #endif // PDF_INDIRECT_OBJECT_LIST_H
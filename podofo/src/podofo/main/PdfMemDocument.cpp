@@ -29,6 +29,7 @@
 #include "PdfPage.h"
 #include "PdfPageCollection.h"
 #include <podofo/auxiliary/StreamDevice.h>
+#include <podofo/private/FileSystem.h>
 #include "PdfCommon.h"
 
 using namespace std;
@@ -42,17 +43,19 @@ PdfMemDocument::PdfMemDocument(bool empty) :
     m_Version(PdfVersionDefault),
     m_InitialVersion(PdfVersionDefault),
     m_HasXRefStream(false),
-    m_PrevXRefOffset(-1)
+    m_PrevXRefOffset(-1),
+    m_ObjectsPerStream(100)
 {
 }
 
-PdfMemDocument::PdfMemDocument(const shared_ptr<InputStreamDevice>& device, const string_view& password)
+PdfMemDocument::PdfMemDocument(const shared_ptr<InputStreamDevice>& device, const string_view& password,
+        PdfLoadOptions options)
     : PdfMemDocument(true)
 {
     if (device == nullptr)
         PODOFO_RAISE_ERROR(PdfErrorCode::InvalidHandle);
 
-    loadFromDevice(device, password);
+    loadFromDevice(device, password, options);
 }
 
 PdfMemDocument::PdfMemDocument(const PdfMemDocument& rhs) :
@@ -60,7 +63,8 @@ PdfMemDocument::PdfMemDocument(const PdfMemDocument& rhs) :
     m_Version(rhs.m_Version),
     m_InitialVersion(rhs.m_InitialVersion),
     m_HasXRefStream(rhs.m_HasXRefStream),
-    m_PrevXRefOffset(rhs.m_PrevXRefOffset)
+    m_PrevXRefOffset(rhs.m_PrevXRefOffset),
+    m_ObjectsPerStream(rhs.m_ObjectsPerStream)
 {
     auto encryptObj = GetTrailer().GetDictionary().FindKey("Encrypt");
     if (encryptObj != nullptr)
@@ -110,36 +114,65 @@ void PdfMemDocument::initFromParser(PdfParser& parser)
     Init();
 }
 
-void PdfMemDocument::Load(const string_view& filename, const string_view& password)
+void PdfMemDocument::Load(const string_view& filename, const string_view& password, PdfLoadOptions options)
 {
     if (filename.length() == 0)
         PODOFO_RAISE_ERROR(PdfErrorCode::InvalidHandle);
 
-    auto device = std::make_shared<FileStreamDevice>(filename);
-    LoadFromDevice(device, password);
+    // Map the file, so the parser reads it without copies
+    auto device = std::make_shared<MmapStreamDevice>(filename);
+    LoadFromDevice(device, password, options);
 }
 
-void PdfMemDocument::LoadFromBuffer(const bufferview& buffer, const string_view& password)
+void PdfMemDocument::LoadFromBuffer(const bufferview& buffer, const string_view& password, PdfLoadOptions options)
 {
     if (buffer.size() == 0)
         PODOFO_RAISE_ERROR(PdfErrorCode::InvalidHandle);
 
     auto device = std::make_shared<SpanStreamDevice>(buffer);
-    LoadFromDevice(device, password);
+    LoadFromDevice(device, password, options);
 }
 
-void PdfMemDocument::LoadFromDevice(const shared_ptr<InputStreamDevice>& device, const string_view& password)
+void PdfMemDocument::LoadFromDevice(const shared_ptr<InputStreamDevice>& device, const string_view& password,
+    PdfLoadOptions options)
 {
     if (device == nullptr)
         PODOFO_RAISE_ERROR(PdfErrorCode::InvalidHandle);
 
     this->Clear();
-    loadFromDevice(device, password);
+    loadFromDevice(device, password, options);
 }
 
-void PdfMemDocument::loadFromDevice(const shared_ptr<InputStreamDevice>& device, const string_view& password)
+void PdfMemDocument::loadFromDevice(const shared_ptr<InputStreamDevice>& device, const string_view& password,
+    PdfLoadOptions options)
 {
     m_device = device;
+    if ((options & PdfLoadOptions::ArenaAllocation) != PdfLoadOptions::None)
+        GetObjects().enableArena();
+
+    if ((options & PdfLoadOptions::Peek) != PdfLoadOptions::None)
+    {
+        if ((options & PdfLoadOptions::ConcurrentRead) != PdfLoadOptions::None)
+            PODOFO_RAISE_ERROR_INFO(PdfErrorCode::InvalidHandle, "Peek loading can't be combined with concurrent reads");
+
+        // The parser is owned by the objects list, which uses
+        // it to read the objects when they are looked up
+        auto& objects = GetObjects();
+        objects.m_peekParser = new PdfParser(objects);
+        try
+        {
+            objects.m_peekParser->SetPassword(password);
+            objects.m_peekParser->Peek(*device);
+        }
+        catch (...)
+        {
+            objects.releasePeekParser();
+            throw;
+        }
+
+        initFromParser(*objects.m_peekParser);
+        return;
+    }
 
     // Call parse file instead of using the constructor
     // so that m_Parser is initialized for encrypted documents
@@ -147,6 +180,15 @@ void PdfMemDocument::loadFromDevice(const shared_ptr<InputStreamDevice>& device,
     parser.SetPassword(password);
     parser.Parse(*device, true);
     initFromParser(parser);
+
+    if ((options & PdfLoadOptions::ConcurrentRead) != PdfLoadOptions::None)
+    {
+        GetObjects().enableConcurrentRead(*device);
+
+        // Build the whole page list now, as it's lazily
+        // created by otherwise read-only accessors
+        GetPages().initPages();
+    }
 }
 
 void PdfMemDocument::AddPdfExtension(const PdfName& ns, int64_t level)
@@ -229,6 +271,16 @@ void PdfMemDocument::RemovePdfExtension(const PdfName& ns, int64_t level)
 
 void PdfMemDocument::Save(const string_view& filename, PdfSaveOptions options)
 {
+    // Truncating the file the document is mapped from would
+    // invalidate the data still referenced by the objects
+    auto mmapDevice = dynamic_cast<const MmapStreamDevice*>(m_device.get());
+    if (mmapDevice != nullptr && fs::exists(fs::u8path(filename))
+        && fs::equivalent(fs::u8path(mmapDevice->GetFilepath()), fs::u8path(filename)))
+    {
+        PODOFO_RAISE_ERROR_INFO(PdfErrorCode::InvalidDeviceOperation,
+            "Can't overwrite the file the document was loaded from, use SaveUpdate() instead");
+    }
+
     FileStreamDevice device(filename, FileMode::Create);
     this->Save(device, options);
 }
@@ -240,6 +292,7 @@ void PdfMemDocument::Save(OutputStreamDevice& device, PdfSaveOptions opts)
     PdfWriter writer(this->GetObjects(), this->GetTrailer().GetObject());
     writer.SetPdfVersion(this->GetPdfVersion());
     writer.SetSaveOptions(opts);
+    writer.SetObjectsPerStream(m_ObjectsPerStream);
 
     if (m_Encrypt != nullptr)
         writer.SetEncrypt(*m_Encrypt);
@@ -295,6 +348,14 @@ void PdfMemDocument::SaveUpdate(OutputStreamDevice& device, PdfSaveOptions opts)
     }
 }
 
+void PdfMemDocument::SetObjectsPerStream(unsigned count)
+{
+    if (count == 0 || count > numeric_limits<uint16_t>::max())
+        PODOFO_RAISE_ERROR_INFO(PdfErrorCode::ValueOutOfRange, "The count of objects per stream must be between 1 and 65535");
+
+    m_ObjectsPerStream = count;
+}
+
 void PdfMemDocument::beforeWrite(PdfSaveOptions opts)
 {
     if ((opts & PdfSaveOptions::NoMetadataUpdate) ==
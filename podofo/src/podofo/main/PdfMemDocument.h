@@ -43,7 +43,8 @@ public:
      */
     PdfMemDocument();
 
-    PdfMemDocument(const std::shared_ptr<InputStreamDevice>& device, const std::string_view& password = { });
+    PdfMemDocument(const std::shared_ptr<InputStreamDevice>& device, const std::string_view& password = { },
+        PdfLoadOptions options = PdfLoadOptions::None);
 
     /** Construct a copy of the given document
      */
@@ -52,34 +53,45 @@ public:
     /** Load a PdfMemDocument from a file
      *
      *  \param filename filename of the file which is going to be parsed/opened
+     *  \param options options to control how the document is loaded
+     *
+     *  The file is memory mapped and stays mapped until the document
+     *  is cleared or destroyed, so raw stream data is not copied
      *
      *  When the bForUpdate is set to true, the filename is copied
      *  for later use by WriteUpdate.
      *
      *  \see WriteUpdate, LoadFromBuffer, LoadFromDevice
      */
-    void Load(const std::string_view& filename, const std::string_view& password = { });
+    void Load(const std::string_view& filename, const std::string_view& password = { },
+        PdfLoadOptions options = PdfLoadOptions::None);
 
     /** Load a PdfMemDocument from a buffer in memory
      *
      *  \param buffer a memory area containing the PDF data
+     *  \param options options to control how the document is loaded
      *
      *  \see WriteUpdate, Load, LoadFromDevice
      */
-    void LoadFromBuffer(const bufferview& buffer, const std::string_view& password = { });
+    void LoadFromBuffer(const bufferview& buffer, const std::string_view& password = { },
+        PdfLoadOptions options = PdfLoadOptions::None);
 
     /** Load a PdfMemDocument from a PdfRefCountedInputDevice
      *
      *  \param device the input device containing the PDF
+     *  \param options options to control how the document is loaded
      *
      *  \see WriteUpdate, Load, LoadFromBuffer
      */
-    void LoadFromDevice(const std::shared_ptr<InputStreamDevice>& device, const std::string_view& password = { });
+    void LoadFromDevice(const std::shared_ptr<InputStreamDevice>& device, const std::string_view& password = { },
+        PdfLoadOptions options = PdfLoadOptions::None);
 
     /** Save the complete document to a file
      *
      *  \param filename filename of the document
      *
+     *  \remarks The file can't be the same the document was loaded from
+     *
      *  \see Save, SaveUpdate
      *
      *  This is an overloaded member function for your convenience.
@@ -126,6 +138,15 @@ public:
      */
     void SaveUpdate(OutputStreamDevice& device, PdfSaveOptions opts = PdfSaveOptions::None);
 
+    /** Set the maximum count of objects packed in a single
+     *  object stream when saving with PdfSaveOptions::ObjectStreams
+     *  \param count the count of objects, between 1 and 65535.
+     *      Default is 100
+     */
+    void SetObjectsPerStream(unsigned count);
+
+    inline unsigned GetObjectsPerStream() const { return m_ObjectsPerStream; }
+
     /** Add a vendor-specific extension to the current PDF version.
      *  \param ns namespace of the extension
      *  \param level level of the extension
@@ -229,7 +250,8 @@ private:
     PdfMemDocument(bool empty);
 
 private:
-    void loadFromDevice(const std::shared_ptr<InputStreamDevice>& device, const std::string_view& password);
+    void loadFromDevice(const std::shared_ptr<InputStreamDevice>& device, const std::string_view& password,
+        PdfLoadOptions options);
 
     /** Internal method to load all objects from a PdfParser object.
      *  The objects will be removed from the parser and are now
@@ -252,6 +274,7 @@ private:
     PdfVersion m_InitialVersion;
     bool m_HasXRefStream;
     int64_t m_PrevXRefOffset;
+    unsigned m_ObjectsPerStream;
     std::shared_ptr<PdfEncrypt> m_Encrypt;
     std::shared_ptr<InputStreamDevice> m_device;
 };
@@ -28,6 +28,7 @@ void PdfMemoryObjectStream::Init(PdfObject& obj)
 void PdfMemoryObjectStream::Clear()
 {
     m_buffer.clear();
+    m_view = { };
 }
 
 bool PdfMemoryObjectStream::TryCopyFrom(const PdfObjectStreamProvider& rhs)
@@ -36,7 +37,11 @@ bool PdfMemoryObjectStream::TryCopyFrom(const PdfObjectStreamProvider& rhs)
     if (memstream == nullptr)
         return false;
 
-    m_buffer = memstream->m_buffer;
+    // NOTE: Always copy the data, so the copy doesn't depend
+    // on the lifetime of a mapped source document
+    auto view = memstream->GetView();
+    m_buffer.assign(view.data(), view.size());
+    m_view = { };
     return true;
 }
 
@@ -46,35 +51,42 @@ bool PdfMemoryObjectStream::TryMoveFrom(PdfObjectStreamProvider&& rhs)
     if (memstream == nullptr)
         return false;
 
+    // NOTE: Copy the data of a view first, as it references
+    // the mapped device of the source document, which may
+    // be closed before this stream is released
+    memstream->ensureBuffer();
     m_buffer = std::move(memstream->m_buffer);
+    m_view = { };
     return true;
 }
 
 unique_ptr<InputStream> PdfMemoryObjectStream::GetInputStream(PdfObject& obj)
 {
     (void)obj;
-    return unique_ptr<InputStream>(new SpanStreamDevice(m_buffer));
+    return unique_ptr<InputStream>(new SpanStreamDevice(GetView()));
 }
 
 unique_ptr<OutputStream> PdfMemoryObjectStream::GetOutputStream(PdfObject& obj)
 {
     (void)obj;
     m_buffer.clear();
+    m_view = { };
     return unique_ptr<OutputStream>(new StringStreamDevice(m_buffer));
 }
 
 void PdfMemoryObjectStream::Write(OutputStream& stream, const PdfStatefulEncrypt& encrypt)
 {
+    auto view = GetView();
     stream.Write("stream\n");
     if (encrypt.HasEncrypt())
     {
         charbuff encrypted;
-        encrypt.EncryptTo(encrypted, { m_buffer.data(), m_buffer.size() });
+        encrypt.EncryptTo(encrypted, view);
         stream.Write(encrypted);
     }
     else
     {
-        stream.Write(string_view(m_buffer.data(), m_buffer.size()));
+        stream.Write(view.data(), view.size());
     }
 
     stream.Write("\nendstream\n");
@@ -83,5 +95,39 @@ void PdfMemoryObjectStream::Write(OutputStream& stream, const PdfStatefulEncrypt
 
 size_t PdfMemoryObjectStream::GetLength() const
 {
-    return m_buffer.size();
+    unique_lock<mutex> lock(m_mutex);
+    return m_view.data() == nullptr ? m_buffer.size() : m_view.size();
+}
+
+const charbuff& PdfMemoryObjectStream::GetBuffer() const
+{
+    // NOTE: Streams of documents loaded with PdfLoadOptions::ConcurrentRead
+    // may be read by multiple threads, which must not copy the view twice
+    unique_lock<mutex> lock(m_mutex);
+    ensureBuffer();
+    return m_buffer;
+}
+
+bufferview PdfMemoryObjectStream::GetView() const
+{
+    unique_lock<mutex> lock(m_mutex);
+    if (m_view.data() == nullptr)
+        return bufferview(m_buffer.data(), m_buffer.size());
+    else
+        return m_view;
+}
+
+void PdfMemoryObjectStream::InitView(const bufferview& view)
+{
+    m_buffer.clear();
+    m_view = view;
+}
+
+void PdfMemoryObjectStream::ensureBuffer() const
+{
+    if (m_view.data() == nullptr)
+        return;
+
+    m_buffer.assign(m_view.data(), m_view.size());
+    m_view = { };
 }
@@ -9,6 +9,8 @@
 
 #include "PdfDeclarations.h"
 
+#include <mutex>
+
 #include "PdfObjectStreamProvider.h"
 
 namespace PoDoFo {
@@ -22,12 +24,17 @@ namespace PoDoFo {
  *  to draw onto a page or binary data like a font or an image.
  *
  *  A PdfMemoryObjectStream is implicitly shared and can therefore be copied very quickly.
+ *
+ *  When loaded from a memory mapped document, the stream just
+ *  references the raw bytes in the mapping and it's copied
+ *  only when modified or copied to another object.
  */
 class PODOFO_API PdfMemoryObjectStream final : public PdfObjectStreamProvider
 {
     friend class PdfObject;
     friend class PdfIndirectObjectList;
     friend class PdfImmediateWriter;
+    friend class PdfObjectStream;
 
 private:
     PdfMemoryObjectStream();
@@ -49,10 +56,26 @@ public:
 
     size_t GetLength() const override;
 
-    const charbuff& GetBuffer() const { return m_buffer; }
+    /** Get the stream raw data, copying it first if
+     * it's still referencing a memory mapped document
+     * \remarks It's safe to call concurrently with the
+     * other const methods
+     */
+    const charbuff& GetBuffer() const;
+
+    /** Get a view of the stream raw data, without copies
+     */
+    bufferview GetView() const;
+
+private:
+    void InitView(const bufferview& view);
+
+    void ensureBuffer() const;
 
  private:
-    charbuff m_buffer;
+    mutable std::mutex m_mutex; // Guards the copy of the view to the buffer
+    mutable charbuff m_buffer;
+    mutable bufferview m_view;
 };
 
 };
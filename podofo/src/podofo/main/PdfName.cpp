@@ -12,6 +12,7 @@
 #include <podofo/auxiliary/OutputDevice.h>
 #include "PdfTokenizer.h"
 #include "PdfPredefinedEncoding.h"
+#include "PdfArenaAllocator.h"
 
 using namespace std;
 using namespace PoDoFo;
@@ -22,6 +23,40 @@ void hexchr(const unsigned char ch, T& it);
 static void EscapeNameTo(string& dst, const string_view& view);
 static string UnescapeName(const string_view& view);
 
+// Names that are interned as atoms. They are all
+// ASCII, so raw data and utf8 representation coincide
+static constexpr string_view s_atomNames[] = {
+    "",
+    "A", "AA", "AP", "AS", "AcroForm", "Action", "Alternate", "Annot", "Annots",
+    "ArtBox", "Ascent", "Author", "BBox", "BaseEncoding", "BaseFont", "BitsPerComponent",
+    "BleedBox", "Border", "CIDFontType0", "CIDFontType2", "CIDSystemInfo", "CIDToGIDMap",
+    "CapHeight", "Catalog", "ColorSpace", "Colors", "Columns", "Contents", "Count",
+    "CreationDate", "Creator", "CropBox", "D", "DA", "DR", "DW", "Decode", "DecodeParms",
+    "Descent", "DescendantFonts", "Dest", "Dests", "DeviceCMYK", "DeviceGray", "DeviceRGB",
+    "Differences", "Encoding", "Encrypt", "ExtGState", "F", "FT", "Ff", "Fields", "Filter",
+    "First", "FirstChar", "Flags", "FlateDecode", "Font", "FontBBox", "FontDescriptor",
+    "FontFile", "FontFile2", "FontFile3", "FontName", "Form", "Group", "Height", "ICCBased",
+    "ID", "Image", "ImageMask", "Index", "Indexed", "Info", "ItalicAngle", "Keywords",
+    "Kids", "LastChar", "Length", "Length1", "Length2", "Length3", "Limits", "Link",
+    "Mask", "Matrix", "MediaBox", "Metadata", "ModDate", "N", "Names", "Next", "Nums",
+    "ObjStm", "Outlines", "P", "Page", "Pages", "Parent", "Pattern", "Predictor", "Prev",
+    "ProcSet", "Producer", "Properties", "Rect", "Resources", "Root", "Rotate", "S",
+    "SMask", "Shading", "Size", "StemV", "StructParents", "Subject", "Subtype", "T",
+    "Title", "ToUnicode", "TrimBox", "TrueType", "Type", "Type0", "Type1", "Type3", "URI",
+    "V", "W", "Widget", "Width", "Widths", "XObject", "XRef",
+};
+
+struct PdfName::AtomTable
+{
+    AtomTable();
+
+    vector<unique_ptr<NameData>> Atoms;
+
+    // NOTE: The shared pointers have no control block, see the
+    // aliasing constructor, so copying them has no refcount overhead
+    unordered_map<string_view, shared_ptr<NameData>> Map;
+};
+
 const PdfName PdfName::KeyNull = PdfName();
 const PdfName PdfName::KeyContents = PdfName("Contents");
 const PdfName PdfName::KeyFlags = PdfName("Flags");
@@ -36,8 +71,8 @@ const PdfName PdfName::KeyKids = PdfName("Kids");
 const PdfName PdfName::KeyCount = PdfName("Count");
 
 PdfName::PdfName()
-    : m_data(new NameData{ true, { }, nullptr })
 {
+    (void)tryInitFromAtom({ });
 }
 
 PdfName::PdfName(const char* str)
@@ -61,8 +96,11 @@ PdfName::PdfName(const PdfName& rhs)
 }
 
 PdfName::PdfName(charbuff&& buff)
-    : m_data(new NameData{ false, std::move(buff), nullptr })
 {
+    if (tryInitFromAtom(buff))
+        return;
+
+    m_data = newData(false, std::move(buff), nullptr);
 }
 
 void PdfName::initFromUtf8String(const string_view& view)
@@ -70,29 +108,83 @@ void PdfName::initFromUtf8String(const string_view& view)
     if (view.data() == nullptr)
         throw runtime_error("Name is null");
 
-    if (view.length() == 0)
-    {
-        m_data.reset(new NameData{ true, { }, nullptr });
+    // NOTE: Atoms are ASCII, so the utf8 string is also the raw data
+    if (tryInitFromAtom(view))
         return;
-    }
 
     bool isAsciiEqual;
     if (!PoDoFo::CheckValidUTF8ToPdfDocEcondingChars(view, isAsciiEqual))
         PODOFO_RAISE_ERROR_INFO(PdfErrorCode::InvalidName, "Characters in string must be PdfDocEncoding character set");
 
     if (isAsciiEqual)
-        m_data.reset(new NameData{ true, charbuff(view), nullptr });
+        m_data = newData(true, charbuff(view), nullptr);
     else
-        m_data.reset(new NameData{ true, (charbuff)PoDoFo::ConvertUTF8ToPdfDocEncoding(view), std::make_unique<string>(view) });
+        m_data = newData(true, (charbuff)PoDoFo::ConvertUTF8ToPdfDocEncoding(view), std::make_unique<string>(view));
+}
+
+shared_ptr<PdfName::NameData> PdfName::newData(bool isUtf8Expanded, charbuff&& chars,
+    unique_ptr<string>&& utf8String)
+{
+    // Names built while loading a document with PdfLoadOptions::ArenaAllocation
+    // keep their data in its arena. NOTE: Only the characters that don't fit the
+    // buffer inline storage are still on the heap
+    auto ret = std::allocate_shared<NameData>(PdfArenaAllocator<NameData>::GetCurrent());
+    ret->IsUtf8Expanded = isUtf8Expanded;
+    ret->IsAtom = false;
+    ret->Chars = std::move(chars);
+    ret->Utf8String = std::move(utf8String);
+    return ret;
+}
+
+bool PdfName::tryInitFromAtom(const string_view& raw)
+{
+    auto& atoms = getAtoms().Map;
+    auto found = atoms.find(raw);
+    if (found == atoms.end())
+        return false;
+
+    m_data = found->second;
+    return true;
+}
+
+const PdfName::AtomTable& PdfName::getAtoms()
+{
+    // NOTE: Function static, so it's available also
+    // to static names in other translation units
+    static AtomTable s_atoms;
+    return s_atoms;
+}
+
+PdfName::AtomTable::AtomTable()
+{
+    Atoms.reserve(std::size(s_atomNames));
+    for (auto& name : s_atomNames)
+    {
+        auto& atom = Atoms.emplace_back(new NameData{ true, true, charbuff(name), nullptr });
+        Map[atom->Chars] = shared_ptr<NameData>(shared_ptr<NameData>(), atom.get());
+    }
 }
 
 PdfName PdfName::FromEscaped(const string_view& view)
 {
+    // Most names have no escape sequences: try to
+    // resolve them to atoms without unescaping
+    if (view.find('#') == string_view::npos)
+    {
+        PdfName ret;
+        if (ret.tryInitFromAtom(view))
+            return ret;
+    }
+
     return FromRaw(UnescapeName(view));
 }
 
 PdfName PdfName::FromRaw(const bufferview& rawcontent)
 {
+    PdfName ret;
+    if (ret.tryInitFromAtom(string_view(rawcontent.data(), rawcontent.size())))
+        return ret;
+
     return PdfName((charbuff)rawcontent);
 }
 
@@ -253,15 +345,16 @@ bool PdfName::operator==(const PdfName& rhs) const
     if (this->m_data == rhs.m_data)
         return true;
 
+    // Names equal to an atom are always the atom itself
+    if (this->m_data->IsAtom || rhs.m_data->IsAtom)
+        return false;
+
     return this->m_data->Chars == rhs.m_data->Chars;
 }
 
 bool PdfName::operator!=(const PdfName& rhs) const
 {
-    if (this->m_data == rhs.m_data)
-        return false;
-
-    return this->m_data->Chars != rhs.m_data->Chars;
+    return !operator==(rhs);
 }
 
 bool PdfName::operator==(const char* str) const
@@ -298,6 +391,9 @@ bool PdfName::operator!=(const string_view& view) const
 
 bool PdfName::operator<(const PdfName& rhs) const
 {
+    if (this->m_data == rhs.m_data)
+        return false;
+
     return this->m_data->Chars < rhs.m_data->Chars;
 }
 
@@ -20,10 +20,16 @@ namespace PoDoFo {
  *
  *  PdfName may have a maximum length of 127 characters.
  *
+ *  Commonly used names are interned in a process wide table of atoms:
+ *  names with the same value share the same atom, so they compare
+ *  and hash by identity and don't allocate when created.
+ *
  *  \see PdfObject \see PdfVariant
  */
 class PODOFO_API PdfName final : public PdfDataProvider
 {
+    friend struct std::hash<PdfName>;
+
 public:
     /** Constructor to create nullptr strings.
      *  use PdfName::KeyNull instead of this constructor
@@ -132,17 +138,28 @@ public:
 private:
     void expandUtf8String() const;
     void initFromUtf8String(const std::string_view& view);
+    bool tryInitFromAtom(const std::string_view& raw);
 
 private:
     struct NameData
     {
         bool IsUtf8Expanded;
 
+        // True if the data is an interned atom. There's
+        // always at most one atom with a given value
+        bool IsAtom;
+
         // The unescaped name raw data, without leading '/'.
         // It can store also the utf8 expanded string, if coincident
         charbuff Chars;
         std::unique_ptr<std::string> Utf8String;
     };
+
+    static std::shared_ptr<NameData> newData(bool isUtf8Expanded, charbuff&& chars,
+        std::unique_ptr<std::string>&& utf8String);
+    struct AtomTable;
+
+    static const AtomTable& getAtoms();
 private:
     std::shared_ptr<NameData> m_data;
 };
@@ -158,7 +175,12 @@ namespace std
     {
         size_t operator()(const PoDoFo::PdfName& name) const noexcept
         {
-            return hash<string_view>()(name.GetRawData());
+            // Names equal to an atom are always the atom
+            // itself, so atoms can just be hashed by identity
+            if (name.m_data->IsAtom)
+                return hash<const void*>()(name.m_data.get());
+            else
+                return hash<string_view>()(name.m_data->Chars);
         }
     };
 }
@@ -14,6 +14,9 @@
 #include "PdfStreamedObjectStream.h"
 #include "PdfMemoryObjectStream.h"
 #include <podofo/auxiliary/StreamDevice.h>
+#include <podofo/private/PdfArena.h>
+#include <podofo/private/PdfConcurrentLoader.h>
+#include <podofo/private/PdfFiltersPrivate.h>
 
 using namespace std;
 using namespace PoDoFo;
@@ -160,12 +163,28 @@ void PdfObject::SetDocument(PdfDocument* document)
 
 void PdfObject::DelayedLoad() const
 {
-    if (m_IsDelayedLoadDone)
+    if (m_IsDelayedLoadDone.load(memory_order_acquire))
         return;
 
-    const_cast<PdfObject&>(*this).DelayedLoadImpl();
-    m_IsDelayedLoadDone = true;
-    const_cast<PdfObject&>(*this).SetVariantOwner();
+    auto loader = getConcurrentLoader();
+    if (loader == nullptr)
+    {
+        // Objects loaded on demand belong to the arena of the document, if any
+        PdfArena::Scope scope(m_Document == nullptr ? nullptr : m_Document->GetObjects().m_arena);
+        const_cast<PdfObject&>(*this).DelayedLoadImpl();
+        m_IsDelayedLoadDone.store(true, memory_order_relaxed);
+        const_cast<PdfObject&>(*this).SetVariantOwner();
+    }
+    else
+    {
+        // The object is published to other threads
+        // only after its ownership is set
+        loader->LoadOnce(m_IsDelayedLoadDone, [this]() {
+            PdfArena::Scope scope(m_Document->GetObjects().m_arena);
+            const_cast<PdfObject&>(*this).DelayedLoadImpl();
+            const_cast<PdfObject&>(*this).SetVariantOwner();
+        });
+    }
 }
 
 void PdfObject::DelayedLoadImpl()
@@ -200,9 +219,10 @@ void PdfObject::initObject()
 {
     m_Document = nullptr;
     m_Parent = nullptr;
+    m_IsInArena = false;
     // By default delayed load is disabled
-    m_IsDelayedLoadDone = true;
-    m_IsDelayedLoadStreamDone = true;
+    m_IsDelayedLoadDone.store(true, memory_order_relaxed);
+    m_IsDelayedLoadStreamDone.store(true, memory_order_relaxed);
 }
 
 void PdfObject::Write(OutputStream& device, PdfWriteFlags writeMode,
@@ -233,25 +253,11 @@ void PdfObject::Write(OutputStream& device, PdfWriteFlags writeMode,
 
     if (m_Stream != nullptr)
     {
-        // Try to compress the flate compress the stream if it has no filters,
-        // the compression is not disabled and it's not the /MetaData object,
-        // which must be unfiltered as per PDF/A
-        const PdfObject* metadataObj;
-        if ((writeMode & PdfWriteFlags::NoFlateCompress) == PdfWriteFlags::None
-            && m_Stream->GetFilters().size() == 0
-            && (m_Document == nullptr 
-                || (metadataObj = m_Document->GetCatalog().GetMetadataObject()) == nullptr
-                || m_IndirectReference != metadataObj->GetIndirectReference()))
+        if (shouldFlateCompress(writeMode))
         {
             PdfObject object;
-            auto& stream = object.GetOrCreateStream();
-            {
-                auto output = stream.GetOutputStream({ PdfFilterType::FlateDecode });
-                auto input = m_Stream->GetInputStream();
-                input.CopyTo(output);
-            }
-
-            m_Stream->MoveFrom(stream);
+            flateCompressTo(object, writeMode);
+            m_Stream->MoveFrom(*object.m_Stream);
         }
 
         // Set length if it's not handled by the underlying provider
@@ -280,6 +286,45 @@ void PdfObject::Write(OutputStream& device, PdfWriteFlags writeMode,
     const_cast<PdfObject&>(*this).ResetDirty();
 }
 
+bool PdfObject::shouldFlateCompress(PdfWriteFlags writeMode) const
+{
+    // Try to compress the flate compress the stream if it has no filters,
+    // the compression is not disabled and it's not the /MetaData object,
+    // which must be unfiltered as per PDF/A
+    const PdfObject* metadataObj;
+    return m_Stream != nullptr
+        && (writeMode & PdfWriteFlags::NoFlateCompress) == PdfWriteFlags::None
+        && m_Stream->GetFilters().size() == 0
+        && (m_Document == nullptr
+            || (metadataObj = m_Document->GetCatalog().GetMetadataObject()) == nullptr
+            || m_IndirectReference != metadataObj->GetIndirectReference());
+}
+
+void PdfObject::flateCompressTo(PdfObject& compressed, PdfWriteFlags writeMode) const
+{
+    int level = Z_DEFAULT_COMPRESSION;
+    if ((writeMode & PdfWriteFlags::FlateCompressFast) != PdfWriteFlags::None)
+        level = Z_BEST_SPEED;
+    else if ((writeMode & PdfWriteFlags::FlateCompressBest) != PdfWriteFlags::None)
+        level = Z_BEST_COMPRESSION;
+
+    constexpr size_t BufferSize = 4096;
+    auto& stream = compressed.GetOrCreateStream();
+    auto output = stream.GetOutputStreamRaw({ PdfFilterType::FlateDecode });
+    auto input = m_Stream->GetInputStream();
+    PdfFlateFilter filter(level);
+    filter.BeginEncode(output);
+    char buffer[BufferSize];
+    bool eof;
+    do
+    {
+        size_t read = input.Read(buffer, BufferSize, eof);
+        filter.EncodeBlock({ buffer, read });
+    } while (!eof);
+
+    filter.EndEncode();
+}
+
 PdfObjectStream& PdfObject::GetOrCreateStream()
 {
     DelayedLoadStream();
@@ -353,11 +398,26 @@ void PdfObject::DelayedLoadStream() const
 
 void PdfObject::delayedLoadStream() const
 {
-    if (m_IsDelayedLoadStreamDone)
+    if (m_IsDelayedLoadStreamDone.load(memory_order_acquire))
         return;
 
-    const_cast<PdfObject&>(*this).DelayedLoadStreamImpl();
-    m_IsDelayedLoadStreamDone = true;
+    auto loader = getConcurrentLoader();
+    if (loader == nullptr)
+    {
+        const_cast<PdfObject&>(*this).DelayedLoadStreamImpl();
+        m_IsDelayedLoadStreamDone.store(true, memory_order_relaxed);
+    }
+    else
+    {
+        loader->LoadOnce(m_IsDelayedLoadStreamDone, [this]() {
+            const_cast<PdfObject&>(*this).DelayedLoadStreamImpl();
+        });
+    }
+}
+
+PdfConcurrentLoader* PdfObject::getConcurrentLoader() const
+{
+    return m_Document == nullptr ? nullptr : m_Document->GetObjects().m_loader;
 }
 
 // TODO2: SetDirty only if the value to be added is different
@@ -397,12 +457,12 @@ void PdfObject::moveStreamFrom(PdfObject& obj)
 
 void PdfObject::EnableDelayedLoading()
 {
-    m_IsDelayedLoadDone = false;
+    m_IsDelayedLoadDone.store(false, memory_order_relaxed);
 }
 
 void PdfObject::EnableDelayedLoadingStream()
 {
-    m_IsDelayedLoadStreamDone = false;
+    m_IsDelayedLoadStreamDone.store(false, memory_order_relaxed);
 }
 
 void PdfObject::DelayedLoadStreamImpl()
@@ -433,10 +493,10 @@ void PdfObject::assign(const PdfObject& rhs)
 {
     rhs.DelayedLoad();
     m_Variant = rhs.m_Variant;
-    m_IsDelayedLoadDone = true;
+    m_IsDelayedLoadDone.store(true, memory_order_relaxed);
     SetVariantOwner();
     copyStreamFrom(rhs);
-    m_IsDelayedLoadStreamDone = true;
+    m_IsDelayedLoadStreamDone.store(true, memory_order_relaxed);
 }
 
 // NOTE: Don't move parent document/container and indirect reference.
@@ -445,15 +505,15 @@ void PdfObject::moveFrom(PdfObject& rhs)
 {
     rhs.DelayedLoad();
     m_Variant = std::move(rhs.m_Variant);
-    m_IsDelayedLoadDone = true;
+    m_IsDelayedLoadDone.store(true, memory_order_relaxed);
     SetVariantOwner();
     moveStreamFrom(rhs);
-    m_IsDelayedLoadStreamDone = true;
+    m_IsDelayedLoadStreamDone.store(true, memory_order_relaxed);
 }
 
 void PdfObject::ResetDirty()
 {
-    PODOFO_ASSERT(m_IsDelayedLoadDone);
+    PODOFO_ASSERT(IsDelayedLoadDone());
     // Propagate new dirty state to subclasses
     switch (m_Variant.GetDataType())
     {
@@ -7,12 +7,15 @@
 #ifndef PDF_OBJECT_H
 #define PDF_OBJECT_H
 
+#include <atomic>
+
 #include "PdfVariant.h"
 #include "PdfObjectStream.h"
 
 namespace PoDoFo {
 
 class PdfEncrypt;
+class PdfConcurrentLoader;
 class PdfIndirectObjectList;
 class PdfDictionary;
 class PdfArray;
@@ -29,6 +32,15 @@ class PdfDataContainer;
  *
  * The object can be written to a file easily using the Write() function.
  *
+ * Thread safety: concurrent read-only access to the same object, or to
+ * objects of the same document, from multiple threads is safe only after
+ * the object and its stream (if any) have completed delayed loading,
+ * see IsDelayedLoadDone(). Delayed loading itself mutates the object and
+ * the document input device, so it must not happen concurrently with any
+ * other access, unless the document was loaded with
+ * PdfLoadOptions::ConcurrentRead. Any modification of the object or of
+ * the document requires exclusive access
+ *
  * \see Write()
  */
 class PODOFO_API PdfObject
@@ -41,6 +53,7 @@ class PODOFO_API PdfObject
     friend class PdfDataContainer;
     friend class PdfObjectStreamParser;
     friend class PdfParser;
+    friend class PdfWriter;
 
 public:
     static PdfObject Null;
@@ -408,7 +421,7 @@ public:
      * and loading has completed. External callers should never need to
      * see this, it's an internal state flag only.
      */
-    inline bool IsDelayedLoadDone() const { return m_IsDelayedLoadDone; }
+    inline bool IsDelayedLoadDone() const { return m_IsDelayedLoadDone.load(std::memory_order_acquire); }
 
     const PdfObjectStream* GetStream() const;
     PdfObjectStream* GetStream();
@@ -473,6 +486,16 @@ protected:
 
     void delayedLoadStream() const;
 
+    PdfConcurrentLoader* getConcurrentLoader() const;
+
+    // Determines if the stream must be flate compressed when writing
+    bool shouldFlateCompress(PdfWriteFlags writeMode) const;
+
+    // Flate compress the stream into the stream of another object,
+    // which can then be moved to this one. It's safe to run this
+    // concurrently on different objects
+    void flateCompressTo(PdfObject& compressed, PdfWriteFlags writeMode) const;
+
     void EnableDelayedLoadingStream();
 
     inline void SetIndirectReference(const PdfReference& reference) { m_IndirectReference = reference; }
@@ -530,9 +553,10 @@ private:
     PdfDocument* m_Document;
     PdfDataContainer* m_Parent;
     bool m_IsDirty; // Indicates if this object was modified after construction
+    bool m_IsInArena; // Set on indirect objects allocated from the arena of the document
 
-    mutable bool m_IsDelayedLoadDone;
-    mutable bool m_IsDelayedLoadStreamDone;
+    mutable std::atomic<bool> m_IsDelayedLoadDone;
+    mutable std::atomic<bool> m_IsDelayedLoadStreamDone;
     std::unique_ptr<PdfObjectStream> m_Stream;
     // Tracks whether deferred loading is still pending (in which case it'll be
     // false). If true, deferred loading is not required or has been completed.
@@ -0,0 +1,188 @@
+/**
+ * SPDX-FileCopyrightText: (C) 2024 Francesco Pretto <ceztko@gmail.com>
+ * SPDX-License-Identifier: LGPL-2.0-or-later
+ * SPDX-License-Identifier: MPL-2.0
+ */
+
+#include <podofo/private/PdfDeclarationsPrivate.h>
+#include "PdfObjectImporter.h"
+
+#include "PdfDocument.h"
+#include "PdfPage.h"
+
+using namespace std;
+using namespace PoDoFo;
+
+// See ISO 32000-1:2008 7.7.3.4 "Inheritance of Page Attributes"
+static const string_view s_inheritableAttributes[] = {
+    "Resources"sv,
+    "MediaBox"sv,
+    "CropBox"sv,
+    "Rotate"sv,
+};
+
+PdfObjectImporter::PdfObjectImporter(PdfDocument& destination, const PdfDocument& source)
+    : m_destination(&destination), m_source(&source)
+{
+    if (&destination == &source)
+        PODOFO_RAISE_ERROR_INFO(PdfErrorCode::InvalidHandle, "The source and destination documents must be different");
+}
+
+PdfObject& PdfObjectImporter::ImportObject(const PdfObject& obj)
+{
+    auto& ref = obj.GetIndirectReference();
+    if (m_source->GetObjects().GetObject(ref) != &obj)
+        PODOFO_RAISE_ERROR_INFO(PdfErrorCode::InvalidHandle, "The object is not an indirect object of the source document");
+
+    auto found = m_imported.find(ref);
+    if (found != m_imported.end())
+        return m_destination->GetObjects().MustGetObject(found->second);
+
+    auto& ret = copyObject(obj);
+    remapPending();
+    return ret;
+}
+
+PdfObject& PdfObjectImporter::ImportPage(const PdfPage& page)
+{
+    if (&page.GetDocument() != m_source)
+        PODOFO_RAISE_ERROR_INFO(PdfErrorCode::InvalidHandle, "The page doesn't belong to the source document");
+
+    auto& ret = importPage(page);
+    remapPending();
+    return ret;
+}
+
+vector<PdfObject*> PdfObjectImporter::ImportPages(unsigned pageIndex, unsigned pageCount)
+{
+    auto& pages = m_source->GetPages();
+    if (pageIndex > pages.GetCount() || pageCount > pages.GetCount() - pageIndex)
+        PODOFO_RAISE_ERROR(PdfErrorCode::ValueOutOfRange);
+
+    // Copy all the pages before remapping the references,
+    // so the references between the pages are kept
+    vector<PdfObject*> ret(pageCount);
+    for (unsigned i = 0; i < pageCount; i++)
+        ret[i] = &importPage(pages.GetPageAt(pageIndex + i));
+
+    remapPending();
+    return ret;
+}
+
+PdfObject* PdfObjectImporter::GetImportedObject(const PdfReference& ref) const
+{
+    auto found = m_imported.find(ref);
+    if (found == m_imported.end())
+        return nullptr;
+
+    return m_destination->GetObjects().GetObject(found->second);
+}
+
+unsigned PdfObjectImporter::GetImportedCount() const
+{
+    return (unsigned)m_imported.size();
+}
+
+PdfObject& PdfObjectImporter::importPage(const PdfPage& page)
+{
+    auto found = m_imported.find(page.GetObject().GetIndirectReference());
+    if (found != m_imported.end())
+        return m_destination->GetObjects().MustGetObject(found->second);
+
+    auto& ret = copyObject(page.GetObject());
+    auto& dict = ret.GetDictionary();
+
+    // The page will be inserted in another page tree, and the
+    // inherited attributes must be set on the page itself
+    dict.RemoveKey("Parent");
+    for (auto& key : s_inheritableAttributes)
+    {
+        if (dict.HasKey(key))
+            continue;
+
+        auto attribute = page.GetDictionary().FindKeyParent(key);
+        if (attribute != nullptr)
+            dict.AddKey(PdfName(key), *attribute);
+    }
+
+    return ret;
+}
+
+PdfObject& PdfObjectImporter::copyObject(const PdfObject& obj)
+{
+    // NOTE: The references of the copy still point to the
+    // source document, they are remapped afterwards
+    auto& ret = m_destination->GetObjects().CreateObject(obj);
+    m_imported[obj.GetIndirectReference()] = ret.GetIndirectReference();
+    m_pending.push_back(&ret);
+    return ret;
+}
+
+bool PdfObjectImporter::tryImportReference(const PdfReference& ref, PdfReference& imported)
+{
+    auto found = m_imported.find(ref);
+    if (found != m_imported.end())
+    {
+        imported = found->second;
+        return true;
+    }
+
+    auto obj = m_source->GetObjects().GetObject(ref);
+    if (obj == nullptr)
+        return false;
+
+    // Pages are imported only explicitly
+    if (obj->IsDictionary() && obj->GetDictionary().FindKeyAsSafe<PdfName>(PdfName::KeyType) == "Page")
+        return false;
+
+    imported = copyObject(*obj).GetIndirectReference();
+    return true;
+}
+
+void PdfObjectImporter::remapReferences(PdfObject& obj)
+{
+    switch (obj.GetDataType())
+    {
+        case PdfDataType::Reference:
+        {
+            PdfReference imported;
+            if (tryImportReference(obj.GetReference(), imported))
+                obj = PdfObject(imported);
+            else
+                obj = PdfObject(PdfVariant());
+
+            break;
+        }
+        case PdfDataType::Dictionary:
+        {
+            for (auto& pair : obj.GetDictionary())
+                remapReferences(pair.second);
+
+            break;
+        }
+        case PdfDataType::Array:
+        {
+            for (auto& child : obj.GetArray())
+                remapReferences(child);
+
+            break;
+        }
+        default:
+        {
+            // Nothing to remap
+            break;
+        }
+    }
+}
+
+void PdfObjectImporter::remapPending()
+{
+    // NOTE: Remapping an object may copy other objects,
+    // which are added to the pending list
+    while (m_pending.size() != 0)
+    {
+        auto obj = m_pending.back();
+        m_pending.pop_back();
+        remapReferences(*obj);
+    }
+}
@@ -0,0 +1,89 @@
+/**
+ * SPDX-FileCopyrightText: (C) 2024 Francesco Pretto <ceztko@gmail.com>
+ * SPDX-License-Identifier: LGPL-2.0-or-later
+ * SPDX-License-Identifier: MPL-2.0
+ */
+
+#ifndef PDF_OBJECT_IMPORTER_H
+#define PDF_OBJECT_IMPORTER_H
+
+#include <unordered_map>
+
+#include "PdfReference.h"
+
+namespace PoDoFo {
+
+class PdfDocument;
+class PdfObject;
+class PdfPage;
+
+/** Imports objects from a source document into a destination document,
+ * copying only the objects that are reachable from the imported ones
+ *
+ * The map of the already imported objects is kept, so repeated imports
+ * from the same source share the common objects, like fonts and images
+ * \remarks References to pages of the source document that were not
+ * imported are replaced with null objects, so that importing a page
+ * doesn't pull in the pages linked by its annotations
+ * \remarks The source document must not be modified nor destroyed while
+ * the importer is in use
+ */
+class PODOFO_API PdfObjectImporter final
+{
+public:
+    PdfObjectImporter(PdfDocument& destination, const PdfDocument& source);
+
+public:
+    /** Import an indirect object of the source document,
+     * together with all the objects reachable from it
+     * \returns the imported object in the destination document
+     */
+    PdfObject& ImportObject(const PdfObject& obj);
+
+    /** Import a page of the source document. The inherited attributes
+     * are set on the imported page, which is not inserted in the
+     * page tree of the destination document
+     * \returns the imported page object
+     */
+    PdfObject& ImportPage(const PdfPage& page);
+
+    /** Import a range of pages of the source document
+     * \see ImportPage
+     */
+    std::vector<PdfObject*> ImportPages(unsigned pageIndex, unsigned pageCount);
+
+    /** Get the object that was imported for the given reference
+     * of the source document
+     * \returns the imported object or nullptr if it was not imported
+     */
+    PdfObject* GetImportedObject(const PdfReference& ref) const;
+
+    /** Get the count of the objects imported so far
+     */
+    unsigned GetImportedCount() const;
+
+public:
+    PdfDocument& GetDestination() const { return *m_destination; }
+    const PdfDocument& GetSource() const { return *m_source; }
+
+private:
+    PdfObjectImporter(const PdfObjectImporter&) = delete;
+    PdfObjectImporter& operator=(const PdfObjectImporter&) = delete;
+
+private:
+    PdfObject& importPage(const PdfPage& page);
+    PdfObject& copyObject(const PdfObject& obj);
+    bool tryImportReference(const PdfReference& ref, PdfReference& imported);
+    void remapReferences(PdfObject& obj);
+    void remapPending();
+
+private:
+    PdfDocument* m_destination;
+    const PdfDocument* m_source;
+    std::unordered_map<PdfReference, PdfReference> m_imported;
+    std::vector<PdfObject*> m_pending;
+};
+
+}
+
+#endif // PDF_OBJECT_IMPORTER_H
@@ -12,6 +12,7 @@
 #include "PdfFilter.h"
 #include <podofo/auxiliary/InputDevice.h>
 #include "PdfDictionary.h"
+#include "PdfMemoryObjectStream.h"
 #include <podofo/auxiliary/StreamDevice.h>
 
 using namespace std;
@@ -24,7 +25,7 @@ static bool isMediaFilter(PdfFilterType filterType);
 static PdfFilterList stripMediaFilters(const PdfFilterList& filters, PdfFilterList& mediaFilters);
 
 PdfObjectStream::PdfObjectStream(PdfObject& parent, std::unique_ptr<PdfObjectStreamProvider>&& provider)
-    : m_Parent(&parent), m_Provider(std::move(provider)), m_locked(false)
+    : m_Parent(&parent), m_Provider(std::move(provider)), m_lockCount(0)
 {
     m_Provider->Init(parent);
 }
@@ -57,7 +58,6 @@ PdfObjectOutputStream PdfObjectStream::GetOutputStream(const PdfFilterList& filt
 
 PdfObjectInputStream PdfObjectStream::GetInputStream(bool raw) const
 {
-    ensureClosed();
     return PdfObjectInputStream(const_cast<PdfObjectStream&>(*this), raw);
 }
 
@@ -380,9 +380,35 @@ void PdfObjectStream::InitData(InputStream& stream, size_t size, PdfFilterList&&
     m_Filters = std::move(filterList);
 }
 
+void PdfObjectStream::InitData(const bufferview& view, PdfFilterList&& filterList)
+{
+    auto memstream = dynamic_cast<PdfMemoryObjectStream*>(m_Provider.get());
+    if (memstream == nullptr)
+    {
+        SpanStreamDevice input(view);
+        InitData(input, view.size(), std::move(filterList));
+        return;
+    }
+
+    memstream->InitView(view);
+    m_Filters = std::move(filterList);
+}
+
 void PdfObjectStream::ensureClosed() const
 {
-    PODOFO_RAISE_LOGIC_IF(m_locked, "The stream should have no read/write operations in progress");
+    PODOFO_RAISE_LOGIC_IF(m_lockCount.load(std::memory_order_acquire) != 0,
+        "The stream should have no read/write operations in progress");
+}
+
+// Input streams can be open concurrently, for example
+// when reading a document loaded with ConcurrentRead
+void PdfObjectStream::lockRead()
+{
+    int count = m_lockCount.load(std::memory_order_relaxed);
+    do
+    {
+        PODOFO_RAISE_LOGIC_IF(count < 0, "The stream should have no write operations in progress");
+    } while (!m_lockCount.compare_exchange_weak(count, count + 1, std::memory_order_acquire));
 }
 
 PdfObjectInputStream::PdfObjectInputStream()
@@ -391,7 +417,7 @@ PdfObjectInputStream::PdfObjectInputStream()
 PdfObjectInputStream::~PdfObjectInputStream()
 {
     if (m_stream != nullptr)
-        m_stream->m_locked = false;
+        m_stream->m_lockCount.fetch_sub(1, std::memory_order_release);
 }
 
 PdfObjectInputStream::PdfObjectInputStream(PdfObjectInputStream&& rhs) noexcept
@@ -403,8 +429,16 @@ PdfObjectInputStream::PdfObjectInputStream(PdfObjectInputStream&& rhs) noexcept
 PdfObjectInputStream::PdfObjectInputStream(PdfObjectStream& stream, bool raw)
     : m_stream(&stream)
 {
-    m_stream->m_locked = true;
-    m_input = stream.getInputStream(raw, m_MediaFilters, m_MediaDecodeParms);
+    m_stream->lockRead();
+    try
+    {
+        m_input = stream.getInputStream(raw, m_MediaFilters, m_MediaDecodeParms);
+    }
+    catch (...)
+    {
+        m_stream->m_lockCount.fetch_sub(1, std::memory_order_release);
+        throw;
+    }
 }
 
 size_t PdfObjectInputStream::readBuffer(char* buffer, size_t size, bool& eof)
@@ -458,7 +492,7 @@ PdfObjectOutputStream::~PdfObjectOutputStream()
         }
 
         // Unlock the stream
-        m_stream->m_locked = false;
+        m_stream->m_lockCount.store(0, std::memory_order_release);
 
         auto document = m_stream->GetParent().GetDocument();
         if (document != nullptr)
@@ -515,7 +549,7 @@ PdfObjectOutputStream::PdfObjectOutputStream(PdfObjectStream& stream,
         m_output = stream.m_Provider->GetOutputStream(stream.GetParent());
     }
 
-    m_stream->m_locked = true;
+    m_stream->m_lockCount.store(-1, std::memory_order_relaxed);
 
     if (buffer.size() != 0)
         WriteBuffer(*m_output, buffer.data(), buffer.size());
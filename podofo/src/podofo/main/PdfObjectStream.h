@@ -15,6 +15,8 @@
 #include <podofo/auxiliary/InputStream.h>
 #include "PdfObjectStreamProvider.h"
 
+#include <atomic>
+
 namespace PoDoFo {
 
 class PdfObject;
@@ -89,6 +91,7 @@ class PODOFO_API PdfObjectStream final
     friend class PdfObjectInputStream;
     friend class PdfObjectOutputStream;
     friend class PdfImmediateWriter;
+    friend class PdfWriter;
 
 private:
     /** Create a new PdfObjectStream object which has a parent PdfObject.
@@ -206,6 +209,11 @@ private:
 
     void InitData(InputStream& stream, size_t len, PdfFilterList&& filterList);
 
+    /** Init the data referencing the given view, if supported
+     * by the provider, or copying it otherwise
+     */
+    void InitData(const bufferview& view, PdfFilterList&& filterList);
+
     /** Copy data and non data fields from rhs
      */
     void CopyFrom(const PdfObjectStream& rhs);
@@ -219,6 +227,8 @@ private:
 private:
     void ensureClosed() const;
 
+    void lockRead();
+
     std::unique_ptr<InputStream> getInputStream(bool raw, PdfFilterList& mediaFilters,
         std::vector<const PdfDictionary*>& decodeParms);
 
@@ -232,7 +242,8 @@ private:
     PdfObject* m_Parent;
     std::unique_ptr<PdfObjectStreamProvider> m_Provider;
     PdfFilterList m_Filters;
-    bool m_locked;
+    // Number of the open input streams, or -1 if an output stream is open
+    std::atomic<int> m_lockCount;
 };
 
 };
@@ -7,7 +7,10 @@
 #include <podofo/private/PdfDeclarationsPrivate.h>
 #include "PdfObjectStreamParser.h"
 
-#include <algorithm>
+#include <atomic>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
 
 #include "PdfDictionary.h"
 #include "PdfEncrypt.h"
@@ -19,72 +22,189 @@
 using namespace std;
 using namespace PoDoFo;
 
+// Decoded content of an object stream and its table of
+// contents, shared by all the objects contained in it
+struct PdfObjectStreamParser::StreamIndex
+{
+    PdfIndirectObjectList* Objects;
+    uint32_t StreamObjectNumber;
+    shared_ptr<charbuff> Buffer;
+    charbuff Data;
+    // Object number -> offset of the object in Data
+    unordered_map<uint32_t, size_t> Offsets;
+    bool Decoded = false;
+    // Guards the index when siblings are loaded concurrently
+    mutex Mutex;
+    // Thread decoding the stream, if any
+    atomic<thread::id> DecodingThread;
+
+    void Decode();
+    bool TryReadObject(uint32_t objNum, PdfVariant& var);
+};
+
+// Placeholder for a compressed object that is read from
+// the object stream on first access
+class PdfObjectStreamParser::DelayedObject final : public PdfObject
+{
+public:
+    DelayedObject(const PdfReference& reference, const shared_ptr<StreamIndex>& index)
+        : PdfObject(PdfVariant(), reference, false), m_Index(index)
+    {
+        EnableDelayedLoading();
+    }
+
+protected:
+    void DelayedLoadImpl() override
+    {
+        // Decoding the stream may need an object stored in the
+        // stream itself, eg. when /Length references it
+        if (m_Index->DecodingThread.load(memory_order_relaxed) == this_thread::get_id())
+        {
+            PODOFO_RAISE_ERROR_INFO(PdfErrorCode::BrokenFile,
+                "Object stream {} 0 R depends on the object {} stored in it",
+                m_Index->StreamObjectNumber, GetIndirectReference().ToString());
+        }
+
+        bool found;
+        {
+            unique_lock<mutex> lock(m_Index->Mutex);
+            found = m_Index->TryReadObject(GetIndirectReference().ObjectNumber(), m_Variant);
+        }
+
+        if (!found)
+        {
+            // A reference to a non existing object
+            // shall be treated as null. See ISO 32000-1:2008 7.3.10
+            PoDoFo::LogMessage(PdfLogSeverity::Warning,
+                "Object {} was not found in the object stream {} 0 R",
+                GetIndirectReference().ToString(), m_Index->StreamObjectNumber);
+        }
+
+        // Release the stream as soon as all siblings are loaded
+        m_Index = nullptr;
+    }
+
+private:
+    shared_ptr<StreamIndex> m_Index;
+};
+
 PdfObjectStreamParser::PdfObjectStreamParser(PdfParserObject& parser,
         PdfIndirectObjectList& objects, const shared_ptr<charbuff>& buffer)
-    : m_Parser(&parser), m_Objects(&objects), m_buffer(buffer)
+    : m_Index(new StreamIndex())
 {
     if (buffer == nullptr)
         PODOFO_RAISE_ERROR(PdfErrorCode::InvalidHandle);
+
+    m_Index->Objects = &objects;
+    m_Index->StreamObjectNumber = parser.GetIndirectReference().ObjectNumber();
+    m_Index->Buffer = buffer;
 }
 
 void PdfObjectStreamParser::Parse(const cspan<int64_t>& objectList)
 {
-    int64_t num = m_Parser->GetDictionary().FindKeyAs<int64_t>("N", 0);
-    int64_t first = m_Parser->GetDictionary().FindKeyAs<int64_t>("First", 0);
-
-    charbuff buffer;
-    m_Parser->GetOrCreateStream().CopyTo(buffer);
+    PdfVariant var;
+    for (int64_t objNo : objectList)
+    {
+        if (!m_Index->TryReadObject(static_cast<uint32_t>(objNo), var))
+            continue;
+
+        // The generation number of an object stream and of any
+        // compressed object is implicitly zero
+        auto& objects = *m_Index->Objects;
+        auto obj = objects.newObject<PdfObject>(std::move(var));
+        obj->SetIndirectReference(PdfReference(static_cast<uint32_t>(objNo), 0));
+        try
+        {
+            objects.PushObject(obj);
+        }
+        catch (...)
+        {
+            objects.deleteObject(obj);
+            throw;
+        }
+    }
+}
 
-    this->readObjectsFromStream(buffer.data(), buffer.size(), num, first, objectList);
-    m_Parser = nullptr;
+void PdfObjectStreamParser::ParseDelayed(const cspan<int64_t>& objectList)
+{
+    for (int64_t objNo : objectList)
+    {
+        auto& objects = *m_Index->Objects;
+        auto obj = objects.newObject<DelayedObject>(
+            PdfReference(static_cast<uint32_t>(objNo), 0), m_Index);
+        try
+        {
+            objects.PushObject(obj);
+        }
+        catch (...)
+        {
+            objects.deleteObject(obj);
+            throw;
+        }
+    }
 }
 
-void PdfObjectStreamParser::readObjectsFromStream(char* buffer, size_t bufferLen,
-    int64_t num, int64_t first, const cspan<int64_t>& objectList)
+void PdfObjectStreamParser::StreamIndex::Decode()
 {
-    SpanStreamDevice device(buffer, bufferLen);
-    PdfTokenizer tokenizer(m_buffer);
-    PdfVariant var;
-    int i = 0;
+    // NOTE: The stream object is looked up again because
+    // in delayed mode it may have been replaced meanwhile
+    auto& streamObj = Objects->MustGetObject(PdfReference(StreamObjectNumber, 0));
+    if (Objects->m_loader != nullptr)
+    {
+        // The parser buffer is shared with all the other
+        // object streams, that may be read concurrently
+        Buffer = std::make_shared<charbuff>(PdfTokenizer::BufferSize);
+    }
+
+    int64_t num = streamObj.GetDictionary().FindKeyAs<int64_t>("N", 0);
+    int64_t first = streamObj.GetDictionary().FindKeyAs<int64_t>("First", 0);
+    streamObj.MustGetStream().CopyTo(Data); // NOTE: The stream is already decrypted
+    Offsets.clear();
 
-    while (i < num)
+    SpanStreamDevice device(Data.data(), Data.size());
+    PdfTokenizer tokenizer(Buffer);
+    for (int64_t i = 0; i < num; i++)
     {
         int64_t objNo = tokenizer.ReadNextNumber(device);
         int64_t offset = tokenizer.ReadNextNumber(device);
-        size_t pos = device.GetPosition();
-
-        if (first >= std::numeric_limits<int64_t>::max() - offset)
+        if (first < 0 || offset < 0 || first >= std::numeric_limits<int64_t>::max() - offset
+            || first + offset >= (int64_t)Data.size())
         {
             PODOFO_RAISE_ERROR_INFO(PdfErrorCode::BrokenFile,
                 "Object position out of max limit");
         }
 
-        // move to the position of the object in the stream
-        device.Seek(static_cast<size_t>(first + offset));
+        // Later entries win, as they did when reading sequentially
+        Offsets[static_cast<uint32_t>(objNo)] = static_cast<size_t>(first + offset);
+    }
 
-        // use a second tokenizer here so that anything that gets dequeued isn't left in the tokenizer that reads the offsets and lengths
-        PdfTokenizer variantTokenizer(m_buffer);
-        variantTokenizer.ReadNextVariant(device, var); // NOTE: The stream is already decrypted
+    Decoded = true;
+}
 
-        bool shouldRead = std::find(objectList.begin(), objectList.end(), objNo) != objectList.end();
-#ifndef VERBOSE_DEBUG_DISABLED
-        std::cerr << "ReadObjectsFromStream STREAM=" << m_Parser->GetIndirectReference().ToString() <<
-            ", OBJ=" << objNo <<
-            ", " << (shouldRead ? "read" : "skipped") << std::endl;
-#endif
-        if (shouldRead)
+bool PdfObjectStreamParser::StreamIndex::TryReadObject(uint32_t objNum, PdfVariant& var)
+{
+    if (!Decoded)
+    {
+        DecodingThread.store(this_thread::get_id(), memory_order_relaxed);
+        try
+        {
+            Decode();
+        }
+        catch (...)
         {
-            // The generation number of an object stream and of any
-            // compressed object is implicitly zero
-            PdfReference reference(static_cast<uint32_t>(objNo), 0);
-            auto obj = new PdfObject(std::move(var));
-            obj->SetIndirectReference(reference);
-            m_Objects->PushObject(obj);
+            DecodingThread.store(thread::id(), memory_order_relaxed);
+            throw;
         }
+        DecodingThread.store(thread::id(), memory_order_relaxed);
+    }
 
-        // move back to the position inside of the table of contents
-        device.Seek(pos);
+    auto found = Offsets.find(objNum);
+    if (found == Offsets.end())
+        return false;
 
-        i++;
-    }
+    SpanStreamDevice device(Data.data(), Data.size());
+    device.Seek(found->second);
+    PdfTokenizer tokenizer(Buffer);
+    tokenizer.ReadNextVariant(device, var);
+    return true;
 }
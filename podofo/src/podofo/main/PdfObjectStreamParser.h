@@ -13,7 +13,6 @@
 
 namespace PoDoFo {
 
-class PdfEncrypt;
 class PdfIndirectObjectList;
 
 /**
@@ -27,8 +26,7 @@ class PdfObjectStreamParser
 public:
     /**
      * Create a new PdfObjectStreamParserObject from an existing
-     * PdfParserObject. The PdfParserObject will be removed and deleted.
-     * All objects from the object stream will be read into memory.
+     * PdfParserObject.
      *
      * \param parser PdfParserObject for an object stream
      * \param objects add loaded objects to this vector of objects
@@ -36,15 +34,23 @@ public:
      */
     PdfObjectStreamParser(PdfParserObject& parser, PdfIndirectObjectList& objects, const std::shared_ptr<charbuff>& buffer);
 
+    /** Read all the objects in the list from the stream into memory
+     */
     void Parse(const cspan<int64_t>& objectList);
 
+    /** Add placeholders for the objects in the list that are read on
+     * first access. The stream is decoded and its offset table indexed
+     * only when the first of them is loaded, and it is shared with
+     * the siblings until all of them are loaded
+     */
+    void ParseDelayed(const cspan<int64_t>& objectList);
+
 private:
-    void readObjectsFromStream(char* buffer, size_t lBufferLen, int64_t lNum, int64_t lFirst, const cspan<int64_t>& list);
+    struct StreamIndex;
+    class DelayedObject;
 
 private:
-    PdfParserObject* m_Parser;
-    PdfIndirectObjectList* m_Objects;
-    std::shared_ptr<charbuff> m_buffer;
+    std::shared_ptr<StreamIndex> m_Index;
 };
 
 };
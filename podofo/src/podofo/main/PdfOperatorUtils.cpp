@@ -10,6 +10,80 @@
 using namespace std;
 using namespace PoDoFo;
 
+namespace
+{
+    struct OperatorEntry
+    {
+        uint32_t Key;
+        uint8_t Length;
+        PdfOperator Operator;
+    };
+
+    using OperatorTable = array<OperatorEntry, 256>;
+
+    // Operator names, in the order of the PdfOperator enumeration
+    constexpr string_view s_OperatorNames[] = {
+        "w", "J", "j", "M", "d", "ri", "i", "gs",
+        "q", "Q", "cm",
+        "m", "l", "c", "v", "y", "h", "re",
+        "S", "s", "f", "F", "f*", "B", "B*", "b", "b*", "n",
+        "W", "W*",
+        "BT", "ET",
+        "Tc", "Tw", "Tz", "TL", "Tf", "Tr", "Ts",
+        "Td", "TD", "Tm", "T*",
+        "Tj", "TJ", "'", "\"",
+        "d0", "d1",
+        "CS", "cs", "SC", "SCN", "sc", "scn", "G", "g", "RG", "rg", "K", "k",
+        "sh",
+        "BI", "ID", "EI",
+        "Do",
+        "MP", "DP", "BMC", "BDC", "EMC",
+        "BX", "EX",
+    };
+
+    static_assert(std::size(s_OperatorNames) == (size_t)PdfOperator::EX, "Operator names must match PdfOperator");
+}
+
+// All operators are at most 3 characters long, so
+// the characters are packed in a 32 bit integer key
+static constexpr uint32_t getOperatorKey(const string_view& opstr)
+{
+    uint32_t key = 0;
+    for (size_t i = 0; i < opstr.length(); i++)
+        key |= (uint32_t)(unsigned char)opstr[i] << (i * 8);
+
+    return key;
+}
+
+// Perfect hash for the keys of the operators,
+// found with an exhaustive search of the multiplier
+static constexpr unsigned getOperatorHash(uint32_t key)
+{
+    return (uint32_t)(key * 0x1EDB0E3BU) >> 24;
+}
+
+static constexpr OperatorTable createOperatorTable()
+{
+    OperatorTable table{ };
+    for (size_t i = 0; i < std::size(s_OperatorNames); i++)
+    {
+        auto& name = s_OperatorNames[i];
+        uint32_t key = getOperatorKey(name);
+        auto& entry = table[getOperatorHash(key)];
+        if (entry.Operator != PdfOperator::Unknown)
+            return { }; // Collision, detected below
+
+        entry = { key, (uint8_t)name.length(), (PdfOperator)(i + 1) };
+    }
+
+    return table;
+}
+
+static constexpr OperatorTable s_OperatorTable = createOperatorTable();
+
+static_assert(s_OperatorTable[getOperatorHash(getOperatorKey("EX"))].Operator == PdfOperator::EX,
+    "The operator hash must have no collisions");
+
 PdfOperator PoDoFo::GetPdfOperator(const string_view& opstr)
 {
     PdfOperator op;
@@ -21,376 +95,23 @@ PdfOperator PoDoFo::GetPdfOperator(const string_view& opstr)
 
 bool PoDoFo::TryGetPdfOperator(const string_view& opstr, PdfOperator& op)
 {
-    if (opstr == "w")
-    {
-        op = PdfOperator::w;
-        return true;
-    }
-    else if (opstr == "J")
-    {
-        op = PdfOperator::J;
-        return true;
-    }
-    else if (opstr == "j")
-    {
-        op = PdfOperator::j;
-        return true;
-    }
-    else if (opstr == "M")
-    {
-        op = PdfOperator::M;
-        return true;
-    }
-    else if (opstr == "d")
-    {
-        op = PdfOperator::d;
-        return true;
-    }
-    else if (opstr == "ri")
-    {
-        op = PdfOperator::ri;
-        return true;
-    }
-    else if (opstr == "i")
-    {
-        op = PdfOperator::i;
-        return true;
-    }
-    else if (opstr == "gs")
-    {
-        op = PdfOperator::gs;
-        return true;
-    }
-    else if (opstr == "q")
-    {
-        op = PdfOperator::q;
-        return true;
-    }
-    else if (opstr == "Q")
-    {
-        op = PdfOperator::Q;
-        return true;
-    }
-    else if (opstr == "cm")
-    {
-        op = PdfOperator::cm;
-        return true;
-    }
-    else if (opstr == "m")
-    {
-        op = PdfOperator::m;
-        return true;
-    }
-    else if (opstr == "l")
-    {
-        op = PdfOperator::l;
-        return true;
-    }
-    else if (opstr == "c")
-    {
-        op = PdfOperator::c;
-        return true;
-    }
-    else if (opstr == "v")
-    {
-        op = PdfOperator::v;
-        return true;
-    }
-    else if (opstr == "y")
-    {
-        op = PdfOperator::y;
-        return true;
-    }
-    else if (opstr == "h")
-    {
-        op = PdfOperator::h;
-        return true;
-    }
-    else if (opstr == "re")
-    {
-        op = PdfOperator::re;
-        return true;
-    }
-    else if (opstr == "S")
-    {
-        op = PdfOperator::S;
-        return true;
-    }
-    else if (opstr == "s")
-    {
-        op = PdfOperator::s;
-        return true;
-    }
-    else if (opstr == "f")
-    {
-        op = PdfOperator::f;
-        return true;
-    }
-    else if (opstr == "F")
-    {
-        op = PdfOperator::F;
-        return true;
-    }
-    else if (opstr == "f*")
-    {
-        op = PdfOperator::f_Star;
-        return true;
-    }
-    else if (opstr == "B")
-    {
-        op = PdfOperator::B;
-        return true;
-    }
-    else if (opstr == "B*")
-    {
-        op = PdfOperator::B_Star;
-        return true;
-    }
-    else if (opstr == "b")
-    {
-        op = PdfOperator::b;
-        return true;
-    }
-    else if (opstr == "b*")
-    {
-        op = PdfOperator::b_Star;
-        return true;
-    }
-    else if (opstr == "n")
-    {
-        op = PdfOperator::n;
-        return true;
-    }
-    else if (opstr == "W")
-    {
-        op = PdfOperator::W;
-        return true;
-    }
-    else if (opstr == "W*")
-    {
-        op = PdfOperator::W_Star;
-        return true;
-    }
-    else if (opstr == "BT")
-    {
-        op = PdfOperator::BT;
-        return true;
-    }
-    else if (opstr == "ET")
-    {
-        op = PdfOperator::ET;
-        return true;
-    }
-    else if (opstr == "Tc")
-    {
-        op = PdfOperator::Tc;
-        return true;
-    }
-    else if (opstr == "Tw")
-    {
-        op = PdfOperator::Tw;
-        return true;
-    }
-    else if (opstr == "Tz")
-    {
-        op = PdfOperator::Tz;
-        return true;
-    }
-    else if (opstr == "TL")
-    {
-        op = PdfOperator::TL;
-        return true;
-    }
-    else if (opstr == "Tf")
-    {
-        op = PdfOperator::Tf;
-        return true;
-    }
-    else if (opstr == "Tr")
-    {
-        op = PdfOperator::Tr;
-        return true;
-    }
-    else if (opstr == "Ts")
-    {
-        op = PdfOperator::Ts;
-        return true;
-    }
-    else if (opstr == "Td")
-    {
-        op = PdfOperator::Td;
-        return true;
-    }
-    else if (opstr == "TD")
-    {
-        op = PdfOperator::TD;
-        return true;
-    }
-    else if (opstr == "Tm")
-    {
-        op = PdfOperator::Tm;
-        return true;
-    }
-    else if (opstr == "T*")
-    {
-        op = PdfOperator::T_Star;
-        return true;
-    }
-    else if (opstr == "Tj")
-    {
-        op = PdfOperator::Tj;
-        return true;
-    }
-    else if (opstr == "TJ")
-    {
-        op = PdfOperator::TJ;
-        return true;
-    }
-    else if (opstr == "'")
-    {
-        op = PdfOperator::Quote;
-        return true;
-    }
-    else if (opstr == "\"")
-    {
-        op = PdfOperator::DoubleQuote;
-        return true;
-    }
-    else if (opstr == "d0")
-    {
-        op = PdfOperator::d0;
-        return true;
-    }
-    else if (opstr == "d1")
-    {
-        op = PdfOperator::d1;
-        return true;
-    }
-    else if (opstr == "CS")
-    {
-        op = PdfOperator::CS;
-        return true;
-    }
-    else if (opstr == "cs")
-    {
-        op = PdfOperator::cs;
-        return true;
-    }
-    else if (opstr == "SC")
-    {
-        op = PdfOperator::SC;
-        return true;
-    }
-    else if (opstr == "SCN")
-    {
-        op = PdfOperator::SCN;
-        return true;
-    }
-    else if (opstr == "sc")
+    if (opstr.length() == 0 || opstr.length() > 3)
     {
-        op = PdfOperator::sc;
-        return true;
-    }
-    else if (opstr == "scn")
-    {
-        op = PdfOperator::scn;
-        return true;
-    }
-    else if (opstr == "G")
-    {
-        op = PdfOperator::G;
-        return true;
-    }
-    else if (opstr == "g")
-    {
-        op = PdfOperator::g;
-        return true;
-    }
-    else if (opstr == "RG")
-    {
-        op = PdfOperator::RG;
-        return true;
-    }
-    else if (opstr == "rg")
-    {
-        op = PdfOperator::rg;
-        return true;
-    }
-    else if (opstr == "K")
-    {
-        op = PdfOperator::K;
-        return true;
-    }
-    else if (opstr == "k")
-    {
-        op = PdfOperator::k;
-        return true;
-    }
-    else if (opstr == "sh")
-    {
-        op = PdfOperator::sh;
-        return true;
-    }
-    else if (opstr == "BI")
-    {
-        op = PdfOperator::BI;
-        return true;
-    }
-    else if (opstr == "ID")
-    {
-        op = PdfOperator::ID;
-        return true;
-    }
-    else if (opstr == "EI")
-    {
-        op = PdfOperator::EI;
-        return true;
-    }
-    else if (opstr == "Do")
-    {
-        op = PdfOperator::Do;
-        return true;
-    }
-    else if (opstr == "MP")
-    {
-        op = PdfOperator::MP;
-        return true;
-    }
-    else if (opstr == "DP")
-    {
-        op = PdfOperator::DP;
-        return true;
-    }
-    else if (opstr == "BMC")
-    {
-        op = PdfOperator::BMC;
-        return true;
-    }
-    else if (opstr == "BDC")
-    {
-        op = PdfOperator::BDC;
-        return true;
-    }
-    else if (opstr == "EMC")
-    {
-        op = PdfOperator::EMC;
-        return true;
-    }
-    else if (opstr == "BX")
-    {
-        op = PdfOperator::BX;
-        return true;
-    }
-    else if (opstr == "EX")
-    {
-        op = PdfOperator::EX;
-        return true;
+        op = PdfOperator::Unknown;
+        return false;
     }
-    else
+
+    uint32_t key = getOperatorKey(opstr);
+    auto& entry = s_OperatorTable[getOperatorHash(key)];
+    if (entry.Operator == PdfOperator::Unknown || entry.Key != key
+        || entry.Length != opstr.length())
     {
         op = PdfOperator::Unknown;
         return false;
     }
+
+    op = entry.Operator;
+    return true;
 }
 
 int PoDoFo::GetOperandCount(PdfOperator op)
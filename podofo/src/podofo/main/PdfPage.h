@@ -23,6 +23,7 @@ class PdfDocument;
 class PdfDictionary;
 class PdfIndirectObjectList;
 class InputStream;
+class PdfContentStreamCache;
 
 struct PdfTextEntry final
 {
@@ -38,6 +39,10 @@ struct PdfTextExtractParams
 {
     nullable<Rect> ClipRect;
     PdfTextExtractFlags Flags;
+    /** Cache of compiled content streams, to avoid tokenizing
+     * again forms shared by different pages
+     */
+    std::shared_ptr<PdfContentStreamCache> ContentCache;
 };
 
 /** PdfPage is one page in the pdf document.
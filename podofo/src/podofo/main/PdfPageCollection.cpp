@@ -8,6 +8,9 @@
 #include "PdfPageCollection.h"
 
 #include <algorithm>
+#include <atomic>
+#include <mutex>
+#include <thread>
 
 #include "PdfDocument.h"
 #include "PdfArray.h"
@@ -15,6 +18,9 @@
 #include "PdfObject.h"
 #include <podofo/auxiliary/OutputDevice.h>
 #include "PdfPage.h"
+#include "PdfResources.h"
+#include "PdfFont.h"
+#include "PdfCompiledContentStream.h"
 
 using namespace std;
 using namespace PoDoFo;
@@ -31,16 +37,20 @@ namespace
 
 static PdfPageTreeNodeType getPageTreeNodeType(const PdfObject& nodeObj);
 static unsigned getChildCount(const PdfObject& nodeObj);
+static bool tryGetNodeCount(const PdfObject& nodeObj, unsigned& count);
+static void loadObjectTree(const PdfObject& obj, const PdfIndirectObjectList& objects,
+    unordered_set<const PdfObject*>& visited, vector<const PdfObject*>& resources);
+static void loadResourceFonts(const PdfResources& resources);
 
 PdfPageCollection::PdfPageCollection(PdfDocument& doc)
-    : PdfDictionaryElement(doc, "Pages"), m_initialized(true)
+    : PdfDictionaryElement(doc, "Pages"), m_initialized(true), m_lazyInitialized(false)
 {
     m_kidsArray = &GetDictionary().AddKey(PdfName::KeyKids, PdfArray()).GetArray();
     GetDictionary().AddKey(PdfName::KeyCount, static_cast<int64_t>(0));
 }
 
 PdfPageCollection::PdfPageCollection(PdfObject& pagesRoot)
-    : PdfDictionaryElement(pagesRoot), m_initialized(false), m_kidsArray(nullptr)
+    : PdfDictionaryElement(pagesRoot), m_initialized(false), m_lazyInitialized(false), m_kidsArray(nullptr)
 {
 }
 
@@ -48,30 +58,25 @@ PdfPageCollection::~PdfPageCollection()
 {
     for (unsigned i = 0; i < m_Pages.size(); i++)
         delete m_Pages[i];
+
+    for (unsigned i = 0; i < m_detachedPages.size(); i++)
+        delete m_detachedPages[i];
 }
 
 unsigned PdfPageCollection::GetCount() const
 {
-    const_cast<PdfPageCollection&>(*this).initPages();
+    const_cast<PdfPageCollection&>(*this).initPagesLazy();
     return (unsigned)m_Pages.size();
 }
 
 PdfPage& PdfPageCollection::GetPageAt(unsigned index)
 {
-    const_cast<PdfPageCollection&>(*this).initPages();
-    if (index >= m_Pages.size())
-        PODOFO_RAISE_ERROR_INFO(PdfErrorCode::PageNotFound, "Page with index {} not found", index);
-
-    return *m_Pages[index];
+    return getPageAt(index);
 }
 
 const PdfPage& PdfPageCollection::GetPageAt(unsigned index) const
 {
-    const_cast<PdfPageCollection&>(*this).initPages();
-    if (index >= m_Pages.size())
-        PODOFO_RAISE_ERROR_INFO(PdfErrorCode::PageNotFound, "Page with index {} not found", index);
-
-    return *m_Pages[index];
+    return const_cast<PdfPageCollection&>(*this).getPageAt(index);
 }
 
 PdfPage& PdfPageCollection::GetPage(const PdfReference& ref)
@@ -86,6 +91,32 @@ const PdfPage& PdfPageCollection::GetPage(const PdfReference& ref) const
     return getPage(ref);
 }
 
+PdfPage& PdfPageCollection::getPageAt(unsigned index)
+{
+    initPagesLazy();
+    if (index >= m_Pages.size())
+        PODOFO_RAISE_ERROR_INFO(PdfErrorCode::PageNotFound, "Page with index {} not found", index);
+
+    auto page = m_Pages[index];
+    if (page != nullptr)
+        return *page;
+
+    page = tryLoadPage(index);
+    if (page != nullptr)
+    {
+        m_Pages[index] = page;
+        return *page;
+    }
+
+    // The page tree is not consistent with the /Count
+    // of its nodes: load the whole tree instead
+    initPages();
+    if (index >= m_Pages.size())
+        PODOFO_RAISE_ERROR_INFO(PdfErrorCode::PageNotFound, "Page with index {} not found", index);
+
+    return *m_Pages[index];
+}
+
 PdfPage& PdfPageCollection::getPage(const PdfReference& ref) const
 {
     // We have to search through all pages,
@@ -101,6 +132,113 @@ PdfPage& PdfPageCollection::getPage(const PdfReference& ref) const
     PODOFO_RAISE_ERROR(PdfErrorCode::PageNotFound);
 }
 
+void PdfPageCollection::ExtractTextTo(vector<vector<PdfTextEntry>>& entries,
+    const string_view& pattern, const PdfTextExtractParams& params, unsigned threadCount)
+{
+    ExtractTextTo(entries, 0, GetCount(), pattern, params, threadCount);
+}
+
+void PdfPageCollection::ExtractTextTo(vector<vector<PdfTextEntry>>& entries,
+    unsigned pageIndex, unsigned pageCount, const string_view& pattern,
+    const PdfTextExtractParams& params, unsigned threadCount)
+{
+    if ((size_t)pageIndex + pageCount > GetCount())
+        PODOFO_RAISE_ERROR_INFO(PdfErrorCode::PageNotFound, "Page range {}-{} out of bounds", pageIndex, pageIndex + pageCount);
+
+    // Only the pages in the range are loaded
+    vector<PdfPage*> pages(pageCount);
+    for (unsigned i = 0; i < pageCount; i++)
+        pages[i] = &getPageAt(pageIndex + i);
+
+    entries.clear();
+    entries.resize(pageCount);
+
+    // Resolve on this thread everything the extraction will access, since
+    // delayed loading and font creation are not thread safe. After this the
+    // workers will only perform read-only access to the document
+    auto& objects = GetDocument().GetObjects();
+    unordered_set<const PdfObject*> visited;
+    vector<const PdfObject*> resources;
+    for (unsigned i = 0; i < pageCount; i++)
+    {
+        auto& page = *pages[i];
+        // Inherited attributes are looked up in the parents
+        for (auto parent : page.m_parents)
+            (void)parent->GetDictionary();
+
+        auto contents = page.GetDictionary().FindKey("Contents");
+        if (contents != nullptr)
+            loadObjectTree(*contents, objects, visited, resources);
+
+        auto pageResources = page.GetResources();
+        if (pageResources != nullptr)
+        {
+            loadObjectTree(pageResources->GetObject(), objects, visited, resources);
+            loadResourceFonts(*pageResources);
+        }
+    }
+
+    // Nested resources, eg. the ones of form XObjects
+    for (auto obj : resources)
+        loadResourceFonts(PdfResources(const_cast<PdfObject&>(*obj)));
+
+    if (threadCount == 0)
+        threadCount = std::max(1u, std::thread::hardware_concurrency());
+    threadCount = std::min(threadCount, pageCount);
+
+    // Forms shared by the pages are tokenized only once
+    PdfTextExtractParams pageParams = params;
+    if (pageParams.ContentCache == nullptr)
+        pageParams.ContentCache = std::make_shared<PdfContentStreamCache>();
+
+    atomic<unsigned> nextPage(0);
+    exception_ptr error;
+    mutex errorMutex;
+    auto worker = [&]() {
+        while (true)
+        {
+            unsigned i = nextPage.fetch_add(1, memory_order_relaxed);
+            if (i >= pageCount)
+                return;
+
+            try
+            {
+                pages[i]->ExtractTextTo(entries[i], pattern, pageParams);
+            }
+            catch (...)
+            {
+                unique_lock<mutex> lock(errorMutex);
+                if (error == nullptr)
+                    error = std::current_exception();
+
+                // Stop the other workers from taking further pages
+                nextPage.store(pageCount, memory_order_relaxed);
+                return;
+            }
+        }
+    };
+
+    if (threadCount <= 1)
+    {
+        worker();
+    }
+    else
+    {
+        // The calling thread acts as one of the workers
+        vector<thread> threads;
+        threads.reserve(threadCount - 1);
+        for (unsigned i = 1; i < threadCount; i++)
+            threads.emplace_back(worker);
+
+        worker();
+        for (auto& thread : threads)
+            thread.join();
+    }
+
+    if (error != nullptr)
+        std::rethrow_exception(error);
+}
+
 void PdfPageCollection::InsertPageAt(unsigned atIndex, PdfPage& pageObj)
 {
     vector<PdfPage*> objs = { &pageObj };
@@ -110,6 +248,8 @@ void PdfPageCollection::InsertPageAt(unsigned atIndex, PdfPage& pageObj)
 void PdfPageCollection::InsertPagesAt(unsigned atIndex, cspan<PdfPage*> pages)
 {
     FlattenStructure();
+    if (atIndex > m_Pages.size())
+        atIndex = (unsigned)m_Pages.size();
 
     // Insert the pages and fix the indices
     m_Pages.insert(m_Pages.begin() + atIndex, pages.begin(), pages.end());
@@ -131,6 +271,7 @@ void PdfPageCollection::InsertPagesAt(unsigned atIndex, cspan<PdfPage*> pages)
 
 PdfPage& PdfPageCollection::CreatePage(const Rect& size)
 {
+    initPages();
     auto page = new PdfPage(GetDocument(), size);
     InsertPageAt((unsigned)m_Pages.size(), *page);
     return *page;
@@ -170,6 +311,11 @@ void PdfPageCollection::AppendDocumentPages(const PdfDocument& doc, unsigned pag
     return GetDocument().AppendDocumentPages(doc, pageIndex, pageCount);
 }
 
+void PdfPageCollection::AppendDocumentPages(PdfObjectImporter& importer, unsigned pageIndex, unsigned pageCount)
+{
+    return GetDocument().AppendDocumentPages(importer, pageIndex, pageCount);
+}
+
 void PdfPageCollection::InsertDocumentPageAt(unsigned atIndex, const PdfDocument& doc, unsigned pageIndex)
 {
     return GetDocument().InsertDocumentPageAt(atIndex, doc, pageIndex);
@@ -200,21 +346,180 @@ void PdfPageCollection::initPages()
     if (m_initialized)
         return;
 
+    // The lazily loaded pages may have been handed out already. The
+    // /Count of the nodes they were found with may be wrong, so they
+    // are matched by object and get the index of the full traversal
+    unordered_map<const PdfObject*, PdfPage*> loadedPages;
+    for (unsigned i = 0; i < m_Pages.size(); i++)
+    {
+        if (m_Pages[i] != nullptr)
+            loadedPages.emplace(&m_Pages[i]->GetObject(), m_Pages[i]);
+    }
+
+    vector<PdfPage*> pages;
     vector<PdfObject*> parents;
     unsigned count = getChildCount(GetObject());
     if (count != 0)
     {
-        m_Pages.reserve(count);
+        pages.reserve(count);
         unordered_set<PdfObject*> visitedNodes;
-        (void)traversePageTreeNode(GetObject(), count, parents, visitedNodes);
+        (void)traversePageTreeNode(GetObject(), count, pages, parents, visitedNodes, loadedPages);
     }
 
+    // NOTE: The remaining lazily loaded pages are not in the tree
+    for (auto& pair : loadedPages)
+        m_detachedPages.push_back(pair.second);
+
+    m_Pages = std::move(pages);
+    m_kidsCache.clear();
     m_initialized = true;
 }
 
+void PdfPageCollection::initPagesLazy()
+{
+    if (m_initialized || m_lazyInitialized)
+        return;
+
+    // Every page is an indirect object: a bigger
+    // count can't be trusted for the lazy loading
+    unsigned count;
+    if (!tryGetNodeCount(GetObject(), count)
+        || count > GetDocument().GetObjects().getSizeBound())
+    {
+        initPages();
+        return;
+    }
+
+    PdfPage* lastPage = nullptr;
+    if (count != 0)
+    {
+        // Probe the last page: this checks the /Count of the root
+        // against the sum of its kids and of the nodes on the path
+        lastPage = tryLoadPage(count - 1);
+        if (lastPage == nullptr)
+        {
+            initPages();
+            return;
+        }
+    }
+
+    m_Pages.resize(count);
+    if (lastPage != nullptr)
+        m_Pages[count - 1] = lastPage;
+
+    m_lazyInitialized = true;
+}
+
+// Descend the tree to the page with the given index, using the
+// /Count of the nodes. Returns nullptr if the tree is not consistent
+PdfPage* PdfPageCollection::tryLoadPage(unsigned index)
+{
+    vector<PdfObject*> parents;
+    unordered_set<PdfObject*> visitedNodes;
+    PdfObject* node = &GetObject();
+    unsigned remaining = index;
+    while (true)
+    {
+        if (!visitedNodes.insert(node).second)
+            return nullptr;
+
+        auto kids = tryGetKids(*node);
+        if (kids == nullptr)
+            return nullptr;
+
+        parents.push_back(node);
+
+        PdfObject* child = nullptr;
+        for (auto& kid : *kids)
+        {
+            if (remaining < kid.Count)
+            {
+                child = kid.Object;
+                break;
+            }
+
+            remaining -= kid.Count;
+        }
+
+        if (child == nullptr)
+            return nullptr;
+
+        if (getPageTreeNodeType(*child) == PdfPageTreeNodeType::Page)
+        {
+            auto page = new PdfPage(*child, std::move(parents));
+            page->SetIndex(index);
+            return page;
+        }
+
+        node = child;
+    }
+}
+
+// Get the kids of a node with the count of their pages. Returns
+// nullptr if the counts of the kids don't sum up to the /Count
+// of the node, or if some kid is not a valid tree node
+const vector<PdfPageCollection::PageTreeKid>* PdfPageCollection::tryGetKids(PdfObject& node)
+{
+    auto found = m_kidsCache.find(&node);
+    if (found != m_kidsCache.end())
+        return &found->second;
+
+    unsigned nodeCount;
+    auto kidsObj = node.GetDictionary().FindKey("Kids");
+    PdfArray* kidsArr;
+    if (!tryGetNodeCount(node, nodeCount) || kidsObj == nullptr || !kidsObj->TryGetArray(kidsArr))
+        return nullptr;
+
+    vector<PageTreeKid> kids;
+    kids.reserve(kidsArr->GetSize());
+    auto& objects = GetDocument().GetObjects();
+    uint64_t sum = 0;
+    PdfReference ref;
+    for (unsigned i = 0; i < kidsArr->GetSize(); i++)
+    {
+        auto child = &(*kidsArr)[i];
+        if (child->TryGetReference(ref))
+            child = objects.GetObject(ref);
+
+        // NOTE: Missing kids are skipped, like in the full traversal
+        if (child == nullptr)
+            continue;
+
+        if (!child->IsDictionary())
+            return nullptr;
+
+        unsigned count;
+        switch (getPageTreeNodeType(*child))
+        {
+            case PdfPageTreeNodeType::Page:
+                count = 1;
+                break;
+            case PdfPageTreeNodeType::Node:
+                if (!tryGetNodeCount(*child, count))
+                    return nullptr;
+                break;
+            default:
+                return nullptr;
+        }
+
+        // Empty nodes are never descended
+        if (count == 0)
+            continue;
+
+        kids.push_back({ child, count });
+        sum += count;
+    }
+
+    if (sum != nodeCount)
+        return nullptr;
+
+    return &m_kidsCache.emplace(&node, std::move(kids)).first->second;
+}
+
 // Returns the number of the remaining
-unsigned PdfPageCollection::traversePageTreeNode(PdfObject& obj, unsigned count,
-    vector<PdfObject*>& parents, unordered_set<PdfObject*>& visitedNodes)
+unsigned PdfPageCollection::traversePageTreeNode(PdfObject& obj, unsigned count, vector<PdfPage*>& pages,
+    vector<PdfObject*>& parents, unordered_set<PdfObject*>& visitedNodes,
+    unordered_map<const PdfObject*, PdfPage*>& loadedPages)
 {
     PODOFO_ASSERT(count != 0);
     utls::RecursionGuard guard;
@@ -245,7 +550,7 @@ unsigned PdfPageCollection::traversePageTreeNode(PdfObject& obj, unsigned count,
                 if (child == nullptr)
                     continue;
 
-                count = traversePageTreeNode(*child, count, parents, visitedNodes);
+                count = traversePageTreeNode(*child, count, pages, parents, visitedNodes, loadedPages);
                 if (count == 0)
                     break;
             }
@@ -255,9 +560,22 @@ unsigned PdfPageCollection::traversePageTreeNode(PdfObject& obj, unsigned count,
         }
         case PdfPageTreeNodeType::Page:
         {
-            unsigned index = (unsigned)m_Pages.size();
-            auto page = new PdfPage(obj, vector<PdfObject*>(parents));
-            m_Pages.push_back(page);
+            unsigned index = (unsigned)pages.size();
+            PdfPage* page;
+            auto found = loadedPages.find(&obj);
+            if (found != loadedPages.end())
+            {
+                // Reuse the page that was loaded lazily
+                page = found->second;
+                loadedPages.erase(found);
+                page->m_parents = parents;
+            }
+            else
+            {
+                page = new PdfPage(obj, vector<PdfObject*>(parents));
+            }
+
+            pages.push_back(page);
             page->SetIndex(index);
             return count - 1;
         }
@@ -320,3 +638,97 @@ unsigned getChildCount(const PdfObject& nodeObj)
 
     return (unsigned)num;
 }
+
+bool tryGetNodeCount(const PdfObject& nodeObj, unsigned& count)
+{
+    auto countObj = nodeObj.GetDictionary().FindKey("Count");
+    int64_t num;
+    if (countObj == nullptr || !countObj->TryGetNumber(num)
+        || num < 0 || num > numeric_limits<unsigned>::max())
+    {
+        count = 0;
+        return false;
+    }
+
+    count = (unsigned)num;
+    return true;
+}
+
+// Load the given object, its streams and all the objects it
+// references, collecting the /Resources dictionaries found
+void loadObjectTree(const PdfObject& obj, const PdfIndirectObjectList& objects,
+    unordered_set<const PdfObject*>& visited, vector<const PdfObject*>& resources)
+{
+    if (!visited.insert(&obj).second)
+        return;
+
+    switch (obj.GetDataType())
+    {
+        case PdfDataType::Reference:
+        {
+            auto childObj = objects.GetObject(obj.GetReference());
+            if (childObj != nullptr)
+                loadObjectTree(*childObj, objects, visited, resources);
+            break;
+        }
+        case PdfDataType::Array:
+        {
+            for (auto& child : obj.GetArray())
+                loadObjectTree(child, objects, visited, resources);
+            break;
+        }
+        case PdfDataType::Dictionary:
+        {
+            auto& dict = obj.GetDictionary();
+
+            // Image data is not needed for text extraction
+            const PdfName* subtype;
+            if (obj.IsIndirect() && !(dict.TryFindKeyAs("Subtype", subtype) && *subtype == "Image"))
+                (void)obj.GetStream();
+
+            for (auto& pair : dict)
+            {
+                // Don't climb back the page tree
+                if (pair.first == "Parent")
+                    continue;
+
+                if (pair.first == "Resources")
+                {
+                    auto resourcesObj = &pair.second;
+                    if (resourcesObj->IsReference())
+                        resourcesObj = objects.GetObject(resourcesObj->GetReference());
+
+                    if (resourcesObj != nullptr && resourcesObj->IsDictionary()
+                        && visited.find(resourcesObj) == visited.end())
+                    {
+                        resources.push_back(resourcesObj);
+                    }
+                }
+
+                loadObjectTree(pair.second, objects, visited, resources);
+            }
+            break;
+        }
+        default:
+        {
+            // Nothing to do
+            break;
+        }
+    }
+}
+
+// Create all the fonts of the given resources, initializing
+// the lazily computed state accessed during text extraction
+void loadResourceFonts(const PdfResources& resources)
+{
+    auto fontDict = resources.GetDictionary().FindKeyAsSafe<const PdfDictionary*>("Font");
+    if (fontDict == nullptr)
+        return;
+
+    for (auto& pair : *fontDict)
+    {
+        auto font = resources.GetFont(pair.first);
+        if (font != nullptr)
+            (void)font->GetWordSpacingLength(PdfTextState());
+    }
+}
@@ -16,6 +16,7 @@
 namespace PoDoFo {
 
 class PdfObject;
+class PdfObjectImporter;
 class Rect;
 
 /** Class for managing the tree of Pages in a PDF document
@@ -26,6 +27,7 @@ class Rect;
 class PODOFO_API PdfPageCollection final : public PdfDictionaryElement
 {
     friend class PdfDocument;
+    friend class PdfMemDocument;
     friend class PdfPage;
 
 public:
@@ -44,12 +46,17 @@ public:
 
     /** Return the number of pages in document
      *  \returns number of pages
+     *  \remarks For a loaded document the count is read from the root
+     *  /Count, without loading the page tree
      */
     unsigned GetCount() const;
 
     /** Return a PdfPage for the specified Page index
      *  The returned page is owned by the pages tree and
      *  deleted along with it.
+     *  For a loaded document only the page tree nodes on the
+     *  path to the page are loaded, using the /Count of the nodes.
+     *  The whole tree is loaded instead if it's not consistent
      *
      *  \param index page index, 0-based
      *  \returns a pointer to the requested page
@@ -67,6 +74,38 @@ public:
     PdfPage& GetPage(const PdfReference& ref);
     const PdfPage& GetPage(const PdfReference& ref) const;
 
+    /** Extract the text of a range of pages using a pool of worker threads
+     *
+     *  The page objects, their content streams, the resources they
+     *  reference and the fonts are loaded up front on the calling thread,
+     *  so that the workers only perform read-only access to the document
+     *  \param entries receives the text entries of every page, in page order
+     *  \param pageIndex the first page to extract (0-based)
+     *  \param pageCount the number of pages to extract
+     *  \param threadCount the number of workers, or 0 to use the
+     *         hardware concurrency
+     *  Unless params has a ContentCache, the content streams of forms
+     *  shared by the pages are compiled in a cache for the extraction
+     *  \remarks The document must not be modified, nor accessed
+     *  by other threads, while the extraction is in progress.
+     *  If extraction fails on some page, the first exception
+     *  raised by the workers is rethrown
+     *  \see PdfPage::ExtractTextTo
+     */
+    void ExtractTextTo(std::vector<std::vector<PdfTextEntry>>& entries,
+        unsigned pageIndex, unsigned pageCount,
+        const std::string_view& pattern = { },
+        const PdfTextExtractParams& params = { },
+        unsigned threadCount = 0);
+
+    /** Extract the text of all the pages using a pool of worker threads
+     *  \see ExtractTextTo(std::vector<std::vector<PdfTextEntry>>&, unsigned, unsigned, const std::string_view&, const PdfTextExtractParams&, unsigned)
+     */
+    void ExtractTextTo(std::vector<std::vector<PdfTextEntry>>& entries,
+        const std::string_view& pattern = { },
+        const PdfTextExtractParams& params = { },
+        unsigned threadCount = 0);
+
     /** Creates a new page object and inserts it into the internal
      *  page tree.
      *  The returned page is owned by the pages tree and will get deleted along
@@ -108,6 +147,16 @@ public:
      */
     void AppendDocumentPages(const PdfDocument& doc, unsigned pageIndex, unsigned pageCount);
 
+    /** Copies one or more pages from the source document of the importer
+     *  to this document. The objects already imported by the importer,
+     *  for example fonts and images, are shared instead of copied again
+     *  \param importer an importer from another document to this document
+     *  \param pageIndex the first page number to copy (0-based)
+     *  \param pageCount the number of pages to copy
+     *  \remarks The outlines of the source document are not copied
+     */
+    void AppendDocumentPages(PdfObjectImporter& importer, unsigned pageIndex, unsigned pageCount);
+
     /** Inserts existing page from another PdfDocument to this document.
      *  \param atIndex index at which to add the page in this document
      *  \param doc the document to append from
@@ -147,17 +196,40 @@ private:
      */
     void InsertPagesAt(unsigned atIndex, cspan<PdfPage*> pages);
 
+private:
+    struct PageTreeKid
+    {
+        PdfObject* Object;
+        unsigned Count;     ///< Count of the pages under the kid
+    };
+
 private:
     PdfPage& getPage(const PdfReference& ref) const;
 
+    PdfPage& getPageAt(unsigned index);
+
     void initPages();
 
-    unsigned traversePageTreeNode(PdfObject& obj, unsigned count,
-        std::vector<PdfObject*>& parents, std::unordered_set<PdfObject*>& visitedNodes);
+    void initPagesLazy();
+
+    PdfPage* tryLoadPage(unsigned index);
+
+    const std::vector<PageTreeKid>* tryGetKids(PdfObject& node);
+
+    unsigned traversePageTreeNode(PdfObject& obj, unsigned count, std::vector<PdfPage*>& pages,
+        std::vector<PdfObject*>& parents, std::unordered_set<PdfObject*>& visitedNodes,
+        std::unordered_map<const PdfObject*, PdfPage*>& loadedPages);
 
 private:
     bool m_initialized;
+    bool m_lazyInitialized;
+    // NOTE: Before the full initialization the pages
+    // not loaded yet are null
     std::vector<PdfPage*> m_Pages;
+    // Lazily loaded pages that were not found again in the tree by
+    // the full initialization. They are kept to not invalidate references
+    std::vector<PdfPage*> m_detachedPages;
+    std::unordered_map<PdfObject*, std::vector<PageTreeKid>> m_kidsCache;
     PdfArray* m_kidsArray;
 };
 
@@ -21,6 +21,7 @@
 #include "PdfFont.h"
 
 #include <podofo/private/outstringstream.h>
+#include <podofo/private/RegexMatcher.h>
 #include <podofo/auxiliary/StateStack.h>
 
 using namespace std;
@@ -91,6 +92,24 @@ struct EntryOptions
     bool ExtractSubstring;
 };
 
+// Search pattern, prepared once for the whole extraction
+class EntryPattern
+{
+public:
+    EntryPattern(const string_view& pattern, const EntryOptions& options);
+public:
+    bool RegexSearch(const string& str) const;
+    bool IsEmpty() const { return m_pattern.empty(); }
+    const string& GetString() const { return m_pattern; }
+    const string& GetLowerString() const { return m_lowerPattern; }
+private:
+    string m_pattern;
+    string m_lowerPattern;
+    // Linear time matcher, used when it supports the regex
+    unique_ptr<utls::RegexMatcher> m_matcher;
+    unique_ptr<regex> m_regex;
+};
+
 using StringChunk = list<StatefulString>;
 using StringChunkPtr = unique_ptr<StringChunk>;
 using StringChunkList = list<StringChunkPtr>;
@@ -132,8 +151,8 @@ private:
     const PdfPage& m_page;
 public:
     const int PageIndex;
-    const string Pattern;
     const EntryOptions Options;
+    const EntryPattern Pattern;
     const nullable<Rect> ClipRect;
     unique_ptr<Matrix> Rotation;
     vector<PdfTextEntry> &Entries;
@@ -161,10 +180,10 @@ static void splitStringBySpaces(vector<StatefulString> &separatedStrings, const
 static void trimSpacesBegin(StringChunk &chunk);
 static void trimSpacesEnd(StringChunk &chunk);
 static void addEntry(vector<PdfTextEntry> &textEntries, StringChunkList &strings,
-    const string_view &pattern, const EntryOptions &options, const nullable<Rect> &clipRect,
+    const EntryPattern &pattern, const EntryOptions &options, const nullable<Rect> &clipRect,
     int pageIndex, const Matrix* rotation);
 static void addEntryChunk(vector<PdfTextEntry> &textEntries, StringChunkList &strings,
-    const string_view &pattern, const EntryOptions& options, const nullable<Rect> &clipRect,
+    const EntryPattern &pattern, const EntryOptions& options, const nullable<Rect> &clipRect,
     int pageIndex, const Matrix* rotation);
 static void processChunks(const StringChunkList& chunks, string& destString,
     vector<unsigned>& positions, vector<const StatefulString*>& strings,
@@ -190,7 +209,9 @@ void PdfPage::ExtractTextTo(vector<PdfTextEntry>& entries, const string_view& pa
     ExtractionContext context(entries, *this, pattern, params.Flags, params.ClipRect);
 
     // Look FIGURE 4.1 Graphics objects
-    PdfContentStreamReader reader(*this);
+    PdfContentReaderArgs args;
+    args.Cache = params.ContentCache;
+    PdfContentStreamReader reader(*this, args);
     PdfContent content;
     vector<double> lengths;
     vector<unsigned> positions;
@@ -427,7 +448,7 @@ void PdfPage::ExtractTextTo(vector<PdfTextEntry>& entries, const string_view& pa
     context.TryAddLastEntry();
 }
 
-void addEntry(vector<PdfTextEntry> &textEntries, StringChunkList &chunks, const string_view &pattern,
+void addEntry(vector<PdfTextEntry> &textEntries, StringChunkList &chunks, const EntryPattern &pattern,
     const EntryOptions &options, const nullable<Rect> &clipRect, int pageIndex, const Matrix* rotation)
 {
     if (options.TokenizeWords)
@@ -492,7 +513,7 @@ void addEntry(vector<PdfTextEntry> &textEntries, StringChunkList &chunks, const
     }
 }
 
-void addEntryChunk(vector<PdfTextEntry> &textEntries, StringChunkList &chunks, const string_view &pattern,
+void addEntryChunk(vector<PdfTextEntry> &textEntries, StringChunkList &chunks, const EntryPattern &entryPattern,
     const EntryOptions& options, const nullable<Rect> &clipRect, int pageIndex, const Matrix* rotation)
 {
     if (options.TrimSpaces)
@@ -547,21 +568,14 @@ void addEntryChunk(vector<PdfTextEntry> &textEntries, StringChunkList &chunks, c
     unsigned lowerIndex = 0;
     unsigned upperIndexLimit = (unsigned)glyphAddresses.size();
     auto textState = firstStr.State;
-    if (pattern.length() != 0)
+    if (!entryPattern.IsEmpty())
     {
-        PODOFO_INVARIANT(utls::IsValidUtf8String(pattern));
+        auto& pattern = entryPattern.GetString();
         bool match;
         if (options.RegexPattern)
         {
             PODOFO_ASSERT(!(options.MatchWholeWord || options.ExtractSubstring));
-            auto flags = regex_constants::ECMAScript;
-            if (options.IgnoreCase)
-                flags |= regex_constants::icase;
-
-            // NOTE: regex_search returns true when a sub-part of the string
-            // matches the regex
-            regex pieces_regex((string)pattern, flags);
-            match = std::regex_search(str, pieces_regex);
+            match = entryPattern.RegexSearch(str);
         }
         else
         {
@@ -571,14 +585,14 @@ void addEntryChunk(vector<PdfTextEntry> &textEntries, StringChunkList &chunks, c
                 if (options.MatchWholeWord)
                 {
                     if (options.IgnoreCase)
-                        match = isMatchWholeWordSubstring(utls::ToLower(str), utls::ToLower(pattern), pos);
+                        match = isMatchWholeWordSubstring(utls::ToLower(str), entryPattern.GetLowerString(), pos);
                     else
                         match = isMatchWholeWordSubstring(str, pattern, pos);
                 }
                 else
                 {
                     if (options.IgnoreCase)
-                        pos = utls::ToLower(str).find(utls::ToLower(pattern));
+                        pos = utls::ToLower(str).find(entryPattern.GetLowerString());
                     else
                         pos = str.find(pattern);
                     match = pos != string::npos;
@@ -607,14 +621,14 @@ void addEntryChunk(vector<PdfTextEntry> &textEntries, StringChunkList &chunks, c
                 if (options.MatchWholeWord)
                 {
                     if (options.IgnoreCase)
-                        match = utls::ToLower(str) == utls::ToLower(pattern);
+                        match = utls::ToLower(str) == entryPattern.GetLowerString();
                     else
                         match = str == pattern;
                 }
                 else
                 {
                     if (options.IgnoreCase)
-                        match = utls::ToLower(str).find(utls::ToLower(pattern)) != string::npos;
+                        match = utls::ToLower(str).find(entryPattern.GetLowerString()) != string::npos;
                     else
                         match = str.find(pattern) != string::npos;
                 }
@@ -843,8 +857,8 @@ ExtractionContext::ExtractionContext(vector<PdfTextEntry>& entries, const PdfPag
     PdfTextExtractFlags flags , const nullable<Rect>& clipRect) :
     m_page(page),
     PageIndex(page.GetPageNumber() - 1),
-    Pattern(pattern),
     Options(optionsFromFlags(flags)),
+    Pattern(pattern, Options),
     ClipRect(clipRect),
     Entries(entries)
 {
@@ -1386,6 +1400,42 @@ void getSubstringIndices(const vector<unsigned>& positions, unsigned lowerPos, u
     }
 }
 
+EntryPattern::EntryPattern(const string_view& pattern, const EntryOptions& options) :
+    m_pattern(pattern)
+{
+    if (pattern.empty())
+        return;
+
+    PODOFO_INVARIANT(utls::IsValidUtf8String(pattern));
+    if (options.RegexPattern)
+    {
+        if (utls::RegexMatcher::TryCreate(pattern, options.IgnoreCase, m_matcher))
+            return;
+
+        // Fallback to std::regex for the features the
+        // linear time matcher doesn't support
+        auto flags = regex_constants::ECMAScript;
+        if (options.IgnoreCase)
+            flags |= regex_constants::icase;
+
+        m_regex.reset(new regex(m_pattern, flags));
+    }
+    else if (options.IgnoreCase)
+    {
+        m_lowerPattern = utls::ToLower(pattern);
+    }
+}
+
+bool EntryPattern::RegexSearch(const string& str) const
+{
+    // NOTE: The search returns true when a sub-part
+    // of the string matches the regex
+    if (m_matcher != nullptr)
+        return m_matcher->Search(str);
+    else
+        return std::regex_search(str, *m_regex);
+}
+
 EntryOptions optionsFromFlags(PdfTextExtractFlags flags)
 {
     EntryOptions ret;
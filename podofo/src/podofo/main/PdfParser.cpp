@@ -17,6 +17,7 @@
 #include "PdfObjectStream.h"
 #include "PdfVariant.h"
 #include "PdfXRefStreamParserObject.h"
+#include <podofo/private/PdfArena.h>
 
 #include <algorithm>
 
@@ -66,14 +67,31 @@ void PdfParser::reset()
 
     m_IgnoreBrokenObjects = true;
     m_IncrementalUpdateCount = 0;
+
+    m_peekDevice = nullptr;
+    m_peekPending.clear();
+    m_peekObjectStreams.clear();
 }
 
 void PdfParser::Parse(InputStreamDevice& device, bool loadOnDemand)
 {
     reset();
+    parse(device, loadOnDemand);
+}
+
+void PdfParser::Peek(InputStreamDevice& device)
+{
+    reset();
+    m_peekDevice = &device;
+    parse(device, true);
+}
 
+void PdfParser::parse(InputStreamDevice& device, bool loadOnDemand)
+{
     m_LoadOnDemand = loadOnDemand;
 
+    // Route the objects built while parsing to the document arena, if any
+    PdfArena::Scope scope(m_Objects->m_arena);
     try
     {
         if (!IsPdfFile(device))
@@ -660,7 +678,23 @@ void PdfParser::ReadObjects(InputStreamDevice& device)
         }
     }
 
-    readObjectsInternal(device);
+    if (m_peekDevice == nullptr)
+    {
+        readObjectsInternal(device);
+        return;
+    }
+
+    // Only register the objects of the object streams, the
+    // objects are read when they are first looked up
+    m_peekPending.assign(m_entries.GetSize(), true);
+    for (unsigned i = 0; i < m_entries.GetSize(); i++)
+    {
+        auto& entry = m_entries[i];
+        if (entry.Parsed && entry.Type == XRefEntryType::Compressed)
+            m_peekObjectStreams[entry.ObjectNumber].push_back(i);
+    }
+
+    updateDocumentVersion();
 }
 
 void PdfParser::readObjectsInternal(InputStreamDevice& device)
@@ -683,66 +717,9 @@ void PdfParser::readObjectsInternal(InputStreamDevice& device)
             {
                 case XRefEntryType::InUse:
                 {
-                    if (entry.Offset > 0)
-                    {
-                        PdfReference reference(i, (uint16_t)entry.Generation);
-                        unique_ptr<PdfParserObject> obj(new PdfParserObject(m_Objects->GetDocument(), reference, device, (ssize_t)entry.Offset));
-                        try
-                        {
-                            obj->SetEncrypt(m_Encrypt);
-                            if (m_Encrypt != nullptr && obj->IsDictionary())
-                            {
-                                auto typeObj = obj->GetDictionary().GetKey(PdfName::KeyType);
-                                if (typeObj != nullptr && typeObj->IsName() && typeObj->GetName() == "XRef")
-                                {
-                                    // XRef is never encrypted
-                                    obj.reset(new PdfParserObject(m_Objects->GetDocument(), reference, device, (ssize_t)entry.Offset));
-                                    if (m_LoadOnDemand)
-                                        obj->DelayedLoad();
-                                }
-                            }
-
-                            m_Objects->PushObject(obj.release());
-                        }
-                        catch (PdfError& e)
-                        {
-                            if (m_IgnoreBrokenObjects)
-                            {
-                                PoDoFo::LogMessage(PdfLogSeverity::Error, "Error while loading object {} {} R, Offset={}, Index={}",
-                                    obj->GetIndirectReference().ObjectNumber(),
-                                    obj->GetIndirectReference().GenerationNumber(),
-                                    entry.Offset, i);
-                                m_Objects->SafeAddFreeObject(reference);
-                            }
-                            else
-                            {
-                                PODOFO_PUSH_FRAME_INFO(e, "Error while loading object {} {} R, Offset={}, Index={}",
-                                    obj->GetIndirectReference().ObjectNumber(),
-                                    obj->GetIndirectReference().GenerationNumber(),
-                                    entry.Offset, i);
-                                throw e;
-                            }
-                        }
-                    }
-                    else if (entry.Generation == 0)
-                    {
-                        PODOFO_ASSERT(entry.Offset == 0);
-                        // There are broken PDFs which add objects with 'n' 
-                        // and 0 offset and 0 generation number
-                        // to the xref table instead of using free objects
-                        // treating them as free objects
-                        if (m_StrictParsing)
-                        {
-                            PODOFO_RAISE_ERROR_INFO(PdfErrorCode::InvalidXRef,
-                                "Found object with 0 offset which should be 'f' instead of 'n'");
-                        }
-                        else
-                        {
-                            PoDoFo::LogMessage(PdfLogSeverity::Warning,
-                                "Treating object {} 0 R as a free object", i);
-                            m_Objects->AddFreeObject(PdfReference(i, 1));
-                        }
-                    }
+                    if (isPeekPending(i))
+                        readObject(device, i);
+
                     break;
                 }
                 case XRefEntryType::Free:
@@ -755,7 +732,8 @@ void PdfParser::readObjectsInternal(InputStreamDevice& device)
                     break;
                 }
                 case XRefEntryType::Compressed:
-                    compressedObjects[entry.ObjectNumber].push_back(i);
+                    if (isPeekPending(i))
+                        compressedObjects[entry.ObjectNumber].push_back(i);
                     break;
                 default:
                     PODOFO_RAISE_ERROR(PdfErrorCode::InvalidEnumValue);
@@ -777,15 +755,17 @@ void PdfParser::readObjectsInternal(InputStreamDevice& device)
     // all normal objects including object streams are available now,
     // we can parse the object streams safely now.
     //
-    // Note that even if demand loading is enabled we still currently read all
-    // objects from the stream into memory then free the stream.
-    //
+    // If demand loading is enabled the compressed objects are just
+    // registered, and each object stream is decoded only when the
+    // first of its objects is accessed
     for (auto& pair : compressedObjects)
     {
-#ifndef VERBOSE_DEBUG_DISABLED
-        if (m_LoadOnDemand)
-            cerr << "Demand loading on, but can't demand-load from object stream." << endl;
-#endif
+        for (auto num : pair.second)
+        {
+            if (m_peekPending.size() != 0)
+                m_peekPending[(size_t)num] = false;
+        }
+
         readCompressedObjectFromStream((uint32_t)pair.first, pair.second);
         m_Objects->AddObjectStream((uint32_t)pair.first);
     }
@@ -798,14 +778,133 @@ void PdfParser::readObjectsInternal(InputStreamDevice& device)
         // in a second pass, or (if demand loading is enabled) defer it for later.
         for (auto objToLoad : *m_Objects)
         {
+            // NOTE: Objects read from object streams have no stream
             auto obj = dynamic_cast<PdfParserObject*>(objToLoad);
-            obj->ParseStream();
+            if (obj != nullptr)
+                obj->ParseStream();
         }
     }
 
     updateDocumentVersion();
 }
 
+void PdfParser::readObject(InputStreamDevice& device, unsigned index)
+{
+    auto& entry = m_entries[index];
+    if (entry.Offset > 0)
+    {
+        PdfReference reference(index, (uint16_t)entry.Generation);
+        auto obj = m_Objects->newObject<PdfParserObject>(m_Objects->GetDocument(), reference, device, (ssize_t)entry.Offset);
+        try
+        {
+            obj->SetEncrypt(m_Encrypt);
+            if (m_Encrypt != nullptr && obj->IsDictionary())
+            {
+                auto typeObj = obj->GetDictionary().GetKey(PdfName::KeyType);
+                if (typeObj != nullptr && typeObj->IsName() && typeObj->GetName() == "XRef")
+                {
+                    // XRef is never encrypted
+                    m_Objects->deleteObject(obj);
+                    obj = nullptr;
+                    obj = m_Objects->newObject<PdfParserObject>(m_Objects->GetDocument(), reference, device, (ssize_t)entry.Offset);
+                    if (m_LoadOnDemand)
+                        obj->DelayedLoad();
+                }
+            }
+
+            m_Objects->PushObject(obj);
+        }
+        catch (PdfError& e)
+        {
+            m_Objects->deleteObject(obj);
+            if (m_IgnoreBrokenObjects)
+            {
+                PoDoFo::LogMessage(PdfLogSeverity::Error, "Error while loading object {} {} R, Offset={}, Index={}",
+                    reference.ObjectNumber(),
+                    reference.GenerationNumber(),
+                    entry.Offset, index);
+                m_Objects->SafeAddFreeObject(reference);
+            }
+            else
+            {
+                PODOFO_PUSH_FRAME_INFO(e, "Error while loading object {} {} R, Offset={}, Index={}",
+                    reference.ObjectNumber(),
+                    reference.GenerationNumber(),
+                    entry.Offset, index);
+                throw e;
+            }
+        }
+    }
+    else if (entry.Generation == 0)
+    {
+        PODOFO_ASSERT(entry.Offset == 0);
+        // There are broken PDFs which add objects with 'n' 
+        // and 0 offset and 0 generation number
+        // to the xref table instead of using free objects
+        // treating them as free objects
+        if (m_StrictParsing)
+        {
+            PODOFO_RAISE_ERROR_INFO(PdfErrorCode::InvalidXRef,
+                "Found object with 0 offset which should be 'f' instead of 'n'");
+        }
+        else
+        {
+            PoDoFo::LogMessage(PdfLogSeverity::Warning,
+                "Treating object {} 0 R as a free object", index);
+            m_Objects->AddFreeObject(PdfReference(index, 1));
+        }
+    }
+}
+
+void PdfParser::readPeekedObject(uint32_t objectNum)
+{
+    if (objectNum >= m_peekPending.size() || !m_peekPending[objectNum])
+        return;
+
+    auto& entry = m_entries[objectNum];
+    if (!entry.Parsed)
+        return;
+
+    PdfArena::Scope scope(m_Objects->m_arena);
+    switch (entry.Type)
+    {
+        case XRefEntryType::InUse:
+        {
+            m_peekPending[objectNum] = false;
+            readObject(*m_peekDevice, objectNum);
+            break;
+        }
+        case XRefEntryType::Compressed:
+        {
+            auto& objectList = m_peekObjectStreams[entry.ObjectNumber];
+            for (auto num : objectList)
+                m_peekPending[(size_t)num] = false;
+
+            readCompressedObjectFromStream((uint32_t)entry.ObjectNumber, objectList);
+            m_Objects->AddObjectStream((uint32_t)entry.ObjectNumber);
+            break;
+        }
+        default:
+        {
+            // Free objects are registered with the remaining objects
+            break;
+        }
+    }
+}
+
+void PdfParser::readRemainingObjects()
+{
+    PdfArena::Scope scope(m_Objects->m_arena);
+    readObjectsInternal(*m_peekDevice);
+    m_peekPending.clear();
+    m_peekObjectStreams.clear();
+}
+
+bool PdfParser::isPeekPending(unsigned index) const
+{
+    return m_peekPending.size() == 0 || m_peekPending[index];
+}
+
 void PdfParser::readCompressedObjectFromStream(uint32_t objNo, const cspan<int64_t>& objectList)
 {
     // generation number of object streams is always 0
@@ -824,7 +923,10 @@ void PdfParser::readCompressedObjectFromStream(uint32_t objNo, const cspan<int64
     }
 
     PdfObjectStreamParser parserObject(*streamObj, *m_Objects, m_buffer);
-    parserObject.Parse(objectList);
+    if (m_LoadOnDemand)
+        parserObject.ParseDelayed(objectList);
+    else
+        parserObject.Parse(objectList);
 }
 
 void PdfParser::findTokenBackward(InputStreamDevice& device, const char* token, size_t range, size_t searchEnd)
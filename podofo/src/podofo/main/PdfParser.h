@@ -30,6 +30,7 @@ class PODOFO_API PdfParser
     PODOFO_UNIT_TEST(PdfParserTest);
     friend class PdfDocument;
     friend class PdfWriter;
+    friend class PdfIndirectObjectList;
 
 public:
     /** Create a new PdfParser object
@@ -62,6 +63,15 @@ public:
      */
     void Parse(InputStreamDevice& device, bool loadOnDemand = true);
 
+    /** Open a PDF file reading only the cross-reference sections
+     *  and the trailers. The objects are read from the device the first
+     *  time they are looked up in the objects list, so the parser and the
+     *  device must be kept alive while the objects list is used
+     *
+     *  \see PdfLoadOptions::Peek
+     */
+    void Peek(InputStreamDevice& device);
+
     /**
      * \returns true if this PdfWriter creates an encrypted PDF file
      */
@@ -263,6 +273,23 @@ private:
      */
     void readObjectsInternal(InputStreamDevice& device);
 
+    /** Read the object at the given index of the cross-reference
+     *  entries, which must be an in use entry
+     */
+    void readObject(InputStreamDevice& device, unsigned index);
+
+    /** Read the object with the given number of a peeked document,
+     *  if it was not read yet. The objects of the same object stream
+     *  are all read together
+     */
+    void readPeekedObject(uint32_t objectNum);
+
+    /** Read all the objects of a peeked document not read yet
+     */
+    void readRemainingObjects();
+
+    bool isPeekPending(unsigned index) const;
+
     /** Read the object with index from the object stream nObjNo
      *  and push it on the objects vector
      *
@@ -292,6 +319,8 @@ private:
      */
     void reset();
 
+    void parse(InputStreamDevice& device, bool loadOnDemand);
+
     /** Small helper method to retrieve the document id from the trailer
      *
      *  \returns the document id of this PDF document
@@ -335,6 +364,11 @@ private:
     unsigned m_IncrementalUpdateCount;
 
     std::set<size_t> m_visitedXRefOffsets;
+
+    // State of the documents opened with Peek()
+    InputStreamDevice* m_peekDevice;
+    std::vector<bool> m_peekPending;    // Entries whose object was not read yet
+    std::map<int64_t, std::vector<int64_t>> m_peekObjectStreams;
 };
 
 };
@@ -13,9 +13,12 @@
 #include "PdfEncrypt.h"
 #include <podofo/auxiliary/InputDevice.h>
 #include <podofo/auxiliary/InputStream.h>
+#include <podofo/auxiliary/StreamDevice.h>
 #include "PdfParser.h"
 #include "PdfObjectStream.h"
 #include "PdfVariant.h"
+#include "PdfIndirectObjectList.h"
+#include <podofo/private/PdfConcurrentLoader.h>
 
 using namespace PoDoFo;
 using namespace std;
@@ -73,12 +76,24 @@ void PdfParserObject::ParseStream()
 
 void PdfParserObject::DelayedLoadImpl()
 {
-    PdfTokenizer tokenizer;
-    m_device->Seek(m_Offset);
-    if (!m_IsTrailer)
-        checkReference(tokenizer);
+    auto load = [&](InputStreamDevice& device) {
+        PdfTokenizer tokenizer;
+        if (!m_IsTrailer)
+            checkReference(device, tokenizer);
 
-    Parse(tokenizer);
+        parse(device, tokenizer);
+    };
+
+    auto loader = getConcurrentLoader();
+    if (loader == nullptr)
+    {
+        m_device->Seek(m_Offset);
+        load(*m_device);
+    }
+    else
+    {
+        loader->ReadAt(*m_device, m_Offset, load);
+    }
 }
 
 void PdfParserObject::DelayedLoadStreamImpl()
@@ -105,13 +120,18 @@ void PdfParserObject::DelayedLoadStreamImpl()
 PdfReference PdfParserObject::ReadReference(PdfTokenizer& tokenizer)
 {
     m_device->Seek(m_Offset);
-    return readReference(tokenizer);
+    return readReference(*m_device, tokenizer);
+}
+
+void PdfParserObject::Parse(PdfTokenizer& tokenizer)
+{
+    parse(*m_device, tokenizer);
 }
 
 // Only called via the demand loading mechanism
 // Be very careful to avoid recursive demand loads via PdfVariant
 // or PdfObject method calls here.
-void PdfParserObject::Parse(PdfTokenizer& tokenizer)
+void PdfParserObject::parse(InputStreamDevice& device, PdfTokenizer& tokenizer)
 {
     PdfStatefulEncrypt encrypt;
     if (m_Encrypt != nullptr)
@@ -124,18 +144,18 @@ void PdfParserObject::Parse(PdfTokenizer& tokenizer)
 
     PdfTokenType tokenType;
     string_view token;
-    bool gotToken = tokenizer.TryReadNextToken(*m_device, token, tokenType);
+    bool gotToken = tokenizer.TryReadNextToken(device, token, tokenType);
     if (!gotToken)
         PODOFO_RAISE_ERROR_INFO(PdfErrorCode::UnexpectedEOF, "Expected variant");
 
     // Check if we have an empty object or data
     if (token != "endobj")
     {
-        tokenizer.ReadNextVariant(*m_device, token, tokenType, m_Variant, encrypt);
+        tokenizer.ReadNextVariant(device, token, tokenType, m_Variant, encrypt);
 
         if (!m_IsTrailer)
         {
-            gotToken = tokenizer.TryReadNextToken(*m_device, token);
+            gotToken = tokenizer.TryReadNextToken(device, token);
             if (!gotToken)
                 PODOFO_RAISE_ERROR_INFO(PdfErrorCode::UnexpectedEOF, "Expected 'endobj' or (if dict) 'stream', got EOF");
 
@@ -147,7 +167,7 @@ void PdfParserObject::Parse(PdfTokenizer& tokenizer)
             else if (m_Variant.IsDictionary() && token == "stream")
             {
                 m_HasStream = true;
-                m_StreamOffset = m_device->GetPosition(); // NOTE: whitespace after "stream" handle in stream parser!
+                m_StreamOffset = device.GetPosition(); // NOTE: whitespace after "stream" handle in stream parser!
             }
             else
             {
@@ -166,18 +186,52 @@ void PdfParserObject::parseStream()
     PODOFO_ASSERT(IsDelayedLoadDone());
 
     int64_t size = -1;
-    char ch;
-
     auto& lengthObj = this->m_Variant.GetDictionary().MustFindKey(PdfName::KeyLength);
     if (!lengthObj.TryGetNumber(size))
         PODOFO_RAISE_ERROR(PdfErrorCode::InvalidStreamLength);
 
-    m_device->Seek(m_StreamOffset);
+    // NOTE: Resolve everything that may need loading other objects
+    // before reading the device, see PdfConcurrentLoader::ReadAt()
+    if (m_Encrypt != nullptr && !m_Encrypt->IsMetadataEncrypted())
+    {
+        // If metadata is not encrypted the Filter is set to "Crypt"
+        auto filterObj = this->m_Variant.GetDictionary().FindKey(PdfName::KeyFilter);
+        if (filterObj != nullptr && filterObj->IsArray())
+        {
+            auto& filters = filterObj->GetArray();
+            for (unsigned i = 0; i < filters.GetSize(); i++)
+            {
+                auto& obj = filters.MustFindAt(i);
+                if (obj.IsName() && obj.GetName() == "Crypt")
+                    m_Encrypt = nullptr;
+            }
+        }
+    }
 
+    auto filters = PdfFilterFactory::CreateFilterList(*this);
+    auto read = [&](InputStreamDevice& device) {
+        parseStream(device, static_cast<size_t>(size), std::move(filters));
+    };
+
+    auto loader = getConcurrentLoader();
+    if (loader == nullptr)
+    {
+        m_device->Seek(m_StreamOffset);
+        read(*m_device);
+    }
+    else
+    {
+        loader->ReadAt(*m_device, m_StreamOffset, read);
+    }
+}
+
+void PdfParserObject::parseStream(InputStreamDevice& device, size_t size, PdfFilterList&& filters)
+{
+    char ch;
     size_t streamOffset;
     while (true)
     {
-        if (!m_device->Peek(ch))
+        if (!device.Peek(ch))
             PODOFO_RAISE_ERROR_INFO(PdfErrorCode::UnexpectedEOF, "Unexpected EOF when reading stream");
 
         switch (ch)
@@ -187,7 +241,7 @@ void PdfParserObject::parseStream()
             // but certain PDFs have additionals whitespaces
             case ' ':
             case '\t':
-                (void)m_device->ReadChar();
+                (void)device.ReadChar();
                 break;
             // From PDF 32000:2008 7.3.8.1 General
             // "The keyword stream that follows the stream dictionary shall be
@@ -195,64 +249,63 @@ void PdfParserObject::parseStream()
             // RETURN and a LINE FEED or just a LINE FEED, and not by a CARRIAGE
             // RETURN alone"
             case '\r':
-                streamOffset = m_device->GetPosition();
-                (void)m_device->ReadChar();
-                if (!m_device->Peek(ch))
+                streamOffset = device.GetPosition();
+                (void)device.ReadChar();
+                if (!device.Peek(ch))
                     PODOFO_RAISE_ERROR_INFO(PdfErrorCode::UnexpectedEOF, "Unexpected EOF when reading stream");
 
                 if (ch == '\n')
                 {
-                    (void)m_device->ReadChar();
-                    streamOffset = m_device->GetPosition();
+                    (void)device.ReadChar();
+                    streamOffset = device.GetPosition();
                 }
                 goto ReadStream;
             case '\n':
-                (void)m_device->ReadChar();
-                streamOffset = m_device->GetPosition();
+                (void)device.ReadChar();
+                streamOffset = device.GetPosition();
                 goto ReadStream;
             // Assume malformed PDF with no whitespaces after the stream keyword
             default:
-                streamOffset = m_device->GetPosition();
+                streamOffset = device.GetPosition();
                 goto ReadStream;
         }
     }
 
 ReadStream:
-    m_device->Seek(streamOffset);	// reset it before reading!
-    if (m_Encrypt != nullptr && !m_Encrypt->IsMetadataEncrypted())
-    {
-        // If metadata is not encrypted the Filter is set to "Crypt"
-        auto filterObj = this->m_Variant.GetDictionary().FindKey(PdfName::KeyFilter);
-        if (filterObj != nullptr && filterObj->IsArray())
-        {
-            auto& filters = filterObj->GetArray();
-            for (unsigned i = 0; i < filters.GetSize(); i++)
-            {
-                auto& obj = filters.MustFindAt(i);
-                if (obj.IsName() && obj.GetName() == "Crypt")
-                    m_Encrypt = nullptr;
-            }
-        }
-    }
+    device.Seek(streamOffset);	// reset it before reading!
 
     // Set stream raw data without marking the object dirty
     if (m_Encrypt != nullptr)
     {
-        auto input = m_Encrypt->CreateEncryptionInputStream(*m_device, static_cast<size_t>(size), GetIndirectReference());
-        getOrCreateStream().InitData(*input, static_cast<ssize_t>(size), PdfFilterFactory::CreateFilterList(*this));
+        auto input = m_Encrypt->CreateEncryptionInputStream(device, size, GetIndirectReference());
+        getOrCreateStream().InitData(*input, size, std::move(filters));
         // Release the encrypt object after loading the stream.
         // It's not needed for serialization here
         m_Encrypt = nullptr;
     }
     else
     {
-        getOrCreateStream().InitData(*m_device, static_cast<ssize_t>(size), PdfFilterFactory::CreateFilterList(*this));
+        // NOTE: The mapping is accessed by offset,
+        // so it doesn't matter which device is read
+        auto mmapDevice = dynamic_cast<MmapStreamDevice*>(m_device);
+        if (mmapDevice == nullptr)
+        {
+            getOrCreateStream().InitData(device, size, std::move(filters));
+        }
+        else
+        {
+            // Reference the raw data directly in the mapping. The /Length
+            // may be wrong: don't read past the end of the file
+            size = std::min(size, mmapDevice->GetLength() - streamOffset);
+            auto view = mmapDevice->GetView(streamOffset, size);
+            getOrCreateStream().InitData(view, std::move(filters));
+        }
     }
 }
 
-void PdfParserObject::checkReference(PdfTokenizer& tokenizer)
+void PdfParserObject::checkReference(InputStreamDevice& device, PdfTokenizer& tokenizer)
 {
-    auto reference = readReference(tokenizer);
+    auto reference = readReference(device, tokenizer);
     if (GetIndirectReference() != reference)
     {
         PoDoFo::LogMessage(PdfLogSeverity::Warning,
@@ -261,13 +314,13 @@ void PdfParserObject::checkReference(PdfTokenizer& tokenizer)
     }
 }
 
-PdfReference PdfParserObject::readReference(PdfTokenizer& tokenizer)
+PdfReference PdfParserObject::readReference(InputStreamDevice& device, PdfTokenizer& tokenizer)
 {
     PdfReference reference;
     try
     {
-        int64_t obj = tokenizer.ReadNextNumber(*m_device);
-        int64_t gen = tokenizer.ReadNextNumber(*m_device);
+        int64_t obj = tokenizer.ReadNextNumber(device);
+        int64_t gen = tokenizer.ReadNextNumber(device);
         reference = PdfReference(static_cast<uint32_t>(obj), static_cast<uint16_t>(gen));
 
     }
@@ -278,7 +331,7 @@ PdfReference PdfParserObject::readReference(PdfTokenizer& tokenizer)
     }
 
     string_view token;
-    if (!tokenizer.TryReadNextToken(*m_device, token) || token != "obj")
+    if (!tokenizer.TryReadNextToken(device, token) || token != "obj")
     {
         PODOFO_RAISE_ERROR_INFO(PdfErrorCode::NoObject, "Error while reading object {} {} R: Next token is not 'obj'",
             reference.ObjectNumber(), reference.GenerationNumber());
@@ -22,6 +22,7 @@ class PdfEncrypt;
 class PODOFO_API PdfParserObject : public PdfObject
 {
     friend class PdfParser;
+    friend class PdfIndirectObjectList;
 
 private:
     /** Parse the object data from the given file handle starting at
@@ -108,9 +109,13 @@ private:
      */
     void parseStream();
 
-    PdfReference readReference(PdfTokenizer& tokenizer);
+    void parseStream(InputStreamDevice& device, size_t size, PdfFilterList&& filters);
 
-    void checkReference(PdfTokenizer& tokenizer);
+    void parse(InputStreamDevice& device, PdfTokenizer& tokenizer);
+
+    PdfReference readReference(InputStreamDevice& device, PdfTokenizer& tokenizer);
+
+    void checkReference(InputStreamDevice& device, PdfTokenizer& tokenizer);
 
 private:
     std::shared_ptr<PdfEncrypt> m_Encrypt;
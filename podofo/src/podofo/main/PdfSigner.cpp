@@ -9,12 +9,57 @@
 #include "PdfDictionary.h"
 #include <podofo/auxiliary/StreamDevice.h>
 
+#include <atomic>
+#include <thread>
+
 using namespace std;
 using namespace PoDoFo;
 
 constexpr const char* ByteRangeBeacon = "[ 0 1234567890 1234567890 1234567890]";
 constexpr size_t BufferSize = 65536;
 
+namespace
+{
+    /** An output device that forwards the writes to the
+     * document device and feeds the signer with the written
+     * data that precedes the signature beacons, so it
+     * doesn't need to be read back after the write
+     */
+    class SignerTeeDevice final : public OutputStreamDevice
+    {
+    public:
+        SignerTeeDevice(StreamDevice& device, PdfSigner& signer,
+            const PdfSignatureBeacons& beacons, size_t hashedLength);
+
+    public:
+        size_t GetLength() const override;
+        size_t GetPosition() const override;
+        bool Eof() const override;
+        bool CanSeek() const override;
+
+        /** Get the length of the data at the beginning of the
+         * device that was passed to the signer, or 0 if the
+         * writes were not sequential and the data must be read again
+         */
+        size_t GetHashedLength() const;
+
+    protected:
+        void writeBuffer(const char* buffer, size_t size) override;
+        void flush() override;
+        void seek(ssize_t offset, SeekDirection direction) override;
+
+    private:
+        size_t getBeaconsOffset() const;
+
+    private:
+        StreamDevice* m_device;
+        PdfSigner* m_signer;
+        const PdfSignatureBeacons* m_beacons;
+        size_t m_hashedLength;
+        bool m_invalid;
+    };
+}
+
 static size_t readForSignature(StreamDevice& device,
     size_t conentsBeaconOffset, size_t conentsBeaconSize,
     char* buffer, size_t size);
@@ -62,18 +107,36 @@ void PoDoFo::SignDocument(PdfMemDocument& doc, StreamDevice& device, PdfSigner&
         acroForm->GetDictionary().RemoveKey("NeedAppearances");
     }
 
-    doc.SaveUpdate(device, opts);
+    // The document being updated is already in the device,
+    // pass it to the signer before appending the update
+    signer.Reset();
+    charbuff buffer(BufferSize);
+    size_t initialLength = device.GetLength();
+    device.Seek(0);
+    size_t readBytes;
+    for (size_t pos = 0; pos < initialLength; pos += readBytes)
+    {
+        readBytes = std::min(BufferSize, initialLength - pos);
+        device.Read(buffer.data(), readBytes);
+        signer.AppendData({ buffer.data(), readBytes });
+    }
+
+    // The update is passed to the signer while it's written, up
+    // to the signature beacons, which are known only afterwards
+    SignerTeeDevice tee(device, signer, beacons, initialLength);
+    doc.SaveUpdate(tee, opts);
     device.Flush();
 
-    charbuff buffer;
     adjustByteRange(device, *beacons.ByteRangeOffset, *beacons.ContentsOffset,
         beacons.ContentsBeacon.size(), buffer);
     device.Flush();
 
-    // Read data from the device to prepare the signature
-    signer.Reset();
-    device.Seek(0);
-    size_t readBytes;
+    // Read the remaining data from the device to prepare the signature
+    size_t hashedLength = tee.GetHashedLength();
+    if (hashedLength == 0)
+        signer.Reset();
+
+    device.Seek(hashedLength);
     buffer.resize(BufferSize);
     while ((readBytes = readForSignature(device, *beacons.ContentsOffset, beacons.ContentsBeacon.size(),
         buffer.data(), BufferSize)) != 0)
@@ -96,6 +159,69 @@ void PoDoFo::SignDocument(PdfMemDocument& doc, StreamDevice& device, PdfSigner&
     device.Flush();
 }
 
+void PoDoFo::SignDocuments(const cspan<PdfSignJob>& jobs,
+    const function<unique_ptr<PdfSigner>()>& createSigner, unsigned threadCount)
+{
+    if (threadCount == 0)
+        threadCount = std::max(1u, std::thread::hardware_concurrency());
+    threadCount = (unsigned)std::min<size_t>(threadCount, jobs.size());
+
+    atomic<size_t> nextJob(0);
+    exception_ptr error;
+    mutex errorMutex;
+    auto worker = [&]() {
+        while (true)
+        {
+            size_t i = nextJob.fetch_add(1, memory_order_relaxed);
+            if (i >= jobs.size())
+                return;
+
+            try
+            {
+                auto& job = jobs[i];
+                if (job.Document == nullptr || job.Device == nullptr || job.Signature == nullptr)
+                    PODOFO_RAISE_ERROR(PdfErrorCode::InvalidHandle);
+
+                auto signer = createSigner();
+                if (signer == nullptr)
+                    PODOFO_RAISE_ERROR_INFO(PdfErrorCode::InvalidHandle, "The signer factory returned no signer");
+
+                SignDocument(*job.Document, *job.Device, *signer, *job.Signature, job.SaveOptions);
+            }
+            catch (...)
+            {
+                unique_lock<mutex> lock(errorMutex);
+                if (error == nullptr)
+                    error = std::current_exception();
+
+                // Stop the other workers from taking further documents
+                nextJob.store(jobs.size(), memory_order_relaxed);
+                return;
+            }
+        }
+    };
+
+    if (threadCount <= 1)
+    {
+        worker();
+    }
+    else
+    {
+        // The calling thread acts as one of the workers
+        vector<thread> threads;
+        threads.reserve(threadCount - 1);
+        for (unsigned i = 1; i < threadCount; i++)
+            threads.emplace_back(worker);
+
+        worker();
+        for (auto& thread : threads)
+            thread.join();
+    }
+
+    if (error != nullptr)
+        std::rethrow_exception(error);
+}
+
 size_t readForSignature(StreamDevice& device, size_t conentsBeaconOffset, size_t conentsBeaconSize,
     char* buffer, size_t bufferSize)
 {
@@ -167,3 +293,85 @@ void prepareBeaconsData(size_t signatureSize, string& contentsBeacon, string& by
                                                          // as an hex string
     byteRangeBeacon.resize(char_traits<char>::length(ByteRangeBeacon), ' ');
 }
+
+SignerTeeDevice::SignerTeeDevice(StreamDevice& device, PdfSigner& signer,
+        const PdfSignatureBeacons& beacons, size_t hashedLength) :
+    m_device(&device),
+    m_signer(&signer),
+    m_beacons(&beacons),
+    m_hashedLength(hashedLength),
+    m_invalid(false)
+{
+}
+
+size_t SignerTeeDevice::GetLength() const
+{
+    return m_device->GetLength();
+}
+
+size_t SignerTeeDevice::GetPosition() const
+{
+    return m_device->GetPosition();
+}
+
+bool SignerTeeDevice::Eof() const
+{
+    return m_device->Eof();
+}
+
+bool SignerTeeDevice::CanSeek() const
+{
+    return m_device->CanSeek();
+}
+
+size_t SignerTeeDevice::GetHashedLength() const
+{
+    return m_invalid ? 0 : m_hashedLength;
+}
+
+void SignerTeeDevice::writeBuffer(const char* buffer, size_t size)
+{
+    size_t pos = m_device->GetPosition();
+    m_device->Write(buffer, size);
+    if (m_invalid)
+        return;
+
+    // The beacons and the data following them are
+    // passed to the signer after patching the /ByteRange
+    size_t beaconsOffset = getBeaconsOffset();
+    if (pos >= beaconsOffset)
+        return;
+
+    if (pos != m_hashedLength)
+    {
+        // The data was not written sequentially
+        m_invalid = true;
+        return;
+    }
+
+    size_t hashedSize = std::min(size, beaconsOffset - pos);
+    m_signer->AppendData({ buffer, hashedSize });
+    m_hashedLength += hashedSize;
+}
+
+void SignerTeeDevice::flush()
+{
+    m_device->Flush();
+}
+
+void SignerTeeDevice::seek(ssize_t offset, SeekDirection direction)
+{
+    m_device->Seek(offset, direction);
+}
+
+size_t SignerTeeDevice::getBeaconsOffset() const
+{
+    // NOTE: The offsets are set just before writing the beacons
+    size_t ret = numeric_limits<size_t>::max();
+    if (*m_beacons->ContentsOffset != 0)
+        ret = *m_beacons->ContentsOffset;
+    if (*m_beacons->ByteRangeOffset != 0)
+        ret = std::min(ret, *m_beacons->ByteRangeOffset);
+
+    return ret;
+}
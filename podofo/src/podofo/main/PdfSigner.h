@@ -9,6 +9,8 @@
 
 #include "PdfDeclarations.h"
 
+#include <functional>
+
 #include "PdfMemDocument.h"
 #include "PdfSignature.h"
 
@@ -73,6 +75,30 @@ namespace PoDoFo
      */
     PODOFO_API void SignDocument(PdfMemDocument& doc, StreamDevice& device, PdfSigner& signer,
         PdfSignature& signature, PdfSaveOptions saveOptions = PdfSaveOptions::None);
+
+    /** A document to be signed with SignDocuments()
+     */
+    struct PODOFO_API PdfSignJob
+    {
+        PdfMemDocument* Document = nullptr;     ///< The document to be signed
+        StreamDevice* Device = nullptr;         ///< The input/output device where the document will be saved
+        PdfSignature* Signature = nullptr;      ///< The signature field where the signature will be applied
+        PdfSaveOptions SaveOptions = PdfSaveOptions::None;
+    };
+
+    /** Sign multiple documents using a pool of worker threads
+     * \param jobs the documents to be signed. The documents, devices
+     *      and signature fields must be all different
+     * \param createSigner function creating the signer of each document, as
+     *      signers hold the state of the signature being computed. It's
+     *      called concurrently by the worker threads
+     * \param threadCount the number of workers, or 0 to use the
+     *      hardware concurrency
+     * \remarks If signing any document fails, the remaining documents
+     *      are not signed and the first error is rethrown
+     */
+    PODOFO_API void SignDocuments(const cspan<PdfSignJob>& jobs,
+        const std::function<std::unique_ptr<PdfSigner>()>& createSigner, unsigned threadCount = 0);
 }
 
 #endif // PDF_SIGNER_H
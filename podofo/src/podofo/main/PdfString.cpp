@@ -17,6 +17,7 @@
 #include "PdfFilter.h"
 #include "PdfTokenizer.h"
 #include <podofo/auxiliary/OutputDevice.h>
+#include "PdfArenaAllocator.h"
 
 using namespace std;
 using namespace PoDoFo;
@@ -32,12 +33,12 @@ enum class StringEncoding
 static StringEncoding getEncoding(const string_view& view);
 
 PdfString::PdfString()
-    : m_data(new StringData{ PdfStringState::Ascii, { } }), m_isHex(false)
+    : m_data(newData(PdfStringState::Ascii, { })), m_isHex(false)
 {
 }
 
 PdfString::PdfString(charbuff&& buff, bool isHex)
-    : m_data(new StringData{ PdfStringState::RawBuffer, std::move(buff) }), m_isHex(isHex)
+    : m_data(newData(PdfStringState::RawBuffer, std::move(buff))), m_isHex(isHex)
 {
 }
 
@@ -267,15 +268,26 @@ void PdfString::initFromUtf8String(const string_view& view)
 
     if (view.length() == 0)
     {
-        m_data.reset(new StringData{ PdfStringState::Ascii, { } });
+        m_data = newData(PdfStringState::Ascii, { });
         return;
     }
 
     bool isAsciiEqual;
     if (PoDoFo::CheckValidUTF8ToPdfDocEcondingChars(view, isAsciiEqual))
-        m_data.reset(new StringData{ isAsciiEqual ? PdfStringState::Ascii : PdfStringState::PdfDocEncoding, charbuff(view) });
+        m_data = newData(isAsciiEqual ? PdfStringState::Ascii : PdfStringState::PdfDocEncoding, charbuff(view));
     else
-        m_data.reset(new StringData{ PdfStringState::Unicode, charbuff(view) });
+        m_data = newData(PdfStringState::Unicode, charbuff(view));
+}
+
+shared_ptr<PdfString::StringData> PdfString::newData(PdfStringState state, charbuff&& chars)
+{
+    // Strings built while loading a document with PdfLoadOptions::ArenaAllocation
+    // keep their data in its arena. NOTE: Only the characters that don't fit the
+    // buffer inline storage are still on the heap
+    auto ret = std::allocate_shared<StringData>(PdfArenaAllocator<StringData>::GetCurrent());
+    ret->State = state;
+    ret->Chars = std::move(chars);
+    return ret;
 }
 
 void PdfString::evaluateString() const
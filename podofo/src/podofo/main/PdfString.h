@@ -151,6 +151,8 @@ private:
         charbuff Chars;
     };
 
+    static std::shared_ptr<StringData> newData(PdfStringState state, charbuff&& chars);
+
 private:
     std::shared_ptr<StringData> m_data;
     bool m_isHex;    // This string is converted to hex during writing it out
@@ -7,71 +7,145 @@
 #include <podofo/private/PdfDeclarationsPrivate.h>
 #include "PdfStringStream.h"
 
-#include <podofo/private/outstringstream.h>
-
 using namespace std;
-using namespace cmn;
 using namespace PoDoFo;
 
+namespace
+{
+    // An unbuffered stream buffer appending to a string, so the
+    // output of the stream and the direct appends stay ordered
+    class AppendStreamBuffer final : public streambuf
+    {
+    public:
+        AppendStreamBuffer(string& str)
+            : m_str(&str) { }
+
+    protected:
+        int_type overflow(int_type ch) override
+        {
+            if (!traits_type::eq_int_type(ch, traits_type::eof()))
+                m_str->push_back(traits_type::to_char_type(ch));
+
+            return traits_type::not_eof(ch);
+        }
+
+        streamsize xsputn(const char_type* s, streamsize count) override
+        {
+            m_str->append(s, (size_t)count);
+            return count;
+        }
+
+    private:
+        string* m_str;
+    };
+
+    class AppendStream final : public ostream
+    {
+    public:
+        AppendStream(string& str)
+            : ostream(nullptr), m_buffer(str)
+        {
+            rdbuf(&m_buffer);
+        }
+
+    private:
+        AppendStreamBuffer m_buffer;
+    };
+}
+
+template <typename T>
+static void appendReal(string& str, T val, unsigned short precision);
+
 PdfStringStream::PdfStringStream()
-    : m_stream(new outstringstream())
+    : m_precision(6)
 {
-    m_stream->imbue(utls::GetInvariantLocale());
 }
 
+PdfStringStream::~PdfStringStream() { }
+
 PdfStringStream& PdfStringStream::operator<<(float val)
 {
-    utls::FormatTo(m_temp, val, (unsigned short)m_stream->precision());
-    (*m_stream) << m_temp;
+    appendReal(m_buffer, val, m_precision);
     return *this;
 }
 
 PdfStringStream& PdfStringStream::operator<<(double val)
 {
-    utls::FormatTo(m_temp, val, (unsigned char)m_stream->precision());
-    (*m_stream) << m_temp;
+    appendReal(m_buffer, val, m_precision);
     return *this;
 }
 
 PdfStringStream& PdfStringStream::operator<<(
     std::ostream& (*pfn)(std::ostream&))
 {
-    pfn(*m_stream);
+    pfn(getStream());
     return *this;
 }
 
 string_view PdfStringStream::GetString() const
 {
-    return static_cast<const outstringstream&>(*m_stream).str();
+    return m_buffer;
 }
 
 string PdfStringStream::TakeString()
 {
-    return static_cast<outstringstream&>(*m_stream).take_str();
+    return std::move(m_buffer);
 }
 
 void PdfStringStream::Clear()
 {
-    static_cast<outstringstream&>(*m_stream).clear();
-    m_temp.clear();
+    m_buffer.clear();
 }
 
 void PdfStringStream::SetPrecision(unsigned short value)
 {
-    (void)m_stream->precision(value);
+    m_precision = value;
+    if (m_stream != nullptr)
+        (void)m_stream->precision(value);
 }
 
 unsigned short PdfStringStream::GetPrecision() const
 {
-    return (unsigned short)m_stream->precision();
+    return m_precision;
 }
 
 unsigned PdfStringStream::GetSize() const
 {
-    return (unsigned)static_cast<const outstringstream&>(*m_stream).size();
+    return (unsigned)m_buffer.size();
 }
 
 void PdfStringStream::writeBuffer(const char* buffer, size_t size)
 {
-    m_stream->write(buffer, size);
+    m_buffer.append(buffer, size);
+}
+
+ostream& PdfStringStream::getStream()
+{
+    if (m_stream == nullptr)
+    {
+        m_stream.reset(new AppendStream(m_buffer));
+        m_stream->imbue(utls::GetInvariantLocale());
+        (void)m_stream->precision(m_precision);
+    }
+
+    return *m_stream;
+}
+
+// Format the number in fixed notation directly at the end
+// of the string, then remove the trailing zeroes
+template <typename T>
+void appendReal(string& str, T val, unsigned short precision)
+{
+    std::format_to(std::back_inserter(str), "{:.{}f}", val, precision);
+    if (precision == 0)
+        return;
+
+    size_t len = str.size();
+    while (str[len - 1] == '0')
+        len--;
+
+    if (str[len - 1] == '.')
+        len--;
+
+    str.resize(len);
 }
@@ -8,6 +8,10 @@
 #define PDF_STRING_STREAM
 
 #include "PdfDeclarations.h"
+
+#include <charconv>
+#include <limits>
+#include <ostream>
 #include <podofo/auxiliary/OutputStream.h>
 
 namespace PoDoFo
@@ -15,16 +19,70 @@ namespace PoDoFo
     /** A specialized Pdf output string stream
      * It suplies an iostream-like operator<< interface,
      * while still inheriting OutputStream
+     *
+     * Strings, characters and numbers are appended directly to
+     * a contiguous buffer. Other types are written through a
+     * std::ostream that appends to the same buffer
      */
     class PODOFO_API PdfStringStream final : public OutputStream
     {
+    private:
+        // Types appended directly to the buffer
+        template <typename T>
+        static constexpr bool isAppendable()
+        {
+            return (std::is_integral_v<T> && sizeof(T) > 1)
+                || std::is_floating_point_v<T>
+                || std::is_same_v<T, char>
+                || std::is_same_v<T, signed char>
+                || std::is_same_v<T, unsigned char>
+                || std::is_convertible_v<const T&, std::string_view>;
+        }
+
     public:
         PdfStringStream();
 
-        template <typename T>
+        ~PdfStringStream();
+
+        template <typename T, std::enable_if_t<!isAppendable<T>(), int> = 0>
         inline PdfStringStream& operator<<(T const& val)
         {
-            (*m_stream) << val;
+            getStream() << val;
+            return *this;
+        }
+
+        template <typename T, std::enable_if_t<std::is_integral_v<T> && (sizeof(T) > 1), int> = 0>
+        inline PdfStringStream& operator<<(T val)
+        {
+            std::array<char, std::numeric_limits<T>::digits10 + 2> arr;
+            auto res = std::to_chars(arr.data(), arr.data() + arr.size(), val);
+            m_buffer.append(arr.data(), res.ptr - arr.data());
+            return *this;
+        }
+
+        inline PdfStringStream& operator<<(const std::string_view& view)
+        {
+            m_buffer.append(view.data(), view.size());
+            return *this;
+        }
+
+        inline PdfStringStream& operator<<(char ch)
+        {
+            m_buffer.push_back(ch);
+            return *this;
+        }
+
+        // Single byte types other than char are
+        // formatted as characters, like std::ostream
+        inline PdfStringStream& operator<<(signed char ch)
+        {
+            m_buffer.push_back((char)ch);
+            return *this;
+        }
+
+        inline PdfStringStream& operator<<(unsigned char ch)
+        {
+            m_buffer.push_back((char)ch);
             return *this;
         }
 
@@ -48,17 +106,20 @@ namespace PoDoFo
 
         unsigned GetSize() const;
 
-        explicit operator std::ostream& () { return *m_stream; }
+        explicit operator std::ostream& () { return getStream(); }
 
     protected:
         void writeBuffer(const char* buffer, size_t size);
 
     private:
+        std::ostream& getStream();
+
         using OutputStream::Flush;
         using OutputStream::Write;
 
     private:
-        charbuff m_temp;
+        std::string m_buffer;
+        unsigned short m_precision;
         std::unique_ptr<std::ostream> m_stream;
     };
 }
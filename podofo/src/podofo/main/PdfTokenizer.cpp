@@ -8,6 +8,7 @@
 #include "PdfTokenizer.h"
 
 #include <podofo/private/charconv_compat.h>
+#include <podofo/private/simd_compat.h>
 
 #include "PdfArray.h"
 #include "PdfDictionary.h"
@@ -21,9 +22,41 @@
 using namespace std;
 using namespace PoDoFo;
 
+namespace
+{
+    enum class PdfCharClass : uint8_t
+    {
+        Regular = 0,
+        Whitespace,
+        Delimiter,
+    };
+}
+
 static char getEscapedCharacter(char ch);
 static void readHexString(InputStreamDevice& device, charbuff& buffer);
 static bool isOctalChar(char ch);
+static const char* skipWhitespaces(const char* it, const char* end);
+static const char* findLineEnd(const char* it, const char* end);
+
+static constexpr array<PdfCharClass, 256> getCharClasses()
+{
+    array<PdfCharClass, 256> ret{ };
+    for (char ch : { '\0', '\t', '\n', '\f', '\r', ' ' })
+        ret[(unsigned char)ch] = PdfCharClass::Whitespace;
+
+    for (char ch : { '(', ')', '<', '>', '[', ']', '{', '}', '/', '%' })
+        ret[(unsigned char)ch] = PdfCharClass::Delimiter;
+
+    return ret;
+}
+
+// Character classes according to PDF 32000:2008 7.2.2 Character Set
+static constexpr array<PdfCharClass, 256> s_charClasses = getCharClasses();
+
+static inline PdfCharClass getCharClass(char ch)
+{
+    return s_charClasses[(unsigned char)ch];
+}
 
 PdfTokenizer::PdfTokenizer(const PdfTokenizerOptions& options)
     : PdfTokenizer(std::make_shared<charbuff>(BufferSize), options)
@@ -65,6 +98,10 @@ bool PdfTokenizer::TryReadNextToken(InputStreamDevice& device, string_view& toke
         return true;
     }
 
+    // Try first to tokenize directly on the device memory
+    if (tryReadNextTokenBuffered(device, token, tokenType))
+        return true;
+
     tokenType = PdfTokenType::Literal;
 
     char ch1;
@@ -177,6 +214,120 @@ Eof:
     goto Exit;
 }
 
+// Read the next token scanning windows of the device memory. Tokens
+// are returned as views of the window, avoiding per character virtual
+// calls and copies. Returns false, leaving the device positioned at
+// the beginning of the next token, if the device doesn't support
+// peeking buffers or the token is not entirely contained in the
+// window, so the regular tokenization can handle it
+bool PdfTokenizer::tryReadNextTokenBuffered(InputStreamDevice& device, string_view& token, PdfTokenType& tokenType)
+{
+    // NOTE: Honor the same maximum token size of the regular path
+    size_t maxTokenSize = m_buffer->size() - 1;
+    bufferview window;
+    bool inComment = false;
+    const char* begin;
+    const char* end;
+    const char* it;
+    while (true)
+    {
+        if (!device.TryPeekBuffer(window))
+            return false;
+
+        begin = window.data();
+        end = begin + window.size();
+        it = begin;
+
+        // Skip whitespaces and comments
+        while (true)
+        {
+            if (inComment)
+            {
+                it = findLineEnd(it, end);
+                if (it == end)
+                    break;
+
+                inComment = false;
+            }
+
+            it = skipWhitespaces(it, end);
+            if (it == end || *it != '%')
+                break;
+
+            inComment = true;
+        }
+
+        if (it != end)
+            break;
+
+        // Consume the whole window and peek the next one
+        device.Seek((ssize_t)window.size(), SeekDirection::Current);
+    }
+
+    const char* tokenEnd;
+    const char* consumedEnd;
+    char ch = *it;
+    if (ch == '<' || ch == '>')
+    {
+        if (end - it < 2)
+            goto Fallback;
+
+        if (it[1] == ch)
+        {
+            // Opening/closing a dictionary
+            if ((int)m_options.LanguageLevel < 2)
+                goto Fallback;
+
+            tokenEnd = it + 2;
+            tokenType = ch == '<' ? PdfTokenType::DoubleAngleBracketsLeft : PdfTokenType::DoubleAngleBracketsRight;
+        }
+        else
+        {
+            tokenEnd = it + 1;
+            tokenType = ch == '<' ? PdfTokenType::AngleBracketLeft : PdfTokenType::AngleBracketRight;
+        }
+
+        consumedEnd = tokenEnd;
+    }
+    else if (IsTokenDelimiter(ch, tokenType))
+    {
+        tokenEnd = it + 1;
+        consumedEnd = tokenEnd;
+    }
+    else
+    {
+        tokenType = PdfTokenType::Literal;
+        const char* limit = it + std::min((size_t)(end - it), maxTokenSize);
+        tokenEnd = it + 1;
+        while (tokenEnd != limit && getCharClass(*tokenEnd) == PdfCharClass::Regular)
+            tokenEnd++;
+
+        // The token may continue in the next window
+        if (tokenEnd == end)
+            goto Fallback;
+
+        consumedEnd = tokenEnd;
+        if (tokenEnd != limit && *tokenEnd == '%')
+        {
+            // A comment terminating the token is consumed as well
+            consumedEnd = findLineEnd(tokenEnd, end);
+            if (consumedEnd == end)
+                goto Fallback;
+        }
+    }
+
+    device.Seek((ssize_t)(consumedEnd - begin), SeekDirection::Current);
+    token = string_view(it, tokenEnd - it);
+    return true;
+
+Fallback:
+    // Consume only skipped whitespaces and comments
+    if (it != begin)
+        device.Seek((ssize_t)(it - begin), SeekDirection::Current);
+
+    return false;
+}
+
 bool PdfTokenizer::TryPeekNextToken(InputStreamDevice& device, string_view& token)
 {
     PdfTokenType tokenType;
@@ -274,21 +425,19 @@ PdfTokenizer::PdfLiteralDataType PdfTokenizer::DetermineDataType(InputStreamDevi
                 return PdfLiteralDataType::Bool;
             }
 
+            // NOTE: The token may be not null terminated
             PdfLiteralDataType dataType = PdfLiteralDataType::Number;
-            const char* start = token.data();
-            while (*start)
+            for (char ch : token)
             {
-                if (*start == '.')
+                if (ch == '.')
                 {
                     dataType = PdfLiteralDataType::Real;
                 }
-                else if (!(isdigit(*start) || *start == '-' || *start == '+'))
+                else if (!((ch >= '0' && ch <= '9') || ch == '-' || ch == '+'))
                 {
                     dataType = PdfLiteralDataType::Unknown;
                     break;
                 }
-
-                start++;
             }
 
             if (dataType == PdfLiteralDataType::Real)
@@ -667,52 +816,12 @@ void PdfTokenizer::EnqueueToken(const string_view& token, PdfTokenType tokenType
 
 bool PdfTokenizer::IsWhitespace(char ch)
 {
-    switch (ch)
-    {
-        case '\0': // NULL
-            return true;
-        case '\t': // TAB
-            return true;
-        case '\n': // Line Feed
-            return true;
-        case '\f': // Form Feed
-            return true;
-        case '\r': // Carriage Return
-            return true;
-        case ' ': // White space
-            return true;
-        default:
-            return false;
-    }
+    return getCharClass(ch) == PdfCharClass::Whitespace;
 }
 
 bool PdfTokenizer::IsDelimiter(char ch)
 {
-    switch (ch)
-    {
-        case '(':
-            return true;
-        case ')':
-            return true;
-        case '<':
-            return true;
-        case '>':
-            return true;
-        case '[':
-            return true;
-        case ']':
-            return true;
-        case '{':
-            return true;
-        case '}':
-            return true;
-        case '/':
-            return true;
-        case '%':
-            return true;
-        default:
-            return false;
-    }
+    return getCharClass(ch) == PdfCharClass::Delimiter;
 }
 
 bool PdfTokenizer::IsTokenDelimiter(char ch, PdfTokenType& tokenType)
@@ -748,7 +857,7 @@ bool PdfTokenizer::IsTokenDelimiter(char ch, PdfTokenType& tokenType)
 
 bool PdfTokenizer::IsRegular(char ch)
 {
-    return !IsWhitespace(ch) && !IsDelimiter(ch);
+    return getCharClass(ch) == PdfCharClass::Regular;
 }
 
 bool PdfTokenizer::IsPrintable(char ch)
@@ -827,3 +936,63 @@ bool isOctalChar(char ch)
             return false;
     }
 }
+
+const char* skipWhitespaces(const char* it, const char* end)
+{
+    // Most often there's at most a single whitespace
+    if (it == end || getCharClass(*it) != PdfCharClass::Whitespace)
+        return it;
+
+    it++;
+#ifdef PODOFO_HAVE_SSE2
+    // Test 16 characters at once for long runs, like the
+    // padding found in xref tables or content streams
+    const __m128i nul = _mm_setzero_si128();
+    const __m128i tab = _mm_set1_epi8('\t');
+    const __m128i lf = _mm_set1_epi8('\n');
+    const __m128i ff = _mm_set1_epi8('\f');
+    const __m128i cr = _mm_set1_epi8('\r');
+    const __m128i space = _mm_set1_epi8(' ');
+    while (end - it >= 16)
+    {
+        __m128i chunk = _mm_loadu_si128((const __m128i*)it);
+        __m128i whitespaces = _mm_or_si128(
+            _mm_or_si128(_mm_or_si128(_mm_cmpeq_epi8(chunk, nul), _mm_cmpeq_epi8(chunk, tab)),
+                _mm_or_si128(_mm_cmpeq_epi8(chunk, lf), _mm_cmpeq_epi8(chunk, ff))),
+            _mm_or_si128(_mm_cmpeq_epi8(chunk, cr), _mm_cmpeq_epi8(chunk, space)));
+        unsigned others = (unsigned)_mm_movemask_epi8(whitespaces) ^ 0xFFFFU;
+        if (others != 0)
+            return it + utls::CountTrailingZeros(others);
+
+        it += 16;
+    }
+#endif // PODOFO_HAVE_SSE2
+
+    while (it != end && getCharClass(*it) == PdfCharClass::Whitespace)
+        it++;
+
+    return it;
+}
+
+const char* findLineEnd(const char* it, const char* end)
+{
+#ifdef PODOFO_HAVE_SSE2
+    const __m128i lf = _mm_set1_epi8('\n');
+    const __m128i cr = _mm_set1_epi8('\r');
+    while (end - it >= 16)
+    {
+        __m128i chunk = _mm_loadu_si128((const __m128i*)it);
+        unsigned found = (unsigned)_mm_movemask_epi8(
+            _mm_or_si128(_mm_cmpeq_epi8(chunk, lf), _mm_cmpeq_epi8(chunk, cr)));
+        if (found != 0)
+            return it + utls::CountTrailingZeros(found);
+
+        it += 16;
+    }
+#endif // PODOFO_HAVE_SSE2
+
+    while (it != end && *it != '\n' && *it != '\r')
+        it++;
+
+    return it;
+}
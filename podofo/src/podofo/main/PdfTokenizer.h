@@ -63,10 +63,11 @@ public:
     /** Reads the next token from the current file position
      *  ignoring all comments.
      *
-     *  \param[out] token On true return, set to a pointer to the read
-     *                     token (a nullptr-terminated C string). The pointer is
-     *                     to memory owned by PdfTokenizer and must NOT be
-     *                     freed.  The contents are invalidated on the next
+     *  \param[out] token On true return, set to a view of the read
+     *                     token. The view is to memory owned by PdfTokenizer
+     *                     or, if the device supports peeking buffers, directly
+     *                     to the device memory. It's not guaranteed to be null
+     *                     terminated. The contents are invalidated on the next
      *                     call to tryReadNextToken(..) and by the destruction of
      *                     the PdfTokenizer. Undefined on false return.
      *
@@ -237,6 +238,7 @@ protected:
     PdfLiteralDataType DetermineDataType(InputStreamDevice& device, const std::string_view& token, PdfTokenType tokenType, PdfVariant& variant);
 
 private:
+    bool tryReadNextTokenBuffered(InputStreamDevice& device, std::string_view& token, PdfTokenType& tokenType);
     bool tryReadDataType(InputStreamDevice& device, PdfLiteralDataType dataType, PdfVariant& variant, const PdfStatefulEncrypt& encrypt);
 
 private:
@@ -12,6 +12,7 @@
 #include "PdfDictionary.h"
 #include "PdfParserObject.h"
 #include <podofo/auxiliary/StreamDevice.h>
+#include <podofo/private/PdfArena.h>
 
 using namespace PoDoFo;
 using namespace std;
@@ -20,8 +21,18 @@ constexpr unsigned short DefaultPrecision = 6;
 
 PdfVariant PdfVariant::Null;
 
+// Data of the variants built while loading a document
+// with PdfLoadOptions::ArenaAllocation goes to its arena
+template <typename T, typename... TArgs>
+static PdfDataProvider* newData(bool& inArena, TArgs&&... args)
+{
+    auto arena = PdfArena::GetCurrent();
+    inArena = arena != nullptr;
+    return PdfArena::New<T>(arena, std::forward<TArgs>(args)...);
+}
+
 PdfVariant::PdfVariant(PdfDataType type)
-    : m_Data{ }, m_DataType(type) { }
+    : m_Data{ }, m_DataType(type), m_ArenaData(false) { }
 
 PdfVariant::PdfVariant()
     : PdfVariant(PdfDataType::Null) { }
@@ -47,13 +58,13 @@ PdfVariant::PdfVariant(double value)
 PdfVariant::PdfVariant(const PdfString& str)
     : PdfVariant(PdfDataType::String)
 {
-    m_Data.Data = new PdfString(str);
+    m_Data.Data = newData<PdfString>(m_ArenaData, str);
 }
 
 PdfVariant::PdfVariant(const PdfName& name)
     : PdfVariant(PdfDataType::Name)
 {
-    m_Data.Data = new PdfName(name);
+    m_Data.Data = newData<PdfName>(m_ArenaData, name);
 }
 
 PdfVariant::PdfVariant(const PdfReference& ref)
@@ -65,51 +76,52 @@ PdfVariant::PdfVariant(const PdfReference& ref)
 PdfVariant::PdfVariant(const PdfArray& arr)
     : PdfVariant(PdfDataType::Array)
 {
-    m_Data.Data = new PdfArray(arr);
+    m_Data.Data = newData<PdfArray>(m_ArenaData, arr);
 }
 
 PdfVariant::PdfVariant(PdfArray&& arr) noexcept
     : PdfVariant(PdfDataType::Array)
 {
-    m_Data.Data = new PdfArray(std::move(arr));
+    m_Data.Data = newData<PdfArray>(m_ArenaData, std::move(arr));
 }
 
 PdfVariant::PdfVariant(const PdfDictionary& dict)
     : PdfVariant(PdfDataType::Dictionary)
 {
-    m_Data.Data = new PdfDictionary(dict);
+    m_Data.Data = newData<PdfDictionary>(m_ArenaData, dict);
 }
 
 PdfVariant::PdfVariant(PdfDictionary&& dict) noexcept
     : PdfVariant(PdfDataType::Dictionary)
 {
-    m_Data.Data = new PdfDictionary(std::move(dict));
+    m_Data.Data = newData<PdfDictionary>(m_ArenaData, std::move(dict));
 }
 
 PdfVariant::PdfVariant(const PdfData& data)
     : PdfVariant(PdfDataType::RawData)
 {
-    m_Data.Data = new PdfData(data);
+    m_Data.Data = newData<PdfData>(m_ArenaData, data);
 }
 
 PdfVariant::PdfVariant(PdfData&& data) noexcept
     : PdfVariant(PdfDataType::RawData)
 {
-    m_Data.Data = new PdfData(std::move(data));
+    m_Data.Data = newData<PdfData>(m_ArenaData, std::move(data));
 }
 
 
 PdfVariant::PdfVariant(const PdfVariant& rhs)
-    : m_Data{ }
+    : m_Data{ }, m_ArenaData(false)
 {
     assign(rhs);
 }
 
 PdfVariant::PdfVariant(PdfVariant&& rhs) noexcept
-    : m_Data(rhs.m_Data), m_DataType(rhs.m_DataType)
+    : m_Data(rhs.m_Data), m_DataType(rhs.m_DataType), m_ArenaData(rhs.m_ArenaData)
 {
     rhs.m_Data = { };
     rhs.m_DataType = PdfDataType::Null;
+    rhs.m_ArenaData = false;
 }
 
 PdfVariant::~PdfVariant()
@@ -127,7 +139,7 @@ void PdfVariant::clear()
         case PdfDataType::String:
         case PdfDataType::RawData:
         {
-            delete m_Data.Data;
+            PdfArena::Delete(m_Data.Data, m_ArenaData);
             break;
         }
 
@@ -249,40 +261,43 @@ PdfVariant& PdfVariant::operator=(PdfVariant&& rhs) noexcept
     clear();
     m_DataType = rhs.m_DataType;
     m_Data = rhs.m_Data;
+    m_ArenaData = rhs.m_ArenaData;
     rhs.m_DataType = PdfDataType::Null;
     rhs.m_Data = { };
+    rhs.m_ArenaData = false;
     return *this;
 }
 
 void PdfVariant::assign(const PdfVariant& rhs)
 {
     m_DataType = rhs.m_DataType;
+    m_ArenaData = false;
     switch (m_DataType)
     {
         case PdfDataType::Array:
         {
-            m_Data.Data = new PdfArray(*static_cast<const PdfArray*>(rhs.m_Data.Data));
+            m_Data.Data = newData<PdfArray>(m_ArenaData, *static_cast<const PdfArray*>(rhs.m_Data.Data));
             break;
         }
         case PdfDataType::Dictionary:
         {
-            m_Data.Data = new PdfDictionary(*static_cast<const PdfDictionary*>(rhs.m_Data.Data));
+            m_Data.Data = newData<PdfDictionary>(m_ArenaData, *static_cast<const PdfDictionary*>(rhs.m_Data.Data));
             break;
         }
         case PdfDataType::Name:
         {
-            m_Data.Data = new PdfName(*static_cast<const PdfName*>(rhs.m_Data.Data));
+            m_Data.Data = newData<PdfName>(m_ArenaData, *static_cast<const PdfName*>(rhs.m_Data.Data));
             break;
         }
         case PdfDataType::String:
         {
-            m_Data.Data = new PdfString(*static_cast<const PdfString*>(rhs.m_Data.Data));
+            m_Data.Data = newData<PdfString>(m_ArenaData, *static_cast<const PdfString*>(rhs.m_Data.Data));
             break;
         }
 
         case PdfDataType::RawData:
         {
-            m_Data.Data = new PdfData((*static_cast<const PdfData*>(rhs.m_Data.Data)));
+            m_Data.Data = newData<PdfData>(m_ArenaData, (*static_cast<const PdfData*>(rhs.m_Data.Data)));
             break;
         }
         case PdfDataType::Reference:
@@ -376,6 +376,7 @@ private:
 
     Variant m_Data;
     PdfDataType m_DataType;
+    bool m_ArenaData; // Set when the data is allocated from the arena of a document
 };
 
 };
@@ -17,8 +17,14 @@
 #include "PdfVariant.h"
 #include "PdfXRef.h"
 #include "PdfXRefStream.h"
+#include "PdfMemoryObjectStream.h"
 #include <podofo/auxiliary/StreamDevice.h>
 
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+
 #define PDF_MAGIC           "\xe2\xe3\xcf\xd3\n"
 // 10 spaces
 #define LINEARIZATION_PADDING "          "
@@ -28,11 +34,45 @@ using namespace PoDoFo;
 
 static PdfWriteFlags ToWriteFlags(PdfSaveOptions opts);
 
+namespace
+{
+    struct CompressJob
+    {
+        CompressJob(PdfObject& obj)
+            : Object(&obj) { }
+
+        PdfObject* Object;
+        std::unique_ptr<PdfObject> Compressed;
+        std::exception_ptr Error;
+        bool Done = false;
+    };
+
+    // Streams compressed by a pool of worker threads,
+    // ahead of the serialization of the objects
+    struct CompressPipeline
+    {
+        ~CompressPipeline()
+        {
+            Stopped.store(true, memory_order_relaxed);
+            for (auto& worker : Workers)
+                worker.join();
+        }
+
+        vector<CompressJob> Jobs;
+        vector<thread> Workers;
+        atomic<size_t> NextJob{ 0 };
+        atomic<bool> Stopped{ false };
+        mutex Mutex;
+        condition_variable JobDone;
+    };
+}
+
 PdfWriter::PdfWriter(PdfIndirectObjectList* objects, const PdfObject& trailer, PdfVersion version) :
     m_Objects(objects),
     m_Trailer(&trailer),
     m_Version(version),
     m_UseXRefStream(false),
+    m_ObjectsPerStream(100),
     m_EncryptObj(nullptr),
     m_SaveOptions(PdfSaveOptions::None),
     m_WriteFlags(PdfWriteFlags::None),
@@ -83,6 +123,10 @@ void PdfWriter::Write(OutputStreamDevice& device)
         m_Encrypt->CreateEncryptionDictionary(m_EncryptObj->GetDictionary());
     }
 
+    // Compressed objects can be referenced only by a XRef stream
+    if (!m_IncrementalUpdate && (m_SaveOptions & PdfSaveOptions::ObjectStreams) != PdfSaveOptions::None)
+        SetUseXRefStream(true);
+
     unique_ptr<PdfXRef> xRef;
     if (m_UseXRefStream)
         xRef.reset(new PdfXRefStream(*this));
@@ -103,23 +147,28 @@ void PdfWriter::Write(OutputStreamDevice& device)
     }
     catch (PdfError& e)
     {
-        // P.Zent: Delete Encryption dictionary (cannot be reused)
-        if (m_EncryptObj != nullptr)
-        {
-            m_Objects->RemoveObject(m_EncryptObj->GetIndirectReference());
-            m_EncryptObj = nullptr;
-        }
-
+        removeTemporaryObjects();
         PODOFO_PUSH_FRAME(e);
         throw e;
     }
 
+    removeTemporaryObjects();
+}
+
+void PdfWriter::removeTemporaryObjects()
+{
     // P.Zent: Delete Encryption dictionary (cannot be reused)
     if (m_EncryptObj != nullptr)
     {
         m_Objects->RemoveObject(m_EncryptObj->GetIndirectReference());
         m_EncryptObj = nullptr;
     }
+
+    // The packed objects stay in the document as regular objects,
+    // while the object streams are removed giving back their numbers,
+    // so repeated saves don't grow the object count or the free list
+    m_Objects->removeNewObjects(m_ObjectStreams);
+    m_ObjectStreams.clear();
 }
 
 void PdfWriter::WritePdfHeader(OutputStreamDevice& device)
@@ -130,8 +179,83 @@ void PdfWriter::WritePdfHeader(OutputStreamDevice& device)
 
 void PdfWriter::WritePdfObjects(OutputStreamDevice& device, const PdfIndirectObjectList& objects, PdfXRef& xref)
 {
+    // Pack the objects first, so the created object streams
+    // are compressed as any other stream
+    vector<PackedObject> packed;
+    if (!m_IncrementalUpdate && (m_SaveOptions & PdfSaveOptions::ObjectStreams) != PdfSaveOptions::None)
+        packObjects(objects, xref, packed);
+
+    // Select the streams to be compressed among the objects that will
+    // surely be written. Loading is not thread safe, so it's done here
+    CompressPipeline pipeline;
+    for (PdfObject* obj : objects)
+    {
+        if ((m_IncrementalUpdate && !obj->IsDirty())
+            || xref.ShouldSkipWrite(obj->GetIndirectReference()))
+        {
+            continue;
+        }
+
+        obj->DelayedLoadStream();
+        if (obj->shouldFlateCompress(m_WriteFlags)
+            && dynamic_cast<const PdfMemoryObjectStream*>(&obj->m_Stream->GetProvider()) != nullptr)
+        {
+            pipeline.Jobs.emplace_back(*obj);
+        }
+    }
+
+    if (pipeline.Jobs.size() > 1)
+    {
+        auto worker = [&pipeline, writeFlags = m_WriteFlags]() {
+            while (!pipeline.Stopped.load(memory_order_relaxed))
+            {
+                size_t i = pipeline.NextJob.fetch_add(1, memory_order_relaxed);
+                if (i >= pipeline.Jobs.size())
+                    return;
+
+                auto& job = pipeline.Jobs[i];
+                try
+                {
+                    job.Compressed.reset(new PdfObject());
+                    job.Object->flateCompressTo(*job.Compressed, writeFlags);
+                }
+                catch (...)
+                {
+                    job.Error = std::current_exception();
+                }
+
+                unique_lock<mutex> lock(pipeline.Mutex);
+                job.Done = true;
+                pipeline.JobDone.notify_all();
+            }
+        };
+
+        // This thread serializes the objects, so it's not counted as a worker
+        unsigned threadCount = std::max(2u, std::thread::hardware_concurrency()) - 1;
+        threadCount = (unsigned)std::min<size_t>(threadCount, pipeline.Jobs.size());
+        pipeline.Workers.reserve(threadCount);
+        for (unsigned i = 0; i < threadCount; i++)
+            pipeline.Workers.emplace_back(worker);
+    }
+    else
+    {
+        // Not worth it, let the objects compress their streams
+        pipeline.Jobs.clear();
+    }
+
+    size_t jobIndex = 0;
+    size_t packedIndex = 0;
     for (PdfObject* obj : objects)
     {
+        if (packedIndex < packed.size() && packed[packedIndex].Object == obj)
+        {
+            // The object was already written in an object stream
+            auto& item = packed[packedIndex];
+            packedIndex++;
+            xref.AddCompressedObject(obj->GetIndirectReference(), item.StreamObjectNumber, item.Index);
+            continue;
+        }
+
         if (m_IncrementalUpdate && !obj->IsDirty())
         {
             if (m_rewriteXRefTable)
@@ -170,6 +294,23 @@ void PdfWriter::WritePdfObjects(OutputStreamDevice& device, const PdfIndirectObj
         }
         else
         {
+            if (jobIndex < pipeline.Jobs.size() && pipeline.Jobs[jobIndex].Object == obj)
+            {
+                // Wait for the compressed stream and move it to the object
+                auto& job = pipeline.Jobs[jobIndex];
+                jobIndex++;
+                {
+                    unique_lock<mutex> lock(pipeline.Mutex);
+                    pipeline.JobDone.wait(lock, [&job]() { return job.Done; });
+                }
+
+                if (job.Error != nullptr)
+                    std::rethrow_exception(job.Error);
+
+                obj->m_Stream->MoveFrom(*job.Compressed->m_Stream);
+                job.Compressed.reset();
+            }
+
             xref.AddInUseObject(obj->GetIndirectReference(), device.GetPosition());
             // Also make sure that we do not encrypt the encryption dictionary!
             obj->Write(device, m_WriteFlags, obj == m_EncryptObj ? nullptr : m_Encrypt.get(), m_buffer);
@@ -182,6 +323,64 @@ void PdfWriter::WritePdfObjects(OutputStreamDevice& device, const PdfIndirectObj
     }
 }
 
+void PdfWriter::packObjects(const PdfIndirectObjectList& objects, PdfXRef& xref, vector<PackedObject>& packed)
+{
+    // Collect the objects that can be stored in an object stream,
+    // see ISO 32000-1:2008 7.5.7 "Object Streams"
+    vector<PdfObject*> candidates;
+    for (PdfObject* obj : objects)
+    {
+        auto& ref = obj->GetIndirectReference();
+        if (ref.GenerationNumber() != 0
+            || obj == m_EncryptObj
+            || xref.ShouldSkipWrite(ref)
+            || obj->HasStream())
+        {
+            continue;
+        }
+
+        candidates.push_back(obj);
+    }
+
+    // NOTE: The packed objects are not encrypted individually,
+    // the object stream is encrypted as a whole instead
+    PdfStatefulEncrypt encrypt;
+    charbuff header;
+    charbuff data;
+    packed.reserve(candidates.size());
+    for (size_t i = 0; i < candidates.size(); i += m_ObjectsPerStream)
+    {
+        unsigned count = (unsigned)std::min<size_t>(m_ObjectsPerStream, candidates.size() - i);
+        // NOTE: Object streams must have generation number 0
+        auto& streamObj = m_Objects->createNewDictionaryObject("ObjStm");
+        m_ObjectStreams.push_back(streamObj.GetIndirectReference());
+        uint32_t streamObjNum = streamObj.GetIndirectReference().ObjectNumber();
+
+        header.clear();
+        data.clear();
+        BufferStreamDevice device(data);
+        for (unsigned j = 0; j < count; j++)
+        {
+            auto obj = candidates[i + j];
+            header.append(utls::Format("{} {} ", obj->GetIndirectReference().ObjectNumber(), data.size()));
+            obj->GetVariant().Write(device, m_WriteFlags, encrypt, m_buffer);
+            device.Write('\n');
+            obj->ResetDirty();
+            packed.push_back({ obj, streamObjNum, j });
+        }
+
+        auto& dict = streamObj.GetDictionary();
+        dict.AddKey("N", static_cast<int64_t>(count));
+        dict.AddKey("First", static_cast<int64_t>(header.size()));
+
+        // Write the data unfiltered, it will be flate
+        // compressed when writing the stream
+        auto stream = streamObj.GetOrCreateStream().GetOutputStreamRaw();
+        stream.Write(header);
+        stream.Write(data);
+    }
+}
+
 void PdfWriter::FillTrailerObject(PdfObject& trailer, size_t size, bool onlySizeKey) const
 {
     trailer.GetDictionary().AddKey(PdfName::KeySize, static_cast<int64_t>(size));
@@ -313,6 +512,16 @@ void PdfWriter::SetEncrypt(const PdfEncrypt& encrypt)
     m_Encrypt = PdfEncrypt::CreateFromEncrypt(encrypt);
 }
 
+void PdfWriter::SetObjectsPerStream(unsigned count)
+{
+    // NOTE: The index of the object in the stream
+    // must fit the 16 bit field of the XRef stream
+    if (count == 0 || count > numeric_limits<uint16_t>::max())
+        PODOFO_RAISE_ERROR_INFO(PdfErrorCode::ValueOutOfRange, "The count of objects per stream must be between 1 and 65535");
+
+    m_ObjectsPerStream = count;
+}
+
 void PdfWriter::SetUseXRefStream(bool useXRefStream)
 {
     if (useXRefStream && m_Version < PdfVersion::V1_5)
@@ -336,5 +545,16 @@ PdfWriteFlags ToWriteFlags(PdfSaveOptions opts)
         ret |= PdfWriteFlags::Clean;
     }
 
+    if ((opts & PdfSaveOptions::FlateCompressFast) !=
+        PdfSaveOptions::None)
+    {
+        ret |= PdfWriteFlags::FlateCompressFast;
+    }
+    else if ((opts & PdfSaveOptions::FlateCompressBest) !=
+        PdfSaveOptions::None)
+    {
+        ret |= PdfWriteFlags::FlateCompressBest;
+    }
+
     return ret;
 }
@@ -61,6 +61,13 @@ public:
      */
     void SetUseXRefStream(bool useXRefStream);
 
+    /** Set the maximum count of objects packed in a single object
+     *  stream, when writing with PdfSaveOptions::ObjectStreams.
+     *  Default is 100
+     *  \param count the count of objects, between 1 and 65535
+     */
+    void SetObjectsPerStream(unsigned count);
+
     /** Set the written document to be encrypted using a PdfEncrypt object
      *
      *  \param encrypt an encryption object which is used to encrypt the written PDF file
@@ -99,6 +106,8 @@ public:
      */
     inline bool GetUseXRefStream() const { return m_UseXRefStream; }
 
+    inline unsigned GetObjectsPerStream() const { return m_ObjectsPerStream; }
+
     /** Sets an offset to the previous XRef table. Set it to lower than
      *  or equal to 0, to not write a reference to the previous XRef table.
      *  The default is 0.
@@ -173,12 +182,26 @@ protected:
 protected:
     charbuff m_buffer;
 
+private:
+    struct PackedObject
+    {
+        PdfObject* Object;
+        uint32_t StreamObjectNumber;
+        unsigned Index;
+    };
+
+private:
+    void packObjects(const PdfIndirectObjectList& objects, PdfXRef& xref, std::vector<PackedObject>& packed);
+    void removeTemporaryObjects();
+
 private:
     PdfIndirectObjectList* m_Objects;
     const PdfObject* m_Trailer;
     PdfVersion m_Version;
 
     bool m_UseXRefStream;
+    unsigned m_ObjectsPerStream;
+    std::vector<PdfReference> m_ObjectStreams; // Object streams created while writing
 
     std::unique_ptr<PdfEncrypt> m_Encrypt;    // If not nullptr encrypt all strings and streams and
                                                // create an encryption dictionary in the trailer
@@ -28,7 +28,21 @@ PdfXRef::~PdfXRef() { }
 
 void PdfXRef::AddInUseObject(const PdfReference& ref, nullable<uint64_t> offset)
 {
-    addObject(ref, offset, true);
+    if (offset == nullptr)
+    {
+        addObject(ref, nullptr, true);
+    }
+    else
+    {
+        XRefItem item(ref, *offset);
+        addObject(ref, &item, true);
+    }
+}
+
+void PdfXRef::AddCompressedObject(const PdfReference& ref, uint32_t streamObjNum, unsigned index)
+{
+    XRefItem item(ref, streamObjNum, index);
+    addObject(ref, &item, true);
 }
 
 void PdfXRef::AddFreeObject(const PdfReference& ref)
@@ -36,12 +50,12 @@ void PdfXRef::AddFreeObject(const PdfReference& ref)
     addObject(ref, nullptr, false);
 }
 
-void PdfXRef::addObject(const PdfReference& ref, nullable<uint64_t> offset, bool inUse)
+void PdfXRef::addObject(const PdfReference& ref, const XRefItem* item, bool inUse)
 {
     if (ref.ObjectNumber() > m_maxObjCount)
         m_maxObjCount = ref.ObjectNumber();
 
-    if (inUse && offset == nullptr)
+    if (inUse && item == nullptr)
     {
         // Objects with no offset provided will not be written
         // in the entry list
@@ -52,7 +66,7 @@ void PdfXRef::addObject(const PdfReference& ref, nullable<uint64_t> offset, bool
 
     for (auto& block : m_blocks)
     {
-        if (block.InsertItem(ref, offset, inUse))
+        if (block.InsertItem(ref, item))
         {
             insertDone = true;
             break;
@@ -64,10 +78,10 @@ void PdfXRef::addObject(const PdfReference& ref, nullable<uint64_t> offset, bool
         PdfXRefBlock block;
         block.First = ref.ObjectNumber();
         block.Count = 1;
-        if (inUse)
-            block.Items.push_back(XRefItem(ref, offset.value()));
-        else
+        if (item == nullptr)
             block.FreeItems.push_back(ref);
+        else
+            block.Items.push_back(*item);
 
         m_blocks.push_back(block);
         std::sort(m_blocks.begin(), m_blocks.end());
@@ -130,8 +144,16 @@ void PdfXRef::Write(OutputStreamDevice& device, charbuff& buffer)
                 itFree++;
             }
 
-            this->WriteXRefEntry(device, itItems->Reference,
-                PdfXRefEntry::CreateInUse(itItems->Offset, itItems->Reference.GenerationNumber()), buffer);
+            if (itItems->Type == XRefEntryType::Compressed)
+            {
+                this->WriteXRefEntry(device, itItems->Reference,
+                    PdfXRefEntry::CreateCompressed((uint32_t)itItems->Offset, itItems->Index), buffer);
+            }
+            else
+            {
+                this->WriteXRefEntry(device, itItems->Reference,
+                    PdfXRefEntry::CreateInUse(itItems->Offset, itItems->Reference.GenerationNumber()), buffer);
+            }
             itItems++;
         }
 
@@ -319,18 +341,17 @@ bool PdfXRef::ShouldSkipWrite(const PdfReference& ref)
     return false;
 }
 
-bool PdfXRef::PdfXRefBlock::InsertItem(const PdfReference& ref, nullable<uint64_t> offset, bool inUse)
+bool PdfXRef::PdfXRefBlock::InsertItem(const PdfReference& ref, const XRefItem* item)
 {
-    PODOFO_ASSERT(!inUse || offset.has_value());
     if (ref.ObjectNumber() == First + Count)
     {
         // Insert at back
         Count++;
 
-        if (inUse)
-            Items.push_back(XRefItem(ref, offset.value()));
-        else
+        if (item == nullptr)
             FreeItems.push_back(ref);
+        else
+            Items.push_back(*item);
 
         return true; // no sorting required
     }
@@ -341,10 +362,10 @@ bool PdfXRef::PdfXRefBlock::InsertItem(const PdfReference& ref, nullable<uint64_
         Count++;
 
         // This is known to be slow, but should not occur actually
-        if (inUse)
-            Items.insert(Items.begin(), XRefItem(ref, offset.value()));
-        else
+        if (item == nullptr)
             FreeItems.insert(FreeItems.begin(), ref);
+        else
+            Items.insert(Items.begin(), *item);
 
         return true; // no sorting required
     }
@@ -354,15 +375,15 @@ bool PdfXRef::PdfXRefBlock::InsertItem(const PdfReference& ref, nullable<uint64_
         // Insert at back
         Count++;
 
-        if (inUse)
+        if (item == nullptr)
         {
-            Items.push_back(XRefItem(ref, offset.value()));
-            std::sort(Items.begin(), Items.end());
+            FreeItems.push_back(ref);
+            std::sort(FreeItems.begin(), FreeItems.end());
         }
         else
         {
-            FreeItems.push_back(ref);
-            std::sort(FreeItems.begin(), FreeItems.end());
+            Items.push_back(*item);
+            std::sort(Items.begin(), Items.end());
         }
 
         return true;
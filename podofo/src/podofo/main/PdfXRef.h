@@ -28,10 +28,15 @@ protected:
     struct XRefItem
     {
         XRefItem(const PdfReference& ref, uint64_t off)
-            : Reference(ref), Offset(off) { }
+            : Reference(ref), Offset(off), Index(0), Type(XRefEntryType::InUse) { }
+
+        XRefItem(const PdfReference& ref, uint32_t streamObjNum, unsigned index)
+            : Reference(ref), Offset(streamObjNum), Index(index), Type(XRefEntryType::Compressed) { }
 
         PdfReference Reference;
-        uint64_t Offset;
+        uint64_t Offset;        ///< Offset, or object stream number for compressed objects
+        unsigned Index;         ///< Index in the object stream for compressed objects
+        XRefEntryType Type;
 
         bool operator<(const XRefItem& rhs) const
         {
@@ -49,7 +54,7 @@ protected:
 
         PdfXRefBlock(const PdfXRefBlock& rhs) = default;
 
-        bool InsertItem(const PdfReference& ref, nullable<uint64_t> offset, bool bUsed);
+        bool InsertItem(const PdfReference& ref, const XRefItem* item);
 
         bool operator<(const PdfXRefBlock& rhs) const
         {
@@ -82,6 +87,15 @@ public:
      */
     void AddInUseObject(const PdfReference& ref, nullable<uint64_t> offset);
 
+    /** Add an object stored in a compressed object stream to the XRef table.
+     *  \remarks Compressed entries can be written only in a XRef stream
+     *
+     *  \param ref reference of this object
+     *  \param streamObjNum the object number of the object stream
+     *  \param index the index of the object in the object stream
+     */
+    void AddCompressedObject(const PdfReference& ref, uint32_t streamObjNum, unsigned index);
+
     /** Add a free object to the XRef table.
      *
      *  \param ref reference of this object
@@ -162,7 +176,7 @@ protected:
     virtual void EndWriteImpl(OutputStreamDevice& device, charbuff& buffer);
 
 private:
-    void addObject(const PdfReference& ref, nullable<uint64_t> offset, bool inUse);
+    void addObject(const PdfReference& ref, const XRefItem* item, bool inUse);
 
     /** Called at the end of writing the XRef table.
      *  Sub classes can overload this method to finish a XRef table.
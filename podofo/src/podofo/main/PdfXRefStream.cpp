@@ -73,10 +73,16 @@ void PdfXRefStream::WriteXRefEntry(OutputStreamDevice& device, const PdfReferenc
         case XRefEntryType::InUse:
             stmEntry.Variant = AS_BIG_ENDIAN(static_cast<uint32_t>(entry.Offset));
             break;
+        case XRefEntryType::Compressed:
+            // The second field is the number of the object stream, the
+            // index of the object in it is stored as the generation below
+            stmEntry.Variant = AS_BIG_ENDIAN(static_cast<uint32_t>(entry.ObjectNumber));
+            break;
         default:
             PODOFO_RAISE_ERROR(PdfErrorCode::InvalidEnumValue);
     }
 
+    // NOTE: Generation and Index share the same storage
     stmEntry.Generation = AS_BIG_ENDIAN(static_cast<uint16_t>(entry.Generation));
     m_rawEntries.push_back(stmEntry);
 }
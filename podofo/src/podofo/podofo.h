@@ -35,6 +35,7 @@
 #include "main/PdfCanvas.h"
 #include "main/PdfColor.h"
 #include "main/PdfContentStreamReader.h"
+#include "main/PdfCompiledContentStream.h"
 #include "main/PdfPostScriptTokenizer.h"
 #include "main/PdfData.h"
 #include "main/PdfDataProvider.h"
@@ -56,6 +57,7 @@
 #include "main/PdfMemoryObjectStream.h"
 #include "main/PdfName.h"
 #include "main/PdfObject.h"
+#include "main/PdfObjectImporter.h"
 #include "main/PdfObjectStreamParser.h"
 #include "main/PdfParser.h"
 #include "main/PdfParserObject.h"
@@ -5,7 +5,11 @@
  */
 
 #include "PdfDeclarationsPrivate.h"
+
+#include <array>
+
 #include "ImageUtils.h"
+#include "simd_compat.h"
 
 using namespace std;
 using namespace PoDoFo;
@@ -16,6 +20,7 @@ using namespace PoDoFo;
 #define FETCH_BIT(bytes, idx) ((bytes[idx / 8] >> (idx % 8)) & 1)
 #endif
 
+static void readScanLine(InputStream& stream, charbuff& srcScanLine);
 template <int bpp>
 static void fetchScanLineRGB(unsigned char* dstScanLine, unsigned width,
     PdfPixelFormat format, const unsigned char* srcScanLine);
@@ -28,22 +33,32 @@ static void fetchScanLineGrayScale(unsigned char* dstScanLine, unsigned width,
 static void fetchScanLineGrayScale(unsigned char* dstScanLine, unsigned width,
     PdfPixelFormat format, const unsigned char* srcScanLine,
     const unsigned char* srcAphaLine);
-static void fetchScanLineBW(unsigned char* dstScanLine, unsigned width,
-    PdfPixelFormat format, const unsigned char* srcScanLine);
-static void fetchScanLineBW(unsigned char* dstScanLine, unsigned width,
+static void expandScanLineBW(unsigned char* dstScanLine, unsigned width,
+    const unsigned char* srcScanLine);
+#ifdef PODOFO_HAVE_SSE2
+static unsigned fetchScanLineGrayScaleSSE2(unsigned char* dstScanLine, unsigned width,
     PdfPixelFormat format, const unsigned char* srcScanLine,
     const unsigned char* srcAphaLine);
+#endif // PODOFO_HAVE_SSE2
+#ifdef PODOFO_HAVE_SSSE3
+PODOFO_TARGET_SSSE3 static unsigned fetchScanLineRGBSSSE3(unsigned char* dstScanLine, unsigned width,
+    PdfPixelFormat format, const unsigned char* srcScanLine,
+    const unsigned char* srcAphaLine);
+PODOFO_TARGET_SSSE3 static unsigned fetchScanLineGrayScaleSSSE3(unsigned char* dstScanLine, unsigned width,
+    PdfPixelFormat format, const unsigned char* srcScanLine);
+#endif // PODOFO_HAVE_SSSE3
 
 void utls::FetchImageRGB(OutputStream& stream, unsigned width, unsigned heigth, PdfPixelFormat format,
-    const unsigned char* imageData, const charbuff& smaskData, charbuff& scanLine)
+    InputStream& imageStream, const charbuff& smaskData, charbuff& scanLine)
 {
-    unsigned srcRowSize = width * 3;
+    charbuff srcScanLine((size_t)width * 3);
     if (smaskData.size() == 0)
     {
         for (unsigned i = 0; i < heigth; i++)
         {
+            readScanLine(imageStream, srcScanLine);
             fetchScanLineRGB<3>((unsigned char*)scanLine.data(),
-                width, format, imageData + i * srcRowSize);
+                width, format, (const unsigned char*)srcScanLine.data());
             stream.Write(scanLine.data(), scanLine.size());
         }
     }
@@ -51,8 +66,9 @@ void utls::FetchImageRGB(OutputStream& stream, unsigned width, unsigned heigth,
     {
         for (unsigned i = 0; i < heigth; i++)
         {
+            readScanLine(imageStream, srcScanLine);
             fetchScanLineRGB<3>((unsigned char*)scanLine.data(),
-                width, format, imageData + i * srcRowSize,
+                width, format, (const unsigned char*)srcScanLine.data(),
                 (const unsigned char*)smaskData.data() + i * width);
             stream.Write(scanLine.data(), scanLine.size());
         }
@@ -60,15 +76,16 @@ void utls::FetchImageRGB(OutputStream& stream, unsigned width, unsigned heigth,
 }
 
 void utls::FetchImageGrayScale(OutputStream& stream, unsigned width, unsigned heigth, PdfPixelFormat format,
-    const unsigned char* imageData, const charbuff& smaskData, charbuff& scanLine)
+    InputStream& imageStream, const charbuff& smaskData, charbuff& scanLine)
 {
-    unsigned srcRowSize = width * 3;
+    charbuff srcScanLine(width);
     if (smaskData.size() == 0)
     {
         for (unsigned i = 0; i < heigth; i++)
         {
+            readScanLine(imageStream, srcScanLine);
             fetchScanLineGrayScale((unsigned char*)scanLine.data(),
-                width, format, imageData + i * srcRowSize);
+                width, format, (const unsigned char*)srcScanLine.data());
             stream.Write(scanLine.data(), scanLine.size());
         }
     }
@@ -76,8 +93,9 @@ void utls::FetchImageGrayScale(OutputStream& stream, unsigned width, unsigned he
     {
         for (unsigned i = 0; i < heigth; i++)
         {
+            readScanLine(imageStream, srcScanLine);
             fetchScanLineGrayScale((unsigned char*)scanLine.data(),
-                width, format, imageData + i * srcRowSize,
+                width, format, (const unsigned char*)srcScanLine.data(),
                 (const unsigned char*)smaskData.data() + i * width);
             stream.Write(scanLine.data(), scanLine.size());
         }
@@ -87,13 +105,17 @@ void utls::FetchImageGrayScale(OutputStream& stream, unsigned width, unsigned he
 void utls::FetchImageBW(OutputStream& stream, unsigned width, unsigned heigth, PdfPixelFormat format,
     fxcodec::ScanlineDecoder& decoder, const charbuff& smaskData, charbuff& scanLine)
 {
+    // The 1 bit pixels are expanded to a grayscale
+    // scan line, then converted to the output format
+    charbuff grayScanLine(width);
     if (smaskData.size() == 0)
     {
         for (unsigned i = 0; i < heigth; i++)
         {
             auto scanLineBW = decoder.GetScanline(i);
-            fetchScanLineBW((unsigned char*)scanLine.data(),
-                width, format, (const unsigned char*)scanLineBW.data());
+            expandScanLineBW((unsigned char*)grayScanLine.data(), width, scanLineBW.data());
+            fetchScanLineGrayScale((unsigned char*)scanLine.data(),
+                width, format, (const unsigned char*)grayScanLine.data());
             stream.Write(scanLine.data(), scanLine.size());
         }
     }
@@ -102,8 +124,9 @@ void utls::FetchImageBW(OutputStream& stream, unsigned width, unsigned heigth, P
         for (unsigned i = 0; i < heigth; i++)
         {
             auto scanLineBW = decoder.GetScanline(i);
-            fetchScanLineBW((unsigned char*)scanLine.data(),
-                width, format, scanLineBW.data(),
+            expandScanLineBW((unsigned char*)grayScanLine.data(), width, scanLineBW.data());
+            fetchScanLineGrayScale((unsigned char*)scanLine.data(),
+                width, format, (const unsigned char*)grayScanLine.data(),
                 (const unsigned char*)smaskData.data() + i * width);
             stream.Write(scanLine.data(), scanLine.size());
         }
@@ -199,15 +222,31 @@ void utls::FetchImageJPEG(OutputStream& stream, PdfPixelFormat format,
 }
 #endif // PODOFO_HAVE_JPEG_LIB
 
+// Read a whole scan line. The data missing
+// in truncated streams is filled with zeroes
+void readScanLine(InputStream& stream, charbuff& srcScanLine)
+{
+    bool eof;
+    size_t read = stream.Read(srcScanLine.data(), srcScanLine.size(), eof);
+    if (read < srcScanLine.size())
+        std::memset(srcScanLine.data() + read, 0, srcScanLine.size() - read);
+}
+
 template <int bpp>
 void fetchScanLineRGB(unsigned char* dstScanLine, unsigned width, PdfPixelFormat format,
     const unsigned char* srcScanLine)
 {
+    unsigned i = 0;
+#ifdef PODOFO_HAVE_SSSE3
+    if (bpp == 3 && utls::HasSSSE3())
+        i = fetchScanLineRGBSSSE3(dstScanLine, width, format, srcScanLine, nullptr);
+#endif // PODOFO_HAVE_SSSE3
+
     switch (format)
     {
         case PdfPixelFormat::RGB24:
         {
-            for (unsigned i = 0; i < width; i++)
+            for (; i < width; i++)
             {
                 dstScanLine[i * 3 + 0] = srcScanLine[i * bpp + 0];
                 dstScanLine[i * 3 + 1] = srcScanLine[i * bpp + 1];
@@ -217,7 +256,7 @@ void fetchScanLineRGB(unsigned char* dstScanLine, unsigned width, PdfPixelFormat
         }
         case PdfPixelFormat::BGR24:
         {
-            for (unsigned i = 0; i < width; i++)
+            for (; i < width; i++)
             {
                 dstScanLine[i * 3 + 0] = srcScanLine[i * bpp + 2];
                 dstScanLine[i * 3 + 1] = srcScanLine[i * bpp + 1];
@@ -227,7 +266,7 @@ void fetchScanLineRGB(unsigned char* dstScanLine, unsigned width, PdfPixelFormat
         }
         case PdfPixelFormat::RGBA:
         {
-            for (unsigned i = 0; i < width; i++)
+            for (; i < width; i++)
             {
                 dstScanLine[i * 4 + 0] = srcScanLine[i * bpp + 0];
                 dstScanLine[i * 4 + 1] = srcScanLine[i * bpp + 1];
@@ -238,7 +277,7 @@ void fetchScanLineRGB(unsigned char* dstScanLine, unsigned width, PdfPixelFormat
         }
         case PdfPixelFormat::BGRA:
         {
-            for (unsigned i = 0; i < width; i++)
+            for (; i < width; i++)
             {
                 dstScanLine[i * 4 + 0] = srcScanLine[i * bpp + 2];
                 dstScanLine[i * 4 + 1] = srcScanLine[i * bpp + 1];
@@ -249,7 +288,7 @@ void fetchScanLineRGB(unsigned char* dstScanLine, unsigned width, PdfPixelFormat
         }
         case PdfPixelFormat::ARGB:
         {
-            for (unsigned i = 0; i < width; i++)
+            for (; i < width; i++)
             {
                 dstScanLine[i * 4 + 0] = 255;
                 dstScanLine[i * 4 + 1] = srcScanLine[i * bpp + 0];
@@ -260,7 +299,7 @@ void fetchScanLineRGB(unsigned char* dstScanLine, unsigned width, PdfPixelFormat
         }
         case PdfPixelFormat::ABGR:
         {
-            for (unsigned i = 0; i < width; i++)
+            for (; i < width; i++)
             {
                 dstScanLine[i * 4 + 0] = 255;
                 dstScanLine[i * 4 + 1] = srcScanLine[i * bpp + 2];
@@ -278,12 +317,18 @@ template <int bpp>
 void fetchScanLineRGB(unsigned char* dstScanLine, unsigned width, PdfPixelFormat format,
     const unsigned char* srcScanLine, const unsigned char* srcAphaLine)
 {
+    unsigned i = 0;
+#ifdef PODOFO_HAVE_SSSE3
+    if (bpp == 3 && utls::HasSSSE3())
+        i = fetchScanLineRGBSSSE3(dstScanLine, width, format, srcScanLine, srcAphaLine);
+#endif // PODOFO_HAVE_SSSE3
+
     switch (format)
     {
         // TODO: Handle alpha?
         case PdfPixelFormat::RGB24:
         {
-            for (unsigned i = 0; i < width; i++)
+            for (; i < width; i++)
             {
                 dstScanLine[i * 3 + 0] = srcScanLine[i * bpp + 0];
                 dstScanLine[i * 3 + 1] = srcScanLine[i * bpp + 1];
@@ -294,7 +339,7 @@ void fetchScanLineRGB(unsigned char* dstScanLine, unsigned width, PdfPixelFormat
         // TODO: Handle alpha?
         case PdfPixelFormat::BGR24:
         {
-            for (unsigned i = 0; i < width; i++)
+            for (; i < width; i++)
             {
                 dstScanLine[i * 3 + 0] = srcScanLine[i * bpp + 2];
                 dstScanLine[i * 3 + 1] = srcScanLine[i * bpp + 1];
@@ -304,7 +349,7 @@ void fetchScanLineRGB(unsigned char* dstScanLine, unsigned width, PdfPixelFormat
         }
         case PdfPixelFormat::RGBA:
         {
-            for (unsigned i = 0; i < width; i++)
+            for (; i < width; i++)
             {
                 dstScanLine[i * 4 + 0] = srcScanLine[i * bpp + 0];
                 dstScanLine[i * 4 + 1] = srcScanLine[i * bpp + 1];
@@ -315,7 +360,7 @@ void fetchScanLineRGB(unsigned char* dstScanLine, unsigned width, PdfPixelFormat
         }
         case PdfPixelFormat::BGRA:
         {
-            for (unsigned i = 0; i < width; i++)
+            for (; i < width; i++)
             {
                 dstScanLine[i * 4 + 0] = srcScanLine[i * bpp + 2];
                 dstScanLine[i * 4 + 1] = srcScanLine[i * bpp + 1];
@@ -326,7 +371,7 @@ void fetchScanLineRGB(unsigned char* dstScanLine, unsigned width, PdfPixelFormat
         }
         case PdfPixelFormat::ARGB:
         {
-            for (unsigned i = 0; i < width; i++)
+            for (; i < width; i++)
             {
                 dstScanLine[i * 4 + 0] = srcAphaLine[i];
                 dstScanLine[i * 4 + 1] = srcScanLine[i * bpp + 0];
@@ -337,7 +382,7 @@ void fetchScanLineRGB(unsigned char* dstScanLine, unsigned width, PdfPixelFormat
         }
         case PdfPixelFormat::ABGR:
         {
-            for (unsigned i = 0; i < width; i++)
+            for (; i < width; i++)
             {
                 dstScanLine[i * 4 + 0] = srcAphaLine[i];
                 dstScanLine[i * 4 + 1] = srcScanLine[i * bpp + 2];
@@ -354,18 +399,28 @@ void fetchScanLineRGB(unsigned char* dstScanLine, unsigned width, PdfPixelFormat
 void fetchScanLineGrayScale(unsigned char* dstScanLine, unsigned width, PdfPixelFormat format,
     const unsigned char* srcScanLine)
 {
+    unsigned i = 0;
+#ifdef PODOFO_HAVE_SSSE3
+    if (utls::HasSSSE3())
+        i = fetchScanLineGrayScaleSSSE3(dstScanLine, width, format, srcScanLine);
+#endif // PODOFO_HAVE_SSSE3
+#ifdef PODOFO_HAVE_SSE2
+    if (i == 0)
+        i = fetchScanLineGrayScaleSSE2(dstScanLine, width, format, srcScanLine, nullptr);
+#endif // PODOFO_HAVE_SSE2
+
     switch (format)
     {
         case PdfPixelFormat::Grayscale:
         {
-            for (unsigned i = 0; i < width; i++)
+            for (; i < width; i++)
                 dstScanLine[i] = srcScanLine[i];
             break;
         }
         case PdfPixelFormat::RGB24:
         case PdfPixelFormat::BGR24:
         {
-            for (unsigned i = 0; i < width; i++)
+            for (; i < width; i++)
             {
                 unsigned char gray = srcScanLine[i];
                 dstScanLine[i * 3 + 0] = gray;
@@ -377,7 +432,7 @@ void fetchScanLineGrayScale(unsigned char* dstScanLine, unsigned width, PdfPixel
         case PdfPixelFormat::RGBA:
         case PdfPixelFormat::BGRA:
         {
-            for (unsigned i = 0; i < width; i++)
+            for (; i < width; i++)
             {
                 unsigned char gray = srcScanLine[i];
                 dstScanLine[i * 4 + 0] = gray;
@@ -390,7 +445,7 @@ void fetchScanLineGrayScale(unsigned char* dstScanLine, unsigned width, PdfPixel
         case PdfPixelFormat::ARGB:
         case PdfPixelFormat::ABGR:
         {
-            for (unsigned i = 0; i < width; i++)
+            for (; i < width; i++)
             {
                 unsigned char gray = srcScanLine[i];
                 dstScanLine[i * 4 + 0] = 255;
@@ -408,12 +463,22 @@ void fetchScanLineGrayScale(unsigned char* dstScanLine, unsigned width, PdfPixel
 void fetchScanLineGrayScale(unsigned char* dstScanLine, unsigned width, PdfPixelFormat format,
     const unsigned char* srcScanLine, const unsigned char* srcAphaLine)
 {
+    unsigned i = 0;
+#ifdef PODOFO_HAVE_SSSE3
+    if (utls::HasSSSE3())
+        i = fetchScanLineGrayScaleSSSE3(dstScanLine, width, format, srcScanLine);
+#endif // PODOFO_HAVE_SSSE3
+#ifdef PODOFO_HAVE_SSE2
+    if (i == 0)
+        i = fetchScanLineGrayScaleSSE2(dstScanLine, width, format, srcScanLine, srcAphaLine);
+#endif // PODOFO_HAVE_SSE2
+
     switch (format)
     {
         // TODO: Handle alpha?
         case PdfPixelFormat::Grayscale:
         {
-            for (unsigned i = 0; i < width; i++)
+            for (; i < width; i++)
                 dstScanLine[i] = srcScanLine[i];
             break;
         }
@@ -421,7 +486,7 @@ void fetchScanLineGrayScale(unsigned char* dstScanLine, unsigned width, PdfPixel
         case PdfPixelFormat::RGB24:
         case PdfPixelFormat::BGR24:
         {
-            for (unsigned i = 0; i < width; i++)
+            for (; i < width; i++)
             {
                 unsigned char gray = srcScanLine[i];
                 dstScanLine[i * 3 + 0] = gray;
@@ -433,7 +498,7 @@ void fetchScanLineGrayScale(unsigned char* dstScanLine, unsigned width, PdfPixel
         case PdfPixelFormat::RGBA:
         case PdfPixelFormat::BGRA:
         {
-            for (unsigned i = 0; i < width; i++)
+            for (; i < width; i++)
             {
                 unsigned char gray = srcScanLine[i];
                 dstScanLine[i * 4 + 0] = gray;
@@ -446,7 +511,7 @@ void fetchScanLineGrayScale(unsigned char* dstScanLine, unsigned width, PdfPixel
         case PdfPixelFormat::ARGB:
         case PdfPixelFormat::ABGR:
         {
-            for (unsigned i = 0; i < width; i++)
+            for (; i < width; i++)
             {
                 unsigned char gray = srcScanLine[i];
                 dstScanLine[i * 4 + 0] = srcAphaLine[i];
@@ -461,113 +526,194 @@ void fetchScanLineGrayScale(unsigned char* dstScanLine, unsigned width, PdfPixel
     }
 }
 
-void fetchScanLineBW(unsigned char* dstScanLine, unsigned width,
-    PdfPixelFormat format, const unsigned char* srcScanLine)
+
+void expandScanLineBW(unsigned char* dstScanLine, unsigned width,
+    const unsigned char* srcScanLine)
+{
+    // Table of the 8 gray pixels for every byte of 1 bit pixels
+    static const auto s_pixels = [] {
+        array<array<unsigned char, 8>, 256> ret;
+        for (unsigned i = 0; i < 256; i++)
+        {
+            unsigned char byte[1] = { (unsigned char)i };
+            for (unsigned j = 0; j < 8; j++)
+                ret[i][j] = (unsigned char)(FETCH_BIT(byte, j) * 255);
+        }
+        return ret;
+    }();
+
+    unsigned i = 0;
+    for (; i + 8 <= width; i += 8)
+        std::memcpy(dstScanLine + i, s_pixels[srcScanLine[i / 8]].data(), 8);
+
+    for (; i < width; i++)
+        dstScanLine[i] = (unsigned char)(FETCH_BIT(srcScanLine, i) * 255);
+}
+
+#ifdef PODOFO_HAVE_SSE2
+
+// The kernels convert the scan line as long as whole vectors can be
+// read and written, and return the count of the converted pixels. The
+// remaining pixels are converted by the scalar loops
+
+unsigned fetchScanLineGrayScaleSSE2(unsigned char* dstScanLine, unsigned width,
+    PdfPixelFormat format, const unsigned char* srcScanLine,
+    const unsigned char* srcAphaLine)
 {
+    unsigned i = 0;
     switch (format)
     {
         case PdfPixelFormat::Grayscale:
         {
-            for (unsigned i = 0; i < width; i++)
-                dstScanLine[i] = (unsigned char)(FETCH_BIT(srcScanLine, i) * 255);
-            break;
-        }
-        case PdfPixelFormat::RGB24:
-        case PdfPixelFormat::BGR24:
-        {
-            for (unsigned i = 0; i < width; i++)
-            {
-                unsigned char value = (unsigned char)(FETCH_BIT(srcScanLine, i) * 255);
-                dstScanLine[i * 3 + 0] = value;
-                dstScanLine[i * 3 + 1] = value;
-                dstScanLine[i * 3 + 2] = value;
-            }
-            break;
+            std::memcpy(dstScanLine, srcScanLine, width);
+            return width;
         }
         case PdfPixelFormat::RGBA:
         case PdfPixelFormat::BGRA:
-        {
-            for (unsigned i = 0; i < width; i++)
-            {
-                unsigned char value = (unsigned char)(FETCH_BIT(srcScanLine, i) * 255);
-                dstScanLine[i * 4 + 0] = value;
-                dstScanLine[i * 4 + 1] = value;
-                dstScanLine[i * 4 + 2] = value;
-                dstScanLine[i * 4 + 3] = 255;
-            }
-            break;
-        }
         case PdfPixelFormat::ARGB:
         case PdfPixelFormat::ABGR:
         {
-            for (unsigned i = 0; i < width; i++)
+            bool alphaFirst = format == PdfPixelFormat::ARGB || format == PdfPixelFormat::ABGR;
+            __m128i alpha = _mm_set1_epi8(-1);
+            for (; i + 16 <= width; i += 16)
             {
-                unsigned char value = (unsigned char)(FETCH_BIT(srcScanLine, i) * 255);
-                dstScanLine[i * 4 + 0] = 255;
-                dstScanLine[i * 4 + 1] = value;
-                dstScanLine[i * 4 + 2] = value;
-                dstScanLine[i * 4 + 3] = value;
+                __m128i gray = _mm_loadu_si128(reinterpret_cast<const __m128i*>(srcScanLine + i));
+                if (srcAphaLine != nullptr)
+                    alpha = _mm_loadu_si128(reinterpret_cast<const __m128i*>(srcAphaLine + i));
+
+                // Interleave to (g, g) and (g, a) byte pairs, or (a, g)
+                // when alpha comes first, then the pairs to pixels
+                __m128i gg[2] = { _mm_unpacklo_epi8(gray, gray), _mm_unpackhi_epi8(gray, gray) };
+                __m128i ga[2];
+                if (alphaFirst)
+                {
+                    ga[0] = _mm_unpacklo_epi8(alpha, gray);
+                    ga[1] = _mm_unpackhi_epi8(alpha, gray);
+                }
+                else
+                {
+                    ga[0] = _mm_unpacklo_epi8(gray, alpha);
+                    ga[1] = _mm_unpackhi_epi8(gray, alpha);
+                }
+
+                auto dst = reinterpret_cast<__m128i*>(dstScanLine + i * 4);
+                for (unsigned j = 0; j < 2; j++)
+                {
+                    if (alphaFirst)
+                    {
+                        _mm_storeu_si128(dst + j * 2 + 0, _mm_unpacklo_epi16(ga[j], gg[j]));
+                        _mm_storeu_si128(dst + j * 2 + 1, _mm_unpackhi_epi16(ga[j], gg[j]));
+                    }
+                    else
+                    {
+                        _mm_storeu_si128(dst + j * 2 + 0, _mm_unpacklo_epi16(gg[j], ga[j]));
+                        _mm_storeu_si128(dst + j * 2 + 1, _mm_unpackhi_epi16(gg[j], ga[j]));
+                    }
+                }
             }
-            break;
+            return i;
         }
         default:
-            PODOFO_RAISE_ERROR_INFO(PdfErrorCode::UnsupportedImageFormat, "Unsupported pixel format");
+            return 0;
     }
 }
 
-void fetchScanLineBW(unsigned char* dstScanLine, unsigned width,
+#endif // PODOFO_HAVE_SSE2
+
+#ifdef PODOFO_HAVE_SSSE3
+
+unsigned fetchScanLineRGBSSSE3(unsigned char* dstScanLine, unsigned width,
     PdfPixelFormat format, const unsigned char* srcScanLine,
     const unsigned char* srcAphaLine)
 {
+    unsigned i = 0;
+    __m128i colorMask;
+    __m128i alphaMask;
     switch (format)
     {
-        // TODO: Handle alpha?
-        case PdfPixelFormat::Grayscale:
+        case PdfPixelFormat::RGB24:
         {
-            for (unsigned i = 0; i < width; i++)
-                dstScanLine[i] = (unsigned char)(FETCH_BIT(srcScanLine, i) * 255);
-            break;
+            std::memcpy(dstScanLine, srcScanLine, (size_t)width * 3);
+            return width;
         }
-        // TODO: Handle alpha?
-        case PdfPixelFormat::RGB24:
         case PdfPixelFormat::BGR24:
         {
-            for (unsigned i = 0; i < width; i++)
+            // 16 bytes are read and written, but only 5 pixels are
+            // converted: the last byte is overwritten afterwards
+            colorMask = _mm_setr_epi8(2, 1, 0, 5, 4, 3, 8, 7, 6, 11, 10, 9, 14, 13, 12, 15);
+            for (; i + 6 <= width; i += 5)
             {
-                unsigned char value = (unsigned char)(FETCH_BIT(srcScanLine, i) * 255);
-                dstScanLine[i * 3 + 0] = value;
-                dstScanLine[i * 3 + 1] = value;
-                dstScanLine[i * 3 + 2] = value;
+                __m128i pixels = _mm_loadu_si128(reinterpret_cast<const __m128i*>(srcScanLine + i * 3));
+                _mm_storeu_si128(reinterpret_cast<__m128i*>(dstScanLine + i * 3),
+                    _mm_shuffle_epi8(pixels, colorMask));
             }
-            break;
+            return i;
         }
         case PdfPixelFormat::RGBA:
+            colorMask = _mm_setr_epi8(0, 1, 2, -1, 3, 4, 5, -1, 6, 7, 8, -1, 9, 10, 11, -1);
+            alphaMask = _mm_setr_epi8(-1, -1, -1, 0, -1, -1, -1, 1, -1, -1, -1, 2, -1, -1, -1, 3);
+            break;
         case PdfPixelFormat::BGRA:
-        {
-            for (unsigned i = 0; i < width; i++)
-            {
-                unsigned char value = (unsigned char)(FETCH_BIT(srcScanLine, i) * 255);
-                dstScanLine[i * 4 + 0] = value;
-                dstScanLine[i * 4 + 1] = value;
-                dstScanLine[i * 4 + 2] = value;
-                dstScanLine[i * 4 + 3] = srcAphaLine[i];
-            }
+            colorMask = _mm_setr_epi8(2, 1, 0, -1, 5, 4, 3, -1, 8, 7, 6, -1, 11, 10, 9, -1);
+            alphaMask = _mm_setr_epi8(-1, -1, -1, 0, -1, -1, -1, 1, -1, -1, -1, 2, -1, -1, -1, 3);
             break;
-        }
         case PdfPixelFormat::ARGB:
+            colorMask = _mm_setr_epi8(-1, 0, 1, 2, -1, 3, 4, 5, -1, 6, 7, 8, -1, 9, 10, 11);
+            alphaMask = _mm_setr_epi8(0, -1, -1, -1, 1, -1, -1, -1, 2, -1, -1, -1, 3, -1, -1, -1);
+            break;
         case PdfPixelFormat::ABGR:
+            colorMask = _mm_setr_epi8(-1, 2, 1, 0, -1, 5, 4, 3, -1, 8, 7, 6, -1, 11, 10, 9);
+            alphaMask = _mm_setr_epi8(0, -1, -1, -1, 1, -1, -1, -1, 2, -1, -1, -1, 3, -1, -1, -1);
+            break;
+        default:
+            return 0;
+    }
+
+    // 16 bytes are read, but only 4 pixels are converted
+    __m128i alpha = _mm_shuffle_epi8(_mm_set1_epi8(-1), alphaMask);
+    for (; i + 6 <= width; i += 4)
+    {
+        __m128i pixels = _mm_loadu_si128(reinterpret_cast<const __m128i*>(srcScanLine + i * 3));
+        if (srcAphaLine != nullptr)
+        {
+            int32_t alphas;
+            std::memcpy(&alphas, srcAphaLine + i, 4);
+            alpha = _mm_shuffle_epi8(_mm_cvtsi32_si128(alphas), alphaMask);
+        }
+
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dstScanLine + i * 4),
+            _mm_or_si128(_mm_shuffle_epi8(pixels, colorMask), alpha));
+    }
+    return i;
+}
+
+unsigned fetchScanLineGrayScaleSSSE3(unsigned char* dstScanLine, unsigned width,
+    PdfPixelFormat format, const unsigned char* srcScanLine)
+{
+    switch (format)
+    {
+        case PdfPixelFormat::RGB24:
+        case PdfPixelFormat::BGR24:
         {
-            for (unsigned i = 0; i < width; i++)
+            const __m128i masks[3] = {
+                _mm_setr_epi8(0, 0, 0, 1, 1, 1, 2, 2, 2, 3, 3, 3, 4, 4, 4, 5),
+                _mm_setr_epi8(5, 5, 6, 6, 6, 7, 7, 7, 8, 8, 8, 9, 9, 9, 10, 10),
+                _mm_setr_epi8(10, 11, 11, 11, 12, 12, 12, 13, 13, 13, 14, 14, 14, 15, 15, 15),
+            };
+            unsigned i = 0;
+            for (; i + 16 <= width; i += 16)
             {
-                unsigned char value = (unsigned char)(FETCH_BIT(srcScanLine, i) * 255);
-                dstScanLine[i * 4 + 0] = srcAphaLine[i];
-                dstScanLine[i * 4 + 1] = value;
-                dstScanLine[i * 4 + 2] = value;
-                dstScanLine[i * 4 + 3] = value;
+                __m128i gray = _mm_loadu_si128(reinterpret_cast<const __m128i*>(srcScanLine + i));
+                auto dst = reinterpret_cast<__m128i*>(dstScanLine + i * 3);
+                for (unsigned j = 0; j < 3; j++)
+                    _mm_storeu_si128(dst + j, _mm_shuffle_epi8(gray, masks[j]));
             }
-            break;
+            return i;
         }
         default:
-            PODOFO_RAISE_ERROR_INFO(PdfErrorCode::UnsupportedImageFormat, "Unsupported pixel format");
+            // The other formats are handled by the SSE2 kernel
+            return 0;
     }
 }
+
+#endif // PODOFO_HAVE_SSSE3
@@ -7,6 +7,7 @@
 #ifndef IMAGE_UTILS_H
 #define IMAGE_UTILS_H
 
+#include <podofo/auxiliary/InputStream.h>
 #include <podofo/auxiliary/OutputStream.h>
 
 #ifdef PODOFO_HAVE_JPEG_LIB
@@ -18,14 +19,16 @@
 namespace utls
 {
     /** Fetch a RGB image and write it to the stream
+     * \param imageStream the image data, read one scan line at time
      */
     void FetchImageRGB(PoDoFo::OutputStream& stream, unsigned width, unsigned heigth, PoDoFo::PdfPixelFormat format,
-        const unsigned char* imageData, const PoDoFo::charbuff& smaskData, PoDoFo::charbuff& scanLine);
+        PoDoFo::InputStream& imageStream, const PoDoFo::charbuff& smaskData, PoDoFo::charbuff& scanLine);
 
     /** Fetch a GrayScale image and write it to the stream
+     * \param imageStream the image data, read one scan line at time
      */
     void FetchImageGrayScale(PoDoFo::OutputStream& stream, unsigned width, unsigned heigth, PoDoFo::PdfPixelFormat format,
-        const unsigned char* imageData, const PoDoFo::charbuff& smaskData, PoDoFo::charbuff& scanLine);
+        PoDoFo::InputStream& imageStream, const PoDoFo::charbuff& smaskData, PoDoFo::charbuff& scanLine);
 
     /** Fetch a black and white image and write it to the stream
      */
@@ -283,3 +283,102 @@ void PoDoFo::jpeg_memory_src(j_decompress_ptr ctx, const JOCTET* buffer, size_t
     src->pub.next_input_byte = buffer;
     src->pub.bytes_in_buffer = bufsize;
 }
+
+/* Expanded data source object for stream input */
+struct my_stream_source_mgr
+{
+    struct jpeg_source_mgr pub; /* public fields */
+    InputStream* stream;
+    JOCTET* buffer;
+    bool start_of_file;
+};
+
+using my_stream_src_ptr = my_stream_source_mgr*;
+
+constexpr size_t INPUT_BUF_SIZE = 4096;
+
+METHODDEF(void) init_stream_source(j_decompress_ptr ctx)
+{
+    my_stream_src_ptr src = reinterpret_cast<my_stream_src_ptr>(ctx->src);
+    src->start_of_file = true;
+}
+
+/*
+ * Fill the input buffer with the next chunk of the stream.
+ * Like in the memory source, a premature EOF is handled
+ * by supplying a fake EOI marker
+ */
+METHODDEF(boolean) fill_stream_input_buffer(j_decompress_ptr ctx)
+{
+    my_stream_src_ptr src = reinterpret_cast<my_stream_src_ptr>(ctx->src);
+    bool eof;
+    size_t read = src->stream->Read(reinterpret_cast<char*>(src->buffer), INPUT_BUF_SIZE, eof);
+    if (read == 0)
+    {
+        if (src->start_of_file)
+            ERREXIT(ctx, JERR_INPUT_EMPTY);
+
+        WARNMS(ctx, JWRN_JPEG_EOF);
+
+        /* Create a fake EOI marker */
+        src->buffer[0] = static_cast<JOCTET>(0xFF);
+        src->buffer[1] = static_cast<JOCTET>(JPEG_EOI);
+        read = 2;
+    }
+
+    src->pub.next_input_byte = src->buffer;
+    src->pub.bytes_in_buffer = read;
+    src->start_of_file = false;
+    return TRUE;
+}
+
+METHODDEF(void) skip_stream_input_data(j_decompress_ptr ctx, long num_bytes)
+{
+    my_stream_src_ptr src = reinterpret_cast<my_stream_src_ptr>(ctx->src);
+
+    if (num_bytes > 0)
+    {
+        while (num_bytes > static_cast<long>(src->pub.bytes_in_buffer))
+        {
+            num_bytes -= static_cast<long>(src->pub.bytes_in_buffer);
+            fill_stream_input_buffer(ctx);
+        }
+
+        src->pub.next_input_byte += static_cast<size_t>(num_bytes);
+        src->pub.bytes_in_buffer -= static_cast<size_t>(num_bytes);
+    }
+}
+
+/*
+ * Prepare for input from a stream.
+ */
+void PoDoFo::jpeg_stream_src(j_decompress_ptr ctx, InputStream& stream)
+{
+    my_stream_src_ptr src;
+
+    /* NOTE: Like in jpeg_memory_src, the source object is made permanent,
+     * so it's unsafe to use this manager and a different source
+     * manager serially with the same JPEG object.
+     */
+    if (ctx->src == nullptr)
+    {
+        ctx->src = static_cast<struct jpeg_source_mgr*>(
+            (*ctx->mem->alloc_small) (reinterpret_cast<j_common_ptr>(ctx), JPOOL_PERMANENT,
+                sizeof(my_stream_source_mgr)));
+        src = reinterpret_cast<my_stream_src_ptr>(ctx->src);
+        src->buffer = static_cast<JOCTET*>(
+            (*ctx->mem->alloc_small) (reinterpret_cast<j_common_ptr>(ctx), JPOOL_PERMANENT,
+                INPUT_BUF_SIZE * sizeof(JOCTET)));
+    }
+
+    src = reinterpret_cast<my_stream_src_ptr>(ctx->src);
+    src->pub.init_source = init_stream_source;
+    src->pub.fill_input_buffer = fill_stream_input_buffer;
+    src->pub.skip_input_data = skip_stream_input_data;
+    src->pub.resync_to_restart = jpeg_resync_to_restart; /* use default method */
+    src->pub.term_source = term_source;
+    src->stream = &stream;
+
+    src->pub.next_input_byte = nullptr; /* forces fill_input_buffer on first read */
+    src->pub.bytes_in_buffer = 0;
+}
@@ -2,6 +2,7 @@
 #define JPEG_COMMON_H
 
 #include <podofo/main/PdfDeclarations.h>
+#include <podofo/auxiliary/InputStream.h>
 #include <csetjmp>
 
 extern "C" {
@@ -24,6 +25,8 @@ namespace PoDoFo
     void InitJpegDecompressContext(jpeg_decompress_struct& ctx, JpegErrorHandler& jerr);
     void SetJpegBufferDestination(jpeg_compress_struct& ctx, charbuff& buff, JpegBufferDestination& jdest);
     void jpeg_memory_src(j_decompress_ptr cinfo, const JOCTET* buffer, size_t bufsize);
+    // NOTE: The stream is read incrementally while decompressing
+    void jpeg_stream_src(j_decompress_ptr cinfo, InputStream& stream);
     void ConvertScanlineCYMKToRGB(j_decompress_ptr info, JSAMPROW scanLine);
 }
 
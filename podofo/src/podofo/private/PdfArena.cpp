@@ -0,0 +1,149 @@
+/**
+ * SPDX-FileCopyrightText: (C) 2024 Francesco Pretto <ceztko@gmail.com>
+ * SPDX-License-Identifier: LGPL-2.0-or-later
+ * SPDX-License-Identifier: MPL-2.0
+ */
+
+#include "PdfDeclarationsPrivate.h"
+#include "PdfArena.h"
+
+using namespace std;
+using namespace PoDoFo;
+
+// Chunks are aligned to their size, so the chunk containing a
+// block, and its arena, is found by masking the block address.
+// Larger blocks get a dedicated chunk, still starting at an
+// aligned address
+static constexpr size_t ChunkSize = 64 * 1024;
+static constexpr size_t DedicatedBlockSize = ChunkSize / 4;
+
+struct PdfArena::Chunk
+{
+    Chunk* Next;
+    PdfArena* Arena;
+    size_t Size;
+    atomic<size_t> Used;
+
+    char* GetData() { return reinterpret_cast<char*>(this + 1); }
+};
+
+// Number of the live arenas: when there are none, the
+// current arena is not looked up at all
+static atomic<unsigned> s_arenaCount(0);
+static thread_local PdfArena* s_current = nullptr;
+
+PdfArena::Scope::Scope(PdfArena* arena)
+    : m_previous(s_current)
+{
+    s_current = arena;
+}
+
+PdfArena::Scope::~Scope()
+{
+    s_current = m_previous;
+}
+
+PdfArena::PdfArena() :
+    m_refCount(1),
+    m_current(nullptr),
+    m_chunks(nullptr),
+    m_reservedSize(0)
+{
+    s_arenaCount.fetch_add(1, memory_order_relaxed);
+}
+
+PdfArena::~PdfArena()
+{
+    auto chunk = m_chunks;
+    while (chunk != nullptr)
+    {
+        auto next = chunk->Next;
+        chunk->~Chunk();
+        ::operator delete(chunk, align_val_t(ChunkSize));
+        chunk = next;
+    }
+
+    s_arenaCount.fetch_sub(1, memory_order_relaxed);
+}
+
+PdfArena* PdfArena::Create()
+{
+    return new PdfArena();
+}
+
+void PdfArena::Release()
+{
+    release();
+}
+
+PdfArena* PdfArena::GetCurrent()
+{
+    // NOTE: An arena is set as current only
+    // by who holds a reference to it
+    if (s_arenaCount.load(memory_order_relaxed) == 0)
+        return nullptr;
+
+    return s_current;
+}
+
+void* PdfArena::Allocate(size_t size)
+{
+    // Round up so the next block stays aligned. Empty blocks
+    // still take some space, so they never lie at the end of
+    // a chunk
+    size = (std::max<size_t>(size, 1) + BlockAlignment - 1) & ~(BlockAlignment - 1);
+    if (size > DedicatedBlockSize)
+    {
+        unique_lock<mutex> lock(m_mutex);
+        auto chunk = createChunk(size);
+        chunk->Used.store(size, memory_order_relaxed);
+        m_refCount.fetch_add(1, memory_order_relaxed);
+        return chunk->GetData();
+    }
+
+    // Bump the current chunk without locking, a
+    // new chunk is created only when it's full
+    while (true)
+    {
+        auto chunk = m_current.load(memory_order_acquire);
+        if (chunk != nullptr)
+        {
+            size_t offset = chunk->Used.fetch_add(size, memory_order_relaxed);
+            if (offset + size <= chunk->Size)
+            {
+                m_refCount.fetch_add(1, memory_order_relaxed);
+                return chunk->GetData() + offset;
+            }
+        }
+
+        unique_lock<mutex> lock(m_mutex);
+        if (m_current.load(memory_order_relaxed) == chunk)
+            m_current.store(createChunk(ChunkSize - sizeof(Chunk)), memory_order_release);
+    }
+}
+
+void PdfArena::Deallocate(void* block) noexcept
+{
+    auto chunk = reinterpret_cast<Chunk*>(reinterpret_cast<uintptr_t>(block) & ~(uintptr_t)(ChunkSize - 1));
+    chunk->Arena->release();
+}
+
+PdfArena::Chunk* PdfArena::createChunk(size_t size)
+{
+    static_assert(sizeof(Chunk) % BlockAlignment == 0, "The chunk data must be aligned");
+    size_t chunkSize = sizeof(Chunk) + size;
+    auto chunk = new(::operator new(chunkSize, align_val_t(ChunkSize))) Chunk();
+    chunk->Next = m_chunks;
+    chunk->Arena = this;
+    chunk->Size = size;
+    chunk->Used.store(0, memory_order_relaxed);
+    m_chunks = chunk;
+    m_reservedSize += chunkSize;
+    return chunk;
+}
+
+void PdfArena::release() noexcept
+{
+    if (m_refCount.fetch_sub(1, memory_order_acq_rel) == 1)
+        delete this;
+}
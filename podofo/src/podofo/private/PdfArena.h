@@ -0,0 +1,144 @@
+/**
+ * SPDX-FileCopyrightText: (C) 2024 Francesco Pretto <ceztko@gmail.com>
+ * SPDX-License-Identifier: LGPL-2.0-or-later
+ * SPDX-License-Identifier: MPL-2.0
+ */
+
+#ifndef PDF_ARENA_H
+#define PDF_ARENA_H
+
+#include <cstddef>
+#include <atomic>
+#include <mutex>
+#include <new>
+#include <utility>
+
+namespace PoDoFo
+{
+    /**
+     * Monotonic memory arena for objects built by the parser of a
+     * single document. Memory handed out by the arena is never reused:
+     * deallocation only drops a reference, and all chunks are returned
+     * to the system at once when both the owner and the last allocation
+     * have released the arena, usually when the document is cleared
+     *
+     * Blocks carry no header: their owners record whether they come
+     * from an arena, e.g. with a flag set at construction, and the
+     * arena of a block is found from the aligned chunk containing it
+     */
+    class PdfArena final
+    {
+    public:
+        /** Set the current arena for the calling thread for the
+         * lifetime of the scope. A nullptr arena routes allocations
+         * to the heap
+         */
+        class Scope final
+        {
+        public:
+            Scope(PdfArena* arena);
+            ~Scope();
+        private:
+            Scope(const Scope&) = delete;
+            Scope& operator=(const Scope&) = delete;
+        private:
+            PdfArena* m_previous;
+        };
+
+    public:
+        /** Create a new arena, owned by the caller
+         * \remarks Call Release() to give up ownership
+         */
+        static PdfArena* Create();
+
+        /** Give up the reference held by the owner
+         */
+        void Release();
+
+        /** Get the current arena of the calling thread, or nullptr
+         * \remarks It doesn't look at the thread as long as no arena exists
+         */
+        static PdfArena* GetCurrent();
+
+        /** Alignment of the blocks handed out by an arena
+         */
+        static constexpr size_t BlockAlignment = alignof(void*) > alignof(double) ? alignof(void*) : alignof(double);
+
+        /** Allocate a block from this arena, aligned to BlockAlignment
+         */
+        void* Allocate(size_t size);
+
+        /** Deallocate a block returned by Allocate() on any arena
+         */
+        static void Deallocate(void* block) noexcept;
+
+        /** Create an object in the given arena, or on the heap if nullptr
+         */
+        template <typename T, typename... TArgs>
+        static T* New(PdfArena* arena, TArgs&&... args);
+
+        /** Destroy an object created by New()
+         * \param inArena true if the object was created in an arena
+         */
+        template <typename T>
+        static void Delete(T* obj, bool inArena) noexcept;
+
+        /** Total bytes requested from the system by this arena
+         */
+        size_t GetReservedSize() const { return m_reservedSize; }
+
+    private:
+        PdfArena();
+        ~PdfArena();
+
+        PdfArena(const PdfArena&) = delete;
+        PdfArena& operator=(const PdfArena&) = delete;
+
+    private:
+        struct Chunk;
+
+        Chunk* createChunk(size_t size);
+        void release() noexcept;
+
+    private:
+        std::atomic<size_t> m_refCount;
+        std::atomic<Chunk*> m_current;
+        std::mutex m_mutex;
+        Chunk* m_chunks;
+        size_t m_reservedSize;
+    };
+
+    template <typename T, typename... TArgs>
+    T* PdfArena::New(PdfArena* arena, TArgs&&... args)
+    {
+        if (arena == nullptr)
+            return new T(std::forward<TArgs>(args)...);
+
+        auto block = arena->Allocate(sizeof(T));
+        try
+        {
+            return new(block) T(std::forward<TArgs>(args)...);
+        }
+        catch (...)
+        {
+            Deallocate(block);
+            throw;
+        }
+    }
+
+    template <typename T>
+    void PdfArena::Delete(T* obj, bool inArena) noexcept
+    {
+        if (inArena)
+        {
+            obj->~T();
+            Deallocate(obj);
+        }
+        else
+        {
+            delete obj;
+        }
+    }
+}
+
+#endif // PDF_ARENA_H
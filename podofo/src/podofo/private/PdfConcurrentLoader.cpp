@@ -0,0 +1,115 @@
+/**
+ * SPDX-FileCopyrightText: (C) 2024 Francesco Pretto <ceztko@gmail.com>
+ * SPDX-License-Identifier: LGPL-2.0-or-later
+ * SPDX-License-Identifier: MPL-2.0
+ */
+
+#include "PdfDeclarationsPrivate.h"
+#include "PdfConcurrentLoader.h"
+
+#include <podofo/auxiliary/StreamDevice.h>
+
+using namespace std;
+using namespace PoDoFo;
+
+PdfConcurrentLoader::PdfConcurrentLoader(InputStreamDevice& device)
+    : m_device(&device), m_view(nullptr), m_viewLength(0)
+{
+    bufferview view;
+    auto mmapDevice = dynamic_cast<const MmapStreamDevice*>(&device);
+    if (mmapDevice != nullptr)
+    {
+        view = mmapDevice->GetView();
+    }
+    else
+    {
+        auto spanDevice = dynamic_cast<const SpanStreamDevice*>(&device);
+        if (spanDevice != nullptr)
+            view = spanDevice->GetView();
+    }
+
+    m_view = view.data();
+    m_viewLength = view.size();
+}
+
+void PdfConcurrentLoader::LoadOnce(atomic<bool>& done, const function<void()>& load)
+{
+    auto threadId = this_thread::get_id();
+    unique_lock<mutex> lock(m_mutex);
+    while (true)
+    {
+        if (done.load(memory_order_acquire))
+            return;
+
+        auto found = m_loading.find(&done);
+        if (found == m_loading.end())
+            break;
+
+        // Waiting for a load that is, directly or through other
+        // threads, waiting for this thread would never end
+        if (found->second == threadId || isWaitingFor(found->second, threadId))
+            PODOFO_RAISE_ERROR_INFO(PdfErrorCode::BrokenFile, "Recursive loading of an object");
+
+        m_waiting[threadId] = &done;
+        m_loaded.wait(lock);
+        m_waiting.erase(threadId);
+    }
+
+    m_loading.emplace(&done, threadId);
+    lock.unlock();
+    try
+    {
+        load();
+    }
+    catch (...)
+    {
+        // Let another thread retry the load
+        lock.lock();
+        m_loading.erase(&done);
+        m_loaded.notify_all();
+        throw;
+    }
+
+    lock.lock();
+    done.store(true, memory_order_release);
+    m_loading.erase(&done);
+    m_loaded.notify_all();
+}
+
+bool PdfConcurrentLoader::isWaitingFor(thread::id loadingThread, thread::id threadId) const
+{
+    // Follow the chain of the threads waiting for each other.
+    // The chain can't have cycles, since they are never entered
+    while (true)
+    {
+        auto waiting = m_waiting.find(loadingThread);
+        if (waiting == m_waiting.end())
+            return false;
+
+        auto loading = m_loading.find(waiting->second);
+        if (loading == m_loading.end())
+            return false;
+
+        if (loading->second == threadId)
+            return true;
+
+        loadingThread = loading->second;
+    }
+}
+
+void PdfConcurrentLoader::ReadAt(InputStreamDevice& device, size_t offset,
+    const function<void(InputStreamDevice&)>& read)
+{
+    if (&device != m_device || m_view == nullptr)
+    {
+        // Devices with a single cursor are accessed one load at a time
+        unique_lock<mutex> lock(m_deviceMutex);
+        device.Seek((ssize_t)offset);
+        read(device);
+        return;
+    }
+
+    SpanStreamDevice cursor(m_view, m_viewLength);
+    cursor.Seek((ssize_t)offset);
+    read(cursor);
+}
@@ -0,0 +1,78 @@
+/**
+ * SPDX-FileCopyrightText: (C) 2024 Francesco Pretto <ceztko@gmail.com>
+ * SPDX-License-Identifier: LGPL-2.0-or-later
+ * SPDX-License-Identifier: MPL-2.0
+ */
+
+#ifndef PDF_CONCURRENT_LOADER_H
+#define PDF_CONCURRENT_LOADER_H
+
+#include <atomic>
+#include <mutex>
+#include <thread>
+#include <functional>
+#include <condition_variable>
+#include <unordered_map>
+
+#include <podofo/auxiliary/InputDevice.h>
+
+namespace PoDoFo
+{
+    /**
+     * Coordinates delayed loading of the objects of a document
+     * read by multiple threads
+     *
+     * Each object (or stream) is loaded exactly once: the first
+     * thread requesting it performs the load while the others wait
+     * for it to complete. Loads of different objects run in parallel
+     * and, when the source device is memory backed, read through
+     * private cursors over the source instead of seeking the shared
+     * device, similarly to positional reads. Other devices are
+     * accessed one load at a time
+     */
+    class PdfConcurrentLoader final
+    {
+    public:
+        PdfConcurrentLoader(InputStreamDevice& device);
+
+        /** Run the load function once, unless the done flag is already set.
+         * The flag is set with release semantics after the load completes,
+         * so readers checking it with acquire semantics see the loaded data
+         * \remarks A load requesting itself, also through loads in progress
+         * on other threads, raises PdfErrorCode::BrokenFile instead of
+         * waiting forever
+         */
+        void LoadOnce(std::atomic<bool>& done, const std::function<void()>& load);
+
+        /** Read from the given device, starting at the given offset.
+         * The read function must not trigger the loading of other objects
+         * \param device the source device, or another device that
+         *      will be accessed one load at a time
+         * \param read read function, called with a device that is
+         *      private to the calling thread while it's running
+         */
+        void ReadAt(InputStreamDevice& device, size_t offset,
+            const std::function<void(InputStreamDevice&)>& read);
+
+    private:
+        bool isWaitingFor(std::thread::id loadingThread, std::thread::id threadId) const;
+
+    private:
+        PdfConcurrentLoader(const PdfConcurrentLoader&) = delete;
+        PdfConcurrentLoader& operator=(const PdfConcurrentLoader&) = delete;
+
+    private:
+        InputStreamDevice* m_device;
+        const char* m_view;        // Memory of the source, if it's memory backed
+        size_t m_viewLength;
+        std::mutex m_mutex;
+        std::condition_variable m_loaded;
+        // Flags of the loads in progress -> loading thread
+        std::unordered_map<const std::atomic<bool>*, std::thread::id> m_loading;
+        // Waiting thread -> flag of the load it's waiting for
+        std::unordered_map<std::thread::id, const std::atomic<bool>*> m_waiting;
+        std::mutex m_deviceMutex;
+    };
+}
+
+#endif // PDF_CONCURRENT_LOADER_H
@@ -386,7 +386,7 @@ void PoDoFo::WriteOperator_TJ_String(PdfStringStream& stream, const string_view&
 
 void PoDoFo::WriteOperator_TJ_End(PdfStringStream& stream)
 {
-    stream << ']' << " TJ\n" << endl;
+    stream << "] TJ\n\n";
 }
 
 void PoDoFo::WriteOperator_cm(PdfStringStream& stream, double a, double b, double c, double d, double e, double f)
@@ -9,10 +9,19 @@
 #include <podofo/main/PdfDictionary.h>
 #include <podofo/main/PdfTokenizer.h>
 #include <podofo/auxiliary/StreamDevice.h>
+#include "simd_compat.h"
 
 using namespace std;
 using namespace PoDoFo;
 
+// PNG filter kernels. Each one decodes a row from the filtered bytes
+// "raw" and the previous decoded row "prev" into "dst". "bpp" is the
+// distance in bytes to the corresponding byte of the left pixel
+static void decodePngSub(const unsigned char* raw, unsigned char* dst, size_t len, unsigned bpp);
+static void decodePngUp(const unsigned char* raw, const unsigned char* prev, unsigned char* dst, size_t len);
+static void decodePngAverage(const unsigned char* raw, const unsigned char* prev, unsigned char* dst, size_t len, unsigned bpp);
+static void decodePngPaeth(const unsigned char* raw, const unsigned char* prev, unsigned char* dst, size_t len, unsigned bpp);
+
 namespace PoDoFo {
 
 // Private data for PdfAscii85Filter. This will be optimised
@@ -43,21 +52,6 @@ public:
         if (m_ColumnCount < 1 || m_Colors < 1 || m_BitsPerComponent < 1)
             PODOFO_RAISE_ERROR(PdfErrorCode::ValueOutOfRange);
 
-        if (m_Predictor >= 10)
-        {
-            m_NextByteIsPredictor = true;
-            m_CurrPredictor = -1;
-        }
-        else
-        {
-            m_NextByteIsPredictor = false;
-            m_CurrPredictor = m_Predictor;
-        }
-
-        m_CurrRowIndex = 0;
-        m_BytesPerPixel = (m_BitsPerComponent * m_Colors) >> 3;
-        m_Rows = (m_ColumnCount * m_Colors * m_BitsPerComponent) >> 3;
-
         // check for multiplication overflow on buffer sizes (e.g. if m_nBPC=2 and m_nColors=SIZE_MAX/2+1)
         if (utls::DoesMultiplicationOverflow(m_BitsPerComponent, m_Colors)
             || utls::DoesMultiplicationOverflow(m_ColumnCount, (size_t)m_BitsPerComponent * m_Colors))
@@ -65,15 +59,34 @@ public:
             PODOFO_RAISE_ERROR(PdfErrorCode::ValueOutOfRange);
         }
 
-        // check that computed allocation sizes are > 0 (CVE-2018-20797)
-        if (m_Rows < 1 || m_BitsPerComponent < 1)
-            PODOFO_RAISE_ERROR(PdfErrorCode::ValueOutOfRange);
+        if (m_Predictor == 2)
+        {
+            switch (m_BitsPerComponent)
+            {
+                case 1:
+                case 2:
+                case 4:
+                case 8:
+                case 16:
+                    break;
+                default:
+                    PODOFO_RAISE_ERROR_INFO(PdfErrorCode::InvalidPredictor,
+                        "tiff predictor is not supported for {} BPC", m_BitsPerComponent);
+            }
+        }
+
+        // Rows are padded to a byte boundary. Filters operating on
+        // less than a byte per pixel use the previous byte instead
+        size_t bitsPerPixel = (size_t)m_BitsPerComponent * m_Colors;
+        m_BytesPerPixel = (unsigned)std::max<size_t>(1, (bitsPerPixel + 7) / 8);
+        m_RowLength = (m_ColumnCount * bitsPerPixel + 7) / 8;
 
-        m_Prev.resize(m_Rows);
-        memset(m_Prev.data(), 0, sizeof(char) * m_Rows);
+        // PNG predictors prepend a filter type byte to each row
+        m_InputRowLength = m_RowLength + (m_Predictor >= 10 ? 1 : 0);
 
-        m_UpperLeftPixelComponents.resize(m_BytesPerPixel);
-        memset(m_UpperLeftPixelComponents.data(), 0, sizeof(char) * m_BytesPerPixel);
+        m_Prev.resize(m_RowLength);
+        m_Partial.resize(m_InputRowLength);
+        m_PartialLength = 0;
     }
 
     void Decode(const char* buffer, size_t len, OutputStream& stream)
@@ -84,114 +97,152 @@ public:
             return;
         }
 
-        while (len-- != 0)
+        auto src = reinterpret_cast<const unsigned char*>(buffer);
+        bool completesRow = false;
+        if (m_PartialLength != 0)
+        {
+            // Complete the row left over by the previous block
+            size_t count = std::min(len, m_InputRowLength - m_PartialLength);
+            std::memcpy(m_Partial.data() + m_PartialLength, src, count);
+            m_PartialLength += count;
+            src += count;
+            len -= count;
+            if (m_PartialLength < m_InputRowLength)
+                return;
+
+            completesRow = true;
+        }
+
+        // Decode all the available rows in a single output
+        // buffer, so they can be written at once
+        size_t rowCount = len / m_InputRowLength;
+        size_t outputRowCount = rowCount + (completesRow ? 1 : 0);
+        if (outputRowCount != 0)
         {
-            if (m_NextByteIsPredictor)
+            m_Output.resize(outputRowCount * m_RowLength);
+            auto dst = reinterpret_cast<unsigned char*>(m_Output.data());
+            const unsigned char* prev = m_Prev.data();
+            if (completesRow)
             {
-                m_CurrPredictor = *buffer + 10;
-                m_NextByteIsPredictor = false;
+                decodeRow(m_Partial.data(), prev, dst);
+                prev = dst;
+                dst += m_RowLength;
+                m_PartialLength = 0;
             }
-            else
-            {
-                switch (m_CurrPredictor)
-                {
-                    case 2: // Tiff Predictor
-                    {
-                        if (m_BitsPerComponent == 8)
-                        {   // Same as png sub
-                            char prev = (m_CurrRowIndex - m_BytesPerPixel < 0
-                                ? 0 : m_Prev[m_CurrRowIndex - m_BytesPerPixel]);
-                            m_Prev[m_CurrRowIndex] = *buffer + prev;
-                            break;
-                        }
-
-                        // TODO: implement tiff predictor for other than 8 BPC
-                        PODOFO_RAISE_ERROR_INFO(PdfErrorCode::InvalidPredictor, "tiff predictors other than 8 BPC are not implemented");
-                        break;
-                    }
-                    case 10: // png none
-                    {
-                        m_Prev[m_CurrRowIndex] = *buffer;
-                        break;
-                    }
-                    case 11: // png sub
-                    {
-                        char prev = (m_CurrRowIndex - m_BytesPerPixel < 0
-                            ? 0 : m_Prev[m_CurrRowIndex - m_BytesPerPixel]);
-                        m_Prev[m_CurrRowIndex] = *buffer + prev;
-                        break;
-                    }
-                    case 12: // png up
-                    {
-                        m_Prev[m_CurrRowIndex] += *buffer;
-                        break;
-                    }
-                    case 13: // png average
-                    {
-                        int prev = (m_CurrRowIndex - m_BytesPerPixel < 0
-                            ? 0 : m_Prev[m_CurrRowIndex - m_BytesPerPixel]);
-                        m_Prev[m_CurrRowIndex] = (char)((prev + m_Prev[m_CurrRowIndex]) >> 1) + *buffer;
-                        break;
-                    }
-                    case 14: // png paeth
-                    {
-                        int nLeftByteIndex = m_CurrRowIndex - m_BytesPerPixel;
-
-                        int a = nLeftByteIndex < 0 ? 0 : static_cast<unsigned char>(m_Prev[nLeftByteIndex]);
-                        int b = static_cast<unsigned char>(m_Prev[m_CurrRowIndex]);
 
-                        int nCurrComponentIndex = m_CurrRowIndex % m_BytesPerPixel;
-                        int c = nLeftByteIndex < 0 ? 0 : static_cast<unsigned char>(m_UpperLeftPixelComponents[nCurrComponentIndex]);
-
-                        int p = a + b - c;
+            for (size_t i = 0; i < rowCount; i++)
+            {
+                decodeRow(src, prev, dst);
+                prev = dst;
+                dst += m_RowLength;
+                src += m_InputRowLength;
+            }
 
-                        int pa = p - a;
-                        if (pa < 0)
-                            pa = -pa;
+            std::memcpy(m_Prev.data(), prev, m_RowLength);
+            stream.Write(m_Output.data(), m_Output.size());
+        }
 
-                        int pb = p - b;
-                        if (pb < 0)
-                            pb = -pb;
+        // Keep the trailing incomplete row for the next block
+        len -= rowCount * m_InputRowLength;
+        if (len != 0)
+        {
+            std::memcpy(m_Partial.data(), src, len);
+            m_PartialLength = len;
+        }
+    }
 
-                        int pc = p - c;
-                        if (pc < 0)
-                            pc = -pc;
+private:
+    void decodeRow(const unsigned char* raw, const unsigned char* prev, unsigned char* dst)
+    {
+        if (m_Predictor == 2)
+        {
+            decodeTiffRow(raw, dst);
+            return;
+        }
 
-                        int closestByte;
-                        if (pa <= pb && pa <= pc)
-                            closestByte = a;
-                        else if (pb <= pc)
-                            closestByte = b;
-                        else
-                            closestByte = c;
+        if (m_Predictor < 10)
+        {
+            // Unknown predictor: pass through the data
+            std::memcpy(dst, raw, m_RowLength);
+            return;
+        }
 
-                        // Save the byte we're about to clobber for the next pixel's prediction
-                        m_UpperLeftPixelComponents[nCurrComponentIndex] = m_Prev[m_CurrRowIndex];
+        unsigned char type = *raw;
+        raw++;
+        switch (type)
+        {
+            case 1: // png sub
+                decodePngSub(raw, dst, m_RowLength, m_BytesPerPixel);
+                break;
+            case 2: // png up
+                decodePngUp(raw, prev, dst, m_RowLength);
+                break;
+            case 3: // png average
+                decodePngAverage(raw, prev, dst, m_RowLength, m_BytesPerPixel);
+                break;
+            case 4: // png paeth
+                decodePngPaeth(raw, prev, dst, m_RowLength, m_BytesPerPixel);
+                break;
+            case 0: // png none
+            default:
+                std::memcpy(dst, raw, m_RowLength);
+                break;
+            case 5: // png optimum
+                PODOFO_RAISE_ERROR_INFO(PdfErrorCode::InvalidPredictor, "png optimum predictor is not implemented");
+        }
+    }
 
-                        m_Prev[m_CurrRowIndex] = *buffer + (char)closestByte;
-                        break;
-                    }
-                    case 15: // png optimum
-                        PODOFO_RAISE_ERROR_INFO(PdfErrorCode::InvalidPredictor, "png optimum predictor is not implemented");
-                        break;
+    // Tiff predictor 2: each component is the difference with
+    // the same component of the pixel on the left
+    void decodeTiffRow(const unsigned char* raw, unsigned char* dst)
+    {
+        switch (m_BitsPerComponent)
+        {
+            case 8:
+            {
+                // Same as png sub
+                decodePngSub(raw, dst, m_RowLength, (unsigned)m_Colors);
+                break;
+            }
+            case 16:
+            {
+                // Components are big endian
+                size_t stride = (size_t)m_Colors * 2;
+                size_t i = 0;
+                for (; i < stride && i < m_RowLength; i++)
+                    dst[i] = raw[i];
 
-                    default:
+                for (; i + 1 < m_RowLength; i += 2)
+                {
+                    unsigned value = ((raw[i] << 8) | raw[i + 1])
+                        + ((dst[i - stride] << 8) | dst[i - stride + 1]);
+                    dst[i] = (unsigned char)(value >> 8);
+                    dst[i + 1] = (unsigned char)value;
+                }
+                break;
+            }
+            default:
+            {
+                // 1, 2 or 4 BPC: components are packed starting
+                // from the most significant bit
+                unsigned bpc = (unsigned)m_BitsPerComponent;
+                unsigned mask = (1u << bpc) - 1;
+                size_t componentCount = (size_t)m_ColumnCount * m_Colors;
+                std::memset(dst, 0, m_RowLength);
+                for (size_t i = 0; i < componentCount; i++)
+                {
+                    size_t offset = i * bpc;
+                    unsigned shift = 8 - bpc - (unsigned)(offset & 7);
+                    unsigned value = (raw[offset >> 3] >> shift) & mask;
+                    if (i >= (size_t)m_Colors)
                     {
-                        //PODOFO_RAISE_ERROR( EPdfError::InvalidPredictor );
-                        break;
+                        size_t leftOffset = offset - (size_t)m_Colors * bpc;
+                        unsigned leftShift = 8 - bpc - (unsigned)(leftOffset & 7);
+                        value = (value + ((dst[leftOffset >> 3] >> leftShift) & mask)) & mask;
                     }
+                    dst[offset >> 3] |= (unsigned char)(value << shift);
                 }
-
-                m_CurrRowIndex++;
-            }
-
-            buffer++;
-
-            if (m_CurrRowIndex >= m_Rows)
-            {   // One line finished
-                m_CurrRowIndex = 0;
-                m_NextByteIsPredictor = (m_CurrPredictor >= 10);
-                stream.Write(m_Prev.data(), m_Rows);
+                break;
             }
         }
     }
@@ -202,24 +253,252 @@ private:
     int m_BitsPerComponent;
     int m_ColumnCount;
     int m_EarlyChange;
-    int m_BytesPerPixel;     // Bytes per pixel
-
-    int m_CurrPredictor;
-    int m_CurrRowIndex;
-    int m_Rows;
+    unsigned m_BytesPerPixel;   // Bytes per pixel, at least 1
+    size_t m_RowLength;         // Bytes of a decoded row
+    size_t m_InputRowLength;    // Bytes of an encoded row
 
-    bool m_NextByteIsPredictor;
+    // The last decoded row, used by the predictors of the next one
+    std::vector<unsigned char> m_Prev;
 
-    charbuff m_Prev;
+    // A row split across input blocks
+    std::vector<unsigned char> m_Partial;
+    size_t m_PartialLength;
 
-    // The PNG Paeth predictor uses the values of the pixel above and to the left
-    // of the current pixel. But we overwrite the row above as we go, so we'll
-    // have to store the bytes of the upper-left pixel separately.
-    charbuff m_UpperLeftPixelComponents;
+    charbuff m_Output;
 };
 
 } // end anonymous namespace
 
+#ifdef PODOFO_HAVE_SSE2
+
+// Every pixel depends on the decoded pixel on its left, so the
+// SSE2 kernels for Sub, Average and Paeth process all the
+// components of a pixel at once
+
+template <unsigned Bpp>
+static inline __m128i loadPixel(const unsigned char* src)
+{
+    uint64_t value = 0;
+    std::memcpy(&value, src, Bpp);
+    return _mm_loadl_epi64(reinterpret_cast<const __m128i*>(&value));
+}
+
+template <unsigned Bpp>
+static inline void storePixel(unsigned char* dst, __m128i pixel)
+{
+    uint64_t value;
+    _mm_storel_epi64(reinterpret_cast<__m128i*>(&value), pixel);
+    std::memcpy(dst, &value, Bpp);
+}
+
+template <unsigned Bpp>
+static size_t decodePngSubSSE2(const unsigned char* raw, unsigned char* dst, size_t len)
+{
+    __m128i a = _mm_setzero_si128();
+    size_t count = len / Bpp;
+    for (size_t i = 0; i < count; i++)
+    {
+        a = _mm_add_epi8(a, loadPixel<Bpp>(raw));
+        storePixel<Bpp>(dst, a);
+        raw += Bpp;
+        dst += Bpp;
+    }
+
+    return count * Bpp;
+}
+
+template <unsigned Bpp>
+static size_t decodePngAverageSSE2(const unsigned char* raw, const unsigned char* prev, unsigned char* dst, size_t len)
+{
+    const __m128i ones = _mm_set1_epi8(1);
+    __m128i a = _mm_setzero_si128();
+    size_t count = len / Bpp;
+    for (size_t i = 0; i < count; i++)
+    {
+        // _mm_avg_epu8 rounds up, subtract the lost bit to round down
+        __m128i b = loadPixel<Bpp>(prev);
+        __m128i avg = _mm_avg_epu8(a, b);
+        avg = _mm_sub_epi8(avg, _mm_and_si128(_mm_xor_si128(a, b), ones));
+        a = _mm_add_epi8(loadPixel<Bpp>(raw), avg);
+        storePixel<Bpp>(dst, a);
+        raw += Bpp;
+        prev += Bpp;
+        dst += Bpp;
+    }
+
+    return count * Bpp;
+}
+
+static inline __m128i absEpi16(__m128i x)
+{
+    __m128i negative = _mm_cmplt_epi16(x, _mm_setzero_si128());
+    return _mm_sub_epi16(_mm_xor_si128(x, negative), negative);
+}
+
+static inline __m128i selectSi128(__m128i mask, __m128i a, __m128i b)
+{
+    return _mm_or_si128(_mm_and_si128(mask, a), _mm_andnot_si128(mask, b));
+}
+
+template <unsigned Bpp>
+static size_t decodePngPaethSSE2(const unsigned char* raw, const unsigned char* prev, unsigned char* dst, size_t len)
+{
+    // Work on 16 bit lanes, so that the predictor
+    // distances can be computed without overflow
+    const __m128i zero = _mm_setzero_si128();
+    __m128i a = zero;
+    __m128i c = zero;
+    size_t count = len / Bpp;
+    for (size_t i = 0; i < count; i++)
+    {
+        __m128i b = _mm_unpacklo_epi8(loadPixel<Bpp>(prev), zero);
+        __m128i x = _mm_unpacklo_epi8(loadPixel<Bpp>(raw), zero);
+
+        // p = a + b - c, so p - a = b - c, p - b = a - c
+        // and p - c = (b - c) + (a - c)
+        __m128i pa = _mm_sub_epi16(b, c);
+        __m128i pb = _mm_sub_epi16(a, c);
+        __m128i pc = _mm_add_epi16(pa, pb);
+        pa = absEpi16(pa);
+        pb = absEpi16(pb);
+        pc = absEpi16(pc);
+
+        __m128i smallest = _mm_min_epi16(pc, _mm_min_epi16(pa, pb));
+        __m128i nearest = selectSi128(_mm_cmpeq_epi16(smallest, pa), a,
+            selectSi128(_mm_cmpeq_epi16(smallest, pb), b, c));
+
+        // Bytewise add keeps the high byte of the lanes clear
+        a = _mm_add_epi8(x, nearest);
+        storePixel<Bpp>(dst, _mm_packus_epi16(a, a));
+        c = b;
+        raw += Bpp;
+        prev += Bpp;
+        dst += Bpp;
+    }
+
+    return count * Bpp;
+}
+
+#endif // PODOFO_HAVE_SSE2
+
+void decodePngSub(const unsigned char* raw, unsigned char* dst, size_t len, unsigned bpp)
+{
+    size_t i = 0;
+#ifdef PODOFO_HAVE_SSE2
+    switch (bpp)
+    {
+        case 3:
+            i = decodePngSubSSE2<3>(raw, dst, len);
+            break;
+        case 4:
+            i = decodePngSubSSE2<4>(raw, dst, len);
+            break;
+        case 6:
+            i = decodePngSubSSE2<6>(raw, dst, len);
+            break;
+        case 8:
+            i = decodePngSubSSE2<8>(raw, dst, len);
+            break;
+    }
+#endif // PODOFO_HAVE_SSE2
+
+    for (; i < bpp && i < len; i++)
+        dst[i] = raw[i];
+
+    for (; i < len; i++)
+        dst[i] = (unsigned char)(raw[i] + dst[i - bpp]);
+}
+
+void decodePngUp(const unsigned char* raw, const unsigned char* prev, unsigned char* dst, size_t len)
+{
+    size_t i = 0;
+#ifdef PODOFO_HAVE_SSE2
+    for (; i + 16 <= len; i += 16)
+    {
+        __m128i x = _mm_loadu_si128(reinterpret_cast<const __m128i*>(raw + i));
+        __m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i*>(prev + i));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), _mm_add_epi8(x, b));
+    }
+#endif // PODOFO_HAVE_SSE2
+
+    for (; i < len; i++)
+        dst[i] = (unsigned char)(raw[i] + prev[i]);
+}
+
+void decodePngAverage(const unsigned char* raw, const unsigned char* prev, unsigned char* dst, size_t len, unsigned bpp)
+{
+    size_t i = 0;
+#ifdef PODOFO_HAVE_SSE2
+    switch (bpp)
+    {
+        case 3:
+            i = decodePngAverageSSE2<3>(raw, prev, dst, len);
+            break;
+        case 4:
+            i = decodePngAverageSSE2<4>(raw, prev, dst, len);
+            break;
+        case 6:
+            i = decodePngAverageSSE2<6>(raw, prev, dst, len);
+            break;
+        case 8:
+            i = decodePngAverageSSE2<8>(raw, prev, dst, len);
+            break;
+    }
+#endif // PODOFO_HAVE_SSE2
+
+    for (; i < bpp && i < len; i++)
+        dst[i] = (unsigned char)(raw[i] + (prev[i] >> 1));
+
+    for (; i < len; i++)
+        dst[i] = (unsigned char)(raw[i] + ((dst[i - bpp] + prev[i]) >> 1));
+}
+
+void decodePngPaeth(const unsigned char* raw, const unsigned char* prev, unsigned char* dst, size_t len, unsigned bpp)
+{
+    size_t i = 0;
+#ifdef PODOFO_HAVE_SSE2
+    switch (bpp)
+    {
+        case 3:
+            i = decodePngPaethSSE2<3>(raw, prev, dst, len);
+            break;
+        case 4:
+            i = decodePngPaethSSE2<4>(raw, prev, dst, len);
+            break;
+        case 6:
+            i = decodePngPaethSSE2<6>(raw, prev, dst, len);
+            break;
+        case 8:
+            i = decodePngPaethSSE2<8>(raw, prev, dst, len);
+            break;
+    }
+#endif // PODOFO_HAVE_SSE2
+
+    // The left and upper left pixels of the first one are zero,
+    // so the predictor is always the upper pixel
+    for (; i < bpp && i < len; i++)
+        dst[i] = (unsigned char)(raw[i] + prev[i]);
+
+    for (; i < len; i++)
+    {
+        int a = dst[i - bpp];
+        int b = prev[i];
+        int c = prev[i - bpp];
+        int pa = std::abs(b - c);
+        int pb = std::abs(a - c);
+        int pc = std::abs(a + b - 2 * c);
+        int predictor;
+        if (pa <= pb && pa <= pc)
+            predictor = a;
+        else if (pb <= pc)
+            predictor = b;
+        else
+            predictor = c;
+
+        dst[i] = (unsigned char)(raw[i] + predictor);
+    }
+}
+
 #pragma region PdfHexFilter
 
 PdfHexFilter::PdfHexFilter()
@@ -462,7 +741,8 @@ void PdfAscii85Filter::WidePut(unsigned tuple, int bytes) const
 
 #pragma endregion PdfFlateFilter
 
-PdfFlateFilter::PdfFlateFilter()
+PdfFlateFilter::PdfFlateFilter(int level)
+    : m_level(level)
 {
     memset(m_buffer, 0, sizeof(m_buffer));
     memset(&m_stream, 0, sizeof(m_stream));
@@ -474,7 +754,7 @@ void PdfFlateFilter::BeginEncodeImpl()
     m_stream.zfree = Z_NULL;
     m_stream.opaque = Z_NULL;
 
-    if (deflateInit(&m_stream, Z_DEFAULT_COMPRESSION))
+    if (deflateInit(&m_stream, m_level))
         PODOFO_RAISE_ERROR(PdfErrorCode::Flate);
 }
 
@@ -92,7 +92,10 @@ class PdfFlateFilter final : public PdfFilter
     static constexpr unsigned BUFFER_SIZE = 4096;
 
 public:
-    PdfFlateFilter();
+    /**
+     * \param level the zlib compression level used when encoding
+     */
+    PdfFlateFilter(int level = Z_DEFAULT_COMPRESSION);
 
     inline bool CanEncode() const override { return true; }
 
@@ -118,6 +121,7 @@ private:
 private:
     unsigned char m_buffer[BUFFER_SIZE];
 
+    int m_level;
     z_stream m_stream;
     std::shared_ptr<PdfPredictorDecoder> m_Predictor;
 };
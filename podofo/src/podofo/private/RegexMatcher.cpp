@@ -0,0 +1,786 @@
+/**
+ * SPDX-FileCopyrightText: (C) 2024 Francesco Pretto <ceztko@gmail.com>
+ * SPDX-License-Identifier: LGPL-2.0-or-later
+ * SPDX-License-Identifier: MPL-2.0
+ */
+
+#include "PdfDeclarationsPrivate.h"
+#include "RegexMatcher.h"
+
+using namespace std;
+using namespace utls;
+
+// Bounded repetitions are expanded in the program, so
+// limit its size to keep patterns like "(a{1000}){1000}" sane
+static constexpr size_t MaxProgramSize = 16384;
+static constexpr unsigned Unbounded = numeric_limits<unsigned>::max();
+
+namespace
+{
+    enum class OpCode : uint8_t
+    {
+        Char,       // Match a single byte
+        Set,        // Match a byte in a character set
+        Any,        // Match any byte but line terminators
+        Split,      // Continue at both Arg and Arg2
+        Jump,       // Continue at Arg
+        Begin,      // Assert the beginning of the string
+        End,        // Assert the end of the string
+        Match,
+    };
+
+    enum class NodeType : uint8_t
+    {
+        Empty,
+        Char,
+        Set,
+        Any,
+        Begin,
+        End,
+        Concat,
+        Alternate,
+        Repeat,
+    };
+}
+
+struct RegexMatcher::Instruction
+{
+    OpCode Code;
+    unsigned char Char;
+    unsigned Arg;
+    unsigned Arg2;
+};
+
+struct RegexMatcher::Node
+{
+    NodeType Type = NodeType::Empty;
+    unsigned char Char = 0;
+    unsigned SetIndex = 0;
+    unsigned Min = 0;
+    unsigned Max = 0;
+    vector<unique_ptr<Node>> Children;
+};
+
+class RegexMatcher::Parser final
+{
+public:
+    Parser(const string_view& pattern, bool ignoreCase, vector<CharSet>& sets)
+        : m_pattern(pattern), m_pos(0), m_ignoreCase(ignoreCase), m_sets(&sets) { }
+
+    bool TryParse(unique_ptr<Node>& node)
+    {
+        if (!tryParseAlternate(node))
+            return false;
+
+        // Unbalanced ')' is left over
+        return m_pos == m_pattern.size();
+    }
+
+private:
+    bool tryParseAlternate(unique_ptr<Node>& node)
+    {
+        unique_ptr<Node> concat;
+        if (!tryParseConcat(concat))
+            return false;
+
+        if (m_pos == m_pattern.size() || m_pattern[m_pos] != '|')
+        {
+            node = std::move(concat);
+            return true;
+        }
+
+        node.reset(new Node());
+        node->Type = NodeType::Alternate;
+        node->Children.push_back(std::move(concat));
+        while (m_pos < m_pattern.size() && m_pattern[m_pos] == '|')
+        {
+            m_pos++;
+            if (!tryParseConcat(concat))
+                return false;
+
+            node->Children.push_back(std::move(concat));
+        }
+
+        return true;
+    }
+
+    bool tryParseConcat(unique_ptr<Node>& node)
+    {
+        node.reset(new Node());
+        node->Type = NodeType::Concat;
+        while (m_pos < m_pattern.size())
+        {
+            char ch = m_pattern[m_pos];
+            if (ch == '|' || ch == ')')
+                break;
+
+            unique_ptr<Node> atom;
+            if (!tryParseAtom(atom) || !tryParseQuantifier(atom))
+                return false;
+
+            node->Children.push_back(std::move(atom));
+        }
+
+        return true;
+    }
+
+    bool tryParseAtom(unique_ptr<Node>& node)
+    {
+        char ch = m_pattern[m_pos++];
+        switch (ch)
+        {
+            case '(':
+            {
+                if (m_pos < m_pattern.size() && m_pattern[m_pos] == '?')
+                {
+                    // Only non capturing groups are supported, lookaheads
+                    // need backtracking
+                    if (m_pos + 1 >= m_pattern.size() || m_pattern[m_pos + 1] != ':')
+                        return false;
+
+                    m_pos += 2;
+                }
+
+                if (!tryParseAlternate(node))
+                    return false;
+
+                if (m_pos == m_pattern.size() || m_pattern[m_pos] != ')')
+                    return false;
+
+                m_pos++;
+                return true;
+            }
+            case '[':
+                return tryParseSet(node);
+            case '.':
+                node = createNode(NodeType::Any);
+                return true;
+            case '^':
+                node = createNode(NodeType::Begin);
+                return true;
+            case '$':
+                node = createNode(NodeType::End);
+                return true;
+            case '\\':
+            {
+                CharSet set;
+                unsigned char escaped;
+                bool isSet;
+                if (!tryParseEscape(escaped, set, isSet))
+                    return false;
+
+                if (isSet)
+                    node = createSetNode(set);
+                else
+                    node = createCharNode(escaped);
+                return true;
+            }
+            case '*':
+            case '+':
+            case '?':
+            case '{':
+            case '}':
+            case ']':
+                // Quantifiers with nothing to repeat. Braces and closing
+                // brackets as literals are left to std::regex
+                return false;
+            default:
+                node = createCharNode((unsigned char)ch);
+                return true;
+        }
+    }
+
+    bool tryParseQuantifier(unique_ptr<Node>& node)
+    {
+        if (m_pos == m_pattern.size())
+            return true;
+
+        unsigned min;
+        unsigned max;
+        switch (m_pattern[m_pos])
+        {
+            case '*':
+                min = 0;
+                max = Unbounded;
+                m_pos++;
+                break;
+            case '+':
+                min = 1;
+                max = Unbounded;
+                m_pos++;
+                break;
+            case '?':
+                min = 0;
+                max = 1;
+                m_pos++;
+                break;
+            case '{':
+            {
+                m_pos++;
+                if (!tryParseNumber(min))
+                    return false;
+
+                max = min;
+                if (m_pos < m_pattern.size() && m_pattern[m_pos] == ',')
+                {
+                    m_pos++;
+                    if (m_pos < m_pattern.size() && m_pattern[m_pos] == '}')
+                        max = Unbounded;
+                    else if (!tryParseNumber(max) || max < min)
+                        return false;
+                }
+
+                if (m_pos == m_pattern.size() || m_pattern[m_pos] != '}')
+                    return false;
+
+                m_pos++;
+                break;
+            }
+            default:
+                return true;
+        }
+
+        switch (node->Type)
+        {
+            case NodeType::Begin:
+            case NodeType::End:
+                // Quantified assertions are not supported
+                return false;
+            default:
+                break;
+        }
+
+        // Lazy quantifiers only change which match is
+        // reported, which is irrelevant for a search
+        if (m_pos < m_pattern.size() && m_pattern[m_pos] == '?')
+            m_pos++;
+
+        auto repeat = createNode(NodeType::Repeat);
+        repeat->Min = min;
+        repeat->Max = max;
+        repeat->Children.push_back(std::move(node));
+        node = std::move(repeat);
+
+        // Quantifiers can't be repeated
+        if (m_pos < m_pattern.size())
+        {
+            switch (m_pattern[m_pos])
+            {
+                case '*':
+                case '+':
+                case '?':
+                case '{':
+                    return false;
+            }
+        }
+
+        return true;
+    }
+
+    bool tryParseNumber(unsigned& number)
+    {
+        size_t start = m_pos;
+        number = 0;
+        while (m_pos < m_pattern.size() && m_pattern[m_pos] >= '0' && m_pattern[m_pos] <= '9')
+        {
+            number = number * 10 + (unsigned)(m_pattern[m_pos] - '0');
+            if (number > MaxProgramSize)
+                return false;
+
+            m_pos++;
+        }
+
+        return m_pos != start;
+    }
+
+    bool tryParseSet(unique_ptr<Node>& node)
+    {
+        CharSet set;
+        bool negated = false;
+        if (m_pos < m_pattern.size() && m_pattern[m_pos] == '^')
+        {
+            negated = true;
+            m_pos++;
+        }
+
+        while (true)
+        {
+            if (m_pos == m_pattern.size())
+                return false;
+
+            if (m_pattern[m_pos] == ']')
+            {
+                m_pos++;
+                break;
+            }
+
+            unsigned char lower;
+            CharSet escapedSet;
+            bool isSet;
+            if (!tryParseSetChar(lower, escapedSet, isSet))
+                return false;
+
+            if (isSet)
+            {
+                set |= escapedSet;
+                continue;
+            }
+
+            // Check for a range, a trailing '-' is a literal
+            if (m_pos + 1 < m_pattern.size() && m_pattern[m_pos] == '-' && m_pattern[m_pos + 1] != ']')
+            {
+                m_pos++;
+                unsigned char upper;
+                if (!tryParseSetChar(upper, escapedSet, isSet) || isSet || upper < lower)
+                    return false;
+
+                for (unsigned i = lower; i <= upper; i++)
+                    addChar(set, (unsigned char)i);
+            }
+            else
+            {
+                addChar(set, lower);
+            }
+        }
+
+        if (negated)
+            set.flip();
+
+        node = createSetNode(set);
+        return true;
+    }
+
+    bool tryParseSetChar(unsigned char& ch, CharSet& set, bool& isSet)
+    {
+        char curr = m_pattern[m_pos++];
+        if (curr != '\\')
+        {
+            ch = (unsigned char)curr;
+            isSet = false;
+            return true;
+        }
+
+        if (m_pos < m_pattern.size() && m_pattern[m_pos] == 'b')
+        {
+            // Backspace inside classes
+            m_pos++;
+            ch = '\b';
+            isSet = false;
+            return true;
+        }
+
+        return tryParseEscape(ch, set, isSet);
+    }
+
+    bool tryParseEscape(unsigned char& ch, CharSet& set, bool& isSet)
+    {
+        if (m_pos == m_pattern.size())
+            return false;
+
+        isSet = false;
+        char escaped = m_pattern[m_pos++];
+        switch (escaped)
+        {
+            case 'd':
+            case 'D':
+                setRange(set, '0', '9');
+                break;
+            case 'w':
+            case 'W':
+                setRange(set, 'a', 'z');
+                setRange(set, 'A', 'Z');
+                setRange(set, '0', '9');
+                set.set('_');
+                break;
+            case 's':
+            case 'S':
+                for (char space : { ' ', '\t', '\n', '\v', '\f', '\r' })
+                    set.set((unsigned char)space);
+                break;
+            case 't':
+                ch = '\t';
+                return true;
+            case 'n':
+                ch = '\n';
+                return true;
+            case 'r':
+                ch = '\r';
+                return true;
+            case 'f':
+                ch = '\f';
+                return true;
+            case 'v':
+                ch = '\v';
+                return true;
+            case '0':
+                ch = '\0';
+                return true;
+            case 'x':
+            {
+                if (m_pos + 2 > m_pattern.size())
+                    return false;
+
+                unsigned value = 0;
+                for (unsigned i = 0; i < 2; i++)
+                {
+                    char hex = m_pattern[m_pos++];
+                    unsigned digit;
+                    if (hex >= '0' && hex <= '9')
+                        digit = (unsigned)(hex - '0');
+                    else if (hex >= 'a' && hex <= 'f')
+                        digit = (unsigned)(hex - 'a' + 10);
+                    else if (hex >= 'A' && hex <= 'F')
+                        digit = (unsigned)(hex - 'A' + 10);
+                    else
+                        return false;
+
+                    value = value * 16 + digit;
+                }
+                ch = (unsigned char)value;
+                return true;
+            }
+            default:
+            {
+                // Word boundaries, back references, unicode and control
+                // escapes are not supported. Any other character
+                // is an identity escape
+                if ((escaped >= 'a' && escaped <= 'z')
+                    || (escaped >= 'A' && escaped <= 'Z')
+                    || (escaped >= '1' && escaped <= '9'))
+                {
+                    return false;
+                }
+
+                ch = (unsigned char)escaped;
+                return true;
+            }
+        }
+
+        // Uppercase classes are the complement of the lowercase ones
+        if (escaped >= 'A' && escaped <= 'Z')
+            set.flip();
+
+        isSet = true;
+        return true;
+    }
+
+    void addChar(CharSet& set, unsigned char ch)
+    {
+        set.set(ch);
+        if (m_ignoreCase)
+        {
+            if (ch >= 'a' && ch <= 'z')
+                set.set(ch - 'a' + 'A');
+            else if (ch >= 'A' && ch <= 'Z')
+                set.set(ch - 'A' + 'a');
+        }
+    }
+
+    static void setRange(CharSet& set, unsigned char lower, unsigned char upper)
+    {
+        for (unsigned i = lower; i <= upper; i++)
+            set.set(i);
+    }
+
+    unique_ptr<Node> createCharNode(unsigned char ch)
+    {
+        bool isAlpha = (ch >= 'a' && ch <= 'z') || (ch >= 'A' && ch <= 'Z');
+        if (m_ignoreCase && isAlpha)
+        {
+            CharSet set;
+            addChar(set, ch);
+            return createSetNode(set);
+        }
+
+        auto ret = createNode(NodeType::Char);
+        ret->Char = ch;
+        return ret;
+    }
+
+    unique_ptr<Node> createSetNode(const CharSet& set)
+    {
+        auto ret = createNode(NodeType::Set);
+        ret->SetIndex = (unsigned)m_sets->size();
+        m_sets->push_back(set);
+        return ret;
+    }
+
+    static unique_ptr<Node> createNode(NodeType type)
+    {
+        unique_ptr<Node> ret(new Node());
+        ret->Type = type;
+        return ret;
+    }
+
+private:
+    string_view m_pattern;
+    size_t m_pos;
+    bool m_ignoreCase;
+    vector<CharSet>* m_sets;
+};
+
+RegexMatcher::RegexMatcher()
+    : m_isLiteral(false) { }
+
+RegexMatcher::~RegexMatcher() { }
+
+bool RegexMatcher::TryCreate(const string_view& pattern, bool ignoreCase, unique_ptr<RegexMatcher>& matcher)
+{
+    // Case folding is performed on ASCII letters only: leave
+    // patterns with other characters to std::regex
+    if (ignoreCase)
+    {
+        for (char ch : pattern)
+        {
+            if ((unsigned char)ch >= 0x80)
+                return false;
+        }
+    }
+
+    unique_ptr<RegexMatcher> ret(new RegexMatcher());
+    unique_ptr<Node> root;
+    Parser parser(pattern, ignoreCase, ret->m_sets);
+    if (!parser.TryParse(root))
+        return false;
+
+    // Collect the literal prefix used to skip to candidate matches.
+    // Sets from case folding don't contribute to it
+    PODOFO_ASSERT(root->Type == NodeType::Concat || root->Type == NodeType::Alternate);
+    if (root->Type == NodeType::Concat)
+    {
+        size_t i = 0;
+        for (; i < root->Children.size() && root->Children[i]->Type == NodeType::Char; i++)
+            ret->m_prefix.push_back((char)root->Children[i]->Char);
+
+        ret->m_isLiteral = i == root->Children.size();
+    }
+
+    if (!ret->m_isLiteral)
+    {
+        if (!ret->tryCompile(*root))
+            return false;
+
+        ret->m_program.push_back({ OpCode::Match, 0, 0, 0 });
+    }
+
+    matcher = std::move(ret);
+    return true;
+}
+
+bool RegexMatcher::Search(const string_view& str) const
+{
+    if (m_isLiteral)
+        return str.find(m_prefix) != string_view::npos;
+
+    // The marks store the generation, that is the position, in which
+    // an instruction was last added to a list. This avoids duplicate
+    // threads, so each position is visited at most once per instruction
+    vector<unsigned> curr;
+    vector<unsigned> next;
+    vector<unsigned> marks(m_program.size(), 0);
+    vector<unsigned> stack;
+    unsigned generation = 1;
+    bool matched = false;
+    size_t length = str.length();
+    size_t pos = 0;
+    while (true)
+    {
+        if (curr.size() == 0 && m_prefix.size() != 0)
+        {
+            // No thread is alive, skip to the next candidate match
+            pos = str.find(m_prefix, pos);
+            if (pos == string_view::npos)
+                return false;
+        }
+
+        // Unanchored search: start a new thread at every position
+        addThread(curr, marks, stack, generation, 0, pos, length, matched);
+        if (matched)
+            return true;
+
+        if (pos == length)
+            return false;
+
+        unsigned char ch = (unsigned char)str[pos];
+        pos++;
+        generation++;
+        next.clear();
+        for (unsigned pc : curr)
+        {
+            auto& inst = m_program[pc];
+            bool advance;
+            switch (inst.Code)
+            {
+                case OpCode::Char:
+                    advance = inst.Char == ch;
+                    break;
+                case OpCode::Set:
+                    advance = m_sets[inst.Arg].test(ch);
+                    break;
+                case OpCode::Any:
+                    advance = ch != '\n' && ch != '\r';
+                    break;
+                default:
+                    advance = false;
+                    break;
+            }
+
+            if (advance)
+            {
+                addThread(next, marks, stack, generation, pc + 1, pos, length, matched);
+                if (matched)
+                    return true;
+            }
+        }
+
+        std::swap(curr, next);
+    }
+}
+
+// Follow the instructions that don't consume input, adding
+// the ones that do to the list. The instructions still to be
+// followed are kept in an explicit stack, as long programs
+// would otherwise exhaust the call stack
+void RegexMatcher::addThread(vector<unsigned>& list, vector<unsigned>& marks, vector<unsigned>& stack,
+    unsigned generation, unsigned pc, size_t pos, size_t length, bool& matched) const
+{
+    stack.clear();
+    stack.push_back(pc);
+    while (stack.size() != 0)
+    {
+        pc = stack.back();
+        stack.pop_back();
+        if (marks[pc] == generation)
+            continue;
+
+        marks[pc] = generation;
+        auto& inst = m_program[pc];
+        switch (inst.Code)
+        {
+            case OpCode::Jump:
+                stack.push_back(inst.Arg);
+                break;
+            case OpCode::Split:
+                // Push the preferred branch last, so it's followed first
+                stack.push_back(inst.Arg2);
+                stack.push_back(inst.Arg);
+                break;
+            case OpCode::Begin:
+                if (pos == 0)
+                    stack.push_back(pc + 1);
+                break;
+            case OpCode::End:
+                if (pos == length)
+                    stack.push_back(pc + 1);
+                break;
+            case OpCode::Match:
+                matched = true;
+                return;
+            default:
+                list.push_back(pc);
+                break;
+        }
+    }
+}
+
+bool RegexMatcher::tryCompile(const Node& node)
+{
+    if (m_program.size() > MaxProgramSize)
+        return false;
+
+    switch (node.Type)
+    {
+        case NodeType::Empty:
+            break;
+        case NodeType::Char:
+            m_program.push_back({ OpCode::Char, node.Char, 0, 0 });
+            break;
+        case NodeType::Set:
+            m_program.push_back({ OpCode::Set, 0, node.SetIndex, 0 });
+            break;
+        case NodeType::Any:
+            m_program.push_back({ OpCode::Any, 0, 0, 0 });
+            break;
+        case NodeType::Begin:
+            m_program.push_back({ OpCode::Begin, 0, 0, 0 });
+            break;
+        case NodeType::End:
+            m_program.push_back({ OpCode::End, 0, 0, 0 });
+            break;
+        case NodeType::Concat:
+            for (auto& child : node.Children)
+            {
+                if (!tryCompile(*child))
+                    return false;
+            }
+            break;
+        case NodeType::Alternate:
+        {
+            // split L1, next; L1: child; jump end; next: ...
+            vector<unsigned> exits;
+            for (size_t i = 0; i < node.Children.size(); i++)
+            {
+                if (i + 1 == node.Children.size())
+                {
+                    if (!tryCompile(*node.Children[i]))
+                        return false;
+
+                    break;
+                }
+
+                unsigned split = (unsigned)m_program.size();
+                m_program.push_back({ OpCode::Split, 0, split + 1, 0 });
+                if (!tryCompile(*node.Children[i]))
+                    return false;
+
+                exits.push_back((unsigned)m_program.size());
+                m_program.push_back({ OpCode::Jump, 0, 0, 0 });
+                m_program[split].Arg2 = (unsigned)m_program.size();
+            }
+
+            for (unsigned exit : exits)
+                m_program[exit].Arg = (unsigned)m_program.size();
+            break;
+        }
+        case NodeType::Repeat:
+        {
+            auto& child = *node.Children[0];
+            for (unsigned i = 0; i < node.Min; i++)
+            {
+                if (!tryCompile(child))
+                    return false;
+            }
+
+            if (node.Max == Unbounded)
+            {
+                // loop: split body, end; body: child; jump loop
+                unsigned loop = (unsigned)m_program.size();
+                m_program.push_back({ OpCode::Split, 0, loop + 1, 0 });
+                if (!tryCompile(child))
+                    return false;
+
+                m_program.push_back({ OpCode::Jump, 0, loop, 0 });
+                m_program[loop].Arg2 = (unsigned)m_program.size();
+            }
+            else
+            {
+                vector<unsigned> exits;
+                for (unsigned i = node.Min; i < node.Max; i++)
+                {
+                    // Each optional copy is skipped to the end of the repetition
+                    unsigned split = (unsigned)m_program.size();
+                    m_program.push_back({ OpCode::Split, 0, split + 1, 0 });
+                    exits.push_back(split);
+                    if (!tryCompile(child))
+                        return false;
+                }
+
+                for (unsigned exit : exits)
+                    m_program[exit].Arg2 = (unsigned)m_program.size();
+            }
+            break;
+        }
+    }
+
+    return true;
+}
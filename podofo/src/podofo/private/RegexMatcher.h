@@ -0,0 +1,71 @@
+/**
+ * SPDX-FileCopyrightText: (C) 2024 Francesco Pretto <ceztko@gmail.com>
+ * SPDX-License-Identifier: LGPL-2.0-or-later
+ * SPDX-License-Identifier: MPL-2.0
+ */
+
+#ifndef REGEX_MATCHER_H
+#define REGEX_MATCHER_H
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+#include <bitset>
+
+namespace utls
+{
+    /**
+     * Regular expression matcher running in time linear with the length
+     * of the searched string, using a Pike VM instead of backtracking
+     *
+     * It supports the subset of the ECMAScript grammar that can be
+     * matched without backtracking: literals, ".", character classes,
+     * the \d \w \s escapes, groups, alternations, greedy and lazy
+     * quantifiers and the ^ $ anchors. Like std::regex on narrow strings,
+     * the matching is performed on bytes
+     */
+    class RegexMatcher final
+    {
+    public:
+        /** Compile the given pattern
+         * \returns false if the pattern uses features not supported
+         * by the matcher, or if it's invalid
+         * \remarks Case is ignored on ASCII letters only, hence
+         * patterns with non-ASCII characters are not supported
+         * when ignoreCase is true
+         */
+        static bool TryCreate(const std::string_view& pattern, bool ignoreCase,
+            std::unique_ptr<RegexMatcher>& matcher);
+
+        /** Determine if a sub-part of the string matches the pattern,
+         * like std::regex_search
+         */
+        bool Search(const std::string_view& str) const;
+
+        ~RegexMatcher();
+
+    private:
+        RegexMatcher();
+
+    private:
+        struct Instruction;
+        struct Node;
+        class Parser;
+        using CharSet = std::bitset<256>;
+
+    private:
+        bool tryCompile(const Node& node);
+        void addThread(std::vector<unsigned>& list, std::vector<unsigned>& marks, std::vector<unsigned>& stack,
+            unsigned generation, unsigned pc, size_t pos, size_t length, bool& matched) const;
+
+    private:
+        std::vector<Instruction> m_program;
+        std::vector<CharSet> m_sets;
+        std::string m_prefix;     // Literal prefix all matches start with
+        bool m_isLiteral;         // The pattern is the prefix alone
+    };
+}
+
+#endif // REGEX_MATCHER_H
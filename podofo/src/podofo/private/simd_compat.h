@@ -0,0 +1,62 @@
+#ifndef COMPAT_SIMD_H
+#define COMPAT_SIMD_H
+
+// SSE2 is part of the x86-64 baseline, so it's always
+// available there. On 32 bit x86 it must be enabled
+#if defined(__SSE2__) || defined(_M_X64) || defined(_M_AMD64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define PODOFO_HAVE_SSE2
+#include <emmintrin.h>
+#endif
+
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+// SSSE3 is not part of the x86-64 baseline: the functions using
+// it must be marked with PODOFO_TARGET_SSSE3 and be called only
+// when HasSSSE3() returns true
+#if defined(PODOFO_HAVE_SSE2) && (defined(__GNUC__) || defined(_MSC_VER))
+#define PODOFO_HAVE_SSSE3
+#include <tmmintrin.h>
+#ifdef _MSC_VER
+#define PODOFO_TARGET_SSSE3
+#else
+#define PODOFO_TARGET_SSSE3 __attribute__((target("ssse3")))
+#endif
+#endif
+
+namespace utls
+{
+    /** Count the trailing zero bits of a non zero mask
+     */
+    inline unsigned CountTrailingZeros(unsigned mask)
+    {
+#ifdef _MSC_VER
+        unsigned long index;
+        _BitScanForward(&index, mask);
+        return (unsigned)index;
+#else
+        return (unsigned)__builtin_ctz(mask);
+#endif
+    }
+
+#ifdef PODOFO_HAVE_SSSE3
+    /** Check if the CPU supports SSSE3
+     */
+    inline bool HasSSSE3()
+    {
+#ifdef _MSC_VER
+        static const bool hasSSSE3 = [] {
+            int info[4];
+            __cpuid(info, 1);
+            return (info[2] & (1 << 9)) != 0;
+        }();
+#else
+        static const bool hasSSSE3 = __builtin_cpu_supports("ssse3") != 0;
+#endif
+        return hasSSSE3;
+    }
+#endif // PODOFO_HAVE_SSSE3
+}
+
+#endif // COMPAT_SIMD_H
@@ -45,3 +45,87 @@ TEST_CASE("TestMetadataSet")
     metadata.SetTitle(nullptr);
     REQUIRE(metadata.GetTitle() == nullptr);
 }
+
+TEST_CASE("TestObjectListLookup")
+{
+    PdfMemDocument doc;
+    auto& objects = doc.GetObjects();
+    auto& obj1 = objects.CreateObject(static_cast<int64_t>(1));
+    auto& obj2 = objects.CreateObject(static_cast<int64_t>(2));
+    auto& obj3 = objects.CreateObject(static_cast<int64_t>(3));
+    auto ref2 = obj2.GetIndirectReference();
+    unsigned size = objects.GetSize();
+
+    REQUIRE(objects.GetObject(ref2) == &obj2);
+    REQUIRE(objects.GetObject(PdfReference(ref2.ObjectNumber(), 1)) == nullptr);
+    REQUIRE(objects.GetObject(PdfReference(1000000, 0)) == nullptr);
+
+    (void)objects.RemoveObject(ref2);
+    REQUIRE(objects.GetObject(ref2) == nullptr);
+    REQUIRE(objects.GetSize() == size - 1);
+
+    // Iteration is ordered by object number and skips removed objects
+    vector<PdfObject*> forward(objects.begin(), objects.end());
+    REQUIRE(forward.size() == size - 1);
+    REQUIRE(std::is_sorted(forward.begin(), forward.end(), [](const PdfObject* lhs, const PdfObject* rhs) {
+        return lhs->GetIndirectReference() < rhs->GetIndirectReference();
+    }));
+    REQUIRE(std::find(forward.begin(), forward.end(), &obj1) != forward.end());
+    REQUIRE(forward.back() == &obj3);
+
+    vector<PdfObject*> backward(objects.rbegin(), objects.rend());
+    REQUIRE(std::equal(forward.rbegin(), forward.rend(), backward.begin(), backward.end()));
+
+    // The removed object number is reused with an incremented generation
+    auto& obj4 = objects.CreateObject(static_cast<int64_t>(4));
+    REQUIRE(obj4.GetIndirectReference() == PdfReference(ref2.ObjectNumber(), 1));
+    REQUIRE(objects.GetObject(obj4.GetIndirectReference()) == &obj4);
+}
+
+TEST_CASE("TestObjectListSparseObjects")
+{
+    // An object numbered far beyond the others is kept
+    // apart from the table of objects, but it's still found
+    ostringstream oss;
+    oss << "%PDF-1.4\n";
+    size_t offsetCatalog = oss.tellp();
+    oss << "1 0 obj << /Type /Catalog /Pages 2 0 R >> endobj\n";
+    size_t offsetPages = oss.tellp();
+    oss << "2 0 obj << /Type /Pages /Kids [] /Count 0 >> endobj\n";
+    size_t offsetFar = oss.tellp();
+    oss << "8388000 0 obj (Far) endobj\n";
+    size_t offsetXRef = oss.tellp();
+    oss << "xref\n0 3\n";
+    oss << "0000000000 65535 f\r\n";
+    oss << utls::Format("{:010} 00000 n\r\n", offsetCatalog);
+    oss << utls::Format("{:010} 00000 n\r\n", offsetPages);
+    oss << "8388000 1\n";
+    oss << utls::Format("{:010} 00000 n\r\n", offsetFar);
+    oss << "trailer << /Size 8388001 /Root 1 0 R >>\n";
+    oss << "startxref\n" << offsetXRef << "\n%%EOF\n";
+
+    PdfMemDocument doc;
+    doc.LoadFromBuffer(oss.str());
+    auto& objects = doc.GetObjects();
+    auto& farObj = objects.MustGetObject(PdfReference(8388000, 0));
+    REQUIRE(farObj.GetString().GetString() == "Far");
+    REQUIRE(objects.GetObject(PdfReference(8387999, 0)) == nullptr);
+
+    vector<PdfObject*> forward(objects.begin(), objects.end());
+    REQUIRE(forward.size() == objects.GetSize());
+    REQUIRE(forward.back() == &farObj);
+    vector<PdfObject*> backward(objects.rbegin(), objects.rend());
+    REQUIRE(std::equal(forward.rbegin(), forward.rend(), backward.begin(), backward.end()));
+
+    // Objects created later are found as well
+    auto& obj = objects.CreateObject(static_cast<int64_t>(1));
+    REQUIRE(objects.GetObject(obj.GetIndirectReference()) == &obj);
+
+    unsigned size = objects.GetSize();
+    (void)objects.RemoveObject(farObj.GetIndirectReference());
+    REQUIRE(objects.GetObject(PdfReference(8388000, 0)) == nullptr);
+    REQUIRE(objects.GetSize() == size - 1);
+    forward.assign(objects.begin(), objects.end());
+    REQUIRE(forward.size() == size - 1);
+    REQUIRE(std::find(forward.begin(), forward.end(), &obj) != forward.end());
+}
@@ -35,3 +35,33 @@ TEST_CASE("testSaveIncremental")
     doc.SaveUpdate(testPath);
     doc.Load(testPath);
 }
+
+TEST_CASE("testMmapDevice")
+{
+    string_view testString = "Hello World Mapping!";
+    auto testPath = TestUtils::GetTestOutputFilePath("testMmapDevice.bin");
+    {
+        FileStreamDevice output(testPath, FileMode::Create);
+        output.Write(testString);
+    }
+
+    MmapStreamDevice device(testPath);
+    REQUIRE(device.GetLength() == testString.size());
+    REQUIRE(string_view(device.GetView().data(), device.GetView().size()) == testString);
+    REQUIRE(string_view(device.GetView(6, 5).data(), 5) == "World");
+    ASSERT_THROW_WITH_ERROR_CODE(device.GetView(6, 100), PdfErrorCode::ValueOutOfRange);
+
+    char ch;
+    device.Seek(6);
+    REQUIRE(device.Peek(ch));
+    REQUIRE(ch == 'W');
+    REQUIRE(device.ReadChar() == 'W');
+    REQUIRE(device.GetPosition() == 7);
+
+    char buffer[64];
+    bool eof;
+    size_t read = device.Read(buffer, std::size(buffer), eof);
+    REQUIRE(eof);
+    REQUIRE(string_view(buffer, read) == "orld Mapping!");
+    REQUIRE(!device.Peek(ch));
+}
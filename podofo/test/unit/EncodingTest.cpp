@@ -337,6 +337,59 @@ TEST_CASE("testToUnicodeParse")
     }
 }
 
+TEST_CASE("testCharCodeMapLookup")
+{
+    PdfCharCodeMap map;
+    map.PushMapping({ 0x41, 1 }, U'A');
+    map.PushMapping({ 0x1001, 2 }, U'\u4E00');
+    map.PushMapping({ 0x1002, 2 }, U'\u4E01');
+    map.PushMapping({ 0x1003, 2 }, vector<codepoint>{ U'f', U'f', U'i' });
+    map.PushMapping({ 0xF001, 2 }, U'\u4E02');          // Far from the other two bytes codes
+    map.PushMapping({ 0x123456, 3 }, U'\U0001F600');
+
+    vector<codepoint> codePoints;
+    REQUIRE(map.TryGetCodePoints({ 0x41, 1 }, codePoints));
+    REQUIRE(codePoints == vector<codepoint>{ U'A' });
+    REQUIRE(map.TryGetCodePoints({ 0x1003, 2 }, codePoints));
+    REQUIRE(codePoints == vector<codepoint>{ U'f', U'f', U'i' });
+    REQUIRE(map.TryGetCodePoints({ 0xF001, 2 }, codePoints));
+    REQUIRE(codePoints == vector<codepoint>{ U'\u4E02' });
+    REQUIRE(map.TryGetCodePoints({ 0x123456, 3 }, codePoints));
+    REQUIRE(codePoints == vector<codepoint>{ U'\U0001F600' });
+    REQUIRE(!map.TryGetCodePoints({ 0x42, 1 }, codePoints));
+    REQUIRE(codePoints.size() == 0);
+    REQUIRE(!map.TryGetCodePoints({ 0x1004, 2 }, codePoints));
+    REQUIRE(!map.TryGetCodePoints({ 0x123457, 3 }, codePoints));
+
+    codepointview view;
+    REQUIRE(map.TryGetCodePoints({ 0x1002, 2 }, view));
+    REQUIRE(view.size() == 1);
+    REQUIRE(view[0] == U'\u4E01');
+
+    // Decode a whole string, with one and two bytes codes
+    auto encoded = "A\x10\x01\x10\x03\xF0\x01" "A"sv;
+    auto it = encoded.begin();
+    codePoints.clear();
+    REQUIRE(map.TryAppendCodePoints(it, encoded.end(), map.GetLimits(), codePoints));
+    REQUIRE(it == encoded.end());
+    REQUIRE(codePoints == vector<codepoint>{ U'A', U'\u4E00', U'f', U'f', U'i', U'\u4E02', U'A' });
+
+    // Decoding stops at the code unit that is not mapped
+    encoded = "A\x10\x05" "A"sv;
+    it = encoded.begin();
+    codePoints.clear();
+    REQUIRE(!map.TryAppendCodePoints(it, encoded.end(), map.GetLimits(), codePoints));
+    REQUIRE(it == encoded.begin() + 1);
+    REQUIRE(codePoints == vector<codepoint>{ U'A' });
+
+    // The lookup tables are updated when the map is modified
+    map.PushMapping({ 0x1005, 2 }, U'B');
+    it = encoded.begin();
+    codePoints.clear();
+    REQUIRE(map.TryAppendCodePoints(it, encoded.end(), map.GetLimits(), codePoints));
+    REQUIRE(codePoints == vector<codepoint>{ U'A', U'B', U'A' });
+}
+
 void outofRangeHelper(PdfEncoding& encoding)
 {
     (void)encoding.GetCodePoint(encoding.GetFirstChar());
@@ -290,6 +290,62 @@ TEST_CASE("TestEncryptBigBuffer")
     }
 }
 
+TEST_CASE("testParallelDecryption")
+{
+    auto test = [](PdfEncryptAlgorithm algorithm, PdfKeyLength keyLength) {
+        charbuff buffer;
+        {
+            PdfMemDocument doc;
+            for (unsigned i = 0; i < 200; i++)
+            {
+                auto& obj = doc.GetObjects().CreateDictionaryObject();
+                obj.GetDictionary().AddKey("Text", PdfString(utls::Format("Text {}", i)));
+                obj.GetDictionary().AddKey("Other", PdfString(utls::Format("Other text {}", i)));
+                obj.GetOrCreateStream().SetData(utls::Format("Stream data of object {}", i));
+            }
+            doc.GetPages().CreatePage(PdfPage::CreateStandardPageSize(PdfPageSize::A4));
+            doc.SetEncrypted(PDF_USER_PASSWORD, PDF_OWNER_PASSWORD, PdfPermissions::Default, algorithm, keyLength);
+            StringStreamDevice device(buffer);
+            doc.Save(device, PdfSaveOptions::NoCollectGarbage);
+        }
+
+        auto collect = [](const PdfMemDocument& doc) {
+            vector<string> ret;
+            for (auto obj : doc.GetObjects())
+            {
+                REQUIRE(obj->IsDelayedLoadDone());
+                string str = obj->ToString();
+                auto stream = obj->GetStream();
+                if (stream != nullptr)
+                {
+                    auto copy = stream->GetCopy();
+                    str.append(copy.data(), copy.size());
+                }
+                ret.push_back(std::move(str));
+            }
+            return ret;
+        };
+
+        // Without concurrent read support the objects are loaded serially
+        PdfMemDocument expectedDoc;
+        expectedDoc.LoadFromBuffer(buffer, PDF_USER_PASSWORD);
+        expectedDoc.GetObjects().LoadAllObjects();
+        auto expected = collect(expectedDoc);
+        REQUIRE(expected.size() > 200);
+
+        PdfMemDocument doc;
+        doc.LoadFromBuffer(buffer, PDF_USER_PASSWORD, PdfLoadOptions::ConcurrentRead);
+        doc.GetObjects().LoadAllObjects(8);
+        REQUIRE(collect(doc) == expected);
+    };
+
+    test(PdfEncryptAlgorithm::RC4V2, PdfKeyLength::L128);
+    test(PdfEncryptAlgorithm::AESV2, PdfKeyLength::L128);
+#ifdef PODOFO_HAVE_LIBIDN
+    test(PdfEncryptAlgorithm::AESV3, PdfKeyLength::L256);
+#endif // PODOFO_HAVE_LIBIDN
+}
+
 void testAuthenticate(PdfEncrypt& encrypt)
 {
     PdfString documentId = PdfString::FromHexData("BF37541A9083A51619AD5924ECF156DF");
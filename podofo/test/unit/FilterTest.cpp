@@ -92,3 +92,147 @@ void testFilter(PdfFilterType filterType, const bufferview& view)
 
     INFO("\t-> Test succeeded!");
 }
+
+// Encode rows with the given PNG filter type, as a reference for the decoder
+static charbuff encodePngRows(const charbuff& data, size_t rowLength, unsigned bpp, unsigned char type)
+{
+    charbuff ret;
+    auto pixels = reinterpret_cast<const unsigned char*>(data.data());
+    for (size_t offset = 0; offset < data.size(); offset += rowLength)
+    {
+        ret.push_back((char)type);
+        for (size_t i = 0; i < rowLength; i++)
+        {
+            int x = pixels[offset + i];
+            int a = i < bpp ? 0 : pixels[offset + i - bpp];
+            int b = offset == 0 ? 0 : pixels[offset - rowLength + i];
+            int c = i < bpp || offset == 0 ? 0 : pixels[offset - rowLength + i - bpp];
+            int predictor;
+            switch (type)
+            {
+                case 1:
+                    predictor = a;
+                    break;
+                case 2:
+                    predictor = b;
+                    break;
+                case 3:
+                    predictor = (a + b) / 2;
+                    break;
+                case 4:
+                {
+                    int p = a + b - c;
+                    int pa = std::abs(p - a);
+                    int pb = std::abs(p - b);
+                    int pc = std::abs(p - c);
+                    predictor = pa <= pb && pa <= pc ? a : (pb <= pc ? b : c);
+                    break;
+                }
+                default:
+                    predictor = 0;
+                    break;
+            }
+            ret.push_back((char)(x - predictor));
+        }
+    }
+    return ret;
+}
+
+// Encode rows with the TIFF horizontal differencing predictor
+static charbuff encodeTiffRows(const charbuff& data, size_t rowLength, unsigned columns, unsigned colors, unsigned bpc)
+{
+    charbuff ret(data.size());
+    auto pixels = reinterpret_cast<const unsigned char*>(data.data());
+    auto encoded = reinterpret_cast<unsigned char*>(ret.data());
+    unsigned mask = bpc == 16 ? 0xFFFF : (1u << bpc) - 1;
+    size_t componentCount = (size_t)columns * colors;
+    auto read = [&](const unsigned char* row, size_t i) -> unsigned {
+        if (bpc == 16)
+            return (row[i * 2] << 8) | row[i * 2 + 1];
+        size_t offset = i * bpc;
+        return (row[offset / 8] >> (8 - bpc - offset % 8)) & mask;
+    };
+    auto write = [&](unsigned char* row, size_t i, unsigned value) {
+        if (bpc == 16)
+        {
+            row[i * 2] = (unsigned char)(value >> 8);
+            row[i * 2 + 1] = (unsigned char)value;
+            return;
+        }
+        size_t offset = i * bpc;
+        unsigned shift = 8 - bpc - offset % 8;
+        row[offset / 8] = (unsigned char)((row[offset / 8] & ~(mask << shift)) | (value << shift));
+    };
+    for (size_t offset = 0; offset < data.size(); offset += rowLength)
+    {
+        for (size_t i = 0; i < componentCount; i++)
+        {
+            unsigned value = read(pixels + offset, i);
+            if (i >= colors)
+                value = (value - read(pixels + offset, i - colors)) & mask;
+            write(encoded + offset, i, value);
+        }
+    }
+    return ret;
+}
+
+static void testPredictor(const charbuff& data, const charbuff& encoded, unsigned predictor,
+    unsigned columns, unsigned colors, unsigned bpc)
+{
+    PdfDictionary decodeParms;
+    decodeParms.AddKey("Predictor", (int64_t)predictor);
+    decodeParms.AddKey("Columns", (int64_t)columns);
+    decodeParms.AddKey("Colors", (int64_t)colors);
+    decodeParms.AddKey("BitsPerComponent", (int64_t)bpc);
+
+    auto filter = PdfFilterFactory::Create(PdfFilterType::FlateDecode);
+    charbuff compressed;
+    filter->EncodeTo(compressed, encoded);
+    charbuff decoded;
+    filter->DecodeTo(decoded, compressed, &decodeParms);
+    REQUIRE(decoded == data);
+}
+
+TEST_CASE("testPredictors")
+{
+    // Pseudo random but smooth enough data, so that
+    // every predictor gets to see a variety of values
+    auto createData = [](size_t size) {
+        charbuff ret(size);
+        unsigned state = 12345;
+        for (size_t i = 0; i < size; i++)
+        {
+            state = state * 1103515245 + 12345;
+            ret[i] = (char)((i * 7 + (state >> 24)) & 0xFF);
+        }
+        return ret;
+    };
+
+    const unsigned columns = 301;
+    const unsigned rows = 40;
+    struct TestFormat
+    {
+        unsigned Colors;
+        unsigned Bpc;
+    };
+    const TestFormat formats[] = { { 1, 1 }, { 1, 2 }, { 3, 4 }, { 1, 8 }, { 2, 8 },
+        { 3, 8 }, { 4, 8 }, { 3, 16 }, { 4, 16 }, { 5, 8 } };
+    for (auto& format : formats)
+    {
+        INFO(utls::Format("Colors {}, BitsPerComponent {}", format.Colors, format.Bpc));
+        size_t rowLength = (columns * format.Colors * format.Bpc + 7) / 8;
+        unsigned bpp = std::max(1u, (format.Colors * format.Bpc + 7) / 8);
+        auto data = createData(rowLength * rows);
+
+        for (unsigned char type = 0; type <= 4; type++)
+            testPredictor(data, encodePngRows(data, rowLength, bpp, type), 10 + type, columns, format.Colors, format.Bpc);
+
+        // Clear the bits of the row padding, which the
+        // TIFF predictor doesn't preserve
+        size_t paddingBits = rowLength * 8 - (size_t)columns * format.Colors * format.Bpc;
+        for (size_t offset = rowLength - 1; offset < data.size(); offset += rowLength)
+            data[offset] = (char)(data[offset] & (0xFF << paddingBits));
+
+        testPredictor(data, encodeTiffRows(data, rowLength, columns, format.Colors, format.Bpc), 2, columns, format.Colors, format.Bpc);
+    }
+}
@@ -8,11 +8,63 @@
 
 #include <PdfTest.h>
 
+#include <thread>
+
 #include <podofo/private/FreetypePrivate.h>
 
 using namespace std;
 using namespace PoDoFo;
 
+TEST_CASE("TestGlyphWidths")
+{
+    auto std14Metrics = PdfFontMetricsStandard14::Create(PdfStandard14FontType::Helvetica);
+    auto metrics = PdfFontMetricsFreetype::FromMetrics(*std14Metrics);
+    auto face = metrics->GetFaceHandle().get();
+    unsigned glyphCount = metrics->GetGlyphCount();
+    REQUIRE(glyphCount > 0);
+
+    // The widths are the advances of the loaded glyphs
+    vector<unsigned> gids;
+    vector<double> expected;
+    for (unsigned i = 0; i < glyphCount; i++)
+    {
+        REQUIRE(FT_Load_Glyph(face, i, FT_LOAD_NO_SCALE | FT_LOAD_NO_BITMAP) == 0);
+        gids.push_back(i);
+        expected.push_back(face->glyph->metrics.horiAdvance / (double)face->units_per_EM);
+    }
+
+    // Glyphs out of range get the default width
+    gids.push_back(glyphCount);
+    expected.push_back(metrics->GetDefaultWidth());
+
+    vector<double> widths;
+    metrics->GetGlyphWidths(gids, widths);
+    REQUIRE(widths == expected);
+
+    double width;
+    REQUIRE(metrics->TryGetGlyphWidth(glyphCount / 2, width));
+    REQUIRE(width == expected[glyphCount / 2]);
+    REQUIRE(!metrics->TryGetGlyphWidth(glyphCount, width));
+
+    // Metrics with the same face share the widths
+    auto metrics2 = PdfFontMetricsFreetype::FromMetrics(*metrics);
+    vector<vector<double>> results(4);
+    vector<thread> threads;
+    for (unsigned i = 0; i < results.size(); i++)
+    {
+        threads.emplace_back([&, i]() {
+            auto& m = i % 2 == 0 ? *metrics : *metrics2;
+            m.GetGlyphWidths(gids, results[i]);
+        });
+    }
+
+    for (auto& thread : threads)
+        thread.join();
+
+    for (auto& result : results)
+        REQUIRE(result == expected);
+}
+
 #ifdef PODOFO_HAVE_FONTCONFIG
 
 #include <fontconfig/fontconfig.h>
@@ -185,3 +185,183 @@ TEST_CASE("TestImage5")
         TestUtils::WriteTestOutputFile(TestUtils::GetTestOutputFilePath("YCCK-jpeg.ppm"), ppmbuffer);
     }
 }
+
+TEST_CASE("TestImageDecodeScanLines")
+{
+    constexpr unsigned WIDTH = 37;
+    constexpr unsigned HEIGHT = 23;
+    PdfMemDocument doc;
+
+    // Rows are not aligned, so a wrong source row size would be detected
+    charbuff rgb((size_t)WIDTH * 3 * HEIGHT);
+    charbuff gray((size_t)WIDTH * HEIGHT);
+    for (unsigned i = 0; i < HEIGHT; i++)
+    {
+        for (unsigned j = 0; j < WIDTH; j++)
+        {
+            rgb[(i * WIDTH + j) * 3 + 0] = (char)(j * 6);
+            rgb[(i * WIDTH + j) * 3 + 1] = (char)(i * 10);
+            rgb[(i * WIDTH + j) * 3 + 2] = (char)128;
+            gray[i * WIDTH + j] = (char)(i * 5 + j * 3);
+        }
+    }
+
+    // NOTE: The decoded rows are aligned to 4 bytes
+    auto checkRows = [](const charbuff& decoded, const charbuff& expected, unsigned rowSize) {
+        unsigned stride = 4 * ((rowSize + 3) / 4);
+        REQUIRE(decoded.size() == (size_t)stride * HEIGHT);
+        for (unsigned i = 0; i < HEIGHT; i++)
+            REQUIRE(std::memcmp(decoded.data() + i * stride, expected.data() + i * rowSize, rowSize) == 0);
+    };
+
+    auto rgbImage = doc.CreateImage();
+    rgbImage->SetData(rgb, WIDTH, HEIGHT, PdfPixelFormat::RGB24, WIDTH * 3);
+    charbuff buffer;
+    rgbImage->DecodeTo(buffer, PdfPixelFormat::RGB24);
+    checkRows(buffer, rgb, WIDTH * 3);
+
+    auto grayImage = doc.CreateImage();
+    grayImage->SetData(gray, WIDTH, HEIGHT, PdfPixelFormat::Grayscale, WIDTH);
+    grayImage->DecodeTo(buffer, PdfPixelFormat::Grayscale);
+    checkRows(buffer, gray, WIDTH);
+
+#ifdef PODOFO_HAVE_JPEG_LIB
+    // The JPEG data is decompressed while reading the stream
+    charbuff jpeg;
+    rgbImage->ExportTo(jpeg, PdfExportFormat::Jpeg);
+    auto jpegImage = doc.CreateImage();
+    jpegImage->LoadFromBuffer(jpeg);
+    REQUIRE(jpegImage->GetObject().MustGetStream().GetFilters()[0] == PdfFilterType::DCTDecode);
+    jpegImage->DecodeTo(buffer, PdfPixelFormat::RGB24);
+    REQUIRE(buffer.size() == (size_t)4 * ((WIDTH * 3 + 3) / 4) * HEIGHT);
+    double diff = 0;
+    for (unsigned i = 0; i < HEIGHT; i++)
+    {
+        for (unsigned j = 0; j < WIDTH * 3; j++)
+        {
+            diff += std::abs((int)(unsigned char)buffer[i * 4 * ((WIDTH * 3 + 3) / 4) + j]
+                - (int)(unsigned char)rgb[i * WIDTH * 3 + j]);
+        }
+    }
+    REQUIRE(diff / rgb.size() < 8);
+#endif // PODOFO_HAVE_JPEG_LIB
+}
+
+TEST_CASE("TestImageDecodePixelFormats")
+{
+    // The width covers both the vectorized conversion and the remaining pixels
+    constexpr unsigned WIDTH = 37;
+    constexpr unsigned HEIGHT = 3;
+    PdfMemDocument doc;
+
+    charbuff rgb((size_t)WIDTH * 3 * HEIGHT);
+    charbuff gray((size_t)WIDTH * HEIGHT);
+    charbuff alpha((size_t)WIDTH * HEIGHT);
+    for (unsigned i = 0; i < WIDTH * HEIGHT; i++)
+    {
+        rgb[i * 3 + 0] = (char)(i * 7);
+        rgb[i * 3 + 1] = (char)(i * 11 + 1);
+        rgb[i * 3 + 2] = (char)(i * 13 + 2);
+        gray[i] = (char)(i * 5 + 3);
+        alpha[i] = (char)(255 - i * 3);
+    }
+
+    auto rgbImage = doc.CreateImage();
+    rgbImage->SetData(rgb, WIDTH, HEIGHT, PdfPixelFormat::RGB24, WIDTH * 3);
+    auto grayImage = doc.CreateImage();
+    grayImage->SetData(gray, WIDTH, HEIGHT, PdfPixelFormat::Grayscale, WIDTH);
+    auto rgbMaskedImage = doc.CreateImage();
+    rgbMaskedImage->SetData(rgb, WIDTH, HEIGHT, PdfPixelFormat::RGB24, WIDTH * 3);
+    auto grayMaskedImage = doc.CreateImage();
+    grayMaskedImage->SetData(gray, WIDTH, HEIGHT, PdfPixelFormat::Grayscale, WIDTH);
+    auto alphaImage = doc.CreateImage();
+    alphaImage->SetData(alpha, WIDTH, HEIGHT, PdfPixelFormat::Grayscale, WIDTH);
+    rgbMaskedImage->SetSoftMask(*alphaImage);
+    grayMaskedImage->SetSoftMask(*alphaImage);
+
+    auto checkFormat = [&](const PdfImage& image, PdfPixelFormat format, bool isGray, bool hasAlpha) {
+        unsigned bpp;
+        switch (format)
+        {
+            case PdfPixelFormat::Grayscale:
+                bpp = 1;
+                break;
+            case PdfPixelFormat::RGB24:
+            case PdfPixelFormat::BGR24:
+                bpp = 3;
+                break;
+            default:
+                bpp = 4;
+                break;
+        }
+
+        charbuff buffer;
+        image.DecodeTo(buffer, format);
+        unsigned stride = 4 * ((WIDTH * bpp + 3) / 4);
+        REQUIRE(buffer.size() == (size_t)stride * HEIGHT);
+        for (unsigned i = 0; i < HEIGHT; i++)
+        {
+            for (unsigned j = 0; j < WIDTH; j++)
+            {
+                unsigned index = i * WIDTH + j;
+                unsigned char r, g, b;
+                if (isGray)
+                {
+                    r = g = b = (unsigned char)gray[index];
+                }
+                else
+                {
+                    r = (unsigned char)rgb[index * 3 + 0];
+                    g = (unsigned char)rgb[index * 3 + 1];
+                    b = (unsigned char)rgb[index * 3 + 2];
+                }
+                unsigned char a = hasAlpha ? (unsigned char)alpha[index] : 255;
+
+                unsigned char expected[4];
+                switch (format)
+                {
+                    case PdfPixelFormat::Grayscale:
+                        expected[0] = r;
+                        break;
+                    case PdfPixelFormat::RGB24:
+                        expected[0] = r; expected[1] = g; expected[2] = b;
+                        break;
+                    case PdfPixelFormat::BGR24:
+                        expected[0] = b; expected[1] = g; expected[2] = r;
+                        break;
+                    case PdfPixelFormat::RGBA:
+                        expected[0] = r; expected[1] = g; expected[2] = b; expected[3] = a;
+                        break;
+                    case PdfPixelFormat::BGRA:
+                        expected[0] = b; expected[1] = g; expected[2] = r; expected[3] = a;
+                        break;
+                    case PdfPixelFormat::ARGB:
+                        expected[0] = a; expected[1] = r; expected[2] = g; expected[3] = b;
+                        break;
+                    case PdfPixelFormat::ABGR:
+                        expected[0] = a; expected[1] = b; expected[2] = g; expected[3] = r;
+                        break;
+                    default:
+                        FAIL("Unexpected format");
+                }
+
+                auto pixel = (const unsigned char*)buffer.data() + i * stride + j * bpp;
+                REQUIRE(std::memcmp(pixel, expected, bpp) == 0);
+            }
+        }
+    };
+
+    PdfPixelFormat formats[] = {
+        PdfPixelFormat::RGB24, PdfPixelFormat::BGR24,
+        PdfPixelFormat::RGBA, PdfPixelFormat::BGRA,
+        PdfPixelFormat::ARGB, PdfPixelFormat::ABGR,
+    };
+    for (auto format : formats)
+    {
+        checkFormat(*rgbImage, format, false, false);
+        checkFormat(*rgbMaskedImage, format, false, true);
+        checkFormat(*grayImage, format, true, false);
+        checkFormat(*grayMaskedImage, format, true, true);
+    }
+    checkFormat(*grayImage, PdfPixelFormat::Grayscale, true, false);
+}
@@ -101,6 +101,28 @@ TEST_CASE("testFromEscaped")
     TestFromEscape("Length#20With#20Spaces", "Length With Spaces");
 }
 
+TEST_CASE("testAtoms")
+{
+    // Names with the same value of an atom compare
+    // and hash the same however they are created
+    auto names = { PdfName("Type"), PdfName(string("Type")), PdfName::FromEscaped("Type"),
+        PdfName::FromEscaped("#54ype"), PdfName::FromRaw(bufferview("Type", 4)) };
+    for (auto& name : names)
+    {
+        REQUIRE(name == PdfName::KeyType);
+        REQUIRE(!(name != PdfName::KeyType));
+        REQUIRE(!(name < PdfName::KeyType));
+        REQUIRE(std::hash<PdfName>()(name) == std::hash<PdfName>()(PdfName::KeyType));
+    }
+
+    REQUIRE(PdfName("Type") != PdfName::KeySubtype);
+    REQUIRE(PdfName("Type") != PdfName("TypeX"));
+    REQUIRE(PdfName::FromEscaped("TypeX") != PdfName::KeyType);
+    REQUIRE(PdfName::FromEscaped("Type#58") == PdfName("TypeX"));
+    REQUIRE(PdfName() == PdfName::KeyNull);
+    REQUIRE(PdfName("").IsNull());
+}
+
 //
 // Test encoding of names.
 // pszString : internal representation, ie unencoded name
@@ -85,3 +85,95 @@ TEST_CASE("TestFlattening")
         REQUIRE(child.GetDictionary().MustGetKey("Parent").GetReference() == pageRootRef);
     }
 }
+
+TEST_CASE("TestImportPages")
+{
+    PdfMemDocument src;
+    auto& font = src.GetObjects().CreateDictionaryObject("Font", "Type1");
+    font.GetDictionary().AddKey("BaseFont", PdfName("Helvetica"));
+
+    // Objects not reachable from the pages must not be imported
+    for (unsigned i = 0; i < 50; i++)
+        src.GetObjects().CreateDictionaryObject().GetDictionary().AddKey("Unused", static_cast<int64_t>(i));
+
+    for (unsigned i = 0; i < 10; i++)
+    {
+        auto& page = src.GetPages().CreatePage(PdfPage::CreateStandardPageSize(PdfPageSize::A4));
+        PdfDictionary fonts;
+        fonts.AddKey("F1", font.GetIndirectReference());
+        PdfDictionary resources;
+        resources.AddKey("Font", fonts);
+        page.GetDictionary().AddKey("Resources", resources);
+
+        auto& contents = src.GetObjects().CreateDictionaryObject();
+        contents.GetOrCreateStream().SetData(utls::Format("BT /F1 12 Tf ({}) Tj ET", i));
+        page.GetDictionary().AddKey("Contents", contents.GetIndirectReference());
+    }
+
+    // A link from the first page to the sixth one
+    auto& annot = src.GetObjects().CreateDictionaryObject("Annot", "Link");
+    PdfArray dest;
+    dest.Add(src.GetPages().GetPageAt(5).GetObject().GetIndirectReference());
+    dest.Add(PdfName("Fit"));
+    annot.GetDictionary().AddKey("Dest", dest);
+    PdfArray annots;
+    annots.Add(annot.GetIndirectReference());
+    src.GetPages().GetPageAt(0).GetDictionary().AddKey("Annots", annots);
+
+    // Inherited attribute
+    src.GetPages().GetDictionary().AddKey("Rotate", static_cast<int64_t>(90));
+
+    auto getFontRef = [](PdfPage& page) {
+        return page.GetDictionary().MustFindKey("Resources").GetDictionary()
+            .MustFindKey("Font").GetDictionary().MustGetKey("F1").GetReference();
+    };
+
+    {
+        PdfMemDocument doc;
+        PdfObjectImporter importer(doc, src);
+        doc.GetPages().AppendDocumentPages(importer, 0, 1);
+        // The page, its contents, the annotation and the font
+        REQUIRE(importer.GetImportedCount() == 4);
+        doc.GetPages().AppendDocumentPages(importer, 1, 1);
+        REQUIRE(importer.GetImportedCount() == 6);
+        REQUIRE(doc.GetPages().GetCount() == 2);
+
+        auto& page0 = doc.GetPages().GetPageAt(0);
+        auto& page1 = doc.GetPages().GetPageAt(1);
+        REQUIRE(page0.GetDictionary().MustFindKey("Rotate").GetNumber() == 90);
+        REQUIRE(page0.GetDictionary().MustGetKey("Parent").GetReference() == doc.GetPages().GetObject().GetIndirectReference());
+
+        // The font is shared by the imported pages
+        REQUIRE(getFontRef(page0) == getFontRef(page1));
+        REQUIRE(importer.GetImportedObject(font.GetIndirectReference())->GetIndirectReference() == getFontRef(page0));
+
+        // The linked page was not imported
+        auto& importedAnnot = *importer.GetImportedObject(annot.GetIndirectReference());
+        REQUIRE(importedAnnot.GetDictionary().MustFindKey("Dest").GetArray().MustFindAt(0).IsNull());
+
+        charbuff buffer;
+        StringStreamDevice device(buffer);
+        doc.Save(device);
+
+        PdfMemDocument loaded;
+        loaded.LoadFromBuffer(buffer);
+        REQUIRE(loaded.GetPages().GetCount() == 2);
+        auto& contents = loaded.GetPages().GetPageAt(1).GetDictionary().MustFindKey("Contents");
+        REQUIRE(contents.MustGetStream().GetCopy() == "BT /F1 12 Tf (1) Tj ET");
+    }
+
+    {
+        PdfMemDocument doc;
+        doc.GetPages().AppendDocumentPages(src);
+        REQUIRE(doc.GetPages().GetCount() == 10);
+
+        // 10 pages with their contents, the annotation and the font
+        REQUIRE(doc.GetObjects().GetSize() < 30);
+
+        // The link to the imported page is kept
+        auto& page0 = doc.GetPages().GetPageAt(0);
+        auto& link = page0.GetDictionary().MustFindKey("Annots").GetArray().MustFindAt(0);
+        REQUIRE(link.GetDictionary().MustFindKey("Dest").GetArray()[0].GetReference()
+            == doc.GetPages().GetPageAt(5).GetObject().GetIndirectReference());
+    }
+}
@@ -188,6 +188,170 @@ TEST_CASE("testDeleteAll")
     testDeleteAll(doc);
 }
 
+TEST_CASE("testLazyPageTree")
+{
+    constexpr unsigned FANOUT = 10;
+    PdfMemDocument doc;
+
+    // Create a tree with FANOUT^3 pages and two levels of intermediate nodes
+    auto& root = doc.GetObjects().CreateDictionaryObject("Pages");
+    doc.GetCatalog().GetDictionary().AddKeyIndirect("Pages", root);
+    PdfReference firstNodeRef;
+    vector<PdfReference> pageRefs;
+    PdfArray mediaBox;
+    PdfPage::CreateStandardPageSize(PdfPageSize::A4).ToArray(mediaBox);
+    PdfArray rootKids;
+    for (unsigned i = 0; i < FANOUT; i++)
+    {
+        auto& node = doc.GetObjects().CreateDictionaryObject("Pages");
+        node.GetDictionary().AddKey("Parent", root.GetIndirectReference());
+        if (i == 0)
+            firstNodeRef = node.GetIndirectReference();
+
+        PdfArray nodeKids;
+        for (unsigned j = 0; j < FANOUT; j++)
+        {
+            auto& leaf = doc.GetObjects().CreateDictionaryObject("Pages");
+            leaf.GetDictionary().AddKey("Parent", node.GetIndirectReference());
+            PdfArray leafKids;
+            for (unsigned k = 0; k < FANOUT; k++)
+            {
+                auto& page = doc.GetObjects().CreateDictionaryObject("Page");
+                page.GetDictionary().AddKey("Parent", leaf.GetIndirectReference());
+                page.GetDictionary().AddKey("MediaBox", mediaBox);
+                page.GetDictionary().AddKey(TEST_PAGE_KEY,
+                    static_cast<int64_t>((i * FANOUT + j) * FANOUT + k));
+                leafKids.Add(page.GetIndirectReference());
+                pageRefs.push_back(page.GetIndirectReference());
+            }
+
+            leaf.GetDictionary().AddKey("Kids", leafKids);
+            leaf.GetDictionary().AddKey("Count", static_cast<int64_t>(FANOUT));
+            nodeKids.Add(leaf.GetIndirectReference());
+        }
+
+        node.GetDictionary().AddKey("Kids", nodeKids);
+        node.GetDictionary().AddKey("Count", static_cast<int64_t>(FANOUT * FANOUT));
+        rootKids.Add(node.GetIndirectReference());
+    }
+
+    root.GetDictionary().AddKey("Kids", rootKids);
+    root.GetDictionary().AddKey("Count", static_cast<int64_t>(FANOUT * FANOUT * FANOUT));
+
+    charbuff buffer;
+    StringStreamDevice device(buffer);
+    doc.Save(device);
+
+    {
+        PdfMemDocument loaded;
+        loaded.LoadFromBuffer(buffer);
+        REQUIRE(loaded.GetPages().GetCount() == TEST_NUM_PAGES * FANOUT);
+
+        auto& page = loaded.GetPages().GetPageAt(537);
+        REQUIRE(isPageNumber(page, 537));
+        REQUIRE(page.GetIndex() == 537);
+        REQUIRE(page.GetMediaBox() == PdfPage::CreateStandardPageSize(PdfPageSize::A4));
+
+        // Only the nodes on the path to the page and their kids are loaded
+        REQUIRE(!loaded.GetObjects().GetObject(pageRefs[0])->IsDelayedLoadDone());
+        REQUIRE(!loaded.GetObjects().GetObject(pageRefs[989])->IsDelayedLoadDone());
+
+        REQUIRE(isPageNumber(loaded.GetPages().GetPageAt(989), 989));
+        REQUIRE(&loaded.GetPages().GetPageAt(537) == &page);
+
+        // Modifying the tree loads it completely, keeping the loaded pages
+        loaded.GetPages().RemovePageAt(0);
+        REQUIRE(loaded.GetPages().GetCount() == TEST_NUM_PAGES * FANOUT - 1);
+        REQUIRE(&loaded.GetPages().GetPageAt(536) == &page);
+        REQUIRE(page.GetIndex() == 536);
+    }
+
+    {
+        PdfMemDocument loaded;
+        loaded.LoadFromBuffer(buffer);
+
+        // An inconsistent /Count makes the whole tree to be loaded
+        loaded.GetObjects().MustGetObject(firstNodeRef).GetDictionary()
+            .AddKey("Count", static_cast<int64_t>(FANOUT));
+        for (unsigned i = 0; i < TEST_NUM_PAGES * FANOUT; i += 111)
+            REQUIRE(isPageNumber(loaded.GetPages().GetPageAt(i), i));
+
+        REQUIRE(loaded.GetObjects().GetObject(pageRefs[0])->IsDelayedLoadDone());
+    }
+}
+
+TEST_CASE("testLazyPageTreeWrongCount")
+{
+    PdfMemDocument doc;
+    for (unsigned i = 0; i < 3; i++)
+        doc.GetPages().CreatePage(PdfPage::CreateStandardPageSize(PdfPageSize::A4));
+
+    // The /Count of the root is bigger than the number of pages
+    doc.GetPages().GetObject().GetDictionary().AddKey("Count", static_cast<int64_t>(5));
+
+    charbuff buffer;
+    StringStreamDevice device(buffer);
+    doc.Save(device);
+
+    PdfMemDocument loaded;
+    loaded.LoadFromBuffer(buffer);
+    REQUIRE(loaded.GetPages().GetCount() == 3);
+
+    PdfMemDocument dest;
+    dest.GetPages().AppendDocumentPages(loaded);
+    REQUIRE(dest.GetPages().GetCount() == 3);
+
+    // The /Count of an intermediate node off the path of the last
+    // page is wrong: the first node has 2 pages but claims 3
+    PdfMemDocument wrongNodeDoc;
+    auto& root = wrongNodeDoc.GetObjects().CreateDictionaryObject("Pages");
+    wrongNodeDoc.GetCatalog().GetDictionary().AddKeyIndirect("Pages", root);
+    PdfArray mediaBox;
+    PdfPage::CreateStandardPageSize(PdfPageSize::A4).ToArray(mediaBox);
+    PdfArray rootKids;
+    unsigned pageNumber = 0;
+    for (unsigned pageCount : { 2u, 3u })
+    {
+        auto& node = wrongNodeDoc.GetObjects().CreateDictionaryObject("Pages");
+        node.GetDictionary().AddKey("Parent", root.GetIndirectReference());
+        PdfArray nodeKids;
+        for (unsigned i = 0; i < pageCount; i++)
+        {
+            auto& page = wrongNodeDoc.GetObjects().CreateDictionaryObject("Page");
+            page.GetDictionary().AddKey("Parent", node.GetIndirectReference());
+            page.GetDictionary().AddKey("MediaBox", mediaBox);
+            page.GetDictionary().AddKey(TEST_PAGE_KEY, static_cast<int64_t>(pageNumber));
+            nodeKids.Add(page.GetIndirectReference());
+            pageNumber++;
+        }
+
+        node.GetDictionary().AddKey("Kids", nodeKids);
+        node.GetDictionary().AddKey("Count", static_cast<int64_t>(3));
+        rootKids.Add(node.GetIndirectReference());
+    }
+    root.GetDictionary().AddKey("Kids", rootKids);
+    root.GetDictionary().AddKey("Count", static_cast<int64_t>(6));
+
+    charbuff wrongNodeBuffer;
+    StringStreamDevice wrongNodeDevice(wrongNodeBuffer);
+    wrongNodeDoc.Save(wrongNodeDevice);
+
+    // The last page is found through the correct node, with the
+    // index given by the wrong count. Then a page in the wrong
+    // node loads the whole tree, which re-indexes the last page
+    PdfMemDocument wrongNodeLoaded;
+    wrongNodeLoaded.LoadFromBuffer(wrongNodeBuffer);
+    auto& pages = wrongNodeLoaded.GetPages();
+    auto& lastPage = pages.GetPageAt(pages.GetCount() - 1);
+    REQUIRE(isPageNumber(lastPage, 4));
+    REQUIRE(isPageNumber(pages.GetPageAt(0), 0));
+    REQUIRE(pages.GetCount() == 5);
+    REQUIRE(lastPage.GetIndex() == 4);
+    REQUIRE(&pages.GetPageAt(4) == &lastPage);
+    for (unsigned i = 0; i < 5; i++)
+        REQUIRE(isPageNumber(pages.GetPageAt(i), i));
+}
+
 void testGetPages(PdfMemDocument& doc)
 {
     for (unsigned i = 0; i < TEST_NUM_PAGES; i++)
@@ -408,6 +408,34 @@ TEST_CASE("TestAppend")
     REQUIRE(out == "q\nBT (Hello) Tj ET\nQ\nq\n1 1 1 rg\nQ\n");
 }
 
+TEST_CASE("TestStringStream")
+{
+    PdfStringStream stream;
+    stream << "BT" << ' ' << (unsigned)12 << ' ' << -7 << ' ' << 0.5 << ' ' << 100.0 << ' '
+        << -0.25f << ' ' << 1.23456789 << ' ' << 0.0000001 << ' ' << "sv"sv << ' ' << string("str") << endl;
+    REQUIRE(stream.GetString() == "BT 12 -7 0.5 100 -0.25 1.234568 0 sv str\n");
+
+    // Types with no direct formatting, like bool, are written through a std::ostream
+    stream.Clear();
+    stream.SetPrecision(2);
+    stream << 3.14159 << ' ' << true << ' ' << (uint64_t)18446744073709551615u;
+    ((OutputStream&)stream).Write(" re\n"sv);
+    REQUIRE(stream.GetString() == "3.14 1 18446744073709551615 re\n");
+    REQUIRE(stream.GetSize() == 31);
+
+    auto str = stream.TakeString();
+    REQUIRE(str == "3.14 1 18446744073709551615 re\n");
+
+    // The painter output honors the precision
+    FakeCanvas canvas;
+    PdfPainter painter;
+    painter.SetCanvas(canvas);
+    painter.SetPrecision(3);
+    painter.DrawLine(0.12345, 10, 1000.5, 20.0001);
+    painter.FinishDrawing();
+    REQUIRE(canvas.GetCopy() == "q\n0.123 10 m\n1000.5 20 l\nS\nQ\n");
+}
+
 TEST_CASE("TestRotate")
 {
     unordered_map<int, Matrix> matrices = {
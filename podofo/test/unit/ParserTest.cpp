@@ -20,9 +20,12 @@
 
 #include <limits>
 
+#include <atomic>
 #include <sstream>
+#include <thread>
 
 #include <PdfTest.h>
+#include <podofo/private/PdfConcurrentLoader.h>
 
 using namespace std;
 using namespace PoDoFo;
@@ -1809,6 +1812,588 @@ TEST_CASE("testReadObjects")
     }
 }
 
+TEST_CASE("testReadDelayedCompressedObjects")
+{
+    ostringstream oss;
+    oss << "%PDF-1.5\n";
+    size_t offsetCatalog = oss.tellp();
+    oss << "1 0 obj << /Type /Catalog /Pages 2 0 R >> endobj\n";
+    size_t offsetPages = oss.tellp();
+    oss << "2 0 obj << /Type /Pages /Kids [] /Count 0 >> endobj\n";
+
+    // Object stream with objects 4 and 5. Object 7 is referenced
+    // in the XRef stream but it's missing from the object stream
+    string objects = "4 0 5 12 << /A 10 >> [ (Hello) 2.5 ]";
+    size_t offsetObjStm = oss.tellp();
+    oss << "3 0 obj << /Type /ObjStm /N 2 /First 9 /Length " << objects.length() << " >>\n";
+    oss << "stream\n" << objects << "\nendstream\nendobj\n";
+
+    size_t offsetXRef = oss.tellp();
+    string entries;
+    auto writeEntry = [&entries](unsigned type, size_t field2, unsigned field3) {
+        entries.append(utls::Format("{:02X}{:08X}{:04X}", type, (unsigned)field2, field3));
+    };
+    writeEntry(0, 0, 65535);
+    writeEntry(1, offsetCatalog, 0);
+    writeEntry(1, offsetPages, 0);
+    writeEntry(1, offsetObjStm, 0);
+    writeEntry(2, 3, 0);
+    writeEntry(2, 3, 1);
+    writeEntry(1, offsetXRef, 0);
+    writeEntry(2, 3, 2);
+    entries.push_back('>');
+    oss << "6 0 obj << /Type /XRef /Size 8 /W [1 4 2] /Root 1 0 R /Filter /ASCIIHexDecode /Length "
+        << entries.length() << " >>\n";
+    oss << "stream\n" << entries << "\nendstream\nendobj\n";
+    oss << "startxref\n" << offsetXRef << "\n%%EOF\n";
+
+    PdfMemDocument doc;
+    doc.LoadFromBuffer(oss.str());
+    auto& objs = doc.GetObjects();
+    auto& obj4 = objs.MustGetObject(PdfReference(4, 0));
+    auto& obj5 = objs.MustGetObject(PdfReference(5, 0));
+    auto& obj7 = objs.MustGetObject(PdfReference(7, 0));
+    REQUIRE(!obj4.IsDelayedLoadDone());
+    REQUIRE(!obj5.IsDelayedLoadDone());
+    REQUIRE(!obj7.IsDelayedLoadDone());
+
+    REQUIRE(obj5.GetArray().GetSize() == 2);
+    REQUIRE(obj5.GetArray()[0].GetString().GetString() == "Hello");
+    REQUIRE(!obj4.IsDelayedLoadDone());
+    REQUIRE(obj4.GetDictionary().FindKeyAs<int64_t>("A") == 10);
+    REQUIRE(obj7.IsNull());
+}
+
+TEST_CASE("testReadObjectStreamWithLengthInItself")
+{
+    ostringstream oss;
+    oss << "%PDF-1.5\n";
+    size_t offsetCatalog = oss.tellp();
+    oss << "1 0 obj << /Type /Catalog /Pages 2 0 R >> endobj\n";
+    size_t offsetPages = oss.tellp();
+    oss << "2 0 obj << /Type /Pages /Kids [] /Count 0 >> endobj\n";
+
+    // The /Length of the object stream is the object 4 stored in it
+    string objects = "4 0 5";
+    size_t offsetObjStm = oss.tellp();
+    oss << "3 0 obj << /Type /ObjStm /N 1 /First 4 /Length 4 0 R >>\n";
+    oss << "stream\n" << objects << "\nendstream\nendobj\n";
+
+    size_t offsetXRef = oss.tellp();
+    string entries;
+    auto writeEntry = [&entries](unsigned type, size_t field2, unsigned field3) {
+        entries.append(utls::Format("{:02X}{:08X}{:04X}", type, (unsigned)field2, field3));
+    };
+    writeEntry(0, 0, 65535);
+    writeEntry(1, offsetCatalog, 0);
+    writeEntry(1, offsetPages, 0);
+    writeEntry(1, offsetObjStm, 0);
+    writeEntry(2, 3, 0);
+    writeEntry(1, offsetXRef, 0);
+    entries.push_back('>');
+    oss << "5 0 obj << /Type /XRef /Size 6 /W [1 4 2] /Root 1 0 R /Filter /ASCIIHexDecode /Length "
+        << entries.length() << " >>\n";
+    oss << "stream\n" << entries << "\nendstream\nendobj\n";
+    oss << "startxref\n" << offsetXRef << "\n%%EOF\n";
+
+    // Loading the object fails instead of recursing
+    for (auto options : { PdfLoadOptions::None, PdfLoadOptions::ConcurrentRead })
+    {
+        PdfMemDocument doc;
+        doc.LoadFromBuffer(oss.str(), { }, options);
+        auto& obj4 = doc.GetObjects().MustGetObject(PdfReference(4, 0));
+        ASSERT_THROW_WITH_ERROR_CODE(obj4.GetNumber(), PdfErrorCode::BrokenFile);
+    }
+}
+
+TEST_CASE("testMmapStreamLengthPastEOF")
+{
+    // The /Length of the stream is bigger than the rest of the file
+    ostringstream oss;
+    oss << "%PDF-1.4\n";
+    size_t offsetCatalog = oss.tellp();
+    oss << "1 0 obj << /Type /Catalog /Pages 2 0 R >> endobj\n";
+    size_t offsetPages = oss.tellp();
+    oss << "2 0 obj << /Type /Pages /Kids [] /Count 0 >> endobj\n";
+    size_t offsetXRef = oss.tellp();
+    oss << "xref\n0 4\n";
+    oss << "0000000000 65535 f\r\n";
+    oss << utls::Format("{:010} 00000 n\r\n", offsetCatalog);
+    oss << utls::Format("{:010} 00000 n\r\n", offsetPages);
+    size_t offsetStreamEntry = oss.tellp();
+    oss << "0000000000 00000 n\r\n";
+    oss << "trailer << /Root 1 0 R /Size 4 >>\n";
+    oss << "startxref\n" << offsetXRef << "\n%%EOF\n";
+    size_t offsetStream = oss.tellp();
+    oss << "3 0 obj << /Length 100000 >>\nstream\nStream data";
+
+    auto docbuff = oss.str();
+    auto offsetStr = utls::Format("{:010}", offsetStream);
+    docbuff.replace(offsetStreamEntry, offsetStr.length(), offsetStr);
+
+    auto filepath = TestUtils::GetTestOutputFilePath("MmapStreamLengthPastEOF.pdf");
+    {
+        FileStreamDevice output(filepath, FileMode::Create);
+        output.Write(docbuff);
+    }
+
+    PdfMemDocument doc;
+    doc.Load(filepath);
+    auto copy = doc.GetObjects().MustGetObject(PdfReference(3, 0)).MustGetStream().GetCopy();
+    REQUIRE(copy == "Stream data");
+
+    // A stream moved out of the document outlives the mapped file
+    PdfMemDocument other;
+    auto& moved = other.GetObjects().CreateDictionaryObject();
+    {
+        PdfMemDocument source;
+        source.Load(filepath);
+        moved.GetOrCreateStream() = std::move(source.GetObjects().MustGetObject(PdfReference(3, 0)).MustGetStream());
+    }
+    REQUIRE(moved.MustGetStream().GetCopy() == "Stream data");
+}
+
+TEST_CASE("testArenaAllocation")
+{
+    charbuff buffer;
+    PdfReference arrayRef;
+    {
+        PdfMemDocument doc;
+        doc.GetPages().CreatePage(PdfPage::CreateStandardPageSize(PdfPageSize::A4));
+        PdfArray arr;
+        for (int64_t i = 0; i < 1000; i++)
+        {
+            PdfDictionary dict;
+            dict.AddKey("Index", i);
+            dict.AddKey("Name", PdfName(utls::Format("Entry{}", i)));
+            dict.AddKey("Text", PdfString(utls::Format("Text {}", i)));
+            arr.Add(doc.GetObjects().CreateObject(std::move(dict)).GetIndirectReference());
+        }
+        arrayRef = doc.GetObjects().CreateObject(arr).GetIndirectReference();
+        StringStreamDevice device(buffer);
+        doc.Save(device, PdfSaveOptions::NoCollectGarbage);
+    }
+
+    {
+        PdfMemDocument doc;
+        doc.LoadFromBuffer(buffer, { }, PdfLoadOptions::ArenaAllocation);
+        REQUIRE(doc.GetPages().GetCount() == 1);
+        auto& arr = doc.GetObjects().MustGetObject(arrayRef).GetArray();
+        REQUIRE(arr.GetSize() == 1000);
+
+        auto& obj = arr.MustFindAt(999);
+        REQUIRE(obj.GetDictionary().FindKeyAs<int64_t>("Index") == 999);
+        REQUIRE(obj.GetDictionary().FindKeyAs<PdfName>("Name") == "Entry999");
+
+        // Modify an object allocated from the arena
+        obj.GetDictionary().AddKey("Added", PdfString("Added"));
+        for (int64_t i = 0; i < 10; i++)
+            obj.GetDictionary().AddKey(PdfName(utls::Format("Key{}", i)), i);
+        REQUIRE(obj.GetDictionary().GetSize() == 14);
+        REQUIRE(obj.GetDictionary().FindKeyAs<PdfString>("Text").GetString() == "Text 999");
+        REQUIRE(obj.GetDictionary().FindKeyAs<int64_t>("Key9") == 9);
+
+        // Objects from the heap and from the arena can be freed together
+        auto createdRef = doc.GetObjects().CreateDictionaryObject().GetIndirectReference();
+        REQUIRE(doc.GetObjects().RemoveObject(createdRef) != nullptr);
+        REQUIRE(doc.GetObjects().RemoveObject(obj.GetIndirectReference()) != nullptr);
+
+        // Reloading releases the previous arena
+        doc.LoadFromBuffer(buffer, { }, PdfLoadOptions::ArenaAllocation);
+        REQUIRE(doc.GetObjects().MustGetObject(arrayRef).GetArray().GetSize() == 1000);
+    }
+
+    // Removed objects and data moved out of the document outlive it
+    unique_ptr<PdfObject> removed;
+    PdfArray movedArr;
+    {
+        PdfMemDocument doc;
+        doc.LoadFromBuffer(buffer, { }, PdfLoadOptions::ArenaAllocation);
+        auto& arr = doc.GetObjects().MustGetObject(arrayRef).GetArray();
+        removed = doc.GetObjects().RemoveObject(arr.MustFindAt(5).GetIndirectReference());
+        movedArr = std::move(arr);
+    }
+    REQUIRE(removed->GetDictionary().FindKeyAs<int64_t>("Index") == 5);
+    REQUIRE(removed->GetDictionary().FindKeyAs<PdfName>("Name") == "Entry5");
+    REQUIRE(movedArr.GetSize() == 1000);
+    REQUIRE(movedArr.back().IsReference());
+}
+
+TEST_CASE("testConcurrentRead")
+{
+    charbuff buffer;
+    charbuff encryptedBuffer;
+    {
+        PdfMemDocument doc;
+        for (unsigned i = 0; i < 200; i++)
+        {
+            auto& obj = doc.GetObjects().CreateDictionaryObject();
+            obj.GetDictionary().AddKey("Index", (int64_t)i);
+            obj.GetDictionary().AddKey("Text", PdfString(utls::Format("Text {}", i)));
+            obj.GetOrCreateStream().SetData(utls::Format("Stream data of object {}", i));
+        }
+        doc.GetPages().CreatePage(PdfPage::CreateStandardPageSize(PdfPageSize::A4));
+
+        StringStreamDevice device(buffer);
+        doc.Save(device, PdfSaveOptions::NoCollectGarbage);
+
+        doc.SetEncrypted("user", "owner");
+        StringStreamDevice encryptedDevice(encryptedBuffer);
+        doc.Save(encryptedDevice, PdfSaveOptions::NoCollectGarbage);
+    }
+
+    // Serialize the objects of a document, loading them on demand
+    auto collect = [](const PdfMemDocument& doc, unsigned start) {
+        vector<PdfObject*> objects(doc.GetObjects().begin(), doc.GetObjects().end());
+        vector<string> ret(objects.size());
+        for (size_t i = 0; i < objects.size(); i++)
+        {
+            // Different threads visit the objects in different orders
+            auto obj = objects[(i + start) % objects.size()];
+            auto& str = ret[(i + start) % objects.size()];
+            str = obj->ToString();
+            auto stream = obj->GetStream();
+            if (stream != nullptr)
+            {
+                auto copy = stream->GetCopy();
+                str.append(copy.data(), copy.size());
+            }
+        }
+        return ret;
+    };
+
+    auto test = [&](const shared_ptr<InputStreamDevice>& device, const string_view& password) {
+        PdfMemDocument expectedDoc;
+        expectedDoc.LoadFromDevice(device, password);
+        auto expected = collect(expectedDoc, 0);
+
+        PdfMemDocument doc;
+        doc.LoadFromDevice(device, password, PdfLoadOptions::ConcurrentRead);
+        const unsigned ThreadCount = 8;
+        vector<vector<string>> results(ThreadCount);
+        vector<thread> threads;
+        for (unsigned i = 0; i < ThreadCount; i++)
+        {
+            threads.emplace_back([&, i]() {
+                results[i] = collect(doc, i * 25);
+            });
+        }
+
+        for (auto& thread : threads)
+            thread.join();
+
+        for (auto& result : results)
+            REQUIRE(result == expected);
+    };
+
+    test(std::make_shared<SpanStreamDevice>(buffer), { });
+    test(std::make_shared<SpanStreamDevice>(encryptedBuffer), "user");
+
+    // Devices that are not memory backed are read one object at a time
+    auto filepath = TestUtils::GetTestOutputFilePath("ConcurrentRead.pdf");
+    {
+        FileStreamDevice output(filepath, FileMode::Create);
+        output.Write(buffer);
+    }
+    test(std::make_shared<FileStreamDevice>(filepath), { });
+}
+
+TEST_CASE("testConcurrentLoadCycle")
+{
+    // Two loads requesting each other on different threads, such
+    // as an object stream and its indirect /Length, must fail
+    // instead of waiting for each other forever
+    charbuff buffer("Dummy"sv);
+    SpanStreamDevice device(buffer);
+    PdfConcurrentLoader loader(device);
+    atomic<bool> done1(false);
+    atomic<bool> done2(false);
+    atomic<unsigned> started(0);
+    function<void()> load1;
+    function<void()> load2;
+    auto waitStarted = [&]() {
+        started.fetch_add(1);
+        while (started.load() < 2)
+            this_thread::yield();
+    };
+    load1 = [&]() {
+        waitStarted();
+        loader.LoadOnce(done2, load2);
+    };
+    load2 = [&]() {
+        waitStarted();
+        loader.LoadOnce(done1, load1);
+    };
+
+    atomic<unsigned> brokenCount(0);
+    auto run = [&](atomic<bool>& done, const function<void()>& load) {
+        try
+        {
+            loader.LoadOnce(done, load);
+        }
+        catch (PdfError& error)
+        {
+            if (error.GetCode() == PdfErrorCode::BrokenFile)
+                brokenCount++;
+        }
+    };
+
+    thread thread1([&]() { run(done1, load1); });
+    thread thread2([&]() { run(done2, load2); });
+    thread1.join();
+    thread2.join();
+    REQUIRE(brokenCount == 2);
+    REQUIRE(!done1);
+    REQUIRE(!done2);
+}
+
+TEST_CASE("testConcurrentStreamRead")
+{
+    charbuff buffer;
+    PdfReference streamRef;
+    string data;
+    {
+        PdfMemDocument doc;
+        for (unsigned i = 0; i < 1000; i++)
+            data.append(utls::Format("Line {}\n", i));
+
+        auto& obj = doc.GetObjects().CreateDictionaryObject();
+        obj.GetOrCreateStream().SetData(data);
+        streamRef = obj.GetIndirectReference();
+        doc.GetPages().CreatePage(PdfPage::CreateStandardPageSize(PdfPageSize::A4));
+
+        StringStreamDevice device(buffer);
+        doc.Save(device, PdfSaveOptions::NoCollectGarbage);
+    }
+
+    PdfMemDocument doc;
+    doc.LoadFromBuffer(buffer, { }, PdfLoadOptions::ConcurrentRead);
+    auto& objStream = doc.GetObjects().MustGetObject(streamRef).MustGetStream();
+
+    // Read the same stream from two threads at the same time
+    atomic<unsigned> matches(0);
+    auto read = [&]() {
+        for (unsigned i = 0; i < 100; i++)
+        {
+            charbuff copy;
+            {
+                auto input = objStream.GetInputStream();
+                BufferStreamDevice device(copy);
+                input.CopyTo(device);
+            }
+            if (copy == data && objStream.GetCopy() == data)
+                matches++;
+        }
+    };
+
+    thread thread1(read);
+    thread thread2(read);
+    thread1.join();
+    thread2.join();
+    REQUIRE(matches == 200);
+
+    // Writing is not allowed while the stream is read
+    {
+        auto input = objStream.GetInputStream();
+        ASSERT_THROW_WITH_ERROR_CODE(objStream.SetData("Test"sv), PdfErrorCode::InternalLogic);
+    }
+
+    objStream.SetData("Test"sv);
+    REQUIRE(objStream.GetCopy() == "Test");
+}
+
+TEST_CASE("testParallelFlateCompress")
+{
+    PdfMemDocument doc;
+    vector<PdfReference> refs;
+    vector<string> data;
+    for (unsigned i = 0; i < 100; i++)
+    {
+        string str;
+        for (unsigned j = 0; j < 200; j++)
+            str.append(utls::Format("{} {} {} re f\n", i, j, (i * j) % 97));
+
+        auto& obj = doc.GetObjects().CreateDictionaryObject();
+        obj.GetOrCreateStream().SetData(str, true);
+        refs.push_back(obj.GetIndirectReference());
+        data.push_back(std::move(str));
+    }
+    doc.GetPages().CreatePage(PdfPage::CreateStandardPageSize(PdfPageSize::A4));
+
+    auto save = [&](PdfSaveOptions opts) {
+        charbuff buffer;
+        StringStreamDevice device(buffer);
+        // Streams compressed in a previous save must be compressed again
+        for (unsigned i = 0; i < refs.size(); i++)
+            doc.GetObjects().MustGetObject(refs[i]).MustGetStream().SetData(data[i], true);
+
+        doc.Save(device, opts | PdfSaveOptions::NoCollectGarbage | PdfSaveOptions::NoMetadataUpdate);
+        return buffer;
+    };
+
+    auto check = [&](const charbuff& buffer) {
+        PdfMemDocument loaded;
+        loaded.LoadFromBuffer(buffer);
+        for (unsigned i = 0; i < refs.size(); i++)
+        {
+            auto& obj = loaded.GetObjects().MustGetObject(refs[i]);
+            auto& stream = obj.MustGetStream();
+            REQUIRE(stream.GetFilters() == PdfFilterList{ PdfFilterType::FlateDecode });
+            REQUIRE(stream.GetCopy() == data[i]);
+        }
+    };
+
+    auto normal = save(PdfSaveOptions::None);
+    auto fast = save(PdfSaveOptions::FlateCompressFast);
+    auto best = save(PdfSaveOptions::FlateCompressBest);
+    check(normal);
+    check(fast);
+    check(best);
+
+    // The output doesn't depend on the compression order
+    REQUIRE(save(PdfSaveOptions::None) == normal);
+    REQUIRE(normal.size() < fast.size());
+}
+
+TEST_CASE("testObjectStreams")
+{
+    PdfMemDocument doc;
+    vector<PdfReference> refs;
+    for (unsigned i = 0; i < 250; i++)
+    {
+        auto& obj = doc.GetObjects().CreateDictionaryObject("Annot", "Widget");
+        obj.GetDictionary().AddKey("Index", static_cast<int64_t>(i));
+        obj.GetDictionary().AddKey("T", PdfString(utls::Format("Field{}", i)));
+        refs.push_back(obj.GetIndirectReference());
+    }
+    auto& streamObj = doc.GetObjects().CreateDictionaryObject();
+    streamObj.GetOrCreateStream().SetData("0 0 10 10 re f"sv);
+    doc.GetPages().CreatePage(PdfPage::CreateStandardPageSize(PdfPageSize::A4));
+    doc.SetObjectsPerStream(100);
+
+    auto save = [&](PdfSaveOptions opts) {
+        charbuff buffer;
+        StringStreamDevice device(buffer);
+        doc.Save(device, opts | PdfSaveOptions::NoCollectGarbage | PdfSaveOptions::NoMetadataUpdate);
+        return buffer;
+    };
+
+    auto check = [&](const charbuff& buffer, const string_view& password) {
+        PdfMemDocument loaded;
+        loaded.LoadFromBuffer(buffer, password);
+        REQUIRE(loaded.GetPages().GetCount() == 1);
+        for (unsigned i = 0; i < refs.size(); i++)
+        {
+            auto& obj = loaded.GetObjects().MustGetObject(refs[i]);
+            REQUIRE(obj.GetDictionary().MustFindKey("Index").GetNumber() == i);
+            REQUIRE(obj.GetDictionary().MustFindKey("T").GetString().GetString() == utls::Format("Field{}", i));
+        }
+        REQUIRE(loaded.GetObjects().MustGetObject(streamObj.GetIndirectReference()).MustGetStream().GetCopy() == "0 0 10 10 re f");
+    };
+
+    auto plain = save(PdfSaveOptions::None);
+    auto packed = save(PdfSaveOptions::ObjectStreams);
+    check(packed, { });
+
+    // The object numbers of the object streams are given back,
+    // only the XRef stream object stays in the document
+    auto objectCount = doc.GetObjects().GetObjectCount();
+    auto freeObjectCount = doc.GetObjects().GetFreeObjects().size();
+    (void)save(PdfSaveOptions::ObjectStreams);
+    REQUIRE(doc.GetObjects().GetObjectCount() == objectCount + 1);
+    REQUIRE(doc.GetObjects().GetFreeObjects().size() == freeObjectCount);
+
+    // The object streams are not left in the document
+    for (auto obj : doc.GetObjects())
+        REQUIRE((!obj->IsDictionary() || obj->GetDictionary().FindKeyAs<PdfName>("Type") != "ObjStm"));
+
+    // The annotations, the catalog, the page tree and the page
+    // are packed in 3 streams of at most 100 objects
+    size_t streamCount = 0;
+    string_view view(packed.data(), packed.size());
+    for (size_t pos = view.find("/ObjStm"); pos != string_view::npos; pos = view.find("/ObjStm", pos + 1))
+        streamCount++;
+    REQUIRE(streamCount == 3);
+    REQUIRE(packed.size() < plain.size());
+
+    doc.SetEncrypted("user", "owner");
+    auto encrypted = save(PdfSaveOptions::ObjectStreams);
+    check(encrypted, "user");
+
+    REQUIRE_THROWS_AS(doc.SetObjectsPerStream(0), PdfError);
+}
+
+TEST_CASE("testPeekLoad")
+{
+    PdfMemDocument doc;
+    vector<PdfReference> refs;
+    for (unsigned i = 0; i < 250; i++)
+    {
+        auto& obj = doc.GetObjects().CreateDictionaryObject();
+        obj.GetDictionary().AddKey("Index", static_cast<int64_t>(i));
+        obj.GetDictionary().AddKey("Text", PdfString(utls::Format("Text {}", i)));
+        refs.push_back(obj.GetIndirectReference());
+    }
+    doc.GetObjects().CreateDictionaryObject().GetOrCreateStream().SetData("0 0 10 10 re f"sv);
+    for (unsigned i = 0; i < 3; i++)
+        doc.GetPages().CreatePage(PdfPage::CreateStandardPageSize(PdfPageSize::A4));
+    doc.GetMetadata().SetTitle(PdfString("Peek"));
+    doc.SetObjectsPerStream(100);
+
+    auto save = [&](PdfSaveOptions opts) {
+        charbuff buffer;
+        StringStreamDevice device(buffer);
+        doc.Save(device, opts | PdfSaveOptions::NoCollectGarbage);
+        return buffer;
+    };
+
+    auto serialize = [](const PdfMemDocument& loaded) {
+        vector<string> ret;
+        for (auto obj : loaded.GetObjects())
+            ret.push_back(obj->GetIndirectReference().ToString() + " " + obj->ToString());
+        return ret;
+    };
+
+    auto check = [&](const charbuff& buffer, const string_view& password) {
+        // Read few values, then enumerate all the objects
+        PdfMemDocument peeked;
+        peeked.LoadFromBuffer(buffer, password, PdfLoadOptions::Peek);
+        REQUIRE(peeked.GetPages().GetCount() == 3);
+        REQUIRE(peeked.GetMetadata().GetTitle()->GetString() == "Peek");
+        REQUIRE(peeked.GetObjects().MustGetObject(refs[150]).GetDictionary().MustFindKey("Index").GetNumber() == 150);
+
+        PdfMemDocument expected;
+        expected.LoadFromBuffer(buffer, password);
+        REQUIRE(serialize(peeked) == serialize(expected));
+        REQUIRE(peeked.GetObjects().GetObjectCount() == expected.GetObjects().GetObjectCount());
+
+        // Creating objects and saving complete the objects list first
+        PdfMemDocument modified;
+        modified.LoadFromBuffer(buffer, password, PdfLoadOptions::Peek);
+        auto& created = modified.GetObjects().CreateDictionaryObject();
+        REQUIRE(created.GetIndirectReference() == expected.GetObjects().CreateDictionaryObject().GetIndirectReference());
+
+        charbuff output;
+        StringStreamDevice device(output);
+        modified.Save(device, PdfSaveOptions::NoCollectGarbage);
+        PdfMemDocument reloaded;
+        reloaded.LoadFromBuffer(output, password);
+        REQUIRE(reloaded.GetPages().GetCount() == 3);
+        REQUIRE(reloaded.GetObjects().MustGetObject(refs[249]).GetDictionary().MustFindKey("Text").GetString().GetString() == "Text 249");
+    };
+
+    check(save(PdfSaveOptions::None), { });
+    check(save(PdfSaveOptions::ObjectStreams), { });
+
+    doc.SetEncrypted("user", "owner");
+    auto encrypted = save(PdfSaveOptions::None);
+    check(encrypted, "user");
+    check(save(PdfSaveOptions::ObjectStreams), "user");
+
+    PdfMemDocument loaded;
+    REQUIRE_THROWS_AS(loaded.LoadFromBuffer(encrypted, "user", PdfLoadOptions::Peek | PdfLoadOptions::ConcurrentRead), PdfError);
+}
+
 TEST_CASE("testIsPdfFile")
 {
     try
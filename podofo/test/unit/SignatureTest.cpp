@@ -0,0 +1,146 @@
+/**
+ * SPDX-FileCopyrightText: (C) 2024 Francesco Pretto <ceztko@gmail.com>
+ * SPDX-License-Identifier: LGPL-2.0-or-later
+ * SPDX-License-Identifier: MPL-2.0
+ */
+
+#include <PdfTest.h>
+
+using namespace std;
+using namespace PoDoFo;
+
+static uint64_t computeHash(const bufferview& data, uint64_t hash);
+static void checkSignature(const string_view& output);
+
+namespace
+{
+    // A signer computing a FNV-1a hash of the signed data
+    class TestSigner final : public PdfSigner
+    {
+    public:
+        TestSigner() : m_hash(0) { }
+
+        void Reset() override
+        {
+            m_hash = 14695981039346656037u;
+        }
+
+        void AppendData(const bufferview& data) override
+        {
+            m_hash = computeHash(data, m_hash);
+        }
+
+        void ComputeSignature(charbuff& buffer, bool dryrun) override
+        {
+            buffer.resize(sizeof(m_hash));
+            if (!dryrun)
+                std::memcpy(buffer.data(), &m_hash, sizeof(m_hash));
+        }
+
+        string GetSignatureSubFilter() const override
+        {
+            return "adbe.pkcs7.detached";
+        }
+
+        string GetSignatureType() const override
+        {
+            return "Sig";
+        }
+
+    private:
+        uint64_t m_hash;
+    };
+}
+
+TEST_CASE("TestSignDocument")
+{
+    string input;
+    {
+        PdfMemDocument doc;
+        for (unsigned i = 0; i < 20; i++)
+        {
+            auto& obj = doc.GetObjects().CreateDictionaryObject();
+            obj.GetOrCreateStream().SetData(utls::Format("Stream data of object {}", i));
+        }
+        doc.GetPages().CreatePage(PdfPage::CreateStandardPageSize(PdfPageSize::A4));
+        StringStreamDevice device(input);
+        doc.Save(device);
+    }
+
+    // The signed data is passed to the signer while writing
+    // the update, it must match the data covered by /ByteRange
+    {
+        PdfMemDocument doc;
+        doc.LoadFromBuffer(input);
+        auto& signature = doc.GetPages().GetPageAt(0).CreateField<PdfSignature>("Signature", Rect());
+        string output = input;
+        StringStreamDevice device(output);
+        TestSigner signer;
+        SignDocument(doc, device, signer, signature);
+        checkSignature(output);
+    }
+
+    // Sign multiple documents concurrently
+    const unsigned DocumentCount = 6;
+    vector<unique_ptr<PdfMemDocument>> docs;
+    vector<string> outputs(DocumentCount, input);
+    vector<unique_ptr<StringStreamDevice>> devices;
+    vector<PdfSignJob> jobs(DocumentCount);
+    for (unsigned i = 0; i < DocumentCount; i++)
+    {
+        docs.push_back(std::make_unique<PdfMemDocument>());
+        docs[i]->LoadFromBuffer(input);
+        devices.push_back(std::make_unique<StringStreamDevice>(outputs[i]));
+        jobs[i].Document = docs[i].get();
+        jobs[i].Device = devices[i].get();
+        jobs[i].Signature = &docs[i]->GetPages().GetPageAt(0).CreateField<PdfSignature>(
+            utls::Format("Signature{}", i), Rect());
+    }
+
+    SignDocuments(jobs, []() { return std::make_unique<TestSigner>(); }, 3);
+    for (auto& output : outputs)
+        checkSignature(output);
+}
+
+uint64_t computeHash(const bufferview& data, uint64_t hash)
+{
+    for (size_t i = 0; i < data.size(); i++)
+    {
+        hash ^= (unsigned char)data[i];
+        hash *= 1099511628211u;
+    }
+
+    return hash;
+}
+
+void checkSignature(const string_view& output)
+{
+    PdfMemDocument doc;
+    doc.LoadFromBuffer(output);
+    const PdfDictionary* sigDict = nullptr;
+    for (auto obj : doc.GetObjects())
+    {
+        if (obj->IsDictionary() && obj->GetDictionary().HasKey("ByteRange"))
+        {
+            sigDict = &obj->GetDictionary();
+            break;
+        }
+    }
+    REQUIRE(sigDict != nullptr);
+
+    auto& byteRange = sigDict->MustFindKey("ByteRange").GetArray();
+    REQUIRE(byteRange.GetSize() == 4);
+    uint64_t hash = 14695981039346656037u;
+    for (unsigned i = 0; i < 4; i += 2)
+    {
+        auto offset = (size_t)byteRange[i].GetNumber();
+        auto length = (size_t)byteRange[i + 1].GetNumber();
+        REQUIRE(offset + length <= output.size());
+        hash = computeHash(bufferview(output.data() + offset, length), hash);
+    }
+    REQUIRE((size_t)(byteRange[2].GetNumber() + byteRange[3].GetNumber()) == output.size());
+
+    auto& contents = sigDict->MustFindKey(PdfName::KeyContents).GetString().GetRawData();
+    REQUIRE(contents.size() == sizeof(hash));
+    REQUIRE(std::memcmp(contents.data(), &hash, sizeof(hash)) == 0);
+}
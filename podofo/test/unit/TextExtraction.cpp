@@ -7,6 +7,8 @@
  */
 
 #include <PdfTest.h>
+#include <regex>
+#include <podofo/private/RegexMatcher.h>
 
 using namespace std;
 using namespace PoDoFo;
@@ -45,3 +47,169 @@ TEST_CASE("TextExtraction2")
     ASSERT_EQUAL(entries[0].X, 31.199999999999999);
     ASSERT_EQUAL(entries[0].Y, 801.60000000000002);
 }
+
+TEST_CASE("TextExtractionParallel")
+{
+    charbuff buffer;
+    {
+        PdfMemDocument doc;
+        auto font = doc.GetFonts().SearchFont("LiberationSans");
+        if (font == nullptr)
+            FAIL("Coult not find Arial font");
+
+        // A form shared by all the pages, with its own resources
+        auto xobj = doc.CreateXObjectForm(Rect(0, 0, 200, 20));
+        PdfPainter painter;
+        painter.SetCanvas(*xobj);
+        painter.TextState.SetFont(*font, 10);
+        painter.DrawText("Shared form text", 0, 5);
+        painter.FinishDrawing();
+
+        for (unsigned i = 0; i < 24; i++)
+        {
+            auto& page = doc.GetPages().CreatePage(PdfPage::CreateStandardPageSize(PdfPageSize::A4));
+            painter.SetCanvas(page);
+            painter.TextState.SetFont(*font, 12);
+            painter.DrawText(utls::Format("Page {} first line", i + 1), 100, 700);
+            painter.DrawText(utls::Format("Page {} second line", i + 1), 100, 650);
+            painter.DrawXObject(*xobj, 100, 400);
+            painter.FinishDrawing();
+        }
+
+        StringStreamDevice device(buffer);
+        doc.Save(device);
+    }
+
+    // Sequential extraction on a separate document, so that
+    // the parallel one starts from not yet loaded objects
+    PdfMemDocument sequentialDoc;
+    sequentialDoc.LoadFromBuffer(buffer);
+    auto& sequentialPages = sequentialDoc.GetPages();
+
+    PdfMemDocument doc;
+    doc.LoadFromBuffer(buffer);
+    auto& pages = doc.GetPages();
+
+    vector<vector<PdfTextEntry>> entries;
+    pages.ExtractTextTo(entries, { }, { }, 4);
+    REQUIRE(entries.size() == 24);
+    for (unsigned i = 0; i < entries.size(); i++)
+    {
+        vector<PdfTextEntry> expected;
+        sequentialPages.GetPageAt(i).ExtractTextTo(expected);
+        REQUIRE(entries[i].size() == 3);
+        REQUIRE(entries[i].size() == expected.size());
+        REQUIRE(entries[i][0].Text == utls::Format("Page {} first line", i + 1));
+        for (unsigned j = 0; j < expected.size(); j++)
+        {
+            REQUIRE(entries[i][j].Text == expected[j].Text);
+            REQUIRE(entries[i][j].Page == expected[j].Page);
+            REQUIRE(entries[i][j].X == expected[j].X);
+            REQUIRE(entries[i][j].Y == expected[j].Y);
+        }
+    }
+
+    // Page range with a pattern
+    pages.ExtractTextTo(entries, 10, 4, "second", { }, 3);
+    REQUIRE(entries.size() == 4);
+    for (unsigned i = 0; i < entries.size(); i++)
+    {
+        REQUIRE(entries[i].size() == 1);
+        REQUIRE(entries[i][0].Text == utls::Format("Page {} second line", i + 11));
+    }
+
+    REQUIRE_THROWS_AS(pages.ExtractTextTo(entries, 20, 5), PdfError);
+}
+
+TEST_CASE("TextExtractionParallelSharedContents")
+{
+    charbuff buffer;
+    {
+        PdfMemDocument doc;
+        auto font = doc.GetFonts().SearchFont("LiberationSans");
+        if (font == nullptr)
+            FAIL("Coult not find Arial font");
+
+        auto& first = doc.GetPages().CreatePage(PdfPage::CreateStandardPageSize(PdfPageSize::A4));
+        PdfPainter painter;
+        painter.SetCanvas(first);
+        painter.TextState.SetFont(*font, 12);
+        painter.DrawText("Shared contents text", 100, 700);
+        painter.FinishDrawing();
+
+        // All the pages point to the same /Contents stream and resources
+        auto& contentsObj = first.MustGetContents().GetObject();
+        auto& resourcesObj = first.GetDictionary().MustFindKey("Resources");
+        for (unsigned i = 1; i < 16; i++)
+        {
+            auto& page = doc.GetPages().CreatePage(PdfPage::CreateStandardPageSize(PdfPageSize::A4));
+            page.GetDictionary().AddKey("Contents", contentsObj.GetIndirectReference());
+            page.GetDictionary().AddKey("Resources", resourcesObj);
+        }
+
+        StringStreamDevice device(buffer);
+        doc.Save(device);
+    }
+
+    // The workers read the shared stream concurrently
+    PdfMemDocument doc;
+    doc.LoadFromBuffer(buffer);
+    vector<vector<PdfTextEntry>> entries;
+    doc.GetPages().ExtractTextTo(entries, { }, { }, 4);
+    REQUIRE(entries.size() == 16);
+    for (unsigned i = 0; i < entries.size(); i++)
+    {
+        REQUIRE(entries[i].size() == 1);
+        REQUIRE(entries[i][0].Text == "Shared contents text");
+        REQUIRE(entries[i][0].Page == (int)i);
+    }
+}
+
+TEST_CASE("TestRegexMatcher")
+{
+    // The linear time matcher must agree with std::regex
+    // on the patterns it supports
+    const char* patterns[] = { "Hello", "^Hello", "World$", "H.llo", "l+o", "lo?W",
+        "(Hello|World) [A-Z]", "[a-f0-9]{2,4}", "\\d+\\.\\d*", "\\w+\\s\\w+", "[^a-z ]",
+        "(?:ab)*c", "a{3}", "x*", "Wor(ld|ds)$", "^$", "\\x41B", "[\\]-]", "(a|ab)(c|bcd)" };
+    const char* strings[] = { "Hello World", "hello world", "Hello World Again", "abc", "ababc",
+        "aaa", "3.14 and 42.", "WORLDS", "abcd", "", "AB", "-]", "1f2e", "Helo World" };
+    for (auto pattern : patterns)
+    {
+        for (bool ignoreCase : { false, true })
+        {
+            unique_ptr<utls::RegexMatcher> matcher;
+            REQUIRE(utls::RegexMatcher::TryCreate(pattern, ignoreCase, matcher));
+            auto flags = regex_constants::ECMAScript;
+            if (ignoreCase)
+                flags |= regex_constants::icase;
+
+            regex reference(pattern, flags);
+            for (auto str : strings)
+            {
+                INFO(utls::Format("Pattern \"{}\", string \"{}\", ignore case {}", pattern, str, ignoreCase));
+                REQUIRE(matcher->Search(str) == std::regex_search(str, reference));
+            }
+        }
+    }
+
+    // Features that need backtracking are left to std::regex
+    unique_ptr<utls::RegexMatcher> matcher;
+    REQUIRE(!utls::RegexMatcher::TryCreate("(a)\\1", false, matcher));
+    REQUIRE(!utls::RegexMatcher::TryCreate("a(?=b)", false, matcher));
+    REQUIRE(!utls::RegexMatcher::TryCreate("\\bword", false, matcher));
+    REQUIRE(!utls::RegexMatcher::TryCreate("(a", false, matcher));
+
+    // Case folding of non-ASCII characters is left to std::regex too
+    REQUIRE(!utls::RegexMatcher::TryCreate("caf\xC3\xA9", true, matcher));
+    REQUIRE(utls::RegexMatcher::TryCreate("caf\xC3\xA9", false, matcher));
+
+    // Long chains of instructions not consuming input don't exhaust the stack
+    string longPattern;
+    for (unsigned i = 0; i < 2000; i++)
+        longPattern.append("x?");
+    longPattern.append("y");
+    REQUIRE(utls::RegexMatcher::TryCreate(longPattern, false, matcher));
+    REQUIRE(matcher->Search("xxxy"));
+    REQUIRE(!matcher->Search("xxxz"));
+}
@@ -14,6 +14,8 @@ using namespace PoDoFo;
 static void Test(const string_view& buffer, PdfDataType dataType, string_view expected = { });
 static void TestStream(const string_view& buffer, const char* tokens[]);
 static void TestStreamIsNextToken(const string_view& buffer, const char* tokens[]);
+static void TestBufferedTokens(const string_view& buffer, const PdfTokenizerOptions& options = { });
+static string ReadContents(PdfContentStreamReader& reader);
 
 TEST_CASE("testArrays")
 {
@@ -171,6 +173,22 @@ TEST_CASE("testComments")
     TestStreamIsNextToken(pszBuffer, pszTokens);
 }
 
+TEST_CASE("testBufferedTokens")
+{
+    // Tokenizing on peeked device buffers must give the same
+    // tokens and device positions of the regular tokenization
+    TestBufferedTokens("613 0 obj<</Length 141/Filter[/ASCII85Decode/FlateDecode]>>endobj");
+    TestBufferedTokens("1 0 obj\r\n<<                                        /Type /Page    >>\r\nendobj");
+    TestBufferedTokens("abc%comment\ndef%comment at the end");
+    TestBufferedTokens("  % only a comment\r\n   \t\f  ");
+    TestBufferedTokens("<FFEB0400A0CC> (string) {a b} <<");
+    TestBufferedTokens("xref\n0 2\n0000000000 65535 f\r\n0000000017 00000 n\r\ntrailer\n<<");
+    TestBufferedTokens("<< /a >> <<b>> <", { PdfPostScriptLanguageLevel::L1, false });
+
+    // Tokens longer than the buffer are split like in the regular path
+    TestBufferedTokens(string(PdfTokenizer::BufferSize * 2, 'a') + " b");
+}
+
 TEST_CASE("testLocale")
 {
     // Test with a locale thate uses "," instead of "." for doubles 
@@ -181,6 +199,64 @@ TEST_CASE("testLocale")
     setlocale(LC_ALL, old);
 }
 
+TEST_CASE("testOperatorLookup")
+{
+    for (unsigned i = 1; i <= (unsigned)PdfOperator::EX; i++)
+    {
+        auto op = (PdfOperator)i;
+        PdfOperator found;
+        REQUIRE(TryGetPdfOperator(GetPdfOperatorName(op), found));
+        REQUIRE(found == op);
+    }
+
+    PdfOperator op;
+    REQUIRE(!TryGetPdfOperator("", op));
+    REQUIRE(op == PdfOperator::Unknown);
+    REQUIRE(!TryGetPdfOperator("X", op));
+    REQUIRE(!TryGetPdfOperator("Tjj", op));
+    REQUIRE(!TryGetPdfOperator("BDCX", op));
+    REQUIRE(!TryGetPdfOperator(string_view("f\0", 2), op));
+}
+
+TEST_CASE("testCompiledContentStream")
+{
+    string_view pageContents =
+        "q 1 0 0 1 10 20 cm BT /F1 12 Tf [(Hello) -250 <414243>] TJ ET "
+        "/Span << /MCID 3 /Flag true /N null >> BDC EMC foo 1 2 "
+        "BI /W 2 /H 1 /BPC 8 /CS /G ID \x01\x02 EI 0.5 g /Fm0 Do /Fm0 Do /Missing Do Q";
+
+    PdfMemDocument doc;
+    auto xobj = doc.CreateXObjectForm(Rect(0, 0, 20, 10));
+    xobj->GetObject().GetOrCreateStream().SetData("0 0 10 10 re f (Form) Tj");
+
+    auto& page = doc.GetPages().CreatePage(PdfPage::CreateStandardPageSize(PdfPageSize::A4));
+    page.GetOrCreateResources().AddResource("XObject", "Fm0", xobj->GetObject());
+    page.GetOrCreateContents().GetStreamForAppending().SetData(pageContents);
+
+    PdfContentStreamReader reader(page);
+    auto expected = ReadContents(reader);
+
+    // Replaying the cached streams gives the same contents, following the forms
+    PdfContentReaderArgs args;
+    args.Cache = std::make_shared<PdfContentStreamCache>();
+    for (unsigned i = 0; i < 2; i++)
+    {
+        PdfContentStreamReader cachedReader(page, args);
+        REQUIRE(ReadContents(cachedReader) == expected);
+    }
+
+    // Only the form is cached, the page is read directly
+    REQUIRE(args.Cache->GetCount() == 1);
+
+    // Compiled streams can also be replayed directly
+    SpanStreamDevice device(pageContents);
+    auto compiled = std::make_shared<PdfCompiledContentStream>(device);
+    PdfContentStreamReader compiledReader(compiled);
+    PdfContentStreamReader deviceReader(std::make_shared<SpanStreamDevice>(pageContents));
+    REQUIRE(ReadContents(compiledReader) == ReadContents(deviceReader));
+    REQUIRE(compiled->GetCount() == 16);
+}
+
 void Test(const string_view& buffer, PdfDataType dataType, string_view expected)
 {
     expected = expected.empty() ? buffer : expected;
@@ -231,3 +307,52 @@ void TestStreamIsNextToken(const string_view& buffer, const char* tokens[])
     while (tokens[i] != nullptr)
         REQUIRE((tokenizer.TryReadNextToken(device, token) && token == tokens[i++]));
 }
+
+void TestBufferedTokens(const string_view& buffer, const PdfTokenizerOptions& options)
+{
+    INFO(utls::Format("Testing with buffer: {}", buffer));
+
+    SpanStreamDevice device(buffer);
+    istringstream stream((string)buffer);
+    StandardStreamDevice expectedDevice(stream);
+    PdfTokenizer tokenizer(options);
+    PdfTokenizer expectedTokenizer(options);
+
+    string_view token;
+    string_view expectedToken;
+    PdfTokenType tokenType;
+    PdfTokenType expectedTokenType;
+    while (true)
+    {
+        bool gotToken = tokenizer.TryReadNextToken(device, token, tokenType);
+        bool expectedGotToken = expectedTokenizer.TryReadNextToken(expectedDevice, expectedToken, expectedTokenType);
+        REQUIRE(gotToken == expectedGotToken);
+        if (!gotToken)
+            break;
+
+        REQUIRE(token == expectedToken);
+        REQUIRE(tokenType == expectedTokenType);
+        REQUIRE(device.GetPosition() == expectedDevice.GetPosition());
+    }
+}
+
+string ReadContents(PdfContentStreamReader& reader)
+{
+    string ret;
+    PdfContent content;
+    while (reader.TryReadNext(content))
+    {
+        ret.append(utls::Format("{} {} {} {} [", (int)content.Type, (int)content.Operator,
+            content.Keyword, (int)content.Warnings));
+        for (unsigned i = 0; i < content.Stack.GetSize(); i++)
+            ret.append(content.Stack[i].ToString()).push_back(' ');
+
+        ret.append("] ");
+        ret.append(PdfVariant(content.InlineImageDictionary).ToString());
+        ret.append(content.InlineImageData);
+        ret.append(content.Name == nullptr ? "" : content.Name->GetString());
+        ret.push_back('\n');
+    }
+
+    return ret;
+}
@@ -169,6 +169,46 @@ TEST_CASE("testIsDirtyFalse")
     TestObjectsDirty(objBool, objNum, objReal, objStr, objRef, objArray, objDict, objStream, objVariant, false);
 }
 
+TEST_CASE("testDictionaryEntries")
+{
+    PdfDictionary dict;
+    auto& first = dict.AddKey("K10", PdfDictionary());
+    for (unsigned i = 0; i < 20; i++)
+        dict.AddKey(PdfName(utls::Format("K{}", (i * 7) % 20)), static_cast<int64_t>(i));
+
+    // Existing keys are replaced in place and references
+    // to entries stay valid while the dictionary grows
+    REQUIRE(dict.GetSize() == 20);
+    REQUIRE(&first == dict.GetKey("K10"));
+    REQUIRE(first.GetNumber() == 10);
+
+    // Iteration is ordered by key
+    string previous;
+    for (auto& pair : dict)
+    {
+        REQUIRE(previous < pair.first.GetString());
+        previous = pair.first.GetString();
+    }
+
+    REQUIRE(dict.RemoveKey("K3"));
+    REQUIRE(!dict.RemoveKey("K3"));
+    REQUIRE(!dict.HasKey("K3"));
+    REQUIRE(dict.GetSize() == 19);
+    dict.AddKey("K3", PdfName("Value"));
+    REQUIRE(dict.MustGetKey("K3").GetName() == "Value");
+
+    PdfDictionary copy(dict);
+    REQUIRE(copy == dict);
+    copy.AddKey("K3", PdfName("Other"));
+    REQUIRE(copy.GetKey("K3")->GetName() == "Other");
+    REQUIRE(dict.GetKey("K3")->GetName() == "Value");
+
+    PdfDictionary moved(std::move(copy));
+    REQUIRE(moved.GetSize() == 20);
+    REQUIRE(copy.GetSize() == 0);
+    REQUIRE(moved.FindKeyAs<int64_t>("K19") == 17);
+}
+
 void TestObjectsDirty(
     const PdfObject& objBool,
     const PdfObject& objNum,
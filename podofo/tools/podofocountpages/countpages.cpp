@@ -13,18 +13,20 @@ using namespace PoDoFo;
 
 void print_help()
 {
-    printf("Usage: podofocountpages [-s] [-t] file1.pdf ... \n\n");
+    printf("Usage: podofocountpages [-s] [-t] [-p] file1.pdf ... \n\n");
     printf("       This tool counts the pages in a PDF file.\n");
     printf("       -s will enable the short format, which ommites\n");
     printf("          printing of the filename in the output.\n");
     printf("       -t print the total sum of all pages.\n");
+    printf("       -p peek the files, reading only the objects\n");
+    printf("          needed to count the pages.\n");
     printf("\nPoDoFo Version: %s\n\n", PODOFO_VERSION_STRING);
 }
 
-int count_pages(const string_view filename, const bool& shortFormat)
+int count_pages(const string_view filename, const bool& shortFormat, PdfLoadOptions options)
 {
     PdfMemDocument document;
-    document.Load(filename);
+    document.Load(filename, { }, options);
     unsigned nPages = document.GetPages().GetCount();
     
     if (shortFormat)
@@ -47,6 +49,7 @@ void Main(const cspan<string_view>& args)
 
     bool total = false;
     bool shortFormat = false;
+    PdfLoadOptions options = PdfLoadOptions::None;
     int sum = 0;
 
     for (unsigned i = 1; i < args.size(); i++)
@@ -61,9 +64,13 @@ void Main(const cspan<string_view>& args)
         {
             total = true;
         }
+        else if (arg == "-p")
+        {
+            options = PdfLoadOptions::Peek;
+        }
         else
         {
-            sum += count_pages(arg, shortFormat);
+            sum += count_pages(arg, shortFormat, options);
         }
     }
 
@@ -7,8 +7,12 @@
 #include "ImageExtractor.h"
 
 #include <sys/stat.h>
+#include <atomic>
+#include <chrono>
 #include <cstdlib>
 #include <cstdio>
+#include <thread>
+#include <unordered_map>
 
 #ifdef _MSC_VER
 #define snprintf _snprintf
@@ -17,93 +21,205 @@
 using namespace std;
 using namespace PoDoFo;
 
+static bool isJpegImage(const PdfObject& obj);
+static bool haveSameContents(const PdfObject& obj1, const bufferview& data1,
+    const PdfObject& obj2, const bufferview& data2);
+static unsigned getKeyCountWithoutLength(const PdfDictionary& dict);
+
 ImageExtractor::ImageExtractor()
-    : m_ImageCount(0), m_fileCounter(0), m_buffer{}
+    : m_ImageCount(0), m_duplicateCount(0), m_fileCounter(0),
+    m_threadCount(1), m_printTimings(false), m_buffer{}
 {
 }
 
-void ImageExtractor::Init(const string_view& input, const string_view& output)
+void ImageExtractor::Init(const string_view& input, const string_view& output,
+    unsigned threadCount, bool skipDuplicates, bool printTimings)
 {
-    PdfMemDocument document;
-    document.Load(input);
+    if (threadCount == 0)
+        threadCount = std::max(1u, std::thread::hardware_concurrency());
 
     m_outputDirectory = output;
+    m_threadCount = threadCount;
+    m_printTimings = printTimings;
+
+    // NOTE: Objects and streams are loaded on first access,
+    // so the workers need a document that allows concurrent reads
+    PdfMemDocument document;
+    document.Load(input, { }, threadCount > 1 ? PdfLoadOptions::ConcurrentRead : PdfLoadOptions::None);
 
+    // Enumerate the images first, so they can be written in parallel
+    vector<Image> images;
     for (auto obj : document.GetObjects())
     {
-        if (obj->IsDictionary())
+        if (!obj->IsDictionary())
+            continue;
+
+        auto subtypeObj = obj->GetDictionary().GetKey(PdfName::KeySubtype);
+        if (subtypeObj == nullptr || !subtypeObj->IsName() || subtypeObj->GetName() != "Image"
+            || !obj->HasStream())
         {
-            PdfObject* typeObj = obj->GetDictionary().GetKey(PdfName::KeyType);
-            PdfObject* subtypeObj = obj->GetDictionary().GetKey(PdfName::KeySubtype);
-            if ((typeObj && typeObj->IsName() && (typeObj->GetName() == "XObject")) ||
-                (subtypeObj && subtypeObj->IsName() && (subtypeObj->GetName() == "Image")))
-            {
-                auto filter = obj->GetDictionary().GetKey(PdfName::KeyFilter);
-                if (filter != nullptr && filter->IsArray() && filter->GetArray().GetSize() == 1 &&
-                    filter->GetArray()[0].IsName() && (filter->GetArray()[0].GetName() == "DCTDecode"))
-                    filter = &filter->GetArray()[0];
+            continue;
+        }
 
-                if (filter && filter->IsName() && (filter->GetName() == "DCTDecode"))
-                {
-                    // The only filter is JPEG -> create a JPEG file
-                    ExtractImage(*obj, true);
-                }
-                else
+        Image image{ };
+        image.Object = obj;
+        image.IsJpeg = isJpegImage(*obj);
+        images.push_back(std::move(image));
+    }
+
+    if (skipDuplicates)
+    {
+        RunParallel(images.size(), [&](size_t i) {
+            HashImage(images[i]);
+        });
+
+        unordered_map<size_t, vector<const Image*>> hashes;
+        for (auto& image : images)
+        {
+            auto& sameHash = hashes[image.Hash];
+            for (auto other : sameHash)
+            {
+                if (image.IsJpeg == other->IsJpeg
+                    && haveSameContents(*image.Object, image.RawData, *other->Object, other->RawData))
                 {
-                    ExtractImage(*obj, false);
+                    image.Original = other;
+                    break;
                 }
             }
+
+            if (image.Original == nullptr)
+                sameHash.push_back(&image);
         }
     }
-}
-
-void ImageExtractor::ExtractImage(const PdfObject& obj, bool jpeg)
-{
-    FILE* file = nullptr;
-    const char* extension = jpeg ? "jpg" : "ppm";
 
-    // Do not overwrite existing files:
-    do
+    // Choose the file names in the same order as the images
+    for (auto& image : images)
     {
-        snprintf(m_buffer, MAX_PATH, "%s/pdfimage_%04i.%s", m_outputDirectory.data(), m_fileCounter++, extension);
+        if (image.Original != nullptr)
+        {
+            printf("-> Skipping image object %s, identical to image object %s\n",
+                image.Object->GetIndirectReference().ToString().data(),
+                image.Original->Object->GetIndirectReference().ToString().data());
+            m_duplicateCount++;
+            continue;
+        }
+
+        // Do not overwrite existing files:
+        do
+        {
+            snprintf(m_buffer, MAX_PATH, "%s/pdfimage_%04i.%s", m_outputDirectory.data(),
+                m_fileCounter++, image.IsJpeg ? "jpg" : "ppm");
+        } while (FileExists(m_buffer));
+
+        image.FileName = m_buffer;
     }
-    while (FileExists(m_buffer));
 
-    file = fopen(m_buffer, "wb");
+    RunParallel(images.size(), [&](size_t i) {
+        if (images[i].Original == nullptr)
+            ExtractImage(images[i]);
+    });
+}
+
+void ImageExtractor::ExtractImage(const Image& image)
+{
+    auto& obj = *image.Object;
+    auto start = chrono::steady_clock::now();
+    FILE* file = fopen(image.FileName.data(), "wb");
     if (file == nullptr)
     {
         PODOFO_RAISE_ERROR(PdfErrorCode::InvalidHandle);
     }
 
-    printf("-> Writing image object %s to the file: %s\n", obj.GetIndirectReference().ToString().data(), m_buffer);
-
-    if (jpeg)
+    if (image.IsJpeg)
     {
-        auto& memprovider = dynamic_cast<const PdfMemoryObjectStream&>(obj.GetStream()->GetProvider());
-        auto& buffer = memprovider.GetBuffer();
-        fwrite(buffer.data(), buffer.size(), sizeof(char), file);
+        // The JPEG data is written as it is, without decoding it
+        auto& stream = obj.MustGetStream();
+        auto memprovider = dynamic_cast<const PdfMemoryObjectStream*>(&stream.GetProvider());
+        if (memprovider == nullptr)
+        {
+            charbuff buffer;
+            stream.CopyTo(buffer, true);
+            fwrite(buffer.data(), buffer.size(), sizeof(char), file);
+        }
+        else
+        {
+            auto buffer = memprovider->GetView();
+            fwrite(buffer.data(), buffer.size(), sizeof(char), file);
+        }
     }
     else
     {
-        //long lBitsPerComponent = pObject->GetDictionary().GetKey( PdfName("BitsPerComponent" ) )->GetNumber();
-        // TODO: Handle colorspaces
-
         // Create a ppm image
         const char* ppmHeader = "P6\n# Image extracted by PoDoFo\n%u %u\n%li\n";
 
-        fprintf(file, ppmHeader,
-            (unsigned)obj.GetDictionary().GetKey("Width")->GetNumber(),
-            (unsigned)obj.GetDictionary().GetKey("Height")->GetNumber(),
-            255);
+        unsigned width = (unsigned)obj.GetDictionary().MustFindKey("Width").GetNumber();
+        unsigned height = (unsigned)obj.GetDictionary().MustFindKey("Height").GetNumber();
+        unique_ptr<const PdfImage> pdfImage;
+        charbuff buffer;
+        bool decoded = false;
+        if (PdfXObject::TryCreateFromObject(obj, pdfImage))
+        {
+            try
+            {
+                pdfImage->DecodeTo(buffer, PdfPixelFormat::RGB24);
+                decoded = true;
+            }
+            catch (PdfError&)
+            {
+                // Unsupported color space or filter
+            }
+        }
 
-        auto buffer = obj.GetStream()->GetCopy();
-        fwrite(buffer.data(), buffer.size(), sizeof(char), file);
+        fprintf(file, ppmHeader, width, height, 255);
+        if (decoded)
+        {
+            // NOTE: The decoded rows are aligned to 4 bytes
+            unsigned rowSize = width * 3;
+            unsigned stride = 4 * ((rowSize + 3) / 4);
+            for (unsigned i = 0; i < height; i++)
+                fwrite(buffer.data() + (size_t)i * stride, rowSize, sizeof(char), file);
+        }
+        else
+        {
+            // TODO: Handle colorspaces
+            buffer = obj.GetStream()->GetCopy();
+            fwrite(buffer.data(), buffer.size(), sizeof(char), file);
+        }
     }
 
     fclose(file);
+
+    unique_lock<mutex> lock(m_outputMutex);
+    if (m_printTimings)
+    {
+        double elapsed = chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+        printf("-> Writing image object %s to the file: %s (%.2f ms)\n",
+            obj.GetIndirectReference().ToString().data(), image.FileName.data(), elapsed);
+    }
+    else
+    {
+        printf("-> Writing image object %s to the file: %s\n",
+            obj.GetIndirectReference().ToString().data(), image.FileName.data());
+    }
+
     m_ImageCount++;
 }
 
+void ImageExtractor::HashImage(Image& image)
+{
+    // Only the images whose data can be viewed without
+    // copies are compared, the others are always written
+    auto memprovider = dynamic_cast<const PdfMemoryObjectStream*>(&image.Object->MustGetStream().GetProvider());
+    if (memprovider == nullptr)
+    {
+        image.Hash = 0;
+        return;
+    }
+
+    image.RawData = memprovider->GetView();
+    image.Hash = std::hash<string_view>()(string_view(image.RawData.data(), image.RawData.size()));
+}
+
 bool ImageExtractor::FileExists(const string_view& filepath)
 {
     bool result = true;
@@ -115,3 +231,104 @@ bool ImageExtractor::FileExists(const string_view& filepath)
 
     return result;
 }
+
+void ImageExtractor::RunParallel(size_t count, const function<void(size_t)>& func)
+{
+    atomic<size_t> next(0);
+    exception_ptr error;
+    mutex errorMutex;
+    auto worker = [&]() {
+        while (true)
+        {
+            size_t i = next.fetch_add(1, memory_order_relaxed);
+            if (i >= count)
+                return;
+
+            try
+            {
+                func(i);
+            }
+            catch (...)
+            {
+                unique_lock<mutex> lock(errorMutex);
+                if (error == nullptr)
+                    error = std::current_exception();
+
+                // Stop the other workers from taking further items
+                next.store(count, memory_order_relaxed);
+                return;
+            }
+        }
+    };
+
+    unsigned threadCount = (unsigned)std::min<size_t>(m_threadCount, count);
+    if (threadCount <= 1)
+    {
+        worker();
+    }
+    else
+    {
+        // The calling thread acts as one of the workers
+        vector<thread> threads;
+        threads.reserve(threadCount - 1);
+        for (unsigned i = 1; i < threadCount; i++)
+            threads.emplace_back(worker);
+
+        worker();
+        for (auto& thread : threads)
+            thread.join();
+    }
+
+    if (error != nullptr)
+        std::rethrow_exception(error);
+}
+
+bool isJpegImage(const PdfObject& obj)
+{
+    auto filter = obj.GetDictionary().GetKey(PdfName::KeyFilter);
+    if (filter != nullptr && filter->IsArray() && filter->GetArray().GetSize() == 1 &&
+        filter->GetArray()[0].IsName() && (filter->GetArray()[0].GetName() == "DCTDecode"))
+        filter = &filter->GetArray()[0];
+
+    // The only filter is JPEG -> create a JPEG file
+    return filter != nullptr && filter->IsName() && filter->GetName() == "DCTDecode";
+}
+
+bool haveSameContents(const PdfObject& obj1, const bufferview& data1,
+    const PdfObject& obj2, const bufferview& data2)
+{
+    if (data1.data() == nullptr || data2.data() == nullptr || data1.size() != data2.size()
+        || std::memcmp(data1.data(), data2.data(), data1.size()) != 0)
+    {
+        return false;
+    }
+
+    // The same data may be interpreted differently if the image
+    // dictionaries are different, eg. with another /ColorSpace,
+    // /Decode, /Filter or /SMask: compare all the keys but /Length
+    auto& dict1 = obj1.GetDictionary();
+    auto& dict2 = obj2.GetDictionary();
+    if (getKeyCountWithoutLength(dict1) != getKeyCountWithoutLength(dict2))
+        return false;
+
+    for (auto& pair : dict1)
+    {
+        if (pair.first == PdfName::KeyLength)
+            continue;
+
+        auto value2 = dict2.GetKey(pair.first);
+        if (value2 == nullptr || *value2 != pair.second)
+            return false;
+    }
+
+    return true;
+}
+
+unsigned getKeyCountWithoutLength(const PdfDictionary& dict)
+{
+    unsigned count = dict.GetSize();
+    if (dict.HasKey(PdfName::KeyLength))
+        count--;
+
+    return count;
+}
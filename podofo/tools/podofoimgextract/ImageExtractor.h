@@ -6,11 +6,17 @@
 #ifndef IMAGE_EXTRACTOR_H
 #define IMAGE_EXTRACTOR_H
 
+#include <functional>
+#include <mutex>
+
 #include <podofo/podofo.h>
 
 /** This class uses the PoDoFo lib to parse
  *  a PDF file and to write all images it finds
  *  in this PDF document to a given directory.
+ *
+ *  The images are enumerated first, then decoded and
+ *  written by a pool of worker threads.
  */
 class ImageExtractor
 {
@@ -20,25 +26,48 @@ public:
     ImageExtractor();
 
     /**
-     * \param pnNum pointer to an integer were
-     *        the number of processed images can be stored
-     *        or null if you do not want this information.
+     * \param threadCount the count of the threads writing
+     *        the images, 0 to use all the available cores
+     * \param skipDuplicates if true, images with the same
+     *        stream contents are written only once
+     * \param printTimings if true, the time spent to write
+     *        every image is printed
      */
-    void Init(const std::string_view& input, const std::string_view& output);
+    void Init(const std::string_view& input, const std::string_view& output,
+        unsigned threadCount = 1, bool skipDuplicates = false, bool printTimings = false);
 
     /**
      * \returns the number of succesfully extracted images
      */
     inline unsigned GetNumImagesExtracted() const;
 
+    /**
+     * \returns the number of images that were skipped
+     *          because identical to an extracted one
+     */
+    inline unsigned GetNumDuplicateImages() const;
+
+private:
+    struct Image
+    {
+        const PoDoFo::PdfObject* Object;
+        bool IsJpeg;
+        PoDoFo::bufferview RawData;     ///< Encoded stream data, if available without copies
+        size_t Hash;
+        const Image* Original;          ///< Identical image already extracted, if any
+        std::string FileName;
+    };
+
 private:
     /** Extracts the image form the given PdfObject
      *  which has to be an XObject with Subtype "Image"
-     *  \param obj a handle to a PDF object
-     *  \param jpeg if true extract as a jpeg, otherwise create a ppm
-     *  \returns ErrOk on success
+     *  \param image the image to extract
      */
-    void ExtractImage(const PoDoFo::PdfObject& obj, bool jpeg);
+    void ExtractImage(const Image& image);
+
+    /** Read the encoded stream data of the image and compute its hash
+     */
+    void HashImage(Image& image);
 
     /** This function checks wether a file with the
      *  given filename does exist.
@@ -46,11 +75,20 @@ private:
      */
     bool FileExists(const std::string_view& filepath);
 
+    /** Call the function for every index in [0, count)
+     *  on m_threadCount threads, rethrowing the first error
+     */
+    void RunParallel(size_t count, const std::function<void(size_t)>& func);
+
 private:
     std::string_view m_outputDirectory;
     unsigned m_ImageCount;
+    unsigned m_duplicateCount;
     unsigned m_fileCounter;
+    unsigned m_threadCount;
+    bool m_printTimings;
     char m_buffer[MAX_PATH];
+    std::mutex m_outputMutex;
 };
 
 inline unsigned ImageExtractor::GetNumImagesExtracted() const
@@ -58,4 +96,9 @@ inline unsigned ImageExtractor::GetNumImagesExtracted() const
     return m_ImageCount;
 }
 
+inline unsigned ImageExtractor::GetNumDuplicateImages() const
+{
+    return m_duplicateCount;
+}
+
 #endif // IMAGE_EXTRACTOR_H
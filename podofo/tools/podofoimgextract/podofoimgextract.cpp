@@ -13,7 +13,11 @@ using namespace PoDoFo;
 
 void print_help()
 {
-    printf("Usage: podofoimgextract [inputfile] [outputdirectory]\n\n");
+    printf("Usage: podofoimgextract [-j threads] [-u] [-t] [inputfile] [outputdirectory]\n\n");
+    printf("       -j decode and write the images on the given count\n");
+    printf("          of threads, 0 to use all the available cores.\n");
+    printf("       -u write only once the images with identical data.\n");
+    printf("       -t print the time spent to write every image.\n");
     printf("\nPoDoFo Version: %s\n\n", PODOFO_VERSION_STRING);
 }
 
@@ -21,17 +25,45 @@ void Main(const cspan<string_view>& args)
 {
     ImageExtractor extractor;
 
-    if (args.size() != 3)
+    unsigned threadCount = 1;
+    bool skipDuplicates = false;
+    bool printTimings = false;
+    vector<string_view> paths;
+    for (unsigned i = 1; i < args.size(); i++)
+    {
+        auto arg = args[i];
+        if (arg == "-j" && i + 1 < args.size())
+        {
+            i++;
+            threadCount = (unsigned)strtol(args[i].data(), NULL, 10);
+        }
+        else if (arg == "-u")
+        {
+            skipDuplicates = true;
+        }
+        else if (arg == "-t")
+        {
+            printTimings = true;
+        }
+        else
+        {
+            paths.push_back(arg);
+        }
+    }
+
+    if (paths.size() != 2)
     {
         print_help();
         exit(-1);
     }
 
-    auto input = args[1];
-    auto output = args[2];
+    auto input = paths[0];
+    auto output = paths[1];
 
-    extractor.Init(input, output);
+    extractor.Init(input, output, threadCount, skipDuplicates, printTimings);
 
     unsigned imageCount = extractor.GetNumImagesExtracted();
     printf("Extracted %u images successfully from the PDF file.\n", imageCount);
+    if (skipDuplicates)
+        printf("Skipped %u duplicate images.\n", extractor.GetNumDuplicateImages());
 }
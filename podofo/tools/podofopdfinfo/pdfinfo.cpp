@@ -10,10 +10,10 @@
 using namespace std;
 using namespace PoDoFo;
 
-PdfInfoHelper::PdfInfoHelper(const string& filepath)
+PdfInfoHelper::PdfInfoHelper(const string& filepath, PdfLoadOptions options)
 {
     m_doc = new PdfMemDocument();
-    m_doc->Load(filepath);
+    m_doc->Load(filepath, { }, options);
 }
 
 PdfInfoHelper::~PdfInfoHelper()
@@ -12,7 +12,7 @@
 class PdfInfoHelper
 {
 public:
-    PdfInfoHelper(const std::string& filepath);
+    PdfInfoHelper(const std::string& filepath, PoDoFo::PdfLoadOptions options);
     virtual ~PdfInfoHelper();
 
     void OutputDocumentInfo(std::ostream& outStream);
@@ -14,7 +14,7 @@ using namespace PoDoFo;
 
 void print_help()
 {
-    printf("Usage: podofopdfinfo [DCPON] [inputfile] \n\n");
+    printf("Usage: podofopdfinfo [-p] [DCPON] [inputfile] \n\n");
     printf("       This tool displays information about the PDF file\n");
     printf("       according to format instruction (if not provided, displays all).\n");
     printf("       D displays Document Info.\n");
@@ -22,6 +22,8 @@ void print_help()
     printf("       P displays Page Info.\n");
     printf("       O displays Outlines.\n");
     printf("       N displays Names.\n");
+    printf("       -p peek the file, reading only the objects\n");
+    printf("          needed for the displayed information.\n");
     printf("\nPoDoFo Version: %s\n\n", PODOFO_VERSION_STRING);
 }
 
@@ -63,7 +65,17 @@ void Main(const cspan<string_view>& args)
     PdfCommon::SetMaxLoggingSeverity(PdfLogSeverity::None);	// turn it off to better view the output from this app!
 #endif
 
-    if (args.size() < 2 || args.size() > 3)
+    PdfLoadOptions options = PdfLoadOptions::None;
+    vector<string_view> positionals;
+    for (unsigned i = 1; i < args.size(); i++)
+    {
+        if (args[i] == "-p")
+            options = PdfLoadOptions::Peek;
+        else
+            positionals.push_back(args[i]);
+    }
+
+    if (positionals.size() < 1 || positionals.size() > 2)
     {
         print_help();
         exit(-1);
@@ -73,21 +85,21 @@ void Main(const cspan<string_view>& args)
     Format format;
     string filepath;
 
-    if (args.size() == 2)
+    if (positionals.size() == 1)
     {
-        input = args[1];
+        input = positionals[0];
     }
-    else if (args.size() == 3)
+    else if (positionals.size() == 2)
     {
-        input = args[2];
-        format = ParseFormat(args[1]);
+        input = positionals[1];
+        format = ParseFormat(positionals[0]);
     }
 
     if (!input.empty())
         filepath = input;
     //else leave empty
 
-    PdfInfoHelper info(filepath);
+    PdfInfoHelper info(filepath, options);
 
     if (format.document)
     {